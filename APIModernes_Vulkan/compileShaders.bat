@@ -1,3 +1,3 @@
-%VK_SDK_PATH%/Bin/glslc.exe shaders/triangle.vert -o shaders/triangle.vert.spv
-%VK_SDK_PATH%/Bin/glslc.exe shaders/triangle.frag -o shaders/triangle.frag.spv
+"%VK_SDK_PATH%/Bin/glslc.exe" shaders/triangle.vert -o shaders/triangle.vert.spv
+"%VK_SDK_PATH%/Bin/glslc.exe" shaders/triangle.frag -o shaders/triangle.frag.spv
 PAUSE
\ No newline at end of file
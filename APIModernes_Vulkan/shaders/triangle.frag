@@ -2,6 +2,9 @@
 
 layout(binding = 1) uniform sampler2D texSampler;
 
+//Specialization constant : the pipeline without it only shows the texture
+layout(constant_id = 0) const bool USE_VERTEX_COLOR = true;
+
 
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec2 fragTexCoord;
@@ -10,5 +13,10 @@ layout(location = 0) out vec4 outColor;
 
 
 void main() {
-    outColor = vec4(fragColor * texture(texSampler, fragTexCoord).rgb, 1.0);
+    vec3 color = texture(texSampler, fragTexCoord).rgb;
+
+    if (USE_VERTEX_COLOR)
+        color *= fragColor;
+
+    outColor = vec4(color, 1.0);
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "Application.h"
 
+#include <cstdio>
 #include <iostream>
 
 Application* Application::mInstance = nullptr;
@@ -10,15 +11,45 @@ bool Application::Init(const std::string& p_windowName, const int& p_width, cons
 	//(I'd like to move the glfw part to IRenderer or smth else !)
 	//
 
-	glfwInit();
-	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API); //For vulkan 
+	//Headless runs where there's no display, glfw isn't even initialized
+	if (!this->mHeadless.enabled)
+	{
+		glfwInit();
+		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API); //For vulkan 
+
+		this->mWindow = Window::Create(p_windowName, p_width, p_height);
+	}
 
 	//Here ?
-	this->mRenderer = new VKRenderer();
-	this->mWindow = Window::Create(p_windowName, p_width, p_height);
+	VKRenderer* renderer = new VKRenderer(this->mPacing, this->mHeadless.enabled);
+
+	//The writer runs on the readback worker, the render loop never waits for the disk
+	if (this->mCapture.IsEnabled())
+	{
+		std::string pattern = this->mCapture.outputPattern;
+
+		renderer->SetFrameConsumer([pattern](const ReadbackFrame& p_frame)
+		{
+			bool rgba = p_frame.format == VK_FORMAT_R8G8B8A8_UNORM || p_frame.format == VK_FORMAT_R8G8B8A8_SRGB;
+			bool bgra = p_frame.format == VK_FORMAT_B8G8R8A8_UNORM || p_frame.format == VK_FORMAT_B8G8R8A8_SRGB;
+
+			//ParseCommandLine() only lets through patterns with a single %u
+			char filePath[512];
+			snprintf(filePath, sizeof(filePath), pattern.c_str(), (unsigned int)p_frame.frameIndex);
+
+			if (!(rgba || bgra) || !WriteImagePPM(filePath, p_frame.pixels, p_frame.width, p_frame.height, p_frame.rowPitch, bgra))
+				std::cout << "[Capture] can't write " << filePath << std::endl;
+		});
+	}
+
+	this->mRenderer = renderer;
 	this->mEngine = new Engine();
 
-	this->mRenderer->Init(this->mWindow);
+	bool result = this->mRenderer->Init(this->mWindow);
+
+	//Nobody watches a headless run, it has to stop on its own
+	if (this->mHeadless.enabled)
+		return result;
 
 	return (this->mRenderer || this->mWindow || this->mEngine);
 }
@@ -52,17 +83,46 @@ Application& Application::Get()
 	return *mInstance;
 }
 
-int Application::Run(const std::string& p_windowName, const int& p_width, const int& p_height)
+int Application::Run(const std::string& p_windowName, const int& p_width, const int& p_height, const FramePacing& p_pacing, const HeadlessSettings& p_headless, const CaptureSettings& p_capture)
 {
+	this->mPacing	= p_pacing;
+	this->mHeadless = p_headless;
+	this->mCapture	= p_capture;
+
 	bool init = this->Init(p_windowName, p_width, p_height);
 
 	if (!init)
 		return 1;
+
+	if (this->mHeadless.enabled)
+	{
+		int result = this->RunHeadless();
+
+		this->Quit();
+
+		return result;
+	}
 	
 	while (!mWindow->ShouldClose()) 
 	{
 		if (glfwGetKey(mWindow->mWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 			glfwSetWindowShouldClose(mWindow->mWindow, true);
+
+		//Once per press
+		bool toggleKeyDown = glfwGetKey(mWindow->mWindow, GLFW_KEY_V) == GLFW_PRESS;
+
+		if (toggleKeyDown && !this->mToggleKeyDown)
+			this->mRenderer->ToggleVertexColor();
+
+		this->mToggleKeyDown = toggleKeyDown;
+
+		//Nothing can be presented while minimized, sleeping until the window comes back rather than skipping frames at full speed
+		this->mWindow->WaitWhileMinimized();
+
+		//The wait Render() would do first, moved before the poll so the frame uses input sampled once the CPU can go
+		if (this->mPacing.waitBeforeInput)
+			this->mRenderer->WaitForFrame();
+
 		glfwPollEvents();
 		this->mRenderer->Render();
 	}
@@ -72,6 +132,18 @@ int Application::Run(const std::string& p_windowName, const int& p_width, const
 	return 0;
 }
 
+int Application::RunHeadless()
+{
+	//How long loading takes changes from run to run, the frames that count only start once it's all there
+	while (!this->mRenderer->IsReady())
+		this->mRenderer->Render();
+
+	for (uint32_t i = 0; i < this->mHeadless.frameCount; i++)
+		this->mRenderer->Render();
+
+	return this->mRenderer->SaveFrame(this->mHeadless.outputPath.c_str()) ? 0 : 1;
+}
+
 void Application::Quit()
 {
 	this->Release();
@@ -16,17 +16,26 @@ private :
 
 	IRenderer* mRenderer = nullptr;
 
+	FramePacing		mPacing;
+	HeadlessSettings	mHeadless;
+	CaptureSettings		mCapture;
+
+	bool mToggleKeyDown = false; //V was already down last frame
+
 private:
 	bool Init(const std::string& p_windowName, const int& p_width, const int& p_height);
 	void Release();
 	void Render();
 
+	//Renders the frames of mHeadless once everything is loaded and writes the last one
+	int RunHeadless();
+
 public :
 	static void Create();
 	static void Destroy();
 	static Application& Get();
 	
-	int Run(const std::string& p_windowName, const int& p_width, const int& p_height);
+	int Run(const std::string& p_windowName, const int& p_width, const int& p_height, const FramePacing& p_pacing = FramePacing(), const HeadlessSettings& p_headless = HeadlessSettings(), const CaptureSettings& p_capture = CaptureSettings());
 	void Quit();
 };
 
@@ -0,0 +1,447 @@
+#include "BlockDecoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+#pragma region BC7 tables
+//Subset of every texel for the 64 two subsets and 64 three subsets partitions
+static const uint8_t BC7_PARTITIONS_2[64][16] =
+{
+	{ 0,0,1,1,0,0,1,1,0,0,1,1,0,0,1,1 }, { 0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,1 }, { 0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1 }, { 0,0,0,1,0,0,1,1,0,0,1,1,0,1,1,1 },
+	{ 0,0,0,0,0,0,0,1,0,0,0,1,0,0,1,1 }, { 0,0,1,1,0,1,1,1,0,1,1,1,1,1,1,1 }, { 0,0,0,1,0,0,1,1,0,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,1,0,0,1,1,0,1,1,1 },
+	{ 0,0,0,0,0,0,0,0,0,0,0,1,0,0,1,1 }, { 0,0,1,1,0,1,1,1,1,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,1,0,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,0,0,0,0,1,0,1,1,1 },
+	{ 0,0,0,1,0,1,1,1,1,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1 }, { 0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1 },
+	{ 0,0,0,0,1,0,0,0,1,1,1,0,1,1,1,1 }, { 0,1,1,1,0,0,0,1,0,0,0,0,0,0,0,0 }, { 0,0,0,0,0,0,0,0,1,0,0,0,1,1,1,0 }, { 0,1,1,1,0,0,1,1,0,0,0,1,0,0,0,0 },
+	{ 0,0,1,1,0,0,0,1,0,0,0,0,0,0,0,0 }, { 0,0,0,0,1,0,0,0,1,1,0,0,1,1,1,0 }, { 0,0,0,0,0,0,0,0,1,0,0,0,1,1,0,0 }, { 0,1,1,1,0,0,1,1,0,0,1,1,0,0,0,1 },
+	{ 0,0,1,1,0,0,0,1,0,0,0,1,0,0,0,0 }, { 0,0,0,0,1,0,0,0,1,0,0,0,1,1,0,0 }, { 0,1,1,0,0,1,1,0,0,1,1,0,0,1,1,0 }, { 0,0,1,1,0,1,1,0,0,1,1,0,1,1,0,0 },
+	{ 0,0,0,1,0,1,1,1,1,1,1,0,1,0,0,0 }, { 0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0 }, { 0,1,1,1,0,0,0,1,1,0,0,0,1,1,1,0 }, { 0,0,1,1,1,0,0,1,1,0,0,1,1,1,0,0 },
+	{ 0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1 }, { 0,0,0,0,1,1,1,1,0,0,0,0,1,1,1,1 }, { 0,1,0,1,1,0,1,0,0,1,0,1,1,0,1,0 }, { 0,0,1,1,0,0,1,1,1,1,0,0,1,1,0,0 },
+	{ 0,0,1,1,1,1,0,0,0,0,1,1,1,1,0,0 }, { 0,1,0,1,0,1,0,1,1,0,1,0,1,0,1,0 }, { 0,1,1,0,1,0,0,1,0,1,1,0,1,0,0,1 }, { 0,1,0,1,1,0,1,0,1,0,1,0,0,1,0,1 },
+	{ 0,1,1,1,0,0,1,1,1,1,0,0,1,1,1,0 }, { 0,0,0,1,0,0,1,1,1,1,0,0,1,0,0,0 }, { 0,0,1,1,0,0,1,0,0,1,0,0,1,1,0,0 }, { 0,0,1,1,1,0,1,1,1,1,0,1,1,1,0,0 },
+	{ 0,1,1,0,1,0,0,1,1,0,0,1,0,1,1,0 }, { 0,0,1,1,1,1,0,0,1,1,0,0,0,0,1,1 }, { 0,1,1,0,0,1,1,0,1,0,0,1,1,0,0,1 }, { 0,0,0,0,0,1,1,0,0,1,1,0,0,0,0,0 },
+	{ 0,1,0,0,1,1,1,0,0,1,0,0,0,0,0,0 }, { 0,0,1,0,0,1,1,1,0,0,1,0,0,0,0,0 }, { 0,0,0,0,0,0,1,0,0,1,1,1,0,0,1,0 }, { 0,0,0,0,0,1,0,0,1,1,1,0,0,1,0,0 },
+	{ 0,1,1,0,1,1,0,0,1,0,0,1,0,0,1,1 }, { 0,0,1,1,0,1,1,0,1,1,0,0,1,0,0,1 }, { 0,1,1,0,0,0,1,1,1,0,0,1,1,1,0,0 }, { 0,0,1,1,1,0,0,1,1,1,0,0,0,1,1,0 },
+	{ 0,1,1,0,1,1,0,0,1,1,0,0,1,0,0,1 }, { 0,1,1,0,0,0,1,1,0,0,1,1,1,0,0,1 }, { 0,1,1,1,1,1,1,0,1,0,0,0,0,0,0,1 }, { 0,0,0,1,1,0,0,0,1,1,1,0,0,1,1,1 },
+	{ 0,0,0,0,1,1,1,1,0,0,1,1,0,0,1,1 }, { 0,0,1,1,0,0,1,1,1,1,1,1,0,0,0,0 }, { 0,0,1,0,0,0,1,0,1,1,1,0,1,1,1,0 }, { 0,1,0,0,0,1,0,0,0,1,1,1,0,1,1,1 }
+};
+
+static const uint8_t BC7_PARTITIONS_3[64][16] =
+{
+	{ 0,0,1,1,0,0,1,1,0,2,2,1,2,2,2,2 }, { 0,0,0,1,0,0,1,1,2,2,1,1,2,2,2,1 }, { 0,0,0,0,2,0,0,1,2,2,1,1,2,2,1,1 }, { 0,2,2,2,0,0,2,2,0,0,1,1,0,1,1,1 },
+	{ 0,0,0,0,0,0,0,0,1,1,2,2,1,1,2,2 }, { 0,0,1,1,0,0,1,1,0,0,2,2,0,0,2,2 }, { 0,0,2,2,0,0,2,2,1,1,1,1,1,1,1,1 }, { 0,0,1,1,0,0,1,1,2,2,1,1,2,2,1,1 },
+	{ 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2 }, { 0,0,0,0,1,1,1,1,1,1,1,1,2,2,2,2 }, { 0,0,0,0,1,1,1,1,2,2,2,2,2,2,2,2 }, { 0,0,1,2,0,0,1,2,0,0,1,2,0,0,1,2 },
+	{ 0,1,1,2,0,1,1,2,0,1,1,2,0,1,1,2 }, { 0,1,2,2,0,1,2,2,0,1,2,2,0,1,2,2 }, { 0,0,1,1,0,1,1,2,1,1,2,2,1,2,2,2 }, { 0,0,1,1,2,0,0,1,2,2,0,0,2,2,2,0 },
+	{ 0,0,0,1,0,0,1,1,0,1,1,2,1,1,2,2 }, { 0,1,1,1,0,0,1,1,2,0,0,1,2,2,0,0 }, { 0,0,0,0,1,1,2,2,1,1,2,2,1,1,2,2 }, { 0,0,2,2,0,0,2,2,0,0,2,2,1,1,1,1 },
+	{ 0,1,1,1,0,1,1,1,0,2,2,2,0,2,2,2 }, { 0,0,0,1,0,0,0,1,2,2,2,1,2,2,2,1 }, { 0,0,0,0,0,0,1,1,0,1,2,2,0,1,2,2 }, { 0,0,0,0,1,1,0,0,2,2,1,0,2,2,1,0 },
+	{ 0,1,2,2,0,1,2,2,0,0,1,1,0,0,0,0 }, { 0,0,1,2,0,0,1,2,1,1,2,2,2,2,2,2 }, { 0,1,1,0,1,2,2,1,1,2,2,1,0,1,1,0 }, { 0,0,0,0,0,1,1,0,1,2,2,1,1,2,2,1 },
+	{ 0,0,2,2,1,1,0,2,1,1,0,2,0,0,2,2 }, { 0,1,1,0,0,1,1,0,2,0,0,2,2,2,2,2 }, { 0,0,1,1,0,1,2,2,0,1,2,2,0,0,1,1 }, { 0,0,0,0,2,0,0,0,2,2,1,1,2,2,2,1 },
+	{ 0,0,0,0,0,0,0,2,1,1,2,2,1,2,2,2 }, { 0,2,2,2,0,0,2,2,0,0,1,2,0,0,1,1 }, { 0,0,1,1,0,0,1,2,0,0,2,2,0,2,2,2 }, { 0,1,2,0,0,1,2,0,0,1,2,0,0,1,2,0 },
+	{ 0,0,0,0,1,1,1,1,2,2,2,2,0,0,0,0 }, { 0,1,2,0,1,2,0,1,2,0,1,2,0,1,2,0 }, { 0,1,2,0,2,0,1,2,1,2,0,1,0,1,2,0 }, { 0,0,1,1,2,2,0,0,1,1,2,2,0,0,1,1 },
+	{ 0,0,1,1,1,1,2,2,2,2,0,0,0,0,1,1 }, { 0,1,0,1,0,1,0,1,2,2,2,2,2,2,2,2 }, { 0,0,0,0,0,0,0,0,2,1,2,1,2,1,2,1 }, { 0,0,2,2,1,1,2,2,0,0,2,2,1,1,2,2 },
+	{ 0,0,2,2,0,0,1,1,0,0,2,2,0,0,1,1 }, { 0,2,2,0,1,2,2,1,0,2,2,0,1,2,2,1 }, { 0,1,0,1,2,2,2,2,2,2,2,2,0,1,0,1 }, { 0,0,0,0,2,1,2,1,2,1,2,1,2,1,2,1 },
+	{ 0,1,0,1,0,1,0,1,0,1,0,1,2,2,2,2 }, { 0,2,2,2,0,1,1,1,0,2,2,2,0,1,1,1 }, { 0,0,0,2,1,1,1,2,0,0,0,2,1,1,1,2 }, { 0,0,0,0,2,1,1,2,2,1,1,2,2,1,1,2 },
+	{ 0,2,2,2,0,1,1,1,0,1,1,1,0,2,2,2 }, { 0,0,0,2,1,1,1,2,1,1,1,2,0,0,0,2 }, { 0,1,1,0,0,1,1,0,0,1,1,0,2,2,2,2 }, { 0,0,0,0,0,0,0,0,2,1,1,2,2,1,1,2 },
+	{ 0,1,1,0,0,1,1,0,2,2,2,2,2,2,2,2 }, { 0,0,2,2,0,0,1,1,0,0,1,1,0,0,2,2 }, { 0,0,2,2,1,1,2,2,1,1,2,2,0,0,2,2 }, { 0,0,0,0,0,0,0,0,0,0,0,0,2,1,1,2 },
+	{ 0,0,0,2,0,0,0,1,0,0,0,2,0,0,0,1 }, { 0,2,2,2,1,2,2,2,0,2,2,2,1,2,2,2 }, { 0,1,0,1,2,2,2,2,2,2,2,2,2,2,2,2 }, { 0,1,1,1,2,0,1,1,2,2,0,1,2,2,2,0 }
+};
+
+//Texel whose index drops its top bit, per subset after the first (texel 0 always anchors subset 0)
+static const uint8_t BC7_ANCHORS_2[64] =
+{
+	15,15,15,15,15,15,15,15, 15,15,15,15,15,15,15,15, 15, 2, 8, 2, 2, 8, 8,15,  2, 8, 2, 2, 8, 8, 2, 2,
+	15,15, 6, 8, 2, 8,15,15,  2, 8, 2, 2, 2,15,15, 6,  6, 2, 6, 8,15,15, 2, 2, 15,15,15,15,15, 2, 2,15
+};
+
+static const uint8_t BC7_ANCHORS_3_SECOND[64] =
+{
+	 3, 3,15,15, 8, 3,15,15,  8, 8, 6, 6, 6, 5, 3, 3,  3, 3, 8,15, 3, 3, 6,10,  5, 8, 8, 6, 8, 5,15,15,
+	 8,15, 3, 5, 6,10, 8,15, 15, 3,15, 5,15,15,15,15,  3,15, 5, 5, 5, 8, 5,10,  5,10, 8,13,15,12, 3, 3
+};
+
+static const uint8_t BC7_ANCHORS_3_THIRD[64] =
+{
+	15, 8, 8, 3,15,15, 3, 8, 15,15,15,15,15,15,15, 8, 15, 8,15, 3,15, 8,15, 8,  3,15, 6,10,15,15,10, 8,
+	15, 3,15,10,10, 8, 9,10,  6,15, 8,15, 3, 6, 6, 8, 15, 3,15,15,15,15,15,15, 15,15,15,15, 3,15,15, 8
+};
+
+static const uint8_t BC7_WEIGHTS_2[4]  = { 0, 21, 43, 64 };
+static const uint8_t BC7_WEIGHTS_3[8]  = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const uint8_t BC7_WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct Bc7Mode
+{
+	uint8_t subsetCount;
+	uint8_t partitionBits;
+	uint8_t rotationBits;
+	uint8_t indexSelectionBits;
+	uint8_t colorBits;
+	uint8_t alphaBits;
+	uint8_t endpointPBits;	//One p-bit per endpoint
+	uint8_t sharedPBits;	//One p-bit per subset
+	uint8_t indexBits;
+	uint8_t secondaryIndexBits;
+};
+
+static const Bc7Mode BC7_MODES[8] =
+{
+	{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+	{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+	{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+	{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+	{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+	{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+	{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+	{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+};
+#pragma endregion BC7 tables
+
+//LSB first, the order every BC7 field is stored in
+class BitReader
+{
+private:
+	const uint8_t*	mData;
+	uint32_t		mPosition = 0;
+
+public:
+	explicit BitReader(const uint8_t* p_data) : mData(p_data) {}
+
+	uint32_t Read(uint32_t p_bitCount)
+	{
+		uint32_t value = 0;
+
+		for (uint32_t i = 0; i < p_bitCount; i++, this->mPosition++)
+			value |= uint32_t((this->mData[this->mPosition >> 3] >> (this->mPosition & 7)) & 1) << i;
+
+		return value;
+	}
+};
+
+static inline uint8_t Interpolate(uint32_t p_e0, uint32_t p_e1, uint32_t p_weight)
+{
+	return uint8_t(((64 - p_weight) * p_e0 + p_weight * p_e1 + 32) >> 6);
+}
+
+static inline uint8_t ExpandBits(uint32_t p_value, uint32_t p_bitCount)
+{
+	p_value <<= 8 - p_bitCount;
+
+	return uint8_t(p_value | (p_value >> p_bitCount));
+}
+
+static void DecodeBc7(const uint8_t* p_block, uint8_t p_texels[64])
+{
+	uint32_t mode = 0;
+
+	while (mode < 8 && !((p_block[0] >> mode) & 1))
+		mode++;
+
+	//Reserved mode : transparent black
+	if (mode == 8)
+	{
+		memset(p_texels, 0, 64);
+		return;
+	}
+
+	const Bc7Mode& info = BC7_MODES[mode];
+
+	BitReader reader(p_block);
+	reader.Read(mode + 1);
+
+	uint32_t partition		= reader.Read(info.partitionBits);
+	uint32_t rotation		= reader.Read(info.rotationBits);
+	uint32_t indexSelection	= reader.Read(info.indexSelectionBits);
+
+	uint32_t endpoints[3][2][4] = {}; //Subset, endpoint, channel
+
+	for (uint32_t channel = 0; channel < 3; channel++)
+	{
+		for (uint32_t subset = 0; subset < info.subsetCount; subset++)
+		{
+			endpoints[subset][0][channel] = reader.Read(info.colorBits);
+			endpoints[subset][1][channel] = reader.Read(info.colorBits);
+		}
+	}
+
+	for (uint32_t subset = 0; subset < info.subsetCount; subset++)
+	{
+		endpoints[subset][0][3] = info.alphaBits ? reader.Read(info.alphaBits) : 255;
+		endpoints[subset][1][3] = info.alphaBits ? reader.Read(info.alphaBits) : 255;
+	}
+
+	uint32_t colorBits = info.colorBits;
+	uint32_t alphaBits = info.alphaBits;
+
+	if (info.endpointPBits || info.sharedPBits)
+	{
+		for (uint32_t subset = 0; subset < info.subsetCount; subset++)
+		{
+			uint32_t sharedPBit = info.sharedPBits ? reader.Read(1) : 0;
+
+			for (uint32_t endpoint = 0; endpoint < 2; endpoint++)
+			{
+				uint32_t pBit = info.endpointPBits ? reader.Read(1) : sharedPBit;
+
+				for (uint32_t channel = 0; channel < 3; channel++)
+					endpoints[subset][endpoint][channel] = (endpoints[subset][endpoint][channel] << 1) | pBit;
+
+				if (alphaBits)
+					endpoints[subset][endpoint][3] = (endpoints[subset][endpoint][3] << 1) | pBit;
+			}
+		}
+
+		colorBits++;
+
+		if (alphaBits)
+			alphaBits++;
+	}
+
+	for (uint32_t subset = 0; subset < info.subsetCount; subset++)
+	{
+		for (uint32_t endpoint = 0; endpoint < 2; endpoint++)
+		{
+			for (uint32_t channel = 0; channel < 3; channel++)
+				endpoints[subset][endpoint][channel] = ExpandBits(endpoints[subset][endpoint][channel], colorBits);
+
+			if (alphaBits)
+				endpoints[subset][endpoint][3] = ExpandBits(endpoints[subset][endpoint][3], alphaBits);
+		}
+	}
+
+	const uint8_t* subsets = info.subsetCount == 2 ? BC7_PARTITIONS_2[partition] : info.subsetCount == 3 ? BC7_PARTITIONS_3[partition] : nullptr;
+
+	auto isAnchor = [&](uint32_t p_texel)
+	{
+		if (p_texel == 0)
+			return true;
+
+		if (info.subsetCount == 2)
+			return p_texel == BC7_ANCHORS_2[partition];
+
+		if (info.subsetCount == 3)
+			return p_texel == BC7_ANCHORS_3_SECOND[partition] || p_texel == BC7_ANCHORS_3_THIRD[partition];
+
+		return false;
+	};
+
+	uint32_t indices[16];
+	uint32_t secondaryIndices[16] = {};
+
+	for (uint32_t texel = 0; texel < 16; texel++)
+		indices[texel] = reader.Read(info.indexBits - (isAnchor(texel) ? 1 : 0));
+
+	if (info.secondaryIndexBits)
+	{
+		for (uint32_t texel = 0; texel < 16; texel++)
+			secondaryIndices[texel] = reader.Read(info.secondaryIndexBits - (texel == 0 ? 1 : 0));
+	}
+
+	auto getWeights = [](uint32_t p_bitCount) { return p_bitCount == 2 ? BC7_WEIGHTS_2 : p_bitCount == 3 ? BC7_WEIGHTS_3 : BC7_WEIGHTS_4; };
+
+	//Mode 4 can swap which index set drives color and alpha
+	const uint8_t* colorWeights = getWeights(indexSelection ? info.secondaryIndexBits : info.indexBits);
+	const uint8_t* alphaWeights = getWeights(info.secondaryIndexBits ? (indexSelection ? info.indexBits : info.secondaryIndexBits) : info.indexBits);
+
+	for (uint32_t texel = 0; texel < 16; texel++)
+	{
+		uint32_t subset			= subsets ? subsets[texel] : 0;
+		uint32_t colorIndex		= indexSelection ? secondaryIndices[texel] : indices[texel];
+		uint32_t alphaIndex		= info.secondaryIndexBits ? (indexSelection ? indices[texel] : secondaryIndices[texel]) : indices[texel];
+
+		const uint32_t* e0 = endpoints[subset][0];
+		const uint32_t* e1 = endpoints[subset][1];
+
+		uint8_t* out = p_texels + texel * 4;
+
+		for (uint32_t channel = 0; channel < 3; channel++)
+			out[channel] = Interpolate(e0[channel], e1[channel], colorWeights[colorIndex]);
+
+		out[3] = info.alphaBits ? Interpolate(e0[3], e1[3], alphaWeights[alphaIndex]) : 255;
+
+		if (rotation)
+			std::swap(out[3], out[rotation - 1]);
+	}
+}
+
+static inline void Expand565(uint16_t p_color, uint8_t p_rgb[3])
+{
+	uint32_t r = (p_color >> 11) & 31;
+	uint32_t g = (p_color >> 5) & 63;
+	uint32_t b = p_color & 31;
+
+	p_rgb[0] = uint8_t((r << 3) | (r >> 2));
+	p_rgb[1] = uint8_t((g << 2) | (g >> 4));
+	p_rgb[2] = uint8_t((b << 3) | (b >> 2));
+}
+
+//Color half of BC1/BC3, p_alwaysFourColors for BC3 where the 3 colors mode doesn't exist
+static void DecodeBc1(const uint8_t* p_block, uint8_t p_texels[64], bool p_alwaysFourColors, bool p_punchThroughAlpha)
+{
+	uint16_t c0 = uint16_t(p_block[0] | (p_block[1] << 8));
+	uint16_t c1 = uint16_t(p_block[2] | (p_block[3] << 8));
+
+	uint8_t palette[4][4];
+
+	Expand565(c0, palette[0]);
+	Expand565(c1, palette[1]);
+
+	palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+
+	for (int channel = 0; channel < 3; channel++)
+	{
+		uint32_t a = palette[0][channel];
+		uint32_t b = palette[1][channel];
+
+		if (c0 > c1 || p_alwaysFourColors)
+		{
+			palette[2][channel] = uint8_t((2 * a + b + 1) / 3);
+			palette[3][channel] = uint8_t((a + 2 * b + 1) / 3);
+		}
+		else
+		{
+			palette[2][channel] = uint8_t((a + b + 1) / 2);
+			palette[3][channel] = 0;
+		}
+	}
+
+	if (c0 <= c1 && !p_alwaysFourColors && p_punchThroughAlpha)
+		palette[3][3] = 0;
+
+	uint32_t indices = uint32_t(p_block[4] | (p_block[5] << 8) | (p_block[6] << 16) | (uint32_t(p_block[7]) << 24));
+
+	for (uint32_t texel = 0; texel < 16; texel++)
+		memcpy(p_texels + texel * 4, palette[(indices >> (texel * 2)) & 3], 4);
+}
+
+//BC4 block into one channel of the texels
+static void DecodeBc4(const uint8_t* p_block, uint8_t p_texels[64], uint32_t p_channel)
+{
+	uint32_t a0 = p_block[0];
+	uint32_t a1 = p_block[1];
+
+	uint8_t palette[8];
+
+	palette[0] = uint8_t(a0);
+	palette[1] = uint8_t(a1);
+
+	if (a0 > a1)
+	{
+		for (uint32_t i = 1; i < 7; i++)
+			palette[i + 1] = uint8_t(((7 - i) * a0 + i * a1 + 3) / 7);
+	}
+	else
+	{
+		for (uint32_t i = 1; i < 5; i++)
+			palette[i + 1] = uint8_t(((5 - i) * a0 + i * a1 + 2) / 5);
+
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+
+	uint64_t indices = 0;
+
+	for (int i = 0; i < 6; i++)
+		indices |= uint64_t(p_block[2 + i]) << (i * 8);
+
+	for (uint32_t texel = 0; texel < 16; texel++)
+		p_texels[texel * 4 + p_channel] = palette[(indices >> (texel * 3)) & 7];
+}
+
+bool BlockDecoder::CanDecode(VkFormat p_format)
+{
+	switch (p_format)
+	{
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+	case VK_FORMAT_BC4_UNORM_BLOCK:
+	case VK_FORMAT_BC5_UNORM_BLOCK:
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		return true;
+	default:
+		return false;
+	}
+}
+
+VkFormat BlockDecoder::GetDecodedFormat(VkFormat p_format)
+{
+	switch (p_format)
+	{
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		return VK_FORMAT_R8G8B8A8_SRGB;
+	default:
+		return VK_FORMAT_R8G8B8A8_UNORM;
+	}
+}
+
+void BlockDecoder::DecodeBlock(VkFormat p_format, const uint8_t* p_block, uint8_t p_texels[64])
+{
+	switch (p_format)
+	{
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		DecodeBc1(p_block, p_texels, false, false);
+		break;
+	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		DecodeBc1(p_block, p_texels, false, true);
+		break;
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+		DecodeBc1(p_block + 8, p_texels, true, false);
+		DecodeBc4(p_block, p_texels, 3);
+		break;
+	case VK_FORMAT_BC4_UNORM_BLOCK:
+		memset(p_texels, 0, 64);
+		DecodeBc4(p_block, p_texels, 0);
+		for (uint32_t texel = 0; texel < 16; texel++)
+			p_texels[texel * 4 + 3] = 255;
+		break;
+	case VK_FORMAT_BC5_UNORM_BLOCK:
+		memset(p_texels, 0, 64);
+		DecodeBc4(p_block, p_texels, 0);
+		DecodeBc4(p_block + 8, p_texels, 1);
+		for (uint32_t texel = 0; texel < 16; texel++)
+			p_texels[texel * 4 + 3] = 255;
+		break;
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		DecodeBc7(p_block, p_texels);
+		break;
+	default:
+		memset(p_texels, 0, 64);
+		break;
+	}
+}
+
+void BlockDecoder::Decode(VkFormat p_format, const uint8_t* p_blocks, uint32_t p_width, uint32_t p_height, uint8_t* p_rgba)
+{
+	bool		isHalfBlock = p_format == VK_FORMAT_BC1_RGB_UNORM_BLOCK || p_format == VK_FORMAT_BC1_RGB_SRGB_BLOCK || p_format == VK_FORMAT_BC1_RGBA_UNORM_BLOCK || p_format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK || p_format == VK_FORMAT_BC4_UNORM_BLOCK;
+	uint32_t	blockSize	= isHalfBlock ? 8 : 16;
+
+	uint32_t blocksX = (p_width + 3) / 4;
+	uint32_t blocksY = (p_height + 3) / 4;
+
+	uint8_t texels[64];
+
+	for (uint32_t blockY = 0; blockY < blocksY; blockY++)
+	{
+		for (uint32_t blockX = 0; blockX < blocksX; blockX++)
+		{
+			DecodeBlock(p_format, p_blocks + (size_t(blockY) * blocksX + blockX) * blockSize, texels);
+
+			//Edge blocks cover texels past the image, drop them
+			uint32_t rowCount	= std::min(4u, p_height - blockY * 4);
+			uint32_t rowSize	= std::min(4u, p_width - blockX * 4) * 4;
+
+			for (uint32_t row = 0; row < rowCount; row++)
+				memcpy(p_rgba + ((size_t(blockY) * 4 + row) * p_width + blockX * 4) * 4, texels + row * 16, rowSize);
+		}
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+#include "vulkan/vulkan.h"
+
+//
+//CPU decoding of BCn blocks to RGBA8, the transcoding fallback for devices that can't sample a compressed format.
+//Bit exact with the D3D/Vulkan decoding rules (BC1-3 interpolation may differ by one from some hardware).
+//
+class BlockDecoder
+{
+public:
+	//BC1, BC3, BC4, BC5 and BC7, UNORM or SRGB
+	static bool CanDecode(VkFormat p_format);
+
+	//RGBA8 format the decoded texels are uploaded as, keeps the sRGB encoding of the source
+	static VkFormat GetDecodedFormat(VkFormat p_format);
+
+	//One 4x4 block, texels in row order
+	static void DecodeBlock(VkFormat p_format, const uint8_t* p_block, uint8_t p_texels[64]);
+
+	//A whole level, p_rgba receives p_width * p_height * 4 bytes
+	static void Decode(VkFormat p_format, const uint8_t* p_blocks, uint32_t p_width, uint32_t p_height, uint8_t* p_rgba);
+};
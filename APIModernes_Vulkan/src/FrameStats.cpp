@@ -0,0 +1,68 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+//Average, 99th percentile and worst of one field, skipping the negative (unknown) values
+static void PrintTimings(const char* p_name, const std::vector<FrameTiming>& p_timings, float FrameTiming::* p_field)
+{
+	std::vector<float> values;
+
+	values.reserve(p_timings.size());
+
+	for (const FrameTiming& timing : p_timings)
+	{
+		if (timing.*p_field >= 0.0f)
+			values.push_back(timing.*p_field);
+	}
+
+	if (values.empty())
+		return;
+
+	std::sort(values.begin(), values.end());
+
+	float sum = 0.0f;
+
+	for (float value : values)
+		sum += value;
+
+	size_t percentile = std::min(values.size() - 1, values.size() * 99 / 100);
+
+	std::cout << "\t" << std::left << std::setw(17) << p_name << std::right << std::fixed << std::setprecision(2)
+			  << sum / values.size() << " avg " << values[percentile] << " p99 " << values.back() << " max" << std::endl;
+}
+
+void FrameStats::Init(const std::string& p_label, uint32_t p_interval)
+{
+	this->mLabel	= p_label;
+	this->mInterval = p_interval;
+
+	this->mTimings.clear();
+	this->mTimings.reserve(p_interval);
+}
+
+void FrameStats::Add(const FrameTiming& p_timing)
+{
+	if (this->mInterval == 0)
+		return;
+
+	this->mTimings.push_back(p_timing);
+
+	if (this->mTimings.size() < this->mInterval)
+		return;
+
+	std::ios::fmtflags flags = std::cout.flags();
+
+	std::cout << "[FrameStats] " << this->mLabel << ", last " << this->mInterval << " frames (ms) :" << std::endl;
+
+	PrintTimings("frame", this->mTimings, &FrameTiming::frame);
+	PrintTimings("fence wait", this->mTimings, &FrameTiming::fenceWait);
+	PrintTimings("acquire", this->mTimings, &FrameTiming::acquire);
+	PrintTimings("input to submit", this->mTimings, &FrameTiming::inputToSubmit);
+	PrintTimings("gpu", this->mTimings, &FrameTiming::gpu);
+
+	std::cout.flags(flags);
+
+	this->mTimings.clear();
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//Where one frame's time went, in milliseconds
+struct FrameTiming
+{
+	float frame			= 0.0f;		//Since the previous frame started, negative for the first one
+	float fenceWait		= 0.0f;		//Blocked on the frame in flight about to be reused
+	float acquire		= 0.0f;		//Blocked in vkAcquireNextImageKHR
+	float inputToSubmit = 0.0f;		//From the input poll to the queue submit : how old the input already is when the GPU gets it
+	float gpu			= -1.0f;	//Between the first and last command of the frame, negative when there's no timestamp
+};
+
+//
+//Collects the frame timings and prints their average, 99th percentile and worst every interval frames, what frames in
+//flight, present mode and waiting before input change shows up here. The GPU time of a frame is only known once its
+//fence is signaled, it's added with the frame that reuses its slot, which only shifts it in the report.
+//Negative values are unknown and left out
+//
+class FrameStats
+{
+private:
+	std::string					mLabel;
+	uint32_t					mInterval = 0;
+	std::vector<FrameTiming>	mTimings;
+
+public:
+	//p_interval = 0 : nothing is collected
+	void Init(const std::string& p_label, uint32_t p_interval);
+
+	bool IsEnabled() const { return this->mInterval != 0; }
+
+	//Prints and starts over once interval timings are in
+	void Add(const FrameTiming& p_timing);
+};
@@ -11,4 +11,16 @@ public:
 	virtual bool Init(Window* p_window);
 	virtual void Release() = 0;
 	virtual void Render()  = 0;
+
+	//Blocks until the next frame can be recorded, Render() doesn't wait again afterwards
+	virtual void WaitForFrame() {}
+
+	//Everything the frame shows is loaded, or failed to
+	virtual bool IsReady() const { return true; }
+
+	//Writes the last rendered frame, headless renderers only
+	virtual bool SaveFrame(const char* /*p_filePath*/) { return false; }
+
+	//Switches the model between its textured only and vertex colored shader permutations
+	virtual void ToggleVertexColor() {}
 };
\ No newline at end of file
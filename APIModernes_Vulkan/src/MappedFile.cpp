@@ -0,0 +1,139 @@
+#include "MappedFile.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	this->Close();
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const char* p_filePath)
+{
+	this->Close();
+
+	HANDLE file = CreateFileA(p_filePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (!mapping)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	this->mData			 = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	this->mSize			 = (size_t)size.QuadPart;
+	this->mFileHandle	 = file;
+	this->mMappingHandle = mapping;
+
+	if (!this->mData)
+		this->Close();
+
+	return this->IsOpen();
+}
+
+void MappedFile::Close()
+{
+	if (this->mData)
+		UnmapViewOfFile(this->mData);
+
+	if (this->mMappingHandle)
+		CloseHandle(this->mMappingHandle);
+
+	if (this->mFileHandle)
+		CloseHandle(this->mFileHandle);
+
+	this->mData			 = nullptr;
+	this->mSize			 = 0;
+	this->mFileHandle	 = nullptr;
+	this->mMappingHandle = nullptr;
+}
+
+bool MappedFile::GetFileInfo(const char* p_filePath, int64_t& p_modificationTime, uint64_t& p_size)
+{
+	struct _stat64 fileStat;
+
+	if (_stat64(p_filePath, &fileStat) != 0)
+		return false;
+
+	p_modificationTime	= (int64_t)fileStat.st_mtime;
+	p_size				= (uint64_t)fileStat.st_size;
+
+	return true;
+}
+#else
+bool MappedFile::Open(const char* p_filePath)
+{
+	this->Close();
+
+	int file = open(p_filePath, O_RDONLY);
+
+	if (file < 0)
+		return false;
+
+	struct stat fileStat;
+
+	if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		close(file);
+		return false;
+	}
+
+	void* data = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+	close(file); //The mapping keeps the file alive
+
+	if (data == MAP_FAILED)
+		return false;
+
+	this->mData = data;
+	this->mSize = (size_t)fileStat.st_size;
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (this->mData)
+		munmap((void*)this->mData, this->mSize);
+
+	this->mData = nullptr;
+	this->mSize = 0;
+}
+
+bool MappedFile::GetFileInfo(const char* p_filePath, int64_t& p_modificationTime, uint64_t& p_size)
+{
+	struct stat fileStat;
+
+	if (stat(p_filePath, &fileStat) != 0)
+		return false;
+
+	p_modificationTime	= (int64_t)fileStat.st_mtime;
+	p_size				= (uint64_t)fileStat.st_size;
+
+	return true;
+}
+#endif
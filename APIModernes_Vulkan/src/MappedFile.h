@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+//
+//Read only view of a whole file, the OS pages it in on demand instead of copying it through a stream.
+//
+class MappedFile
+{
+private:
+	const void* mData = nullptr;
+	size_t		mSize = 0;
+
+#ifdef _WIN32
+	void*		mFileHandle		= nullptr;
+	void*		mMappingHandle	= nullptr;
+#endif
+
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const char* p_filePath);
+	void Close();
+
+	bool		IsOpen()  const { return this->mData != nullptr; }
+	const void* GetData() const { return this->mData; }
+	size_t		GetSize() const { return this->mSize; }
+
+	//Last write time in seconds and size, false if the file doesn't exist
+	static bool GetFileInfo(const char* p_filePath, int64_t& p_modificationTime, uint64_t& p_size);
+};
@@ -0,0 +1,192 @@
+#include "MeshCache.h"
+
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+static inline uint64_t AlignBlob(uint64_t p_offset)
+{
+	return (p_offset + 15) & ~15ull;
+}
+
+std::string MeshCache::GetCachePath(const char* p_sourcePath)
+{
+	return std::string(p_sourcePath) + ".meshcache";
+}
+
+bool MeshCache::HashFile(const char* p_filePath, uint64_t& p_hash)
+{
+	MappedFile file;
+
+	if (!file.Open(p_filePath))
+		return false;
+
+	p_hash = HashBytes(file.GetData(), file.GetSize());
+
+	return true;
+}
+
+MeshBounds MeshCache::ComputeBounds(const Vertex* p_vertices, uint32_t p_vertexCount)
+{
+	MeshBounds bounds;
+
+	for (uint32_t i = 0; i < p_vertexCount; i++)
+	{
+		bounds.min = glm::min(bounds.min, p_vertices[i].pos);
+		bounds.max = glm::max(bounds.max, p_vertices[i].pos);
+	}
+
+	return bounds;
+}
+
+bool MeshCache::IsUpToDate(const char* p_sourcePath, const std::string& p_cachePath, VertexFormat p_vertexFormat)
+{
+	FileHeader header;
+
+	std::ifstream file = std::ifstream(p_cachePath, std::ios::binary);
+
+	if (!file.read((char*)&header, sizeof(header)))
+		return false;
+
+	file.close();
+
+	if (header.magic != MAGIC || header.version != VERSION)
+		return false;
+
+	if (header.vertexFormat != (uint32_t)p_vertexFormat || header.vertexStride != GetVertexStride(p_vertexFormat))
+		return false;
+
+	if (header.pathHash != HashBytes(p_sourcePath, strlen(p_sourcePath)))
+		return false;
+
+	int64_t	 modificationTime	= 0;
+	uint64_t size				= 0;
+
+	//Shipped without its source : trust the cache
+	if (!MappedFile::GetFileInfo(p_sourcePath, modificationTime, size))
+		return true;
+
+	if (header.sourceModificationTime == modificationTime && header.sourceSize == size)
+		return true;
+
+	uint64_t hash = 0;
+
+	if (header.sourceSize != size || !HashFile(p_sourcePath, hash) || header.sourceHash != hash)
+		return false;
+
+	//Touched but not modified (checkout, copy...), remember the new time so we don't hash it again
+	header.sourceModificationTime = modificationTime;
+
+	std::fstream patch = std::fstream(p_cachePath, std::ios::in | std::ios::out | std::ios::binary);
+
+	if (patch.is_open())
+		patch.write((const char*)&header, sizeof(header));
+
+	return true;
+}
+
+bool MeshCache::Open(const char* p_sourcePath, VertexFormat p_vertexFormat)
+{
+	this->Close();
+
+	std::string cachePath = GetCachePath(p_sourcePath);
+
+	if (!this->IsUpToDate(p_sourcePath, cachePath, p_vertexFormat) || !this->mFile.Open(cachePath.c_str()))
+		return false;
+
+	const char*		  data	 = (const char*)this->mFile.GetData();
+	const FileHeader* header = (const FileHeader*)data;
+
+	uint64_t vertexBytes = header->vertexCount * header->vertexStride;
+	uint64_t indexBytes	 = header->indexCount * header->indexSize;
+	uint64_t subMeshBytes = header->subMeshCount * sizeof(SubMesh);
+
+	bool isValid = this->mFile.GetSize() >= sizeof(FileHeader)
+		&& (header->indexSize == 2 || header->indexSize == 4)
+		&& header->vertexCount <= UINT32_MAX && header->indexCount <= UINT32_MAX
+		&& header->vertexOffset + vertexBytes <= this->mFile.GetSize()
+		&& header->indexOffset + indexBytes <= this->mFile.GetSize()
+		&& header->subMeshCount > 0 && header->subMeshOffset + subMeshBytes <= this->mFile.GetSize();
+
+	if (!isValid)
+	{
+		this->Close();
+		return false;
+	}
+
+	this->mView.vertices	 = data + header->vertexOffset;
+	this->mView.vertexCount	 = (uint32_t)header->vertexCount;
+	this->mView.vertexFormat = p_vertexFormat;
+	this->mView.indices		= data + header->indexOffset;
+	this->mView.indexCount	= (uint32_t)header->indexCount;
+	this->mView.indexSize	= header->indexSize;
+	this->mView.subMeshes	 = (const SubMesh*)(data + header->subMeshOffset);
+	this->mView.subMeshCount = (uint32_t)header->subMeshCount;
+	this->mView.bounds.min	= glm::vec3(header->boundsMin[0], header->boundsMin[1], header->boundsMin[2]);
+	this->mView.bounds.max	= glm::vec3(header->boundsMax[0], header->boundsMax[1], header->boundsMax[2]);
+
+	return true;
+}
+
+void MeshCache::Close()
+{
+	this->mFile.Close();
+	this->mView = MeshView();
+}
+
+bool MeshCache::Write(const char* p_sourcePath, const MeshView& p_mesh)
+{
+	FileHeader header{};
+
+	header.magic		= MAGIC;
+	header.version		= VERSION;
+	header.pathHash		= HashBytes(p_sourcePath, strlen(p_sourcePath));
+	header.vertexFormat = (uint32_t)p_mesh.vertexFormat;
+	header.vertexStride = GetVertexStride(p_mesh.vertexFormat);
+	header.indexSize	= p_mesh.indexSize;
+	header.vertexCount	= p_mesh.vertexCount;
+	header.indexCount	= p_mesh.indexCount;
+	header.vertexOffset = AlignBlob(sizeof(FileHeader));
+	header.indexOffset	= AlignBlob(header.vertexOffset + header.vertexCount * header.vertexStride);
+	header.subMeshCount = p_mesh.subMeshCount;
+	header.subMeshOffset = AlignBlob(header.indexOffset + header.indexCount * header.indexSize);
+
+	if (!MappedFile::GetFileInfo(p_sourcePath, header.sourceModificationTime, header.sourceSize) || !HashFile(p_sourcePath, header.sourceHash))
+		return false;
+
+	memcpy(header.boundsMin, &p_mesh.bounds.min, sizeof(header.boundsMin));
+	memcpy(header.boundsMax, &p_mesh.bounds.max, sizeof(header.boundsMax));
+
+	std::string cachePath	= GetCachePath(p_sourcePath);
+	std::string tmpPath		= cachePath + ".tmp";
+
+	std::ofstream file = std::ofstream(tmpPath, std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+		return false;
+
+	const char padding[16] = {};
+
+	file.write((const char*)&header, sizeof(header));
+	file.write(padding, header.vertexOffset - sizeof(header));
+	file.write((const char*)p_mesh.vertices, header.vertexCount * header.vertexStride);
+	file.write(padding, header.indexOffset - (header.vertexOffset + header.vertexCount * header.vertexStride));
+	file.write((const char*)p_mesh.indices, header.indexCount * header.indexSize);
+	file.write(padding, header.subMeshOffset - (header.indexOffset + header.indexCount * header.indexSize));
+	file.write((const char*)p_mesh.subMeshes, header.subMeshCount * sizeof(SubMesh));
+	file.close();
+
+	if (file.fail())
+	{
+		std::remove(tmpPath.c_str());
+		return false;
+	}
+
+	if (!AtomicReplaceFile(tmpPath, cachePath))
+	{
+		std::remove(tmpPath.c_str());
+		return false;
+	}
+
+	return true;
+}
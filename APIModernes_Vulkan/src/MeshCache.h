@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <cfloat>
+#include <string>
+
+#include "Utils.h"
+#include "MappedFile.h"
+
+struct MeshBounds
+{
+	glm::vec3 min = glm::vec3( FLT_MAX);
+	glm::vec3 max = glm::vec3(-FLT_MAX);
+};
+
+//Range of the index buffer drawn with its own vertex offset
+struct SubMesh
+{
+	uint32_t	firstIndex;
+	uint32_t	indexCount;
+	int32_t		vertexOffset;
+};
+
+//Geometry ready to upload, points either into a mapped cache file or into vectors owned by the caller
+struct MeshView
+{
+	const void*		vertices	 = nullptr;
+	uint32_t		vertexCount	 = 0;
+	VertexFormat	vertexFormat = VertexFormat::Float32;
+	const void*		indices		= nullptr;
+	uint32_t		indexCount	= 0;
+	uint32_t		indexSize	= 0; //Bytes per index, 2 or 4
+	const SubMesh*	subMeshes	 = nullptr; //At least one, covering every index
+	uint32_t		subMeshCount = 0;
+	MeshBounds		bounds;
+};
+
+//
+//Binary copy of a deduplicated model stored next to its source (model.obj -> model.obj.meshcache).
+//Layout : FileHeader | vertex blob | index blob | sub-mesh blob, blobs are 16 bytes aligned so they can be uploaded straight from the mapping.
+//The cache is valid while the source path, modification time and size match. When only the time changed the content hash decides.
+//
+class MeshCache
+{
+private:
+	static constexpr uint32_t MAGIC		= 0x4D534843; //"MSHC"
+	static constexpr uint32_t VERSION	= 4;		  //Bump whenever Vertex, the layout or the mesh processing changes
+
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t pathHash;
+		int64_t	 sourceModificationTime;
+		uint64_t sourceSize;
+		uint64_t sourceHash;
+		uint32_t vertexFormat;
+		uint32_t vertexStride;
+		uint32_t indexSize;
+		uint64_t vertexCount;
+		uint64_t indexCount;
+		uint64_t vertexOffset;
+		uint64_t indexOffset;
+		uint64_t subMeshCount;
+		uint64_t subMeshOffset;
+		float	 boundsMin[3];
+		float	 boundsMax[3];
+	};
+
+	MappedFile	mFile;
+	MeshView	mView;
+
+private:
+	static bool HashFile(const char* p_filePath, uint64_t& p_hash);
+	bool IsUpToDate(const char* p_sourcePath, const std::string& p_cachePath, VertexFormat p_vertexFormat);
+
+public:
+	static std::string GetCachePath(const char* p_sourcePath);
+
+	//Maps the cache of p_sourcePath, false if it is missing, corrupted, stale or holds another vertex format
+	bool Open(const char* p_sourcePath, VertexFormat p_vertexFormat);
+	void Close();
+
+	//Only valid while the cache is open
+	const MeshView& GetView() const { return this->mView; }
+
+	//Written to a temporary file then renamed, a crash never leaves a half written cache behind
+	static bool Write(const char* p_sourcePath, const MeshView& p_mesh);
+
+	static MeshBounds ComputeBounds(const Vertex* p_vertices, uint32_t p_vertexCount);
+};
@@ -0,0 +1,114 @@
+#include "MeshIndexer.h"
+
+MeshView MeshData::GetView() const
+{
+	MeshView view;
+
+	if (!this->packedVertices.empty())
+	{
+		view.vertices		= this->packedVertices.data();
+		view.vertexCount	= (uint32_t)this->packedVertices.size();
+		view.vertexFormat	= VertexFormat::Packed16;
+	}
+	else
+	{
+		view.vertices		= this->vertices.data();
+		view.vertexCount	= (uint32_t)this->vertices.size();
+		view.vertexFormat	= VertexFormat::Float32;
+	}
+
+	view.subMeshes		= this->subMeshes.data();
+	view.subMeshCount	= (uint32_t)this->subMeshes.size();
+	view.bounds			= this->bounds;
+
+	if (!this->indices32.empty())
+	{
+		view.indices	= this->indices32.data();
+		view.indexCount = (uint32_t)this->indices32.size();
+		view.indexSize	= sizeof(uint32_t);
+	}
+	else
+	{
+		view.indices	= this->indices16.data();
+		view.indexCount = (uint32_t)this->indices16.size();
+		view.indexSize	= sizeof(uint16_t);
+	}
+
+	return view;
+}
+
+void MeshData::Clear()
+{
+	*this = MeshData();
+}
+
+void MeshIndexer::Build(std::vector<Vertex>&& p_vertices, const std::vector<uint32_t>& p_indices, bool p_split, MeshData& p_mesh)
+{
+	p_mesh.Clear();
+	p_mesh.bounds = MeshCache::ComputeBounds(p_vertices.data(), (uint32_t)p_vertices.size());
+
+	if (p_vertices.size() <= MAX_16BIT_VERTICES || !p_split)
+	{
+		if (p_vertices.size() <= MAX_16BIT_VERTICES)
+			p_mesh.indices16.assign(p_indices.begin(), p_indices.end());
+		else
+			p_mesh.indices32 = p_indices;
+
+		p_mesh.vertices = std::move(p_vertices);
+		p_mesh.subMeshes.push_back({ 0, (uint32_t)p_indices.size(), 0 });
+
+		return;
+	}
+
+	//Greedy in triangle order : a sub-mesh is closed when the next triangle would need a 65537th vertex
+	std::vector<uint32_t> localIndex(p_vertices.size(), UINT32_MAX);
+	std::vector<uint32_t> usedVertices; //Global vertices of the current sub-mesh, to reset localIndex
+
+	SubMesh subMesh = { 0, 0, 0 };
+
+	p_mesh.indices16.reserve(p_indices.size());
+
+	for (size_t triangle = 0; triangle + 2 < p_indices.size(); triangle += 3)
+	{
+		uint32_t newVertices = 0;
+
+		for (size_t corner = triangle; corner < triangle + 3; corner++)
+		{
+			//A vertex repeated in a degenerate triangle is only counted at its first corner
+			bool repeated = (corner > triangle && p_indices[corner] == p_indices[triangle]) || (corner == triangle + 2 && p_indices[corner] == p_indices[triangle + 1]);
+
+			newVertices += !repeated && localIndex[p_indices[corner]] == UINT32_MAX;
+		}
+
+		if (usedVertices.size() + newVertices > MAX_16BIT_VERTICES)
+		{
+			p_mesh.subMeshes.push_back(subMesh);
+
+			for (uint32_t vertex : usedVertices)
+				localIndex[vertex] = UINT32_MAX;
+
+			usedVertices.clear();
+
+			subMesh.firstIndex		= (uint32_t)p_mesh.indices16.size();
+			subMesh.indexCount		= 0;
+			subMesh.vertexOffset	= (int32_t)p_mesh.vertices.size();
+		}
+
+		for (size_t corner = triangle; corner < triangle + 3; corner++)
+		{
+			uint32_t vertex = p_indices[corner];
+
+			if (localIndex[vertex] == UINT32_MAX)
+			{
+				localIndex[vertex] = (uint32_t)usedVertices.size();
+				usedVertices.push_back(vertex);
+				p_mesh.vertices.push_back(p_vertices[vertex]);
+			}
+
+			p_mesh.indices16.push_back((uint16_t)localIndex[vertex]);
+			subMesh.indexCount++;
+		}
+	}
+
+	p_mesh.subMeshes.push_back(subMesh);
+}
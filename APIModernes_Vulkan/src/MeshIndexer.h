@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "MeshCache.h"
+
+//CPU side mesh owning its buffers, only one of the index vectors is filled
+struct MeshData
+{
+	std::vector<Vertex>		vertices;
+	std::vector<PackedVertex> packedVertices; //Replaces vertices once packed
+	std::vector<uint16_t>	indices16;
+	std::vector<uint32_t>	indices32;
+	std::vector<SubMesh>	subMeshes;
+	MeshBounds				bounds;
+
+	MeshView GetView() const;
+	void Clear();
+};
+
+//
+//Picks the index width of a mesh : 16 bits halves the index buffer and its fetch bandwidth, so 32 bits are only used
+//when some index doesn't fit. With p_split, big meshes stay in 16 bits by cutting them into sub-meshes of at most
+//65536 vertices, each drawn with its own vertexOffset. Vertices shared across a cut are duplicated.
+//
+class MeshIndexer
+{
+public:
+	static constexpr uint32_t MAX_16BIT_VERTICES = 65536; //Primitive restart is off, 0xFFFF is a regular index
+
+	//Takes a triangle list
+	static void Build(std::vector<Vertex>&& p_vertices, const std::vector<uint32_t>& p_indices, bool p_split, MeshData& p_mesh);
+};
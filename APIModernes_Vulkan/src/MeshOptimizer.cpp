@@ -0,0 +1,362 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <chrono>
+
+#pragma region Helpers
+//FIFO cache model : a vertex is cached while less than p_cacheSize misses happened since it was loaded
+class FifoCache
+{
+private:
+	std::vector<uint32_t>	mLoadedAt;
+	uint32_t				mMisses		= 0;
+	uint32_t				mCacheSize	= 0;
+
+public:
+	FifoCache(uint32_t p_vertexCount, uint32_t p_cacheSize) : mLoadedAt(p_vertexCount, 0), mCacheSize(p_cacheSize)
+	{
+		this->mMisses = p_cacheSize + 1; //Nothing starts cached
+	}
+
+	//Returns true on a miss
+	bool Access(uint32_t p_vertex)
+	{
+		if (this->mMisses - this->mLoadedAt[p_vertex] < this->mCacheSize)
+			return false;
+
+		this->mLoadedAt[p_vertex] = this->mMisses++;
+		return true;
+	}
+
+	void Reset()
+	{
+		this->mMisses += this->mCacheSize; //Everything falls out
+	}
+};
+
+//Vertex -> triangles using it, packed
+struct Adjacency
+{
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> triangles;
+	std::vector<uint32_t> counts;
+};
+
+//Only the p_triangleCount first triangles, trailing indices of an incomplete one are left out
+static void BuildAdjacency(const std::vector<uint32_t>& p_indices, uint32_t p_triangleCount, uint32_t p_vertexCount, Adjacency& p_adjacency)
+{
+	const size_t indexCount = size_t(p_triangleCount) * 3;
+
+	p_adjacency.counts.assign(p_vertexCount, 0);
+	p_adjacency.offsets.assign(p_vertexCount + 1, 0);
+	p_adjacency.triangles.resize(indexCount);
+
+	for (size_t i = 0; i < indexCount; i++)
+		p_adjacency.counts[p_indices[i]]++;
+
+	for (uint32_t i = 0; i < p_vertexCount; i++)
+		p_adjacency.offsets[i + 1] = p_adjacency.offsets[i] + p_adjacency.counts[i];
+
+	std::vector<uint32_t> cursor(p_adjacency.offsets.begin(), p_adjacency.offsets.end() - 1);
+
+	for (size_t i = 0; i < indexCount; i++)
+		p_adjacency.triangles[cursor[p_indices[i]]++] = (uint32_t)(i / 3);
+}
+#pragma endregion Helpers
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const std::vector<uint32_t>& p_indices, uint32_t p_vertexCount, uint32_t p_cacheSize)
+{
+	VertexCacheStats stats;
+
+	const uint32_t triangleCount = (uint32_t)(p_indices.size() / 3);
+
+	if (triangleCount == 0 || p_vertexCount == 0)
+		return stats;
+
+	FifoCache cache = FifoCache(p_vertexCount, p_cacheSize);
+
+	uint32_t misses = 0;
+
+	for (size_t i = 0; i < size_t(triangleCount) * 3; i++)
+		misses += cache.Access(p_indices[i]);
+
+	stats.acmr = (float)misses / triangleCount;
+	stats.atvr = (float)misses / p_vertexCount;
+
+	return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(const std::vector<uint32_t>& p_indices, uint32_t p_vertexCount, std::vector<uint32_t>& p_result, std::vector<uint32_t>* p_clusters, uint32_t p_cacheSize)
+{
+	const uint32_t triangleCount = (uint32_t)(p_indices.size() / 3);
+
+	p_result.clear();
+	p_result.reserve(triangleCount * 3);
+
+	if (p_clusters)
+		p_clusters->clear();
+
+	if (triangleCount == 0)
+		return;
+
+	Adjacency adjacency;
+	BuildAdjacency(p_indices, triangleCount, p_vertexCount, adjacency);
+
+	std::vector<uint32_t>& liveTriangles = adjacency.counts; //Not emitted yet, per vertex
+	std::vector<uint32_t>  cacheTime(p_vertexCount, 0);
+	std::vector<bool>	   emitted(triangleCount, false);
+	std::vector<uint32_t>  deadEnd;
+	std::vector<uint32_t>  candidates;
+
+	uint32_t time		= p_cacheSize + 1;
+	uint32_t inputOrder = 0; //Next vertex to try when the dead end stack is exhausted
+
+	int64_t fanning = 0;
+
+	while (fanning >= 0)
+	{
+		candidates.clear();
+
+		//Emit every remaining triangle around the fanning vertex
+		for (uint32_t i = adjacency.offsets[fanning]; i < adjacency.offsets[fanning + 1]; i++)
+		{
+			uint32_t triangle = adjacency.triangles[i];
+
+			if (emitted[triangle])
+				continue;
+
+			emitted[triangle] = true;
+
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				uint32_t vertex = p_indices[triangle * 3 + corner];
+
+				p_result.push_back(vertex);
+				deadEnd.push_back(vertex);
+				candidates.push_back(vertex);
+
+				liveTriangles[vertex]--;
+
+				if (time - cacheTime[vertex] > p_cacheSize)
+					cacheTime[vertex] = time++;
+			}
+		}
+
+		//Next fanning vertex : the one that will still be in cache once its remaining triangles are emitted, oldest first
+		int64_t	 next			= -1;
+		uint32_t bestPriority	= 0;
+
+		for (uint32_t vertex : candidates)
+		{
+			if (liveTriangles[vertex] == 0)
+				continue;
+
+			uint32_t priority = 0;
+
+			if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= p_cacheSize)
+				priority = time - cacheTime[vertex];
+
+			if (next < 0 || priority > bestPriority)
+			{
+				next			= vertex;
+				bestPriority	= priority;
+			}
+		}
+
+		if (next >= 0)
+		{
+			fanning = next;
+			continue;
+		}
+
+		//Dead end : go back to a recent vertex, or to the next one in input order
+		while (!deadEnd.empty() && next < 0)
+		{
+			uint32_t vertex = deadEnd.back();
+			deadEnd.pop_back();
+
+			if (liveTriangles[vertex] > 0)
+				next = vertex;
+		}
+
+		while (inputOrder < p_vertexCount && next < 0)
+		{
+			if (liveTriangles[inputOrder] > 0)
+				next = inputOrder;
+
+			inputOrder++;
+		}
+
+		//Cache locality is lost on a jump, that's a natural place to cut for the overdraw pass
+		if (next >= 0 && p_clusters)
+			p_clusters->push_back((uint32_t)(p_result.size() / 3));
+
+		fanning = next;
+	}
+
+	if (p_clusters)
+		p_clusters->insert(p_clusters->begin(), 0);
+}
+
+uint32_t MeshOptimizer::OptimizeOverdraw(std::vector<uint32_t>& p_indices, const std::vector<Vertex>& p_vertices, const std::vector<uint32_t>& p_clusters, float p_threshold)
+{
+	const uint32_t triangleCount = (uint32_t)(p_indices.size() / 3);
+
+	if (triangleCount == 0)
+		return 0;
+
+	//Soft cuts : inside a hard cluster, start a new one whenever the current one is already as cache friendly as the mesh
+	const float meshAcmr = AnalyzeVertexCache(p_indices, (uint32_t)p_vertices.size()).acmr;
+
+	std::vector<uint32_t> clusters;
+	FifoCache cache = FifoCache((uint32_t)p_vertices.size(), CACHE_SIZE);
+
+	for (size_t hard = 0; hard < p_clusters.size(); hard++)
+	{
+		uint32_t begin	= p_clusters[hard];
+		uint32_t end	= hard + 1 < p_clusters.size() ? p_clusters[hard + 1] : triangleCount;
+
+		uint32_t clusterBegin	= begin;
+		uint32_t misses			= 0;
+
+		cache.Reset();
+		clusters.push_back(begin);
+
+		for (uint32_t triangle = begin; triangle < end; triangle++)
+		{
+			for (uint32_t corner = 0; corner < 3; corner++)
+				misses += cache.Access(p_indices[triangle * 3 + corner]);
+
+			if (triangle + 1 < end && (float)misses / (triangle + 1 - clusterBegin) <= p_threshold * meshAcmr)
+			{
+				clusterBegin	= triangle + 1;
+				misses			= 0;
+
+				cache.Reset();
+				clusters.push_back(clusterBegin);
+			}
+		}
+
+		//The leftover after the last cut is usually too short to pay for its cold cache, give it back to the previous cluster
+		if (clusterBegin > begin && clusterBegin < end && (float)misses / (end - clusterBegin) > p_threshold * meshAcmr)
+			clusters.pop_back();
+	}
+
+	//Sort key : how far the cluster sits along its own normal from the mesh center, outer shells first
+	struct Cluster
+	{
+		uint32_t	begin;
+		uint32_t	end;
+		float		sortKey;
+	};
+
+	std::vector<Cluster> sortedClusters(clusters.size());
+
+	glm::vec3 meshCenter = glm::vec3(0.0f);
+	float	  meshArea	 = 0.0f;
+
+	std::vector<glm::vec3> centers(clusters.size());
+	std::vector<glm::vec3> normals(clusters.size());
+
+	for (size_t i = 0; i < clusters.size(); i++)
+	{
+		Cluster& cluster = sortedClusters[i];
+
+		cluster.begin	= clusters[i];
+		cluster.end		= i + 1 < clusters.size() ? clusters[i + 1] : triangleCount;
+
+		glm::vec3 center = glm::vec3(0.0f);
+		glm::vec3 normal = glm::vec3(0.0f);
+		float	  area	 = 0.0f;
+
+		for (uint32_t triangle = cluster.begin; triangle < cluster.end; triangle++)
+		{
+			const glm::vec3& a = p_vertices[p_indices[triangle * 3 + 0]].pos;
+			const glm::vec3& b = p_vertices[p_indices[triangle * 3 + 1]].pos;
+			const glm::vec3& c = p_vertices[p_indices[triangle * 3 + 2]].pos;
+
+			glm::vec3 cross			= glm::cross(b - a, c - a); //Length is twice the area
+			float	  triangleArea	= glm::length(cross);
+
+			center += (a + b + c) * (triangleArea / 3.0f);
+			normal += cross;
+			area   += triangleArea;
+		}
+
+		meshCenter	+= center;
+		meshArea	+= area;
+
+		centers[i] = area > 0.0f ? center / area : p_vertices[p_indices[cluster.begin * 3]].pos;
+		normals[i] = glm::length(normal) > 0.0f ? glm::normalize(normal) : glm::vec3(0.0f);
+	}
+
+	if (meshArea > 0.0f)
+		meshCenter /= meshArea;
+
+	for (size_t i = 0; i < clusters.size(); i++)
+		sortedClusters[i].sortKey = glm::dot(centers[i] - meshCenter, normals[i]);
+
+	//Stable : equal keys keep the cache order, so the result doesn't depend on the sort implementation
+	std::stable_sort(sortedClusters.begin(), sortedClusters.end(), [](const Cluster& p_a, const Cluster& p_b) { return p_a.sortKey > p_b.sortKey; });
+
+	std::vector<uint32_t> result;
+	result.reserve(p_indices.size());
+
+	for (const Cluster& cluster : sortedClusters)
+		result.insert(result.end(), p_indices.begin() + cluster.begin * 3, p_indices.begin() + cluster.end * 3);
+
+	//Fragmented meshes (lots of seams) lose more than the budget in the sharing between clusters, keep the cache order
+	if (AnalyzeVertexCache(result, (uint32_t)p_vertices.size()).acmr > p_threshold * meshAcmr)
+		return 0;
+
+	p_indices.swap(result);
+
+	return (uint32_t)clusters.size();
+}
+
+void MeshOptimizer::OptimizeVertexFetch(std::vector<Vertex>& p_vertices, std::vector<uint32_t>& p_indices)
+{
+	std::vector<uint32_t> remap(p_vertices.size(), UINT32_MAX);
+	std::vector<Vertex>	  result;
+
+	result.reserve(p_vertices.size());
+
+	for (uint32_t& index : p_indices)
+	{
+		if (remap[index] == UINT32_MAX)
+		{
+			remap[index] = (uint32_t)result.size();
+			result.push_back(p_vertices[index]);
+		}
+
+		index = remap[index];
+	}
+
+	p_vertices.swap(result);
+}
+
+void MeshOptimizer::Optimize(std::vector<Vertex>& p_vertices, std::vector<uint32_t>& p_indices, MeshOptimizationStats* p_stats)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	MeshOptimizationStats stats;
+
+	stats.before = AnalyzeVertexCache(p_indices, (uint32_t)p_vertices.size());
+
+	std::vector<uint32_t> reordered;
+	std::vector<uint32_t> clusters;
+
+	OptimizeVertexCache(p_indices, (uint32_t)p_vertices.size(), reordered, &clusters);
+
+	stats.clusterCount = OptimizeOverdraw(reordered, p_vertices, clusters);
+
+	OptimizeVertexFetch(p_vertices, reordered);
+
+	p_indices.swap(reordered);
+
+	stats.after			= AnalyzeVertexCache(p_indices, (uint32_t)p_vertices.size());
+	stats.milliseconds	= std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	if (p_stats)
+		*p_stats = stats;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Utils.h"
+
+//Post-transform cache behaviour of an index buffer, simulated as a FIFO
+struct VertexCacheStats
+{
+	float acmr = 0.0f; //Cache misses per triangle : 0.5 is the best a regular grid can do, 3 the worst
+	float atvr = 0.0f; //Cache misses per vertex : 1 means every vertex is transformed once
+};
+
+struct MeshOptimizationStats
+{
+	VertexCacheStats	before;
+	VertexCacheStats	after;
+	uint32_t			clusterCount	= 0;
+	float				milliseconds	= 0.0f;
+};
+
+//
+//Reorders a triangle list for the GPU, CPU only so it can be timed without a device :
+// - vertex cache : Tipsify (Sander et al. 2007), fans around the vertex that stays in cache the longest
+// - overdraw : Tipsify output is cut into clusters, which are sorted so the ones facing out of the mesh are drawn first
+//   and hide the rest. Cuts are only made where the cluster's ACMR stays under OVERDRAW_THRESHOLD x the mesh ACMR
+// - vertex fetch : vertices are renumbered in first use order so the vertex buffer is read linearly
+//Indices past the last whole triangle are dropped
+//
+class MeshOptimizer
+{
+public:
+	static constexpr uint32_t	CACHE_SIZE			= 16;
+	static constexpr float		OVERDRAW_THRESHOLD	= 1.05f;
+
+	static VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& p_indices, uint32_t p_vertexCount, uint32_t p_cacheSize = CACHE_SIZE);
+
+	//p_clusters receives the first triangle of every place Tipsify had to jump elsewhere in the mesh
+	static void OptimizeVertexCache(const std::vector<uint32_t>& p_indices, uint32_t p_vertexCount, std::vector<uint32_t>& p_result, std::vector<uint32_t>* p_clusters = nullptr, uint32_t p_cacheSize = CACHE_SIZE);
+
+	//p_clusters comes from OptimizeVertexCache on the same indices. Returns the number of clusters after the soft cuts,
+	//0 when sorting them would cost more than p_threshold x the ACMR and the order was kept
+	static uint32_t OptimizeOverdraw(std::vector<uint32_t>& p_indices, const std::vector<Vertex>& p_vertices, const std::vector<uint32_t>& p_clusters, float p_threshold = OVERDRAW_THRESHOLD);
+
+	//Drops unreferenced vertices
+	static void OptimizeVertexFetch(std::vector<Vertex>& p_vertices, std::vector<uint32_t>& p_indices);
+
+	//The three passes in order
+	static void Optimize(std::vector<Vertex>& p_vertices, std::vector<uint32_t>& p_indices, MeshOptimizationStats* p_stats = nullptr);
+};
@@ -0,0 +1,183 @@
+#include "MipmapGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIPMAP_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define MIPMAP_USE_SSE2 0
+#endif
+
+static constexpr uint32_t ENCODE_TABLE_SIZE = 4096; //Linear -> 8 bits, fine enough that every sRGB code is reachable
+
+struct ColorTables
+{
+	float	decode[256];				//8 bits -> linear
+	uint8_t encode[ENCODE_TABLE_SIZE];	//Linear * (ENCODE_TABLE_SIZE - 1) -> 8 bits
+};
+
+static ColorTables BuildColorTables(bool p_srgb)
+{
+	ColorTables tables;
+
+	for (uint32_t i = 0; i < 256; i++)
+	{
+		float value = i / 255.0f;
+
+		tables.decode[i] = p_srgb ? (value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f)) : value;
+	}
+
+	for (uint32_t i = 0; i < ENCODE_TABLE_SIZE; i++)
+	{
+		float value = i / float(ENCODE_TABLE_SIZE - 1);
+
+		if (p_srgb)
+			value = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+
+		tables.encode[i] = (uint8_t)std::lround(std::min(std::max(value, 0.0f), 1.0f) * 255.0f);
+	}
+
+	return tables;
+}
+
+static size_t AlignLevelOffset(size_t p_offset)
+{
+	return (p_offset + 15) & ~size_t(15);
+}
+
+static void Decode(const uint8_t* p_pixels, size_t p_texelCount, const ColorTables& p_tables, float* p_linear)
+{
+	for (size_t i = 0; i < p_texelCount; i++)
+	{
+		const uint8_t*	texel	= p_pixels + i * 4;
+		float*			out		= p_linear + i * 4;
+
+		out[0] = p_tables.decode[texel[0]];
+		out[1] = p_tables.decode[texel[1]];
+		out[2] = p_tables.decode[texel[2]];
+		out[3] = texel[3] / 255.0f;
+	}
+}
+
+static void Encode(const float* p_linear, size_t p_texelCount, const ColorTables& p_tables, uint8_t* p_pixels)
+{
+#if MIPMAP_USE_SSE2
+	const __m128 scale = _mm_setr_ps(float(ENCODE_TABLE_SIZE - 1), float(ENCODE_TABLE_SIZE - 1), float(ENCODE_TABLE_SIZE - 1), 255.0f);
+	const __m128 zero  = _mm_setzero_ps();
+
+	alignas(16) int32_t codes[4];
+
+	for (size_t i = 0; i < p_texelCount; i++)
+	{
+		__m128 value = _mm_mul_ps(_mm_loadu_ps(p_linear + i * 4), scale);
+
+		value = _mm_min_ps(_mm_max_ps(value, zero), scale);
+		_mm_store_si128((__m128i*)codes, _mm_cvtps_epi32(value)); //Round to nearest
+
+		uint8_t* texel = p_pixels + i * 4;
+
+		texel[0] = p_tables.encode[codes[0]];
+		texel[1] = p_tables.encode[codes[1]];
+		texel[2] = p_tables.encode[codes[2]];
+		texel[3] = (uint8_t)codes[3];
+	}
+#else
+	for (size_t i = 0; i < p_texelCount; i++)
+	{
+		const float*	value	= p_linear + i * 4;
+		uint8_t*		texel	= p_pixels + i * 4;
+
+		for (int channel = 0; channel < 3; channel++)
+			texel[channel] = p_tables.encode[std::lround(std::min(std::max(value[channel], 0.0f), 1.0f) * (ENCODE_TABLE_SIZE - 1))];
+
+		texel[3] = (uint8_t)std::lround(std::min(std::max(value[3], 0.0f), 1.0f) * 255.0f);
+	}
+#endif
+}
+
+//2x2 box, odd sizes clamp the last row/column instead of reading past it
+static void Downsample(const float* p_src, uint32_t p_srcWidth, uint32_t p_srcHeight, float* p_dst, uint32_t p_dstWidth, uint32_t p_dstHeight)
+{
+	for (uint32_t y = 0; y < p_dstHeight; y++)
+	{
+		const float* row0 = p_src + size_t(std::min(y * 2, p_srcHeight - 1)) * p_srcWidth * 4;
+		const float* row1 = p_src + size_t(std::min(y * 2 + 1, p_srcHeight - 1)) * p_srcWidth * 4;
+
+		float* out = p_dst + size_t(y) * p_dstWidth * 4;
+
+		for (uint32_t x = 0; x < p_dstWidth; x++)
+		{
+			size_t x0 = size_t(std::min(x * 2, p_srcWidth - 1)) * 4;
+			size_t x1 = size_t(std::min(x * 2 + 1, p_srcWidth - 1)) * 4;
+
+#if MIPMAP_USE_SSE2
+			__m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(row0 + x0), _mm_loadu_ps(row0 + x1)), _mm_add_ps(_mm_loadu_ps(row1 + x0), _mm_loadu_ps(row1 + x1)));
+
+			_mm_storeu_ps(out + x * 4, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+#else
+			for (int channel = 0; channel < 4; channel++)
+				out[x * 4 + channel] = (row0[x0 + channel] + row0[x1 + channel] + row1[x0 + channel] + row1[x1 + channel]) * 0.25f;
+#endif
+		}
+	}
+}
+
+uint32_t MipmapGenerator::GetLevelCount(uint32_t p_width, uint32_t p_height)
+{
+	uint32_t levelCount = 1;
+
+	for (uint32_t size = std::max(p_width, p_height); size > 1; size >>= 1)
+		levelCount++;
+
+	return levelCount;
+}
+
+void MipmapGenerator::GenerateRgba8(const uint8_t* p_pixels, uint32_t p_width, uint32_t p_height, bool p_srgb, std::vector<uint8_t>& p_chain, std::vector<ImageLevel>& p_levels)
+{
+	static const ColorTables linearTables	= BuildColorTables(false);
+	static const ColorTables srgbTables		= BuildColorTables(true);
+
+	const ColorTables& tables = p_srgb ? srgbTables : linearTables;
+
+	uint32_t levelCount = GetLevelCount(p_width, p_height);
+
+	p_levels.resize(levelCount);
+
+	size_t chainSize = 0;
+
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		ImageLevel& imageLevel = p_levels[level];
+
+		imageLevel.width	= std::max(p_width >> level, 1u);
+		imageLevel.height	= std::max(p_height >> level, 1u);
+		imageLevel.offset	= AlignLevelOffset(chainSize);
+		imageLevel.size		= VkDeviceSize(imageLevel.width) * imageLevel.height * 4;
+
+		chainSize = size_t(imageLevel.offset + imageLevel.size);
+	}
+
+	p_chain.resize(chainSize);
+	std::copy(p_pixels, p_pixels + p_levels[0].size, p_chain.begin());
+
+	//Ping-pong between the current level and the next one, both in linear float
+	std::vector<float> current(size_t(p_width) * p_height * 4);
+	std::vector<float> next(levelCount > 1 ? size_t(p_levels[1].width) * p_levels[1].height * 4 : 0); //Levels only shrink, the swapped buffers always fit
+
+	Decode(p_pixels, size_t(p_width) * p_height, tables, current.data());
+
+	for (uint32_t level = 1; level < levelCount; level++)
+	{
+		const ImageLevel& src = p_levels[level - 1];
+		const ImageLevel& dst = p_levels[level];
+
+		size_t texelCount = size_t(dst.width) * dst.height;
+
+		Downsample(current.data(), src.width, src.height, next.data(), dst.width, dst.height);
+		Encode(next.data(), texelCount, tables, p_chain.data() + dst.offset);
+
+		std::swap(current, next);
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "VKUploadContext.h"
+
+//
+//CPU mip chain for RGBA8 images, used when the device can't blit the format with a linear filter.
+//2x2 box filter done in linear space on float4 texels (one SSE register per texel when available), every level is
+//filtered from the previous float level so rounding only happens once per level.
+//
+class MipmapGenerator
+{
+public:
+	//Full chain down to 1x1
+	static uint32_t GetLevelCount(uint32_t p_width, uint32_t p_height);
+
+	//Writes every level, level 0 included, into p_chain. Level offsets are 16 bytes aligned so the blob can be staged as is.
+	//p_srgb : color channels are decoded/encoded with the sRGB curve, alpha is always linear
+	static void GenerateRgba8(const uint8_t* p_pixels, uint32_t p_width, uint32_t p_height, bool p_srgb, std::vector<uint8_t>& p_chain, std::vector<ImageLevel>& p_levels);
+};
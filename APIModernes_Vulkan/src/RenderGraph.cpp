@@ -0,0 +1,1150 @@
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+//Framebuffers of imported views that stopped coming back (swapchain images rotate, they come back every few frames)
+#define UNUSED_FRAMEBUFFER_FRAMES 32
+
+namespace
+{
+	struct AccessInfo
+	{
+		VkImageLayout			layout;
+		VkPipelineStageFlags	stages;
+		VkAccessFlags			access;
+		VkAccessFlags			writeAccess;	//0 for reads
+		VkImageUsageFlags		usage;
+		bool					attachment;
+	};
+
+	const VkPipelineStageFlags DEPTH_STAGES		= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	const VkPipelineStageFlags SHADER_STAGES	= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+	//Indexed by TextureAccess
+	const AccessInfo ACCESS_INFOS[] =
+	{
+		{ VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,	VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,					VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,			true },
+		{ VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,	DEPTH_STAGES,									VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,	VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,	VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,	true },
+		{ VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,	DEPTH_STAGES,									VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,												0,												VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,	true },
+		{ VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,			SHADER_STAGES,									VK_ACCESS_SHADER_READ_BIT,																	0,												VK_IMAGE_USAGE_SAMPLED_BIT,						false },
+		{ VK_IMAGE_LAYOUT_GENERAL,							SHADER_STAGES,									VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,										VK_ACCESS_SHADER_WRITE_BIT,						VK_IMAGE_USAGE_STORAGE_BIT,						false },
+		{ VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,				VK_PIPELINE_STAGE_TRANSFER_BIT,					VK_ACCESS_TRANSFER_READ_BIT,																0,												VK_IMAGE_USAGE_TRANSFER_SRC_BIT,				false },
+		{ VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,				VK_PIPELINE_STAGE_TRANSFER_BIT,					VK_ACCESS_TRANSFER_WRITE_BIT,																VK_ACCESS_TRANSFER_WRITE_BIT,					VK_IMAGE_USAGE_TRANSFER_DST_BIT,				false }
+	};
+
+	static_assert(sizeof(ACCESS_INFOS) / sizeof(ACCESS_INFOS[0]) == (size_t)TextureAccess::Count, "One AccessInfo per TextureAccess");
+
+	const AccessInfo& GetAccessInfo(TextureAccess p_access)
+	{
+		return ACCESS_INFOS[(uint32_t)p_access];
+	}
+
+	//What reads or writes a texture left in p_layout after the graph, nothing for present
+	VkAccessFlags GetLayoutAccess(VkImageLayout p_layout)
+	{
+		for (const AccessInfo& info : ACCESS_INFOS)
+		{
+			if (info.layout == p_layout)
+				return info.access;
+		}
+
+		return 0;
+	}
+
+	bool IsDepthLayout(VkImageLayout p_layout)
+	{
+		return p_layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL || p_layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+	}
+
+	bool HasStencil(VkFormat p_format)
+	{
+		return p_format == VK_FORMAT_D32_SFLOAT_S8_UINT || p_format == VK_FORMAT_D24_UNORM_S8_UINT || p_format == VK_FORMAT_D16_UNORM_S8_UINT || p_format == VK_FORMAT_S8_UINT;
+	}
+
+	VkImageAspectFlags GetAspect(VkFormat p_format)
+	{
+		switch (p_format)
+		{
+		case VK_FORMAT_D16_UNORM:
+		case VK_FORMAT_X8_D24_UNORM_PACK32:
+		case VK_FORMAT_D32_SFLOAT:
+			return VK_IMAGE_ASPECT_DEPTH_BIT;
+
+		case VK_FORMAT_S8_UINT:
+			return VK_IMAGE_ASPECT_STENCIL_BIT;
+
+		case VK_FORMAT_D16_UNORM_S8_UINT:
+		case VK_FORMAT_D24_UNORM_S8_UINT:
+		case VK_FORMAT_D32_SFLOAT_S8_UINT:
+			return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+
+		default:
+			return VK_IMAGE_ASPECT_COLOR_BIT;
+		}
+	}
+
+	const char* GetLayoutName(VkImageLayout p_layout)
+	{
+		switch (p_layout)
+		{
+		case VK_IMAGE_LAYOUT_UNDEFINED:							return "UNDEFINED";
+		case VK_IMAGE_LAYOUT_GENERAL:							return "GENERAL";
+		case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:			return "COLOR_ATTACHMENT";
+		case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:	return "DEPTH_ATTACHMENT";
+		case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:	return "DEPTH_READ_ONLY";
+		case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:			return "SHADER_READ_ONLY";
+		case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:				return "TRANSFER_SRC";
+		case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:				return "TRANSFER_DST";
+		case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:					return "PRESENT_SRC";
+		default:												return "OTHER";
+		}
+	}
+
+	const char* GetLoadOpName(VkAttachmentLoadOp p_loadOp)
+	{
+		return p_loadOp == VK_ATTACHMENT_LOAD_OP_CLEAR ? "clear" : p_loadOp == VK_ATTACHMENT_LOAD_OP_LOAD ? "load" : "dont care";
+	}
+}
+
+#pragma region Declaration
+bool RenderGraph::Init(VkDevice p_logicalDevice, VKMemoryAllocator* p_allocator, uint32_t p_framesInFlight)
+{
+	this->mLogicalDevice	= p_logicalDevice;
+	this->mAllocator		= p_allocator;
+	this->mFramesInFlight	= p_framesInFlight;
+
+	return true;
+}
+
+void RenderGraph::Release()
+{
+	this->DestroyTransients(this->mTransients);
+
+	for (TransientSet& retired : this->mRetiredTransients)
+		this->DestroyTransients(retired);
+
+	for (auto& framebuffer : this->mFramebuffers)
+		vkDestroyFramebuffer(this->mLogicalDevice, framebuffer.second.framebuffer, nullptr);
+
+	for (auto& renderPass : this->mRenderPasses)
+		vkDestroyRenderPass(this->mLogicalDevice, renderPass.second, nullptr);
+
+	this->mRetiredTransients.clear();
+	this->mFramebuffers.clear();
+	this->mRenderPasses.clear();
+	this->mPasses.clear();
+	this->mTextures.clear();
+	this->mFinalBarriers.clear();
+	this->mCompiled = false;
+}
+
+void RenderGraph::Reset()
+{
+	this->mFrameIndex++;
+
+	this->mPasses.clear();
+	this->mTextures.clear();
+	this->mFinalBarriers.clear();
+	this->mMemorySlotCount	= 0;
+	this->mCompiled			= false;
+
+	//The frame that last used them is done
+	for (size_t i = 0; i < this->mRetiredTransients.size();)
+	{
+		if (this->mRetiredTransients[i].lastUsedFrame + this->mFramesInFlight <= this->mFrameIndex)
+		{
+			this->DestroyTransients(this->mRetiredTransients[i]);
+			this->mRetiredTransients.erase(this->mRetiredTransients.begin() + i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	uint64_t unusedFrames = std::max<uint64_t>(UNUSED_FRAMEBUFFER_FRAMES, this->mFramesInFlight);
+
+	for (auto framebuffer = this->mFramebuffers.begin(); framebuffer != this->mFramebuffers.end();)
+	{
+		if (framebuffer->second.lastUsedFrame + unusedFrames <= this->mFrameIndex)
+		{
+			vkDestroyFramebuffer(this->mLogicalDevice, framebuffer->second.framebuffer, nullptr);
+			framebuffer = this->mFramebuffers.erase(framebuffer);
+		}
+		else
+		{
+			++framebuffer;
+		}
+	}
+}
+
+RenderGraphTexture RenderGraph::ImportTexture(const char* p_name, VkImage p_image, VkImageView p_view, const RenderGraphTextureDescription& p_description,
+											  VkImageLayout p_initialLayout, VkPipelineStageFlags p_initialStages, VkImageLayout p_finalLayout, VkPipelineStageFlags p_finalStages)
+{
+	Texture texture;
+
+	texture.name			= p_name;
+	texture.description		= p_description;
+	texture.imported		= true;
+	texture.image			= p_image;
+	texture.view			= p_view;
+	texture.initialLayout	= p_initialLayout;
+	texture.initialStages	= p_initialStages;
+	texture.finalLayout		= p_finalLayout;
+	texture.finalStages		= p_finalStages;
+
+	this->mTextures.push_back(texture);
+
+	return static_cast<RenderGraphTexture>(this->mTextures.size() - 1);
+}
+
+RenderGraphTexture RenderGraph::CreateTexture(const char* p_name, const RenderGraphTextureDescription& p_description)
+{
+	Texture texture;
+
+	texture.name		= p_name;
+	texture.description = p_description;
+
+	this->mTextures.push_back(texture);
+
+	return static_cast<RenderGraphTexture>(this->mTextures.size() - 1);
+}
+
+void RenderGraph::AddPass(const char* p_name, const RenderGraphSetup& p_setup, const RenderGraphExecute& p_execute)
+{
+	Pass pass;
+
+	pass.name		= p_name;
+	pass.execute	= p_execute;
+
+	this->mPasses.push_back(pass);
+
+	RenderGraphPassBuilder builder(this, static_cast<uint32_t>(this->mPasses.size() - 1));
+
+	p_setup(builder);
+}
+
+void RenderGraph::Use(uint32_t p_pass, RenderGraphTexture p_texture, TextureAccess p_access, bool p_clear, const VkClearValue& p_clearValue)
+{
+	TextureUse use;
+
+	use.texture		= p_texture;
+	use.access		= p_access;
+	use.clear		= p_clear;
+	use.clearValue	= p_clearValue;
+
+	this->mPasses[p_pass].uses.push_back(use);
+}
+
+VkImageView RenderGraph::GetImageView(RenderGraphTexture p_texture) const
+{
+	const Texture& texture = this->mTextures[p_texture];
+
+	if (texture.imported)
+		return texture.view;
+
+	return p_texture < this->mTransients.views.size() ? this->mTransients.views[p_texture] : VK_NULL_HANDLE;
+}
+
+void RenderGraph::ForgetImageView(VkImageView p_view)
+{
+	for (auto framebuffer = this->mFramebuffers.begin(); framebuffer != this->mFramebuffers.end();)
+	{
+		//Views are in the key after the render pass, before the extent
+		if (std::find(framebuffer->first.begin() + 1, framebuffer->first.end() - 2, (uint64_t)p_view) != framebuffer->first.end() - 2)
+		{
+			vkDestroyFramebuffer(this->mLogicalDevice, framebuffer->second.framebuffer, nullptr);
+			framebuffer = this->mFramebuffers.erase(framebuffer);
+		}
+		else
+		{
+			++framebuffer;
+		}
+	}
+}
+#pragma endregion Declaration
+
+#pragma region Compilation
+bool RenderGraph::Compile()
+{
+	this->mCompiled = false;
+
+	for (const Pass& pass : this->mPasses)
+	{
+		for (size_t i = 0; i < pass.uses.size(); i++)
+		{
+			if (pass.uses[i].texture >= this->mTextures.size())
+			{
+				std::cout << "[RenderGraph] " << pass.name << " : uses a texture that doesn't exist" << std::endl;
+				return false;
+			}
+
+			//One state per texture and pass, it can't be in two layouts at once
+			for (size_t j = 0; j < i; j++)
+			{
+				if (pass.uses[j].texture == pass.uses[i].texture)
+				{
+					std::cout << "[RenderGraph] " << pass.name << " : uses " << this->mTextures[pass.uses[i].texture].name << " twice" << std::endl;
+					return false;
+				}
+			}
+		}
+	}
+
+	for (Texture& texture : this->mTextures)
+	{
+		texture.usage		= 0;
+		texture.firstPass	= UINT32_MAX;
+		texture.lastPass	= 0;
+		texture.memorySlot	= UINT32_MAX;
+	}
+
+	this->mFinalBarriers.clear();
+
+	this->Cull();
+
+	//Lifetimes and usage, from the passes left only
+	for (uint32_t passIndex = 0; passIndex < this->mPasses.size(); passIndex++)
+	{
+		Pass& pass = this->mPasses[passIndex];
+
+		if (pass.culled)
+			continue;
+
+		pass.extent = { 0, 0 };
+
+		for (const TextureUse& use : pass.uses)
+		{
+			Texture& texture = this->mTextures[use.texture];
+
+			texture.usage		|= GetAccessInfo(use.access).usage;
+			texture.firstPass	= std::min(texture.firstPass, passIndex);
+			texture.lastPass	= std::max(texture.lastPass, passIndex);
+
+			if (!GetAccessInfo(use.access).attachment)
+				continue;
+
+			VkExtent2D extent = { texture.description.width, texture.description.height };
+
+			if (pass.extent.width != 0 && (pass.extent.width != extent.width || pass.extent.height != extent.height))
+			{
+				std::cout << "[RenderGraph] " << pass.name << " : attachments of different sizes" << std::endl;
+				return false;
+			}
+
+			pass.extent = extent;
+		}
+	}
+
+	this->AssignMemorySlots();
+	this->ComputeBarriers();
+
+	this->mCompiled = true;
+
+	return true;
+}
+
+void RenderGraph::Cull()
+{
+	//Textures whose current content someone needs, walking the passes backwards : what leaves the graph at first
+	std::vector<bool> needed(this->mTextures.size(), false);
+
+	for (size_t i = 0; i < this->mTextures.size(); i++)
+		needed[i] = this->mTextures[i].imported;
+
+	for (size_t passIndex = this->mPasses.size(); passIndex-- > 0;)
+	{
+		Pass& pass = this->mPasses[passIndex];
+
+		pass.culled = !pass.sideEffects;
+
+		for (const TextureUse& use : pass.uses)
+		{
+			if (GetAccessInfo(use.access).writeAccess != 0 && needed[use.texture])
+				pass.culled = false;
+		}
+
+		if (pass.culled)
+			continue;
+
+		//A clear overwrites everything, what was written before doesn't matter anymore
+		for (const TextureUse& use : pass.uses)
+		{
+			if (use.clear)
+				needed[use.texture] = false;
+		}
+
+		//Reads, and writes that keep the previous content
+		for (const TextureUse& use : pass.uses)
+		{
+			if (!use.clear)
+				needed[use.texture] = true;
+		}
+	}
+}
+
+void RenderGraph::AssignMemorySlots()
+{
+	std::vector<RenderGraphTexture> transients;
+
+	for (RenderGraphTexture i = 0; i < this->mTextures.size(); i++)
+	{
+		if (!this->mTextures[i].imported && this->mTextures[i].firstPass != UINT32_MAX)
+			transients.push_back(i);
+	}
+
+	//Interval graph coloring : taken by first use, a slot is reused as soon as its last texture is done
+	std::stable_sort(transients.begin(), transients.end(), [this](RenderGraphTexture p_a, RenderGraphTexture p_b)
+	{
+		return this->mTextures[p_a].firstPass < this->mTextures[p_b].firstPass;
+	});
+
+	std::vector<uint32_t> slotLastPass;
+
+	for (RenderGraphTexture textureIndex : transients)
+	{
+		Texture& texture = this->mTextures[textureIndex];
+
+		texture.memorySlot = UINT32_MAX;
+
+		for (uint32_t slot = 0; slot < slotLastPass.size(); slot++)
+		{
+			if (slotLastPass[slot] < texture.firstPass)
+			{
+				texture.memorySlot = slot;
+				break;
+			}
+		}
+
+		if (texture.memorySlot == UINT32_MAX)
+		{
+			texture.memorySlot = static_cast<uint32_t>(slotLastPass.size());
+			slotLastPass.push_back(0);
+		}
+
+		slotLastPass[texture.memorySlot] = texture.lastPass;
+	}
+
+	this->mMemorySlotCount = static_cast<uint32_t>(slotLastPass.size());
+}
+
+void RenderGraph::ComputeBarriers()
+{
+	struct TextureState
+	{
+		VkImageLayout			layout			= VK_IMAGE_LAYOUT_UNDEFINED;
+		bool					defined			= false;	//Holds content a later pass may want
+		bool					touched			= false;	//Used by a pass already
+		VkPipelineStageFlags	writeStages		= 0;		//Last write
+		VkAccessFlags			writeAccess		= 0;
+		VkPipelineStageFlags	readStages		= 0;		//Reads since the last write
+		VkPipelineStageFlags	visibleStages	= 0;		//Where the last write is visible already
+		VkAccessFlags			visibleAccess	= 0;
+	};
+
+	struct SlotUse
+	{
+		VkPipelineStageFlags	stages = 0;
+		VkAccessFlags			writeAccess = 0;
+	};
+
+	//Every stage and write a texture is used with, what the next texture of its memory slot has to wait for
+	std::vector<SlotUse> textureUses(this->mTextures.size());
+
+	for (const Pass& pass : this->mPasses)
+	{
+		if (pass.culled)
+			continue;
+
+		for (const TextureUse& use : pass.uses)
+		{
+			textureUses[use.texture].stages			|= GetAccessInfo(use.access).stages;
+			textureUses[use.texture].writeAccess	|= GetAccessInfo(use.access).writeAccess;
+		}
+	}
+
+	//Starts with the last texture of each slot : the previous frame used the memory last, on the same queue
+	std::vector<SlotUse>		slotUses(this->mMemorySlotCount);
+	std::vector<uint32_t>		slotLastFirstPass(this->mMemorySlotCount, 0);
+	std::vector<TextureState>	states(this->mTextures.size());
+
+	for (RenderGraphTexture i = 0; i < this->mTextures.size(); i++)
+	{
+		const Texture& texture = this->mTextures[i];
+
+		if (texture.imported)
+		{
+			states[i].layout		= texture.initialLayout;
+			states[i].defined		= texture.initialLayout != VK_IMAGE_LAYOUT_UNDEFINED;
+			states[i].writeStages	= texture.initialStages;
+		}
+		else if (texture.memorySlot != UINT32_MAX && texture.firstPass >= slotLastFirstPass[texture.memorySlot])
+		{
+			slotLastFirstPass[texture.memorySlot]	= texture.firstPass;
+			slotUses[texture.memorySlot]			= textureUses[i];
+		}
+	}
+
+	for (uint32_t passIndex = 0; passIndex < this->mPasses.size(); passIndex++)
+	{
+		Pass& pass = this->mPasses[passIndex];
+
+		pass.barriers.clear();
+		pass.attachments.clear();
+
+		if (pass.culled)
+			continue;
+
+		for (const TextureUse& use : pass.uses)
+		{
+			const AccessInfo&	info	= GetAccessInfo(use.access);
+			const Texture&		texture = this->mTextures[use.texture];
+			TextureState&		state	= states[use.texture];
+
+			//First use of a transient texture : it takes the memory over from the previous one of its slot
+			if (!texture.imported && !state.touched)
+			{
+				state.writeStages = slotUses[texture.memorySlot].stages;
+				state.writeAccess = slotUses[texture.memorySlot].writeAccess;
+			}
+
+			bool keepContent	= !use.clear && state.defined;
+			bool layoutChange	= state.layout != info.layout;
+			bool isWrite		= info.writeAccess != 0;
+
+			RenderGraphBarrier barrier{};
+
+			barrier.texture		= use.texture;
+			barrier.oldLayout	= keepContent ? state.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+			barrier.newLayout	= info.layout;
+			barrier.dstStages	= info.stages;
+			barrier.dstAccess	= info.access;
+
+			bool needsBarrier = false;
+
+			if (layoutChange || isWrite)
+			{
+				//A layout transition is a write too : after every earlier read and write
+				barrier.srcStages	= state.writeStages | state.readStages;
+				barrier.srcAccess	= state.writeAccess;
+				needsBarrier		= layoutChange || barrier.srcStages != 0;
+			}
+			else if (state.writeStages != 0 && ((info.stages & ~state.visibleStages) != 0 || (info.access & ~state.visibleAccess) != 0))
+			{
+				//Read after write, unless an earlier read already made the write visible here
+				barrier.srcStages	= state.writeStages;
+				barrier.srcAccess	= state.writeAccess;
+				needsBarrier		= true;
+			}
+
+			if (!layoutChange)
+				barrier.oldLayout = state.layout;
+
+			if (needsBarrier)
+			{
+				if (barrier.srcStages == 0)
+					barrier.srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+
+				pass.barriers.push_back(barrier);
+			}
+
+			if (info.attachment)
+			{
+				RenderGraphAttachment attachment;
+
+				attachment.texture		= use.texture;
+				attachment.layout		= info.layout;
+				attachment.loadOp		= use.clear ? VK_ATTACHMENT_LOAD_OP_CLEAR : (keepContent ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+				attachment.storeOp		= VK_ATTACHMENT_STORE_OP_DONT_CARE; //Set once the later passes are known
+				attachment.clearValue	= use.clearValue;
+
+				pass.attachments.push_back(attachment);
+			}
+
+			//New state
+			state.layout	= info.layout;
+			state.touched	= true;
+
+			if (isWrite)
+			{
+				state.defined		= true;
+				state.writeStages	= info.stages;
+				state.writeAccess	= info.writeAccess;
+				state.readStages	= 0;
+				state.visibleStages = 0;
+				state.visibleAccess = 0;
+			}
+			else
+			{
+				if (layoutChange)
+					state.readStages = 0;
+
+				state.readStages |= info.stages;
+
+				if (needsBarrier)
+				{
+					state.visibleStages |= info.stages;
+					state.visibleAccess |= info.access;
+				}
+			}
+
+			if (!texture.imported && passIndex == texture.lastPass)
+				slotUses[texture.memorySlot] = textureUses[use.texture];
+		}
+
+		//Depth last, the render pass expects it after the colors
+		std::stable_partition(pass.attachments.begin(), pass.attachments.end(), [](const RenderGraphAttachment& p_attachment)
+		{
+			return !IsDepthLayout(p_attachment.layout);
+		});
+	}
+
+	//Store ops : kept when a later pass wants the content or it leaves the graph
+	for (uint32_t passIndex = 0; passIndex < this->mPasses.size(); passIndex++)
+	{
+		for (RenderGraphAttachment& attachment : this->mPasses[passIndex].attachments)
+		{
+			bool store = this->mTextures[attachment.texture].imported;
+
+			for (uint32_t nextIndex = passIndex + 1; nextIndex < this->mPasses.size(); nextIndex++)
+			{
+				const Pass& next = this->mPasses[nextIndex];
+
+				auto use = std::find_if(next.uses.begin(), next.uses.end(), [&attachment](const TextureUse& p_use)
+				{
+					return p_use.texture == attachment.texture;
+				});
+
+				if (next.culled || use == next.uses.end())
+					continue;
+
+				store = !use->clear;
+				break;
+			}
+
+			attachment.storeOp = store ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		}
+	}
+
+	//Imported textures are left the way the outside expects them
+	for (RenderGraphTexture i = 0; i < this->mTextures.size(); i++)
+	{
+		const Texture&		texture = this->mTextures[i];
+		const TextureState& state	= states[i];
+
+		if (!texture.imported || texture.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED || (state.layout == texture.finalLayout && state.writeAccess == 0))
+			continue;
+
+		RenderGraphBarrier barrier{};
+
+		barrier.texture		= i;
+		barrier.oldLayout	= state.defined ? state.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout	= texture.finalLayout;
+		barrier.srcStages	= state.writeStages | state.readStages;
+		barrier.srcAccess	= state.writeAccess;
+		barrier.dstStages	= texture.finalStages;
+		barrier.dstAccess	= GetLayoutAccess(texture.finalLayout);
+
+		if (barrier.srcStages == 0)
+			barrier.srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+
+		this->mFinalBarriers.push_back(barrier);
+	}
+}
+
+std::string RenderGraph::Describe() const
+{
+	std::ostringstream description;
+
+	auto describeBarrier = [this, &description](const RenderGraphBarrier& p_barrier)
+	{
+		description << "    barrier " << this->mTextures[p_barrier.texture].name << " " << GetLayoutName(p_barrier.oldLayout) << " -> " << GetLayoutName(p_barrier.newLayout)
+					<< " stages 0x" << std::hex << p_barrier.srcStages << " -> 0x" << p_barrier.dstStages << " access 0x" << p_barrier.srcAccess << " -> 0x" << p_barrier.dstAccess << std::dec << "\n";
+	};
+
+	for (const Pass& pass : this->mPasses)
+	{
+		description << "pass " << pass.name << (pass.culled ? " (culled)" : "") << "\n";
+
+		for (const RenderGraphBarrier& barrier : pass.barriers)
+			describeBarrier(barrier);
+
+		for (const RenderGraphAttachment& attachment : pass.attachments)
+		{
+			description << "    attachment " << this->mTextures[attachment.texture].name << " " << GetLayoutName(attachment.layout) << " load " << GetLoadOpName(attachment.loadOp)
+						<< " store " << (attachment.storeOp == VK_ATTACHMENT_STORE_OP_STORE ? "store" : "dont care") << "\n";
+		}
+	}
+
+	description << "end\n";
+
+	for (const RenderGraphBarrier& barrier : this->mFinalBarriers)
+		describeBarrier(barrier);
+
+	for (const Texture& texture : this->mTextures)
+	{
+		if (texture.memorySlot != UINT32_MAX)
+			description << "memory slot " << texture.memorySlot << " : " << texture.name << " (passes " << texture.firstPass << " to " << texture.lastPass << ")\n";
+	}
+
+	return description.str();
+}
+#pragma endregion Compilation
+
+#pragma region Execution
+bool RenderGraph::Execute(VkCommandBuffer p_commandBuffer)
+{
+	if (!this->mCompiled || !this->CreateTransients())
+		return false;
+
+	for (const Pass& pass : this->mPasses)
+	{
+		if (pass.culled)
+			continue;
+
+		this->RecordBarriers(p_commandBuffer, pass.barriers);
+
+		RenderGraphContext context;
+
+		context.commandBuffer	= p_commandBuffer;
+		context.renderPass		= VK_NULL_HANDLE;
+		context.extent			= pass.extent;
+		context.graph			= this;
+
+		if (!pass.attachments.empty())
+		{
+			std::vector<uint32_t>		key;
+			std::vector<VkClearValue>	clearValues;
+
+			for (const RenderGraphAttachment& attachment : pass.attachments)
+			{
+				const RenderGraphTextureDescription& description = this->mTextures[attachment.texture].description;
+
+				key.insert(key.end(), { (uint32_t)description.format, (uint32_t)description.samples, (uint32_t)attachment.loadOp, (uint32_t)attachment.storeOp, (uint32_t)attachment.layout });
+				clearValues.push_back(attachment.clearValue);
+			}
+
+			context.renderPass = this->GetRenderPass(key);
+
+			//The pass can't record outside of its render pass, the other passes still run
+			if (context.renderPass == VK_NULL_HANDLE)
+			{
+				std::cout << "[RenderGraph] " << pass.name << " : can't create the render pass, pass skipped" << std::endl;
+				continue;
+			}
+
+			VkFramebuffer framebuffer = this->GetFramebuffer(context.renderPass, pass);
+
+			if (framebuffer == VK_NULL_HANDLE)
+			{
+				std::cout << "[RenderGraph] " << pass.name << " : can't create the framebuffer, pass skipped" << std::endl;
+				continue;
+			}
+
+			VkRenderPassBeginInfo renderPassBeginInfo{};
+
+			renderPassBeginInfo.sType				= VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+			renderPassBeginInfo.renderPass			= context.renderPass;
+			renderPassBeginInfo.framebuffer			= framebuffer;
+			renderPassBeginInfo.renderArea.extent	= pass.extent;
+			renderPassBeginInfo.renderArea.offset	= { 0, 0 };
+			renderPassBeginInfo.clearValueCount		= static_cast<uint32_t>(clearValues.size());
+			renderPassBeginInfo.pClearValues		= clearValues.data();
+
+			vkCmdBeginRenderPass(p_commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+			VkViewport viewport{};
+
+			viewport.width		= (float)pass.extent.width;
+			viewport.height		= (float)pass.extent.height;
+			viewport.maxDepth	= 1.0f;
+
+			vkCmdSetViewport(p_commandBuffer, 0, 1, &viewport);
+
+			VkRect2D scissor{};
+
+			scissor.extent = pass.extent;
+
+			vkCmdSetScissor(p_commandBuffer, 0, 1, &scissor);
+		}
+
+		if (pass.execute)
+			pass.execute(context);
+
+		if (!pass.attachments.empty())
+			vkCmdEndRenderPass(p_commandBuffer);
+	}
+
+	this->RecordBarriers(p_commandBuffer, this->mFinalBarriers);
+
+	return true;
+}
+
+void RenderGraph::RecordBarriers(VkCommandBuffer p_commandBuffer, const std::vector<RenderGraphBarrier>& p_barriers) const
+{
+	if (p_barriers.empty())
+		return;
+
+	//Every barrier of the pass in one call
+	std::vector<VkImageMemoryBarrier>	imageBarriers(p_barriers.size());
+	VkPipelineStageFlags				srcStages = 0;
+	VkPipelineStageFlags				dstStages = 0;
+
+	for (size_t i = 0; i < p_barriers.size(); i++)
+	{
+		const RenderGraphBarrier&	barrier = p_barriers[i];
+		const Texture&				texture = this->mTextures[barrier.texture];
+
+		VkImageMemoryBarrier& imageBarrier = imageBarriers[i];
+
+		imageBarrier.sType							= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		imageBarrier.oldLayout						= barrier.oldLayout;
+		imageBarrier.newLayout						= barrier.newLayout;
+		imageBarrier.srcAccessMask					= barrier.srcAccess;
+		imageBarrier.dstAccessMask					= barrier.dstAccess;
+		imageBarrier.srcQueueFamilyIndex			= VK_QUEUE_FAMILY_IGNORED;
+		imageBarrier.dstQueueFamilyIndex			= VK_QUEUE_FAMILY_IGNORED;
+		imageBarrier.image							= texture.imported ? texture.image : this->mTransients.images[barrier.texture];
+		imageBarrier.subresourceRange.aspectMask	= GetAspect(texture.description.format);
+		imageBarrier.subresourceRange.levelCount	= 1;
+		imageBarrier.subresourceRange.layerCount	= 1;
+
+		srcStages |= barrier.srcStages;
+		dstStages |= barrier.dstStages;
+	}
+
+	vkCmdPipelineBarrier(p_commandBuffer, srcStages, dstStages, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+}
+
+VkRenderPass RenderGraph::GetCompatibleRenderPass(const std::vector<VkFormat>& p_colorFormats, VkFormat p_depthFormat, VkSampleCountFlagBits p_samples)
+{
+	//Only formats and sample counts matter for compatibility
+	std::vector<uint32_t> key;
+
+	for (VkFormat format : p_colorFormats)
+		key.insert(key.end(), { (uint32_t)format, (uint32_t)p_samples, (uint32_t)VK_ATTACHMENT_LOAD_OP_DONT_CARE, (uint32_t)VK_ATTACHMENT_STORE_OP_DONT_CARE, (uint32_t)VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
+
+	if (p_depthFormat != VK_FORMAT_UNDEFINED)
+		key.insert(key.end(), { (uint32_t)p_depthFormat, (uint32_t)p_samples, (uint32_t)VK_ATTACHMENT_LOAD_OP_DONT_CARE, (uint32_t)VK_ATTACHMENT_STORE_OP_DONT_CARE, (uint32_t)VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL });
+
+	return this->GetRenderPass(key);
+}
+
+VkRenderPass RenderGraph::GetRenderPass(const std::vector<uint32_t>& p_key)
+{
+	auto cached = this->mRenderPasses.find(p_key);
+
+	if (cached != this->mRenderPasses.end())
+		return cached->second;
+
+	std::vector<VkAttachmentDescription>	attachments(p_key.size() / 5);
+	std::vector<VkAttachmentReference>		colorReferences;
+	VkAttachmentReference					depthReference{};
+	bool									hasDepth = false;
+
+	for (uint32_t i = 0; i < attachments.size(); i++)
+	{
+		const uint32_t* values = &p_key[i * 5];
+
+		VkAttachmentDescription& attachment = attachments[i];
+
+		attachment.format	= (VkFormat)values[0];
+		attachment.samples	= (VkSampleCountFlagBits)values[1];
+		attachment.loadOp	= (VkAttachmentLoadOp)values[2];
+		attachment.storeOp	= (VkAttachmentStoreOp)values[3];
+
+		attachment.stencilLoadOp	= HasStencil(attachment.format) ? attachment.loadOp : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		attachment.stencilStoreOp	= HasStencil(attachment.format) ? attachment.storeOp : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+		//The graph's barriers do the transitions, the render pass doesn't
+		attachment.initialLayout	= (VkImageLayout)values[4];
+		attachment.finalLayout		= (VkImageLayout)values[4];
+
+		VkAttachmentReference reference{ i, attachment.initialLayout };
+
+		if (IsDepthLayout(attachment.initialLayout))
+		{
+			depthReference	= reference;
+			hasDepth		= true;
+		}
+		else
+		{
+			colorReferences.push_back(reference);
+		}
+	}
+
+	VkSubpassDescription subpassDescription{};
+
+	subpassDescription.pipelineBindPoint		= VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpassDescription.colorAttachmentCount		= static_cast<uint32_t>(colorReferences.size());
+	subpassDescription.pColorAttachments		= colorReferences.data();
+	subpassDescription.pDepthStencilAttachment	= hasDepth ? &depthReference : nullptr;
+
+	VkRenderPassCreateInfo renderPassCreateInfo{};
+
+	renderPassCreateInfo.sType				= VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassCreateInfo.attachmentCount	= static_cast<uint32_t>(attachments.size());
+	renderPassCreateInfo.pAttachments		= attachments.data();
+	renderPassCreateInfo.subpassCount		= 1;
+	renderPassCreateInfo.pSubpasses			= &subpassDescription;
+
+	VkRenderPass renderPass = VK_NULL_HANDLE;
+
+	if (vkCreateRenderPass(this->mLogicalDevice, &renderPassCreateInfo, nullptr, &renderPass) != VK_SUCCESS)
+		return VK_NULL_HANDLE;
+
+	this->mRenderPasses.emplace(p_key, renderPass);
+
+	return renderPass;
+}
+
+VkFramebuffer RenderGraph::GetFramebuffer(VkRenderPass p_renderPass, const Pass& p_pass)
+{
+	std::vector<VkImageView>	views;
+	std::vector<uint64_t>		key = { (uint64_t)p_renderPass };
+
+	for (const RenderGraphAttachment& attachment : p_pass.attachments)
+	{
+		views.push_back(this->GetImageView(attachment.texture));
+		key.push_back((uint64_t)views.back());
+	}
+
+	key.push_back(p_pass.extent.width);
+	key.push_back(p_pass.extent.height);
+
+	auto cached = this->mFramebuffers.find(key);
+
+	if (cached != this->mFramebuffers.end())
+	{
+		cached->second.lastUsedFrame = this->mFrameIndex;
+		return cached->second.framebuffer;
+	}
+
+	VkFramebufferCreateInfo framebufferCreateInfo{};
+
+	framebufferCreateInfo.sType				= VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+	framebufferCreateInfo.renderPass		= p_renderPass;
+	framebufferCreateInfo.attachmentCount	= static_cast<uint32_t>(views.size());
+	framebufferCreateInfo.pAttachments		= views.data();
+	framebufferCreateInfo.width				= p_pass.extent.width;
+	framebufferCreateInfo.height			= p_pass.extent.height;
+	framebufferCreateInfo.layers			= 1;
+
+	VkFramebuffer framebuffer = VK_NULL_HANDLE;
+
+	if (vkCreateFramebuffer(this->mLogicalDevice, &framebufferCreateInfo, nullptr, &framebuffer) != VK_SUCCESS)
+		return VK_NULL_HANDLE;
+
+	this->mFramebuffers.emplace(key, CachedFramebuffer{ framebuffer, this->mFrameIndex });
+
+	return framebuffer;
+}
+
+bool RenderGraph::CreateTransients()
+{
+	std::vector<uint32_t> key;
+
+	for (RenderGraphTexture i = 0; i < this->mTextures.size(); i++)
+	{
+		const Texture& texture = this->mTextures[i];
+
+		if (texture.imported || texture.memorySlot == UINT32_MAX)
+			continue;
+
+		key.insert(key.end(), { i, texture.description.width, texture.description.height, (uint32_t)texture.description.format, (uint32_t)texture.description.samples, texture.usage, texture.memorySlot });
+	}
+
+	if (key == this->mTransients.key)
+	{
+		this->mTransients.lastUsedFrame = this->mFrameIndex;
+		return true;
+	}
+
+	//The graph changed (new pass, resize...), the frames in flight keep the old images until they're done
+	if (!this->mTransients.images.empty())
+		this->mRetiredTransients.push_back(this->mTransients);
+
+	this->mTransients				= TransientSet();
+	this->mTransients.lastUsedFrame = this->mFrameIndex;
+	this->mTransients.images.resize(this->mTextures.size(), VK_NULL_HANDLE);
+	this->mTransients.views.resize(this->mTextures.size(), VK_NULL_HANDLE);
+
+	//Memory shared by the textures of a slot, a slot is split when its textures can't live in the same memory type
+	struct MemoryGroup
+	{
+		uint32_t						slot;
+		VkMemoryRequirements			requirements;
+		std::vector<RenderGraphTexture> textures;
+	};
+
+	std::vector<MemoryGroup> groups;
+
+	for (RenderGraphTexture i = 0; i < this->mTextures.size(); i++)
+	{
+		const Texture& texture = this->mTextures[i];
+
+		if (texture.imported || texture.memorySlot == UINT32_MAX)
+			continue;
+
+		VkImageCreateInfo imageCreateInfo{};
+
+		imageCreateInfo.sType			= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageCreateInfo.imageType		= VK_IMAGE_TYPE_2D;
+		imageCreateInfo.format			= texture.description.format;
+		imageCreateInfo.extent			= { texture.description.width, texture.description.height, 1 };
+		imageCreateInfo.mipLevels		= 1;
+		imageCreateInfo.arrayLayers		= 1;
+		imageCreateInfo.samples			= texture.description.samples;
+		imageCreateInfo.tiling			= VK_IMAGE_TILING_OPTIMAL;
+		imageCreateInfo.usage			= texture.usage;
+		imageCreateInfo.sharingMode		= VK_SHARING_MODE_EXCLUSIVE;
+		imageCreateInfo.initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED;
+
+		if (vkCreateImage(this->mLogicalDevice, &imageCreateInfo, nullptr, &this->mTransients.images[i]) != VK_SUCCESS)
+		{
+			std::cout << "[RenderGraph] " << texture.name << " : can't create the image" << std::endl;
+			return false;
+		}
+
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(this->mLogicalDevice, this->mTransients.images[i], &requirements);
+
+		auto group = std::find_if(groups.begin(), groups.end(), [&texture, &requirements](const MemoryGroup& p_group)
+		{
+			return p_group.slot == texture.memorySlot && (p_group.requirements.memoryTypeBits & requirements.memoryTypeBits) != 0;
+		});
+
+		if (group == groups.end())
+		{
+			groups.push_back(MemoryGroup{ texture.memorySlot, requirements, { i } });
+			continue;
+		}
+
+		group->requirements.size			= std::max(group->requirements.size, requirements.size);
+		group->requirements.alignment		= std::max(group->requirements.alignment, requirements.alignment);
+		group->requirements.memoryTypeBits &= requirements.memoryTypeBits;
+		group->textures.push_back(i);
+	}
+
+	for (const MemoryGroup& group : groups)
+	{
+		MemoryAllocation memory;
+
+		if (!this->mAllocator->Allocate(group.requirements, MemoryUsage::GpuOnly, false, memory))
+		{
+			std::cout << "[RenderGraph] can't allocate memory slot " << group.slot << std::endl;
+			return false;
+		}
+
+		this->mTransients.memories.push_back(memory);
+
+		for (RenderGraphTexture textureIndex : group.textures)
+		{
+			const Texture& texture = this->mTextures[textureIndex];
+
+			if (vkBindImageMemory(this->mLogicalDevice, this->mTransients.images[textureIndex], memory.memory, memory.offset) != VK_SUCCESS)
+			{
+				std::cout << "[RenderGraph] " << texture.name << " : can't bind the image memory" << std::endl;
+				return false;
+			}
+
+			VkImageViewCreateInfo imageViewCreateInfo{};
+
+			imageViewCreateInfo.sType							= VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			imageViewCreateInfo.image							= this->mTransients.images[textureIndex];
+			imageViewCreateInfo.viewType						= VK_IMAGE_VIEW_TYPE_2D;
+			imageViewCreateInfo.format							= texture.description.format;
+			imageViewCreateInfo.subresourceRange.aspectMask		= GetAspect(texture.description.format);
+			imageViewCreateInfo.subresourceRange.levelCount		= 1;
+			imageViewCreateInfo.subresourceRange.layerCount		= 1;
+
+			//A sampled view can only have one aspect, shaders read the depth
+			if ((texture.usage & VK_IMAGE_USAGE_SAMPLED_BIT) && (imageViewCreateInfo.subresourceRange.aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT))
+				imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+
+			if (vkCreateImageView(this->mLogicalDevice, &imageViewCreateInfo, nullptr, &this->mTransients.views[textureIndex]) != VK_SUCCESS)
+				return false;
+		}
+	}
+
+	//Only once everything exists, a set that failed half way is retired by the next frame
+	this->mTransients.key = key;
+
+	std::cout << "[RenderGraph] " << groups.size() << " allocations for " << key.size() / 7 << " transient textures" << std::endl;
+
+	return true;
+}
+
+void RenderGraph::DestroyTransients(TransientSet& p_transients)
+{
+	//The handle can come back for a new view, a cached framebuffer must not match it
+	for (VkImageView view : p_transients.views)
+	{
+		if (view == VK_NULL_HANDLE)
+			continue;
+
+		this->ForgetImageView(view);
+		vkDestroyImageView(this->mLogicalDevice, view, nullptr);
+	}
+
+	for (VkImage image : p_transients.images)
+		vkDestroyImage(this->mLogicalDevice, image, nullptr);
+
+	for (MemoryAllocation& memory : p_transients.memories)
+		this->mAllocator->Free(memory);
+
+	p_transients = TransientSet();
+}
+#pragma endregion Execution
+
+#pragma region Pass builder
+void RenderGraphPassBuilder::WriteColor(RenderGraphTexture p_texture)
+{
+	this->mGraph->Use(this->mPass, p_texture, TextureAccess::ColorAttachment, false, VkClearValue{});
+}
+
+void RenderGraphPassBuilder::ClearColor(RenderGraphTexture p_texture, const VkClearColorValue& p_clearValue)
+{
+	VkClearValue clearValue{};
+
+	clearValue.color = p_clearValue;
+
+	this->mGraph->Use(this->mPass, p_texture, TextureAccess::ColorAttachment, true, clearValue);
+}
+
+void RenderGraphPassBuilder::WriteDepth(RenderGraphTexture p_texture)
+{
+	this->mGraph->Use(this->mPass, p_texture, TextureAccess::DepthAttachment, false, VkClearValue{});
+}
+
+void RenderGraphPassBuilder::ClearDepth(RenderGraphTexture p_texture, float p_depth, uint32_t p_stencil)
+{
+	VkClearValue clearValue{};
+
+	clearValue.depthStencil = { p_depth, p_stencil };
+
+	this->mGraph->Use(this->mPass, p_texture, TextureAccess::DepthAttachment, true, clearValue);
+}
+
+void RenderGraphPassBuilder::ReadDepth(RenderGraphTexture p_texture)
+{
+	this->mGraph->Use(this->mPass, p_texture, TextureAccess::DepthRead, false, VkClearValue{});
+}
+
+void RenderGraphPassBuilder::Read(RenderGraphTexture p_texture, TextureAccess p_access)
+{
+	this->mGraph->Use(this->mPass, p_texture, p_access, false, VkClearValue{});
+}
+
+void RenderGraphPassBuilder::Write(RenderGraphTexture p_texture, TextureAccess p_access)
+{
+	this->mGraph->Use(this->mPass, p_texture, p_access, false, VkClearValue{});
+}
+
+void RenderGraphPassBuilder::SetSideEffects()
+{
+	this->mGraph->mPasses[this->mPass].sideEffects = true;
+}
+#pragma endregion Pass builder
@@ -0,0 +1,254 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "VKMemoryAllocator.h"
+
+typedef uint32_t RenderGraphTexture;
+
+#define INVALID_RENDER_GRAPH_TEXTURE UINT32_MAX
+
+//How a pass touches a texture, each one is a layout + the stages and accesses it happens at
+enum class TextureAccess : uint32_t
+{
+	ColorAttachment,	//Written, loaded first unless cleared
+	DepthAttachment,	//Tested and written, loaded first unless cleared
+	DepthRead,			//Tested without writes, read only layout
+	ShaderRead,			//Sampled by fragment or compute shaders
+	StorageWrite,		//Storage image, read and written by fragment or compute shaders
+	TransferSrc,
+	TransferDst,
+
+	Count
+};
+
+struct RenderGraphTextureDescription
+{
+	uint32_t				width	= 0;
+	uint32_t				height	= 0;
+	VkFormat				format	= VK_FORMAT_UNDEFINED;
+	VkSampleCountFlagBits	samples = VK_SAMPLE_COUNT_1_BIT;
+};
+
+struct RenderGraphBarrier
+{
+	RenderGraphTexture		texture;
+	VkImageLayout			oldLayout;
+	VkImageLayout			newLayout;
+	VkPipelineStageFlags	srcStages;
+	VkPipelineStageFlags	dstStages;
+	VkAccessFlags			srcAccess;
+	VkAccessFlags			dstAccess;
+};
+
+struct RenderGraphAttachment
+{
+	RenderGraphTexture	texture;
+	VkImageLayout		layout;
+	VkAttachmentLoadOp	loadOp;
+	VkAttachmentStoreOp storeOp;
+	VkClearValue		clearValue;
+};
+
+class RenderGraph;
+
+//What a pass callback records with, viewport and scissor are already set to the attachments when it has some
+struct RenderGraphContext
+{
+	VkCommandBuffer		commandBuffer;
+	VkRenderPass		renderPass;		//VK_NULL_HANDLE for passes without attachments
+	VkExtent2D			extent;
+	const RenderGraph*	graph;			//GetImageView() of the textures the pass reads
+};
+
+class RenderGraphPassBuilder;
+
+typedef std::function<void(RenderGraphPassBuilder&)>		RenderGraphSetup;
+typedef std::function<void(const RenderGraphContext&)>	RenderGraphExecute;
+
+//
+//Frame graph : the frame is declared every frame as passes that say which textures they read and write, then compiled and
+//recorded in one go. The textures a pass creates are transient, the graph owns them and only keeps them for the frame.
+//Compile() is CPU only and makes no Vulkan call, so what it decides can be checked without a device :
+//	- Culling : walking back from the imported textures (what leaves the graph, the swapchain image), passes whose writes
+//	  nobody reads are dropped, unless they have side effects
+//	- Barriers : the state of every texture is followed through the passes that are left. A barrier is only emitted for a
+//	  layout change or a real hazard (read after write, write after read or write), reads already made visible don't get a
+//	  second one, and every barrier a pass needs is merged into a single vkCmdPipelineBarrier
+//	- Load and store ops : an attachment is cleared when asked, loaded only when an earlier pass wrote it, and stored only
+//	  when a later pass reads it or it's imported
+//	- Aliasing : transient textures whose lifetimes don't overlap share the same memory, the first pass using one waits
+//	  for the last pass that used the memory before it
+//Execute() then creates what the compiled graph needs (kept across frames while the graph doesn't change) and records it.
+//Passes run in declaration order, which is a valid order since a pass can only read what was declared before it
+//
+class RenderGraph
+{
+private:
+	struct TextureUse
+	{
+		RenderGraphTexture	texture;
+		TextureAccess		access;
+		bool				clear;
+		VkClearValue		clearValue;
+	};
+
+	struct Pass
+	{
+		std::string				name;
+		std::vector<TextureUse> uses;
+		RenderGraphExecute		execute;
+		bool					sideEffects = false;
+
+		//Compiled
+		bool								culled = true;
+		std::vector<RenderGraphBarrier>		barriers;
+		std::vector<RenderGraphAttachment>	attachments; //Colors in declaration order, then depth
+		VkExtent2D							extent{};
+	};
+
+	struct Texture
+	{
+		std::string						name;
+		RenderGraphTextureDescription	description;
+
+		bool					imported		= false;
+		VkImage					image			= VK_NULL_HANDLE;
+		VkImageView				view			= VK_NULL_HANDLE;
+		VkImageLayout			initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED;
+		VkPipelineStageFlags	initialStages	= VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		VkImageLayout			finalLayout		= VK_IMAGE_LAYOUT_UNDEFINED;
+		VkPipelineStageFlags	finalStages		= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+
+		//Compiled
+		VkImageUsageFlags	usage		= 0;
+		uint32_t			firstPass	= UINT32_MAX;	//Passes that aren't culled only
+		uint32_t			lastPass	= 0;
+		uint32_t			memorySlot	= UINT32_MAX;	//Transient textures with the same slot alias
+	};
+
+	//Transient images of one compiled graph, kept while the next frames compile to the same
+	struct TransientSet
+	{
+		std::vector<uint32_t>			key;
+		std::vector<VkImage>			images;		//Indexed by texture
+		std::vector<VkImageView>		views;
+		std::vector<MemoryAllocation>	memories;	//One per memory slot, more when a slot needs several memory types
+		uint64_t						lastUsedFrame = 0;
+	};
+
+	struct CachedFramebuffer
+	{
+		VkFramebuffer	framebuffer;
+		uint64_t		lastUsedFrame;
+	};
+
+	VkDevice			mLogicalDevice	= VK_NULL_HANDLE;
+	VKMemoryAllocator*	mAllocator		= nullptr;
+	uint32_t			mFramesInFlight = 1;
+	uint64_t			mFrameIndex		= 0;
+
+	//Declared this frame
+	std::vector<Pass>				mPasses;
+	std::vector<Texture>			mTextures;
+	std::vector<RenderGraphBarrier> mFinalBarriers;			//Imported textures to their final layout
+	uint32_t						mMemorySlotCount = 0;
+	bool							mCompiled = false;
+
+	//Kept across frames
+	std::map<std::vector<uint32_t>, VkRenderPass>		mRenderPasses;		//Keyed by attachment formats, ops and layouts
+	std::map<std::vector<uint64_t>, CachedFramebuffer>	mFramebuffers;		//Keyed by render pass, views and extent
+	TransientSet										mTransients;
+	std::vector<TransientSet>							mRetiredTransients; //Frames in flight may still use them
+
+	friend class RenderGraphPassBuilder;
+
+private:
+	void Use(uint32_t p_pass, RenderGraphTexture p_texture, TextureAccess p_access, bool p_clear, const VkClearValue& p_clearValue);
+
+	void Cull();
+	void AssignMemorySlots();
+	void ComputeBarriers();
+
+	//p_key : format, samples, load op, store op and layout of every attachment
+	VkRenderPass	GetRenderPass(const std::vector<uint32_t>& p_key);
+	VkFramebuffer	GetFramebuffer(VkRenderPass p_renderPass, const Pass& p_pass);
+	bool			CreateTransients();
+	void			DestroyTransients(TransientSet& p_transients);
+
+	void RecordBarriers(VkCommandBuffer p_commandBuffer, const std::vector<RenderGraphBarrier>& p_barriers) const;
+
+public:
+	bool Init(VkDevice p_logicalDevice, VKMemoryAllocator* p_allocator, uint32_t p_framesInFlight);
+	//The device must be idle
+	void Release();
+
+	//Starts declaring a new frame, once per frame after its fence wait. Destroys what no frame in flight uses anymore
+	void Reset();
+
+	//A texture the graph doesn't own, it's in p_initialLayout once p_initialStages are done and is left in p_finalLayout
+	//for p_finalStages. Passes writing it are never culled
+	RenderGraphTexture ImportTexture(const char* p_name, VkImage p_image, VkImageView p_view, const RenderGraphTextureDescription& p_description,
+									 VkImageLayout p_initialLayout, VkPipelineStageFlags p_initialStages, VkImageLayout p_finalLayout, VkPipelineStageFlags p_finalStages);
+
+	//Only lives for the frame, its memory may be shared with other transient textures
+	RenderGraphTexture CreateTexture(const char* p_name, const RenderGraphTextureDescription& p_description);
+
+	//p_setup declares what the pass uses, right away. p_execute records it, from Execute()
+	void AddPass(const char* p_name, const RenderGraphSetup& p_setup, const RenderGraphExecute& p_execute);
+
+	//CPU only. False when a pass uses a texture in a way that can't work (logged)
+	bool Compile();
+
+	//Records the compiled graph, creating the images, render passes and framebuffers it needs
+	bool Execute(VkCommandBuffer p_commandBuffer);
+
+	//Render pass compatible with the ones of passes writing these formats, for the pipelines drawing in them.
+	//p_depthFormat is VK_FORMAT_UNDEFINED without depth. Owned by the graph
+	VkRenderPass GetCompatibleRenderPass(const std::vector<VkFormat>& p_colorFormats, VkFormat p_depthFormat, VkSampleCountFlagBits p_samples = VK_SAMPLE_COUNT_1_BIT);
+
+	VkImageView GetImageView(RenderGraphTexture p_texture) const;
+
+	//Destroys the framebuffers made with p_view, before destroying an imported view (swapchain recreation)
+	void ForgetImageView(VkImageView p_view);
+
+	//Compiled results
+	bool										IsCulled(uint32_t p_pass) const		{ return this->mPasses[p_pass].culled; }
+	const std::vector<RenderGraphBarrier>&		GetBarriers(uint32_t p_pass) const	{ return this->mPasses[p_pass].barriers; }
+	const std::vector<RenderGraphAttachment>&	GetAttachments(uint32_t p_pass) const { return this->mPasses[p_pass].attachments; }
+	const std::vector<RenderGraphBarrier>&		GetFinalBarriers() const			{ return this->mFinalBarriers; }
+	uint32_t									GetMemorySlot(RenderGraphTexture p_texture) const { return this->mTextures[p_texture].memorySlot; }
+	uint32_t									GetMemorySlotCount() const			{ return this->mMemorySlotCount; }
+
+	//Every pass with its barriers, load/store ops and the memory slots, what Compile() decided in readable form
+	std::string Describe() const;
+};
+
+//Handed to a pass setup callback to declare what the pass uses
+class RenderGraphPassBuilder
+{
+private:
+	RenderGraph*	mGraph;
+	uint32_t		mPass;
+
+public:
+	RenderGraphPassBuilder(RenderGraph* p_graph, uint32_t p_pass) : mGraph(p_graph), mPass(p_pass) {}
+
+	void WriteColor(RenderGraphTexture p_texture);
+	void ClearColor(RenderGraphTexture p_texture, const VkClearColorValue& p_clearValue);
+	void WriteDepth(RenderGraphTexture p_texture);
+	void ClearDepth(RenderGraphTexture p_texture, float p_depth = 1.0f, uint32_t p_stencil = 0);
+	void ReadDepth(RenderGraphTexture p_texture);
+
+	void Read(RenderGraphTexture p_texture, TextureAccess p_access = TextureAccess::ShaderRead);
+	void Write(RenderGraphTexture p_texture, TextureAccess p_access);
+
+	//Never culled, for passes whose result leaves the graph some other way (readbacks, queries)
+	void SetSideEffects();
+};
@@ -0,0 +1,223 @@
+#include "ShaderWatcher.h"
+#include "Utils.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <set>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <map>
+#else
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+//How often the watch thread checks if it should stop
+#define WATCH_POLL_INTERVAL_MS 200
+//Editors may still be writing when the first notification comes in
+#define WATCH_SETTLE_DELAY_MS 100
+
+bool ShaderWatcher::Init(const char* p_directory, const char* p_compiler)
+{
+	this->mDirectory	= p_directory;
+	this->mCompiler		= p_compiler;
+	this->mStopping		= false;
+
+	this->mThread = std::thread(&ShaderWatcher::WatchLoop, this);
+
+	std::cout << "[HotReload] watching " << this->mDirectory << std::endl;
+
+	return true;
+}
+
+void ShaderWatcher::Release()
+{
+	this->mStopping = true;
+
+	if (this->mThread.joinable())
+		this->mThread.join();
+
+	this->mCompiled.clear();
+}
+
+std::vector<std::string> ShaderWatcher::TakeCompiled()
+{
+	std::vector<std::string> compiled;
+
+	std::lock_guard<std::mutex> lock(this->mMutex);
+
+	compiled.swap(this->mCompiled);
+
+	return compiled;
+}
+
+bool ShaderWatcher::IsShaderSource(const std::string& p_fileName)
+{
+	static const char* extensions[] = { ".vert", ".frag", ".comp", ".geom", ".tesc", ".tese" };
+
+	for (const char* extension : extensions)
+	{
+		size_t length = strlen(extension);
+
+		if (p_fileName.size() > length && p_fileName.compare(p_fileName.size() - length, length, extension) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+void ShaderWatcher::Compile(const std::string& p_fileName)
+{
+	std::string sourcePath	= this->mDirectory + "/" + p_fileName;
+	std::string outputPath	= sourcePath + ".spv";
+	std::string tmpPath		= outputPath + ".tmp";
+
+	//The SDK is often installed under a path with spaces
+	std::string command = "\"" + this->mCompiler + "\" \"" + sourcePath + "\" -o \"" + tmpPath + "\"";
+
+#ifdef _WIN32
+	//cmd /c strips the first and last quote of a line starting with one, the outer pair keeps the others intact
+	command = "\"" + command + "\"";
+#endif
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	if (std::system(command.c_str()) != 0)
+	{
+		std::remove(tmpPath.c_str());
+		std::cout << "[HotReload] " << sourcePath << " doesn't compile, keeping the previous shader" << std::endl;
+		return;
+	}
+
+	if (!AtomicReplaceFile(tmpPath, outputPath))
+	{
+		std::remove(tmpPath.c_str());
+		return;
+	}
+
+	std::cout << "[HotReload] " << sourcePath << " compiled in " << std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count() << " ms" << std::endl;
+
+	std::lock_guard<std::mutex> lock(this->mMutex);
+
+	this->mCompiled.push_back(outputPath);
+}
+
+#ifdef _WIN32
+void ShaderWatcher::WatchLoop()
+{
+	//The notification doesn't say which file changed, write times tell
+	auto scanSources = [this](std::map<std::string, FILETIME>& p_writeTimes, std::set<std::string>& p_changed)
+	{
+		WIN32_FIND_DATAA	findData;
+		HANDLE				find = FindFirstFileA((this->mDirectory + "/*").c_str(), &findData);
+
+		if (find == INVALID_HANDLE_VALUE)
+			return;
+
+		do
+		{
+			if (!IsShaderSource(findData.cFileName))
+				continue;
+
+			auto writeTime = p_writeTimes.find(findData.cFileName);
+
+			if (writeTime != p_writeTimes.end() && CompareFileTime(&writeTime->second, &findData.ftLastWriteTime) != 0)
+				p_changed.insert(findData.cFileName);
+
+			p_writeTimes[findData.cFileName] = findData.ftLastWriteTime;
+		}
+		while (FindNextFileA(find, &findData));
+
+		FindClose(find);
+	};
+
+	HANDLE change = FindFirstChangeNotificationA(this->mDirectory.c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+
+	if (change == INVALID_HANDLE_VALUE)
+	{
+		std::cout << "[HotReload] can't watch " << this->mDirectory << std::endl;
+		return;
+	}
+
+	std::map<std::string, FILETIME> writeTimes;
+	std::set<std::string>			changed;
+
+	scanSources(writeTimes, changed);
+
+	while (!this->mStopping)
+	{
+		if (WaitForSingleObject(change, WATCH_POLL_INTERVAL_MS) != WAIT_OBJECT_0)
+			continue;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(WATCH_SETTLE_DELAY_MS));
+
+		FindNextChangeNotification(change);
+
+		changed.clear();
+		scanSources(writeTimes, changed);
+
+		for (const std::string& fileName : changed)
+			this->Compile(fileName);
+	}
+
+	FindCloseChangeNotification(change);
+}
+#else
+void ShaderWatcher::WatchLoop()
+{
+	int notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+	//Saved in place or written elsewhere and moved over the old file, editors do both
+	if (notify < 0 || inotify_add_watch(notify, this->mDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+	{
+		std::cout << "[HotReload] can't watch " << this->mDirectory << std::endl;
+
+		if (notify >= 0)
+			close(notify);
+		return;
+	}
+
+	alignas(inotify_event) char buffer[4096];
+
+	while (!this->mStopping)
+	{
+		pollfd pollFd = { notify, POLLIN, 0 };
+
+		if (poll(&pollFd, 1, WATCH_POLL_INTERVAL_MS) <= 0)
+			continue;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(WATCH_SETTLE_DELAY_MS));
+
+		//Every event queued by now, a source saved twice is compiled once
+		std::set<std::string> changed;
+
+		for (;;)
+		{
+			ssize_t size = read(notify, buffer, sizeof(buffer));
+
+			if (size <= 0)
+				break;
+
+			for (char* event = buffer; event < buffer + size; event += sizeof(inotify_event) + ((inotify_event*)event)->len)
+			{
+				const inotify_event* notification = (const inotify_event*)event;
+
+				if (notification->len > 0 && IsShaderSource(notification->name))
+					changed.insert(notification->name);
+			}
+		}
+
+		for (const std::string& fileName : changed)
+			this->Compile(fileName);
+	}
+
+	close(notify);
+}
+#endif
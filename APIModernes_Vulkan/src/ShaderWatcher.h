@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//
+//Development helper : watches a directory of GLSL sources (inotify on Linux, change notifications on Windows) and compiles
+//every saved source to <source>.spv next to it on its own thread, the way compileShaders.bat does.
+//The render thread picks the rebuilt files up with TakeCompiled() between frames and reloads them.
+//A source that doesn't compile leaves the previous .spv untouched, the compiler prints why
+//
+class ShaderWatcher
+{
+private:
+	std::string mDirectory;
+	std::string mCompiler;
+
+	std::thread			mThread;
+	std::atomic<bool>	mStopping{ false };
+
+	std::mutex					mMutex;
+	std::vector<std::string>	mCompiled;
+
+private:
+	void WatchLoop();
+
+	static bool IsShaderSource(const std::string& p_fileName);
+
+	//Compiles to a temporary file first, a failed compilation never leaves a broken .spv behind
+	void Compile(const std::string& p_fileName);
+
+public:
+	//p_compiler : path of glslc, environment variables allowed on Windows. Quoted on the command line, then the source and "-o <output>"
+	bool Init(const char* p_directory, const char* p_compiler);
+	void Release();
+
+	//.spv paths rebuilt since the last call, as "<directory>/<source>.spv"
+	std::vector<std::string> TakeCompiled();
+};
@@ -0,0 +1,59 @@
+#include "SpecializationConstants.h"
+
+#include <algorithm>
+
+void SpecializationConstants::SetWord(uint32_t p_id, SpecializationType p_type, uint32_t p_word)
+{
+	auto entry = std::lower_bound(this->mEntries.begin(), this->mEntries.end(), p_id, [](const VkSpecializationMapEntry& p_entry, uint32_t p_constantId)
+	{
+		return p_entry.constantID < p_constantId;
+	});
+
+	size_t index = entry - this->mEntries.begin();
+
+	if (entry != this->mEntries.end() && entry->constantID == p_id)
+	{
+		this->mTypes[index] = p_type;
+		this->mData[index]	= p_word;
+		return;
+	}
+
+	VkSpecializationMapEntry newEntry{};
+
+	newEntry.constantID = p_id;
+	newEntry.size		= sizeof(uint32_t);
+
+	this->mEntries.insert(entry, newEntry);
+	this->mTypes.insert(this->mTypes.begin() + index, p_type);
+	this->mData.insert(this->mData.begin() + index, p_word);
+
+	//Entries after the new one moved by a word
+	for (size_t i = 0; i < this->mEntries.size(); i++)
+		this->mEntries[i].offset = static_cast<uint32_t>(i * sizeof(uint32_t));
+}
+
+VkSpecializationInfo SpecializationConstants::GetInfo() const
+{
+	VkSpecializationInfo info{};
+
+	info.mapEntryCount	= static_cast<uint32_t>(this->mEntries.size());
+	info.pMapEntries	= this->mEntries.data();
+	info.dataSize		= this->mData.size() * sizeof(uint32_t);
+	info.pData			= this->mData.data();
+
+	return info;
+}
+
+bool SpecializationConstants::operator==(const SpecializationConstants& p_other) const
+{
+	if (this->mEntries.size() != p_other.mEntries.size())
+		return false;
+
+	for (size_t i = 0; i < this->mEntries.size(); i++)
+	{
+		if (this->mEntries[i].constantID != p_other.mEntries[i].constantID)
+			return false;
+	}
+
+	return this->mTypes == p_other.mTypes && this->mData == p_other.mData;
+}
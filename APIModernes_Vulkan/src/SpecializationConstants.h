@@ -0,0 +1,77 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+//Types a constant_id can be declared with in GLSL, every one of them is 4 bytes
+enum class SpecializationType : uint32_t
+{
+	Bool,
+	Int,
+	UInt,
+	Float
+};
+
+template <typename T>
+struct SpecializationTypeOf;
+
+template <> struct SpecializationTypeOf<bool>		{ static const SpecializationType value = SpecializationType::Bool; };
+template <> struct SpecializationTypeOf<int32_t>	{ static const SpecializationType value = SpecializationType::Int; };
+template <> struct SpecializationTypeOf<uint32_t>	{ static const SpecializationType value = SpecializationType::UInt; };
+template <> struct SpecializationTypeOf<float>		{ static const SpecializationType value = SpecializationType::Float; };
+
+//
+//A "layout(constant_id = N) const T" of a shader, declared once on the C++ side with the same type :
+//	static const SpecializationConstant<bool>		USE_VERTEX_COLOR{ 0 };
+//	static const SpecializationConstant<uint32_t>	LIGHT_COUNT{ 1 };
+//
+template <typename T>
+struct SpecializationConstant
+{
+	typedef T Type;
+
+	uint32_t id;
+};
+
+//
+//Values given to the constants of one shader stage, the ones left out keep the default written in the shader.
+//Kept sorted by constant id so the same values set in any order make the same permutation
+//
+class SpecializationConstants
+{
+private:
+	std::vector<VkSpecializationMapEntry>	mEntries;
+	std::vector<SpecializationType>			mTypes;
+	std::vector<uint32_t>					mData;		//One word per entry, in the order of mEntries
+
+	void SetWord(uint32_t p_id, SpecializationType p_type, uint32_t p_word);
+
+	//A SPIR-V bool constant is read as a VkBool32
+	static uint32_t ToWord(bool p_value)		{ return p_value ? VK_TRUE : VK_FALSE; }
+	static uint32_t ToWord(int32_t p_value)		{ return static_cast<uint32_t>(p_value); }
+	static uint32_t ToWord(uint32_t p_value)	{ return p_value; }
+	static uint32_t ToWord(float p_value)		{ uint32_t word; memcpy(&word, &p_value, sizeof(word)); return word; }
+
+public:
+	template <typename T>
+	SpecializationConstants& Set(SpecializationConstant<T> p_constant, typename SpecializationConstant<T>::Type p_value)
+	{
+		this->SetWord(p_constant.id, SpecializationTypeOf<T>::value, ToWord(p_value));
+
+		return *this;
+	}
+
+	bool IsEmpty() const { return this->mEntries.empty(); }
+
+	uint32_t			GetCount() const					{ return static_cast<uint32_t>(this->mEntries.size()); }
+	uint32_t			GetId(uint32_t p_index) const		{ return this->mEntries[p_index].constantID; }
+	SpecializationType	GetType(uint32_t p_index) const		{ return this->mTypes[p_index]; }
+
+	//Points into this object, valid as long as it isn't modified
+	VkSpecializationInfo GetInfo() const;
+
+	bool operator==(const SpecializationConstants& p_other) const;
+};
@@ -0,0 +1,695 @@
+#include "SpirvReflection.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+//The few parts of the SPIR-V spec the reflection needs, spirv.h isn't part of the headers shipped with the repo
+namespace
+{
+	const uint32_t SPIRV_MAGIC = 0x07230203;
+
+	enum Op : uint32_t
+	{
+		OpEntryPoint		= 15,
+		OpTypeBool			= 20,
+		OpTypeInt			= 21,
+		OpTypeFloat			= 22,
+		OpTypeVector		= 23,
+		OpTypeMatrix		= 24,
+		OpTypeImage			= 25,
+		OpTypeSampler		= 26,
+		OpTypeSampledImage	= 27,
+		OpTypeArray			= 28,
+		OpTypeRuntimeArray	= 29,
+		OpTypeStruct		= 30,
+		OpTypePointer		= 32,
+		OpConstant			= 43,
+		OpSpecConstantTrue	= 48,
+		OpSpecConstantFalse = 49,
+		OpSpecConstant		= 50,
+		OpFunction			= 54,
+		OpVariable			= 59,
+		OpDecorate			= 71,
+		OpMemberDecorate	= 72
+	};
+
+	enum Decoration : uint32_t
+	{
+		DecorationSpecId		= 1,
+		DecorationBlock			= 2,
+		DecorationBufferBlock	= 3,
+		DecorationArrayStride	= 6,
+		DecorationMatrixStride	= 7,
+		DecorationBuiltIn		= 11,
+		DecorationLocation		= 30,
+		DecorationBinding		= 33,
+		DecorationDescriptorSet = 34,
+		DecorationOffset		= 35
+	};
+
+	enum StorageClass : uint32_t
+	{
+		StorageClassUniformConstant = 0,
+		StorageClassInput			= 1,
+		StorageClassUniform			= 2,
+		StorageClassPushConstant	= 9,
+		StorageClassStorageBuffer	= 12
+	};
+
+	enum Dim : uint32_t
+	{
+		DimBuffer		= 5,
+		DimSubpassData	= 6
+	};
+
+	//Everything known about one result id
+	struct SpirvId
+	{
+		uint32_t				opcode = 0;
+		std::vector<uint32_t>	operands;	//Words after the result id for types, [type, storage class] for variables, [value] for constants
+
+		uint32_t	set				= UINT32_MAX;
+		uint32_t	binding			= UINT32_MAX;
+		uint32_t	location		= UINT32_MAX;
+		uint32_t	arrayStride		= 0;
+		uint32_t	specId			= UINT32_MAX;
+		uint32_t	resultType		= 0;	//Specialization constants
+		bool		builtIn			= false;
+		bool		block			= false;
+		bool		bufferBlock		= false;
+
+		//Struct members
+		std::vector<uint32_t>	memberOffsets;
+		std::vector<uint32_t>	memberMatrixStrides;
+		bool					memberBuiltIn = false;
+	};
+
+	typedef std::unordered_map<uint32_t, SpirvId> SpirvIds;
+
+	//Fewest words an instruction the reflection reads can have, opcode included. 0 for the ones it skips
+	uint32_t GetMinWordCount(uint32_t p_opcode)
+	{
+		switch (p_opcode)
+		{
+		case OpTypeBool:
+		case OpTypeSampler:
+		case OpTypeStruct:			return 2;
+		case OpTypeFloat:
+		case OpTypeSampledImage:
+		case OpTypeRuntimeArray:
+		case OpSpecConstantTrue:
+		case OpSpecConstantFalse:
+		case OpDecorate:			return 3;
+		case OpEntryPoint:
+		case OpTypeInt:
+		case OpTypeVector:
+		case OpTypeMatrix:
+		case OpTypeArray:
+		case OpTypePointer:
+		case OpConstant:
+		case OpSpecConstant:
+		case OpVariable:
+		case OpMemberDecorate:		return 4;
+		case OpTypeImage:			return 9;
+		default:					return 0;
+		}
+	}
+
+	//The decorations the reflection reads a literal of, it comes right after the decoration
+	bool HasLiteral(uint32_t p_decoration)
+	{
+		switch (p_decoration)
+		{
+		case DecorationSpecId:
+		case DecorationArrayStride:
+		case DecorationMatrixStride:
+		case DecorationBuiltIn:
+		case DecorationLocation:
+		case DecorationBinding:
+		case DecorationDescriptorSet:
+		case DecorationOffset:
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+	VkShaderStageFlagBits GetStage(uint32_t p_executionModel)
+	{
+		switch (p_executionModel)
+		{
+		case 0:		return VK_SHADER_STAGE_VERTEX_BIT;
+		case 1:		return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+		case 2:		return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+		case 3:		return VK_SHADER_STAGE_GEOMETRY_BIT;
+		case 4:		return VK_SHADER_STAGE_FRAGMENT_BIT;
+		case 5:		return VK_SHADER_STAGE_COMPUTE_BIT;
+		default:	return VkShaderStageFlagBits(0);
+		}
+	}
+
+	uint32_t GetMemberSlot(std::vector<uint32_t>& p_values, uint32_t p_member)
+	{
+		if (p_values.size() <= p_member)
+			p_values.resize(p_member + 1, 0);
+
+		return p_member;
+	}
+
+	//Bytes taken in a block, p_matrixStride comes from the member holding the matrix
+	uint32_t GetTypeSize(const SpirvIds& p_ids, uint32_t p_typeId, uint32_t p_matrixStride = 0)
+	{
+		auto type = p_ids.find(p_typeId);
+
+		if (type == p_ids.end())
+			return 0;
+
+		const SpirvId&					id			= type->second;
+		const std::vector<uint32_t>&	operands	= id.operands;
+
+		switch (id.opcode)
+		{
+		case OpTypeBool:
+			return 4;
+
+		case OpTypeInt:
+		case OpTypeFloat:
+			return operands[0] / 8;
+
+		case OpTypeVector:
+			return operands[1] * GetTypeSize(p_ids, operands[0]);
+
+		case OpTypeMatrix:
+			return operands[1] * (p_matrixStride != 0 ? p_matrixStride : GetTypeSize(p_ids, operands[0]));
+
+		case OpTypeArray:
+		{
+			auto length = p_ids.find(operands[1]);
+
+			if (length == p_ids.end() || length->second.operands.empty())
+				return 0;
+
+			return length->second.operands[0] * (id.arrayStride != 0 ? id.arrayStride : GetTypeSize(p_ids, operands[0], p_matrixStride));
+		}
+
+		case OpTypeStruct:
+		{
+			uint32_t size = 0;
+
+			for (uint32_t member = 0; member < operands.size(); member++)
+			{
+				uint32_t offset			= member < id.memberOffsets.size() ? id.memberOffsets[member] : 0;
+				uint32_t matrixStride	= member < id.memberMatrixStrides.size() ? id.memberMatrixStrides[member] : 0;
+
+				size = std::max(size, offset + GetTypeSize(p_ids, operands[member], matrixStride));
+			}
+
+			return size;
+		}
+
+		default:
+			return 0;
+		}
+	}
+
+	VkFormat GetVertexInputFormat(const SpirvIds& p_ids, uint32_t p_typeId, uint32_t& p_componentCount)
+	{
+		auto type = p_ids.find(p_typeId);
+
+		if (type == p_ids.end())
+			return VK_FORMAT_UNDEFINED;
+
+		uint32_t componentTypeId = p_typeId;
+		p_componentCount = 1;
+
+		if (type->second.opcode == OpTypeVector)
+		{
+			componentTypeId		= type->second.operands[0];
+			p_componentCount	= type->second.operands[1];
+		}
+
+		auto componentType = p_ids.find(componentTypeId);
+
+		if (componentType == p_ids.end() || componentType->second.operands.empty() || componentType->second.operands[0] != 32 || p_componentCount > 4)
+			return VK_FORMAT_UNDEFINED;
+
+		static const VkFormat floatFormats[]	= { VK_FORMAT_R32_SFLOAT,	VK_FORMAT_R32G32_SFLOAT,	VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+		static const VkFormat intFormats[]		= { VK_FORMAT_R32_SINT,		VK_FORMAT_R32G32_SINT,		VK_FORMAT_R32G32B32_SINT,	VK_FORMAT_R32G32B32A32_SINT };
+		static const VkFormat uintFormats[]		= { VK_FORMAT_R32_UINT,		VK_FORMAT_R32G32_UINT,		VK_FORMAT_R32G32B32_UINT,	VK_FORMAT_R32G32B32A32_UINT };
+
+		if (componentType->second.opcode == OpTypeFloat)
+			return floatFormats[p_componentCount - 1];
+
+		if (componentType->second.opcode == OpTypeInt)
+			return componentType->second.operands[1] != 0 ? intFormats[p_componentCount - 1] : uintFormats[p_componentCount - 1];
+
+		return VK_FORMAT_UNDEFINED;
+	}
+
+	void SortBindings(std::vector<ShaderBinding>& p_bindings)
+	{
+		std::sort(p_bindings.begin(), p_bindings.end(), [](const ShaderBinding& p_a, const ShaderBinding& p_b)
+		{
+			return p_a.set != p_b.set ? p_a.set < p_b.set : p_a.binding < p_b.binding;
+		});
+	}
+
+	//Descriptor type of a resource variable once its arrays are stripped, VK_DESCRIPTOR_TYPE_MAX_ENUM when it isn't one
+	VkDescriptorType GetDescriptorType(const SpirvIds& p_ids, uint32_t p_storageClass, uint32_t p_typeId, uint32_t& p_count)
+	{
+		p_count = 1;
+
+		auto type = p_ids.find(p_typeId);
+
+		while (type != p_ids.end() && (type->second.opcode == OpTypeArray || type->second.opcode == OpTypeRuntimeArray))
+		{
+			if (type->second.opcode == OpTypeArray)
+			{
+				auto length = p_ids.find(type->second.operands[1]);
+
+				if (length != p_ids.end() && !length->second.operands.empty())
+					p_count *= length->second.operands[0];
+			}
+
+			type = p_ids.find(type->second.operands[0]);
+		}
+
+		if (type == p_ids.end())
+			return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+
+		const SpirvId& id = type->second;
+
+		switch (p_storageClass)
+		{
+		case StorageClassUniform:
+			if (id.bufferBlock)
+				return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			return id.block ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_MAX_ENUM;
+
+		case StorageClassStorageBuffer:
+			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+		case StorageClassUniformConstant:
+			switch (id.opcode)
+			{
+			case OpTypeSampler:
+				return VK_DESCRIPTOR_TYPE_SAMPLER;
+
+			case OpTypeSampledImage:
+				return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+			case OpTypeImage:
+			{
+				//Sampled type, Dim, Depth, Arrayed, MS, Sampled (1 = with a sampler, 2 = storage)
+				uint32_t dim		= id.operands[1];
+				uint32_t sampled	= id.operands[5];
+
+				if (dim == DimSubpassData)
+					return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+
+				if (dim == DimBuffer)
+					return sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+
+				return sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+			}
+
+			default:
+				return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+			}
+
+		default:
+			return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+		}
+	}
+}
+
+bool SpirvReflection::Reflect(const std::vector<char>& p_byteCode, ShaderReflection& p_reflection)
+{
+	p_reflection = ShaderReflection();
+
+	if (p_byteCode.size() < 5 * sizeof(uint32_t) || p_byteCode.size() % sizeof(uint32_t) != 0)
+		return false;
+
+	std::vector<uint32_t> words(p_byteCode.size() / sizeof(uint32_t));
+	memcpy(words.data(), p_byteCode.data(), p_byteCode.size());
+
+	if (words[0] != SPIRV_MAGIC)
+		return false;
+
+	SpirvIds				ids;
+	std::vector<uint32_t>	variables;
+	std::vector<uint32_t>	specConstants;
+
+	//
+	//Declarations, everything before the first function
+	//
+
+	for (size_t offset = 5; offset < words.size();)
+	{
+		uint32_t wordCount	= words[offset] >> 16;
+		uint32_t opcode		= words[offset] & 0xFFFF;
+
+		if (wordCount == 0 || offset + wordCount > words.size())
+			return false;
+
+		if (opcode == OpFunction)
+			break;
+
+		const uint32_t* instruction = &words[offset];
+
+		//Every operand read below is within the instruction
+		bool truncated = wordCount < GetMinWordCount(opcode);
+
+		if (opcode == OpDecorate && !truncated)
+			truncated = HasLiteral(instruction[2]) && wordCount < 4;
+		else if (opcode == OpMemberDecorate && !truncated)
+			truncated = HasLiteral(instruction[3]) && wordCount < 5;
+
+		if (truncated)
+		{
+			std::cout << "[Reflection] instruction " << opcode << " at word " << offset << " is missing operands" << std::endl;
+			return false;
+		}
+
+		switch (opcode)
+		{
+		case OpEntryPoint:
+			p_reflection.stages |= GetStage(instruction[1]);
+			break;
+
+		case OpDecorate:
+		{
+			SpirvId& target = ids[instruction[1]];
+
+			uint32_t value = HasLiteral(instruction[2]) ? instruction[3] : 0;
+
+			switch (instruction[2])
+			{
+			case DecorationSpecId:			target.specId		= value;	break;
+			case DecorationBlock:			target.block		= true;		break;
+			case DecorationBufferBlock:		target.bufferBlock	= true;		break;
+			case DecorationArrayStride:		target.arrayStride	= value;	break;
+			case DecorationBuiltIn:			target.builtIn		= true;		break;
+			case DecorationLocation:		target.location		= value;	break;
+			case DecorationBinding:			target.binding		= value;	break;
+			case DecorationDescriptorSet:	target.set			= value;	break;
+			}
+			break;
+		}
+
+		case OpMemberDecorate:
+		{
+			SpirvId& target = ids[instruction[1]];
+
+			uint32_t member = instruction[2];
+			uint32_t value	= HasLiteral(instruction[3]) ? instruction[4] : 0;
+
+			switch (instruction[3])
+			{
+			case DecorationOffset:			target.memberOffsets[GetMemberSlot(target.memberOffsets, member)]				= value; break;
+			case DecorationMatrixStride:	target.memberMatrixStrides[GetMemberSlot(target.memberMatrixStrides, member)]	= value; break;
+			case DecorationBuiltIn:			target.memberBuiltIn = true; break;
+			}
+			break;
+		}
+
+		case OpTypeBool:
+		case OpTypeInt:
+		case OpTypeFloat:
+		case OpTypeVector:
+		case OpTypeMatrix:
+		case OpTypeImage:
+		case OpTypeSampler:
+		case OpTypeSampledImage:
+		case OpTypeArray:
+		case OpTypeRuntimeArray:
+		case OpTypeStruct:
+		case OpTypePointer:
+		{
+			SpirvId& type = ids[instruction[1]];
+
+			type.opcode = opcode;
+			type.operands.assign(instruction + 2, instruction + wordCount);
+			break;
+		}
+
+		case OpConstant:
+		{
+			SpirvId& constant = ids[instruction[2]];
+
+			constant.opcode = opcode;
+			constant.operands.assign(instruction + 3, instruction + wordCount);
+			break;
+		}
+
+		case OpSpecConstantTrue:
+		case OpSpecConstantFalse:
+		case OpSpecConstant:
+		{
+			SpirvId& constant = ids[instruction[2]];
+
+			//The default value, an array sized by a specialization constant is reflected with it
+			constant.opcode		= opcode;
+			constant.resultType = instruction[1];
+
+			if (opcode == OpSpecConstant)
+				constant.operands.assign(instruction + 3, instruction + wordCount);
+			else
+				constant.operands = { opcode == OpSpecConstantTrue ? 1u : 0u };
+
+			specConstants.push_back(instruction[2]);
+			break;
+		}
+
+		case OpVariable:
+		{
+			SpirvId& variable = ids[instruction[2]];
+
+			variable.opcode		= opcode;
+			variable.operands	= { instruction[1], instruction[3] };
+
+			variables.push_back(instruction[2]);
+			break;
+		}
+		}
+
+		offset += wordCount;
+	}
+
+	//
+	//Interface
+	//
+
+	for (uint32_t variableId : variables)
+	{
+		const SpirvId&	variable		= ids[variableId];
+		uint32_t		storageClass	= variable.operands[1];
+
+		auto pointer = ids.find(variable.operands[0]);
+
+		if (pointer == ids.end() || pointer->second.opcode != OpTypePointer)
+			continue;
+
+		uint32_t typeId = pointer->second.operands[1];
+
+		if (storageClass == StorageClassPushConstant)
+		{
+			const SpirvId& block = ids[typeId];
+
+			uint32_t offset = block.memberOffsets.empty() ? 0 : *std::min_element(block.memberOffsets.begin(), block.memberOffsets.end());
+
+			VkPushConstantRange range{};
+
+			range.stageFlags	= p_reflection.stages;
+			range.offset		= offset;
+			range.size			= GetTypeSize(ids, typeId) - offset;
+
+			p_reflection.pushConstants.push_back(range);
+		}
+		else if (storageClass == StorageClassInput)
+		{
+			//gl_VertexIndex & co, and the gl_PerVertex block of the later stages
+			if (!(p_reflection.stages & VK_SHADER_STAGE_VERTEX_BIT) || variable.builtIn || ids[typeId].memberBuiltIn)
+				continue;
+
+			ShaderVertexInput input;
+
+			input.location	= variable.location;
+			input.format	= GetVertexInputFormat(ids, typeId, input.componentCount);
+
+			if (input.location == UINT32_MAX || input.format == VK_FORMAT_UNDEFINED)
+			{
+				std::cout << "[Reflection] vertex input " << variableId << " : only 32 bits scalars and vectors with a location are supported" << std::endl;
+				return false;
+			}
+
+			p_reflection.vertexInputs.push_back(input);
+		}
+		else if (variable.binding != UINT32_MAX)
+		{
+			ShaderBinding binding;
+
+			binding.set		= variable.set != UINT32_MAX ? variable.set : 0;
+			binding.binding = variable.binding;
+			binding.type	= GetDescriptorType(ids, storageClass, typeId, binding.count);
+			binding.stages	= p_reflection.stages;
+
+			if (binding.type == VK_DESCRIPTOR_TYPE_MAX_ENUM)
+			{
+				std::cout << "[Reflection] set " << binding.set << " binding " << binding.binding << " : unsupported resource type" << std::endl;
+				return false;
+			}
+
+			p_reflection.bindings.push_back(binding);
+		}
+	}
+
+	for (uint32_t constantId : specConstants)
+	{
+		const SpirvId& constant = ids[constantId];
+
+		auto type = ids.find(constant.resultType);
+
+		//Constants derived from others with OpSpecConstantOp have no SpecId
+		if (constant.specId == UINT32_MAX || type == ids.end())
+			continue;
+
+		const SpirvId& constantType = type->second;
+
+		ShaderSpecConstant specConstant;
+
+		specConstant.id = constant.specId;
+
+		if (constantType.opcode == OpTypeBool)
+			specConstant.type = SpecializationType::Bool;
+		else if (constantType.opcode == OpTypeFloat && constantType.operands[0] == 32)
+			specConstant.type = SpecializationType::Float;
+		else if (constantType.opcode == OpTypeInt && constantType.operands[0] == 32)
+			specConstant.type = constantType.operands[1] != 0 ? SpecializationType::Int : SpecializationType::UInt;
+		else
+			continue;
+
+		p_reflection.specConstants.push_back(specConstant);
+	}
+
+	std::sort(p_reflection.specConstants.begin(), p_reflection.specConstants.end(), [](const ShaderSpecConstant& p_a, const ShaderSpecConstant& p_b)
+	{
+		return p_a.id < p_b.id;
+	});
+
+	SortBindings(p_reflection.bindings);
+
+	std::sort(p_reflection.vertexInputs.begin(), p_reflection.vertexInputs.end(), [](const ShaderVertexInput& p_a, const ShaderVertexInput& p_b)
+	{
+		return p_a.location < p_b.location;
+	});
+
+	return p_reflection.stages != 0;
+}
+
+bool ShaderReflection::operator==(const ShaderReflection& p_other) const
+{
+	if (this->pushConstants.size() != p_other.pushConstants.size())
+		return false;
+
+	for (size_t i = 0; i < this->pushConstants.size(); i++)
+	{
+		const VkPushConstantRange& range		= this->pushConstants[i];
+		const VkPushConstantRange& otherRange	= p_other.pushConstants[i];
+
+		if (range.stageFlags != otherRange.stageFlags || range.offset != otherRange.offset || range.size != otherRange.size)
+			return false;
+	}
+
+	return this->stages == p_other.stages && this->bindings == p_other.bindings && this->vertexInputs == p_other.vertexInputs && this->specConstants == p_other.specConstants;
+}
+
+bool ShaderReflection::Merge(const ShaderReflection& p_other)
+{
+	for (const ShaderBinding& otherBinding : p_other.bindings)
+	{
+		auto binding = std::find_if(this->bindings.begin(), this->bindings.end(), [&otherBinding](const ShaderBinding& p_binding)
+		{
+			return p_binding.set == otherBinding.set && p_binding.binding == otherBinding.binding;
+		});
+
+		if (binding == this->bindings.end())
+		{
+			this->bindings.push_back(otherBinding);
+			continue;
+		}
+
+		if (binding->type != otherBinding.type || binding->count != otherBinding.count)
+		{
+			std::cout << "[Reflection] set " << binding->set << " binding " << binding->binding << " is declared differently by two stages" << std::endl;
+			return false;
+		}
+
+		binding->stages |= otherBinding.stages;
+	}
+
+	SortBindings(this->bindings);
+
+	//The same block in several stages becomes one range, a stage can't appear in two ranges
+	for (const VkPushConstantRange& otherRange : p_other.pushConstants)
+	{
+		auto range = std::find_if(this->pushConstants.begin(), this->pushConstants.end(), [&otherRange](const VkPushConstantRange& p_range)
+		{
+			return p_range.offset == otherRange.offset && p_range.size == otherRange.size;
+		});
+
+		if (range != this->pushConstants.end())
+			range->stageFlags |= otherRange.stageFlags;
+		else
+			this->pushConstants.push_back(otherRange);
+	}
+
+	if (this->vertexInputs.empty())
+		this->vertexInputs = p_other.vertexInputs;
+
+	this->stages |= p_other.stages;
+
+	return true;
+}
+
+std::vector<ShaderBinding> ShaderReflection::GetSetBindings(uint32_t p_set) const
+{
+	std::vector<ShaderBinding> setBindings;
+
+	for (const ShaderBinding& binding : this->bindings)
+	{
+		if (binding.set == p_set)
+			setBindings.push_back(binding);
+	}
+
+	return setBindings;
+}
+
+uint32_t ShaderReflection::GetSetCount() const
+{
+	uint32_t setCount = 0;
+
+	for (const ShaderBinding& binding : this->bindings)
+		setCount = std::max(setCount, binding.set + 1);
+
+	return setCount;
+}
+
+uint32_t ShaderReflection::FindMismatchedConstant(const SpecializationConstants& p_constants) const
+{
+	for (uint32_t i = 0; i < p_constants.GetCount(); i++)
+	{
+		auto constant = std::find_if(this->specConstants.begin(), this->specConstants.end(), [&p_constants, i](const ShaderSpecConstant& p_constant)
+		{
+			return p_constant.id == p_constants.GetId(i);
+		});
+
+		if (constant == this->specConstants.end() || constant->type != p_constants.GetType(i))
+			return i;
+	}
+
+	return UINT32_MAX;
+}
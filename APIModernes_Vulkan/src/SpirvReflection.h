@@ -0,0 +1,81 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "SpecializationConstants.h"
+
+struct ShaderBinding
+{
+	uint32_t			set		= 0;
+	uint32_t			binding = 0;
+	VkDescriptorType	type	= VK_DESCRIPTOR_TYPE_MAX_ENUM;
+	uint32_t			count	= 1;
+	VkShaderStageFlags	stages	= 0;
+
+	bool operator==(const ShaderBinding& p_other) const
+	{
+		return set == p_other.set && binding == p_other.binding && type == p_other.type && count == p_other.count && stages == p_other.stages;
+	}
+};
+
+//What the shader reads, the vertex buffer layout decides the fetch format
+struct ShaderVertexInput
+{
+	uint32_t location		= 0;
+	uint32_t componentCount = 0;
+	VkFormat format			= VK_FORMAT_UNDEFINED; //32 bits per component, the type the shader declares
+
+	bool operator==(const ShaderVertexInput& p_other) const
+	{
+		return location == p_other.location && componentCount == p_other.componentCount && format == p_other.format;
+	}
+};
+
+//A layout(constant_id) constant, only 32 bits ones can be specialized
+struct ShaderSpecConstant
+{
+	uint32_t			id		= 0;
+	SpecializationType	type	= SpecializationType::UInt;
+
+	bool operator==(const ShaderSpecConstant& p_other) const
+	{
+		return id == p_other.id && type == p_other.type;
+	}
+};
+
+//Interface of one shader, or of several once merged
+struct ShaderReflection
+{
+	VkShaderStageFlags				stages			= 0;
+	std::vector<ShaderBinding>		bindings;		//Sorted by set then binding
+	std::vector<VkPushConstantRange>	pushConstants;	//One range per stage that has a push constant block
+	std::vector<ShaderVertexInput>	vertexInputs;	//Vertex stage only, sorted by location
+	std::vector<ShaderSpecConstant>	specConstants;	//Sorted by id, not merged : the values are given per stage
+
+	bool operator==(const ShaderReflection& p_other) const;
+
+	//Bindings used by several stages get their stage flags combined. False when both declare the same binding differently
+	bool Merge(const ShaderReflection& p_other);
+
+	//Bindings of p_set, empty when the set isn't used
+	std::vector<ShaderBinding> GetSetBindings(uint32_t p_set) const;
+	//Highest set used + 1
+	uint32_t GetSetCount() const;
+
+	//Index in p_constants of the first one this shader doesn't declare, or declares with another type. UINT32_MAX when all match
+	uint32_t FindMismatchedConstant(const SpecializationConstants& p_constants) const;
+};
+
+//
+//Reads the interface of a SPIR-V module : descriptor bindings, push constant block, vertex shader inputs and specialization constants.
+//Only walks the declarations (decorations, types, global variables), the function bodies are skipped
+//
+class SpirvReflection
+{
+public:
+	//False when p_byteCode isn't SPIR-V, or declares something the engine can't bind (the reason is logged)
+	static bool Reflect(const std::vector<char>& p_byteCode, ShaderReflection& p_reflection);
+};
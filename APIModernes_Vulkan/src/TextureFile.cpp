@@ -0,0 +1,419 @@
+#include "TextureFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "Utils.h"
+
+constexpr uint8_t TextureFile::IDENTIFIER[12];
+
+#pragma region Data format descriptor
+//Khronos data format constants, only what the formats we know need
+enum DfdColorModel : uint32_t
+{
+	DFD_MODEL_RGBSDA	= 1,
+	DFD_MODEL_BC1A		= 128,
+	DFD_MODEL_BC3		= 130,
+	DFD_MODEL_BC4		= 131,
+	DFD_MODEL_BC5		= 132,
+	DFD_MODEL_BC7		= 134,
+	DFD_MODEL_ASTC		= 162
+};
+
+static constexpr uint32_t DFD_PRIMARIES_BT709	= 1;
+static constexpr uint32_t DFD_TRANSFER_LINEAR	= 1;
+static constexpr uint32_t DFD_TRANSFER_SRGB		= 2;
+static constexpr uint32_t DFD_QUALIFIER_LINEAR	= 0x10; //Channel not affected by the transfer function (alpha of sRGB formats)
+
+struct DfdSample
+{
+	uint32_t bitOffset;
+	uint32_t bitLength;
+	uint32_t channelType;
+	uint32_t upper;
+};
+
+static bool IsSrgb(VkFormat p_format)
+{
+	switch (p_format)
+	{
+	case VK_FORMAT_R8G8B8A8_SRGB:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		return true;
+	default:
+		//ASTC SRGB formats are the odd ones of each pair
+		return p_format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && p_format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK && (p_format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) % 2 == 1;
+	}
+}
+
+//Basic descriptor block, as 32 bits words including the leading dfdTotalSize
+static std::vector<uint32_t> BuildDataFormatDescriptor(VkFormat p_format, const FormatInfo& p_info)
+{
+	bool		srgb			= IsSrgb(p_format);
+	uint32_t	alphaQualifier	= srgb ? DFD_QUALIFIER_LINEAR : 0;
+	uint32_t	model;
+
+	std::vector<DfdSample> samples;
+
+	switch (p_format)
+	{
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SRGB:
+		model	= DFD_MODEL_RGBSDA;
+		samples = { { 0, 8, 0, 255 }, { 8, 8, 1, 255 }, { 16, 8, 2, 255 }, { 24, 8, 15 | alphaQualifier, 255 } };
+		break;
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		model	= DFD_MODEL_BC1A;
+		samples = { { 0, 64, 0, UINT32_MAX } };
+		break;
+	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		model	= DFD_MODEL_BC1A;
+		samples = { { 0, 64, 1, UINT32_MAX } };
+		break;
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+		model	= DFD_MODEL_BC3;
+		samples = { { 0, 64, 15 | alphaQualifier, UINT32_MAX }, { 64, 64, 0, UINT32_MAX } };
+		break;
+	case VK_FORMAT_BC4_UNORM_BLOCK:
+		model	= DFD_MODEL_BC4;
+		samples = { { 0, 64, 0, UINT32_MAX } };
+		break;
+	case VK_FORMAT_BC5_UNORM_BLOCK:
+		model	= DFD_MODEL_BC5;
+		samples = { { 0, 64, 0, UINT32_MAX }, { 64, 64, 1, UINT32_MAX } };
+		break;
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		model	= DFD_MODEL_BC7;
+		samples = { { 0, 128, 0, UINT32_MAX } };
+		break;
+	default:
+		model	= DFD_MODEL_ASTC;
+		samples = { { 0, 128, 0, UINT32_MAX } };
+		break;
+	}
+
+	uint32_t blockSize = 24 + 16 * (uint32_t)samples.size();
+
+	std::vector<uint32_t> words;
+
+	words.push_back(4 + blockSize);
+	words.push_back(0); //Khronos vendor, basic descriptor type
+	words.push_back(2 | (blockSize << 16)); //Version 1.3
+	words.push_back(model | (DFD_PRIMARIES_BT709 << 8) | ((srgb ? DFD_TRANSFER_SRGB : DFD_TRANSFER_LINEAR) << 16));
+	words.push_back((p_info.blockWidth - 1) | ((p_info.blockHeight - 1) << 8));
+	words.push_back(p_info.blockSize);
+	words.push_back(0);
+
+	for (const DfdSample& sample : samples)
+	{
+		words.push_back(sample.bitOffset | ((sample.bitLength - 1) << 16) | (sample.channelType << 24));
+		words.push_back(0);
+		words.push_back(0);
+		words.push_back(sample.upper);
+	}
+
+	return words;
+}
+#pragma endregion Data format descriptor
+
+bool TextureFile::GetFormatInfo(VkFormat p_format, FormatInfo& p_info)
+{
+	switch (p_format)
+	{
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SRGB:
+		p_info = { 1, 1, 4 };
+		return true;
+
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+	case VK_FORMAT_BC4_UNORM_BLOCK:
+		p_info = { 4, 4, 8 };
+		return true;
+
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+	case VK_FORMAT_BC5_UNORM_BLOCK:
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		p_info = { 4, 4, 16 };
+		return true;
+
+	default:
+		break;
+	}
+
+	//ASTC : UNORM/SRGB pairs in block size order, always 16 bytes
+	static const uint8_t ASTC_BLOCKS[14][2] = { { 4, 4 }, { 5, 4 }, { 5, 5 }, { 6, 5 }, { 6, 6 }, { 8, 5 }, { 8, 6 }, { 8, 8 }, { 10, 5 }, { 10, 6 }, { 10, 8 }, { 10, 10 }, { 12, 10 }, { 12, 12 } };
+
+	if (p_format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && p_format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK)
+	{
+		const uint8_t* block = ASTC_BLOCKS[(p_format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) / 2];
+
+		p_info = { block[0], block[1], 16 };
+		return true;
+	}
+
+	return false;
+}
+
+VkDeviceSize TextureFile::GetLevelSize(const FormatInfo& p_info, uint32_t p_width, uint32_t p_height)
+{
+	VkDeviceSize blocksX = (p_width + p_info.blockWidth - 1) / p_info.blockWidth;
+	VkDeviceSize blocksY = (p_height + p_info.blockHeight - 1) / p_info.blockHeight;
+
+	return blocksX * blocksY * p_info.blockSize;
+}
+
+bool TextureFile::Open(const char* p_filePath)
+{
+	this->Close();
+
+	if (!this->mFile.Open(p_filePath))
+		return false;
+
+	const uint8_t*	file		= (const uint8_t*)this->mFile.GetData();
+	size_t			fileSize	= this->mFile.GetSize();
+
+	Header header;
+
+	if (fileSize < sizeof(Header))
+	{
+		this->Close();
+		return false;
+	}
+
+	memcpy(&header, file, sizeof(Header));
+
+	FormatInfo formatInfo;
+
+	//Single 2D image only : no array, cube map or volume, no supercompression
+	bool valid = memcmp(header.identifier, IDENTIFIER, sizeof(IDENTIFIER)) == 0
+		&& header.pixelWidth > 0 && header.pixelHeight > 0 && header.pixelDepth == 0
+		&& header.layerCount <= 1 && header.faceCount == 1 && header.supercompressionScheme == 0
+		&& GetFormatInfo((VkFormat)header.vkFormat, formatInfo);
+
+	uint32_t levelCount = std::max(header.levelCount, 1u); //0 asks for runtime generation, we only use what is stored
+
+	//No level past 1x1, the image couldn't be created with them
+	if (!valid || levelCount > 32 || (std::max(header.pixelWidth, header.pixelHeight) >> (levelCount - 1)) == 0 || sizeof(Header) + levelCount * sizeof(LevelIndex) > fileSize)
+	{
+		this->Close();
+		return false;
+	}
+
+	//Key/value data is optional, a bad range only drops it
+	if (header.kvdByteLength > 0 && header.kvdByteOffset <= fileSize && header.kvdByteLength <= fileSize - header.kvdByteOffset)
+	{
+		this->mKeyValueData = file + header.kvdByteOffset;
+		this->mKeyValueSize = header.kvdByteLength;
+	}
+
+	std::vector<LevelIndex> levelIndices(levelCount);
+	memcpy(levelIndices.data(), file + sizeof(Header), levelCount * sizeof(LevelIndex));
+
+	uint64_t dataBegin	= UINT64_MAX;
+	uint64_t dataEnd	= 0;
+
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		const LevelIndex& index = levelIndices[level];
+
+		uint32_t width	= std::max(header.pixelWidth >> level, 1u);
+		uint32_t height = std::max(header.pixelHeight >> level, 1u);
+
+		//Also rejects truncated files and offsets that would wrap
+		if (index.byteLength != GetLevelSize(formatInfo, width, height) || index.byteOffset > fileSize || index.byteLength > fileSize - index.byteOffset || index.byteOffset % formatInfo.blockSize != 0)
+		{
+			this->Close();
+			return false;
+		}
+
+		dataBegin	= std::min(dataBegin, index.byteOffset);
+		dataEnd		= std::max(dataEnd, index.byteOffset + index.byteLength);
+	}
+
+	this->mLevels.resize(levelCount);
+
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		ImageLevel& imageLevel = this->mLevels[level];
+
+		imageLevel.offset	= levelIndices[level].byteOffset - dataBegin;
+		imageLevel.size		= levelIndices[level].byteLength;
+		imageLevel.width	= std::max(header.pixelWidth >> level, 1u);
+		imageLevel.height	= std::max(header.pixelHeight >> level, 1u);
+	}
+
+	this->mFormat	= (VkFormat)header.vkFormat;
+	this->mWidth	= header.pixelWidth;
+	this->mHeight	= header.pixelHeight;
+	this->mData		= file + dataBegin;
+	this->mDataSize = dataEnd - dataBegin;
+
+	return true;
+}
+
+void TextureFile::Close()
+{
+	this->mFile.Close();
+
+	this->mFormat	= VK_FORMAT_UNDEFINED;
+	this->mWidth	= 0;
+	this->mHeight	= 0;
+	this->mData		= nullptr;
+	this->mDataSize = 0;
+	this->mLevels.clear();
+
+	this->mKeyValueData = nullptr;
+	this->mKeyValueSize = 0;
+}
+
+bool TextureFile::FindKeyValue(const char* p_key, std::string& p_value) const
+{
+	size_t keyLength = strlen(p_key);
+
+	uint32_t offset = 0;
+
+	while (offset + 4 <= this->mKeyValueSize)
+	{
+		uint32_t length;
+		memcpy(&length, this->mKeyValueData + offset, 4);
+
+		if (length > this->mKeyValueSize - offset - 4)
+			return false;
+
+		const char* entry = (const char*)this->mKeyValueData + offset + 4;
+
+		//Key, its 0, then the value
+		if (length > keyLength && memcmp(entry, p_key, keyLength) == 0 && entry[keyLength] == '\0')
+		{
+			const char* value		= entry + keyLength + 1;
+			size_t		valueLength = length - keyLength - 1;
+
+			//Strings are stored with their terminator
+			if (valueLength > 0 && value[valueLength - 1] == '\0')
+				valueLength--;
+
+			p_value.assign(value, valueLength);
+
+			return true;
+		}
+
+		offset += 4 + ((length + 3) & ~3u);
+	}
+
+	return false;
+}
+
+bool TextureFile::Write(const char* p_filePath, VkFormat p_format, const uint8_t* p_data, const std::vector<ImageLevel>& p_levels, std::vector<std::pair<std::string, std::string>> p_keyValues)
+{
+	FormatInfo formatInfo;
+
+	if (p_levels.empty() || !GetFormatInfo(p_format, formatInfo))
+		return false;
+
+	//Every offset in the file is aligned to 4, levels to lcm(block size, 4)
+	auto align = [](uint64_t p_value, uint64_t p_alignment) { return (p_value + p_alignment - 1) / p_alignment * p_alignment; };
+
+	uint64_t levelAlignment = formatInfo.blockSize % 4 == 0 ? formatInfo.blockSize : formatInfo.blockSize * 4;
+
+	std::vector<uint32_t> dataFormatDescriptor = BuildDataFormatDescriptor(p_format, formatInfo);
+
+	//Entries are sorted by key, values are stored with their terminator
+	std::sort(p_keyValues.begin(), p_keyValues.end());
+
+	std::vector<uint8_t> keyValueData;
+
+	for (const std::pair<std::string, std::string>& keyValue : p_keyValues)
+	{
+		uint32_t length = uint32_t(keyValue.first.size() + 1 + keyValue.second.size() + 1);
+
+		keyValueData.insert(keyValueData.end(), (const uint8_t*)&length, (const uint8_t*)&length + 4);
+		keyValueData.insert(keyValueData.end(), keyValue.first.c_str(), keyValue.first.c_str() + keyValue.first.size() + 1);
+		keyValueData.insert(keyValueData.end(), keyValue.second.c_str(), keyValue.second.c_str() + keyValue.second.size() + 1);
+		keyValueData.resize((size_t)align(keyValueData.size(), 4), 0);
+	}
+
+	Header header{};
+
+	memcpy(header.identifier, IDENTIFIER, sizeof(IDENTIFIER));
+
+	header.vkFormat		= p_format;
+	header.typeSize		= 1; //Byte components or blocks, 1 for every format we know
+	header.pixelWidth	= p_levels[0].width;
+	header.pixelHeight	= p_levels[0].height;
+	header.faceCount	= 1;
+	header.levelCount	= (uint32_t)p_levels.size();
+	header.dfdByteOffset = uint32_t(sizeof(Header) + p_levels.size() * sizeof(LevelIndex));
+	header.dfdByteLength = uint32_t(dataFormatDescriptor.size() * 4);
+	header.kvdByteOffset = keyValueData.empty() ? 0 : header.dfdByteOffset + header.dfdByteLength;
+	header.kvdByteLength = (uint32_t)keyValueData.size();
+
+	//Smallest level first in the file
+	std::vector<LevelIndex> levelIndices(p_levels.size());
+
+	uint64_t offset = header.dfdByteOffset + header.dfdByteLength + header.kvdByteLength;
+
+	for (size_t level = p_levels.size(); level-- > 0;)
+	{
+		offset = align(offset, levelAlignment);
+
+		levelIndices[level].byteOffset				= offset;
+		levelIndices[level].byteLength				= p_levels[level].size;
+		levelIndices[level].uncompressedByteLength	= p_levels[level].size;
+
+		offset += p_levels[level].size;
+	}
+
+	std::string tmpPath = std::string(p_filePath) + ".tmp";
+
+	std::ofstream file = std::ofstream(tmpPath, std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+		return false;
+
+	const char padding[16] = {};
+
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)levelIndices.data(), levelIndices.size() * sizeof(LevelIndex));
+	file.write((const char*)dataFormatDescriptor.data(), dataFormatDescriptor.size() * 4);
+	file.write((const char*)keyValueData.data(), keyValueData.size());
+
+	uint64_t written = header.dfdByteOffset + header.dfdByteLength + header.kvdByteLength;
+
+	for (size_t level = p_levels.size(); level-- > 0;)
+	{
+		file.write(padding, levelIndices[level].byteOffset - written);
+		file.write((const char*)p_data + p_levels[level].offset, p_levels[level].size);
+
+		written = levelIndices[level].byteOffset + levelIndices[level].byteLength;
+	}
+
+	file.close();
+
+	if (file.fail())
+	{
+		std::remove(tmpPath.c_str());
+		return false;
+	}
+
+	if (!AtomicReplaceFile(tmpPath, p_filePath))
+	{
+		std::remove(tmpPath.c_str());
+		return false;
+	}
+
+	return true;
+}
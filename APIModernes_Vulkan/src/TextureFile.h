@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "vulkan/vulkan.h"
+
+#include "MappedFile.h"
+#include "VKUploadContext.h"
+
+//Size of one block of a format, 1x1 blocks for uncompressed formats
+struct FormatInfo
+{
+	uint32_t blockWidth		= 1;
+	uint32_t blockHeight	= 1;
+	uint32_t blockSize		= 0; //Bytes
+};
+
+//
+//KTX2 container holding a single 2D image and its pre-baked mips, mapped so the level data goes to staging without a copy.
+//Only uncompressed payloads (no BasisLZ / zstd supercompression) in a format GetFormatInfo() knows.
+//Write() produces the same kind of file, with a basic data format descriptor so other KTX2 tools can read it.
+//
+class TextureFile
+{
+public:
+	static constexpr uint8_t IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	struct Header
+	{
+		uint8_t		identifier[12];
+		uint32_t	vkFormat;
+		uint32_t	typeSize;
+		uint32_t	pixelWidth;
+		uint32_t	pixelHeight;
+		uint32_t	pixelDepth;
+		uint32_t	layerCount;
+		uint32_t	faceCount;
+		uint32_t	levelCount;
+		uint32_t	supercompressionScheme;
+		uint32_t	dfdByteOffset;
+		uint32_t	dfdByteLength;
+		uint32_t	kvdByteOffset;
+		uint32_t	kvdByteLength;
+		uint64_t	sgdByteOffset;
+		uint64_t	sgdByteLength;
+	};
+
+	struct LevelIndex
+	{
+		uint64_t byteOffset;
+		uint64_t byteLength;
+		uint64_t uncompressedByteLength;
+	};
+
+private:
+	MappedFile mFile;
+
+	VkFormat				mFormat		= VK_FORMAT_UNDEFINED;
+	uint32_t				mWidth		= 0;
+	uint32_t				mHeight		= 0;
+	const uint8_t*			mData		= nullptr; //First byte of the level data
+	VkDeviceSize			mDataSize	= 0;
+	std::vector<ImageLevel> mLevels;			   //Offsets relative to mData, level 0 first
+
+	const uint8_t*			mKeyValueData = nullptr;
+	uint32_t				mKeyValueSize = 0;
+
+public:
+	bool Open(const char* p_filePath);
+	void Close();
+
+	VkFormat						GetFormat()		const { return this->mFormat; }
+	uint32_t						GetWidth()		const { return this->mWidth; }
+	uint32_t						GetHeight()		const { return this->mHeight; }
+	const uint8_t*					GetData()		const { return this->mData; }
+	VkDeviceSize					GetDataSize()	const { return this->mDataSize; }
+	const std::vector<ImageLevel>&	GetLevels()		const { return this->mLevels; }
+
+	//Value of a key/value data entry, without its terminating 0
+	bool FindKeyValue(const char* p_key, std::string& p_value) const;
+
+	//p_data holds the levels at the offsets of p_levels (level 0 first, like GetLevels()). Written to a temporary file then renamed
+	static bool Write(const char* p_filePath, VkFormat p_format, const uint8_t* p_data, const std::vector<ImageLevel>& p_levels, std::vector<std::pair<std::string, std::string>> p_keyValues);
+
+	//False for formats textures can't be loaded as
+	static bool GetFormatInfo(VkFormat p_format, FormatInfo& p_info);
+
+	//Bytes of one level, whole blocks
+	static VkDeviceSize GetLevelSize(const FormatInfo& p_info, uint32_t p_width, uint32_t p_height);
+};
@@ -0,0 +1,443 @@
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "stb_image/stb_image.h"
+
+#include "BlockDecoder.h"
+#include "MipmapGenerator.h"
+
+static std::string GetCompressedPath(const std::string& p_filePath)
+{
+	size_t extension = p_filePath.find_last_of('.');
+	size_t separator = p_filePath.find_last_of("/\\");
+
+	if (extension == std::string::npos || (separator != std::string::npos && extension < separator))
+		return p_filePath + ".ktx2";
+
+	return p_filePath.substr(0, extension) + ".ktx2";
+}
+
+bool TextureStreamer::Init(VkPhysicalDevice p_physicalDevice, VkDevice p_logicalDevice, VKMemoryAllocator* p_allocator, VKUploadContext* p_uploadContext, uint32_t p_framesInFlight, VkDeviceSize p_uploadBudget, uint32_t p_threadCount)
+{
+	this->mPhysicalDevice	= p_physicalDevice;
+	this->mLogicalDevice	= p_logicalDevice;
+	this->mAllocator		= p_allocator;
+	this->mUploadContext	= p_uploadContext;
+	this->mFramesInFlight	= p_framesInFlight;
+	this->mUploadBudget		= p_uploadBudget;
+
+	//Mid grey, neutral under any lighting
+	const uint8_t placeholderTexel[4] = { 128, 128, 128, 255 };
+
+	ImageLevel placeholderLevel;
+
+	placeholderLevel.size	= sizeof(placeholderTexel);
+	placeholderLevel.width	= 1;
+	placeholderLevel.height = 1;
+
+	bool result = this->CreateImage(1, 1, 1, VK_FORMAT_R8G8B8A8_UNORM, this->mPlaceholderImage, this->mPlaceholderMemory);
+
+	result &= this->mUploadContext->UploadImageLevels(placeholderTexel, sizeof(placeholderTexel), this->mPlaceholderImage, &placeholderLevel, 1);
+
+	this->mPlaceholderView = this->CreateView(this->mPlaceholderImage, VK_FORMAT_R8G8B8A8_UNORM, 0, 1);
+
+	if (p_threadCount == 0)
+		p_threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+	for (uint32_t i = 0; i < p_threadCount; i++)
+		this->mWorkers.emplace_back(&TextureStreamer::WorkerLoop, this);
+
+	return result && this->mPlaceholderView != VK_NULL_HANDLE;
+}
+
+void TextureStreamer::Release()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mMutex);
+
+		this->mStopping = true;
+	}
+
+	this->mCondition.notify_all();
+
+	for (std::thread& worker : this->mWorkers)
+		worker.join();
+
+	this->mWorkers.clear();
+
+	for (std::unique_ptr<StreamedTexture>& texture : this->mTextures)
+	{
+		vkDestroyImageView(this->mLogicalDevice, texture->view, nullptr);
+		vkDestroyImage(this->mLogicalDevice, texture->image, nullptr);
+		this->mAllocator->Free(texture->memory);
+	}
+
+	for (const RetiredView& retired : this->mRetiredViews)
+		vkDestroyImageView(this->mLogicalDevice, retired.view, nullptr);
+
+	this->mTextures.clear();
+	this->mStreaming.clear();
+	this->mRetiredViews.clear();
+	this->mDecoded.clear();
+	this->mQueue.clear();
+
+	vkDestroyImageView(this->mLogicalDevice, this->mPlaceholderView, nullptr);
+	vkDestroyImage(this->mLogicalDevice, this->mPlaceholderImage, nullptr);
+	this->mAllocator->Free(this->mPlaceholderMemory);
+}
+
+TextureHandle TextureStreamer::Request(const char* p_filePath, bool p_srgb)
+{
+	TextureHandle handle = (TextureHandle)this->mTextures.size();
+
+	std::unique_ptr<StreamedTexture> texture(new StreamedTexture());
+
+	texture->handle			= handle;
+	texture->filePath		= p_filePath;
+	texture->srgb			= p_srgb;
+	texture->requestTime	= Clock::now();
+
+	{
+		std::lock_guard<std::mutex> lock(this->mMutex);
+
+		this->mQueue.push_back(texture.get());
+	}
+
+	this->mTextures.push_back(std::move(texture));
+	this->mCondition.notify_one();
+
+	return handle;
+}
+
+#pragma region Worker side
+void TextureStreamer::WorkerLoop()
+{
+	for (;;)
+	{
+		StreamedTexture* texture = nullptr;
+
+		{
+			std::unique_lock<std::mutex> lock(this->mMutex);
+
+			this->mCondition.wait(lock, [this] { return this->mStopping || !this->mQueue.empty(); });
+
+			if (this->mStopping)
+				return;
+
+			texture = this->mQueue.front();
+			this->mQueue.pop_front();
+		}
+
+		auto start = Clock::now();
+
+		this->Decode(*texture);
+
+		texture->decodeTime = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+		std::lock_guard<std::mutex> lock(this->mMutex);
+
+		this->mDecoded.push_back(texture->handle);
+	}
+}
+
+void TextureStreamer::Decode(StreamedTexture& p_texture)
+{
+	std::string compressedPath = GetCompressedPath(p_texture.filePath);
+
+	if (p_texture.file.Open(compressedPath.c_str()))
+	{
+		VkFormat fileFormat = p_texture.file.GetFormat();
+
+		//Blocks go straight from the mapped file to staging
+		if (this->CanSample(fileFormat))
+		{
+			p_texture.data		= p_texture.file.GetData();
+			p_texture.format	= fileFormat;
+			p_texture.levels	= p_texture.file.GetLevels();
+			p_texture.source	= compressedPath + ", format " + std::to_string(fileFormat);
+			p_texture.decoded	= true;
+			return;
+		}
+
+		VkFormat decodedFormat = BlockDecoder::CanDecode(fileFormat) ? BlockDecoder::GetDecodedFormat(fileFormat) : VK_FORMAT_UNDEFINED;
+
+		if (decodedFormat != VK_FORMAT_UNDEFINED && this->CanSample(decodedFormat))
+		{
+			const std::vector<ImageLevel>& fileLevels = p_texture.file.GetLevels();
+
+			p_texture.levels = fileLevels;
+
+			VkDeviceSize decodedSize = 0;
+
+			for (ImageLevel& level : p_texture.levels)
+			{
+				level.offset	= (decodedSize + 15) & ~VkDeviceSize(15);
+				level.size		= VkDeviceSize(level.width) * level.height * 4;
+				decodedSize		= level.offset + level.size;
+			}
+
+			p_texture.pixels.resize((size_t)decodedSize);
+
+			for (size_t i = 0; i < fileLevels.size(); i++)
+				BlockDecoder::Decode(fileFormat, p_texture.file.GetData() + fileLevels[i].offset, fileLevels[i].width, fileLevels[i].height, p_texture.pixels.data() + p_texture.levels[i].offset);
+
+			p_texture.data		= p_texture.pixels.data();
+			p_texture.format	= decodedFormat;
+			p_texture.source	= compressedPath + ", format " + std::to_string(fileFormat) + " unsupported, transcoded to " + std::to_string(decodedFormat);
+			p_texture.decoded	= true;
+
+			p_texture.file.Close();
+			return;
+		}
+
+		p_texture.file.Close();
+	}
+
+	int width, height, channels;
+	stbi_uc* pixels = stbi_load(p_texture.filePath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+	if (!pixels)
+	{
+		p_texture.source = p_texture.filePath + " : " + stbi_failure_reason();
+		return;
+	}
+
+	//Levels go up smallest first, before level 0 is even there : the chain is built here rather than blitted from it
+	MipmapGenerator::GenerateRgba8(pixels, (uint32_t)width, (uint32_t)height, p_texture.srgb, p_texture.pixels, p_texture.levels);
+
+	stbi_image_free(pixels);
+
+	p_texture.data		= p_texture.pixels.data();
+	p_texture.format	= p_texture.srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+	p_texture.source	= p_texture.filePath + ", mips built on the CPU";
+	p_texture.decoded	= true;
+}
+
+bool TextureStreamer::CanSample(VkFormat p_format) const
+{
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties(this->mPhysicalDevice, p_format, &formatProperties);
+
+	VkFormatFeatureFlags features = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+	return (formatProperties.optimalTilingFeatures & features) == features;
+}
+#pragma endregion Worker side
+
+bool TextureStreamer::CreateImage(uint32_t p_width, uint32_t p_height, uint32_t p_mipLevels, VkFormat p_format, VkImage& p_image, MemoryAllocation& p_memory)
+{
+	VkImageCreateInfo imageCreateInfo{};
+
+	imageCreateInfo.sType			= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageCreateInfo.imageType		= VK_IMAGE_TYPE_2D;
+	imageCreateInfo.extent			= { p_width, p_height, 1 };
+	imageCreateInfo.mipLevels		= p_mipLevels;
+	imageCreateInfo.arrayLayers		= 1;
+	imageCreateInfo.format			= p_format;
+	imageCreateInfo.tiling			= VK_IMAGE_TILING_OPTIMAL;
+	imageCreateInfo.initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED;
+	imageCreateInfo.usage			= VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	imageCreateInfo.samples			= VK_SAMPLE_COUNT_1_BIT;
+	imageCreateInfo.sharingMode		= VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateImage(this->mLogicalDevice, &imageCreateInfo, nullptr, &p_image) != VK_SUCCESS)
+		return false;
+
+	return this->mAllocator->AllocateForImage(p_image, VK_IMAGE_TILING_OPTIMAL, MemoryUsage::GpuOnly, p_memory);
+}
+
+VkImageView TextureStreamer::CreateView(VkImage p_image, VkFormat p_format, uint32_t p_baseLevel, uint32_t p_levelCount)
+{
+	VkImageViewCreateInfo imageViewCreateInfo{};
+
+	imageViewCreateInfo.sType							= VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	imageViewCreateInfo.image							= p_image;
+	imageViewCreateInfo.viewType						= VK_IMAGE_VIEW_TYPE_2D;
+	imageViewCreateInfo.format							= p_format;
+	imageViewCreateInfo.subresourceRange.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+	imageViewCreateInfo.subresourceRange.baseMipLevel	= p_baseLevel;
+	imageViewCreateInfo.subresourceRange.levelCount		= p_levelCount;
+	imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+	imageViewCreateInfo.subresourceRange.layerCount		= 1;
+
+	VkImageView imageView = VK_NULL_HANDLE;
+
+	vkCreateImageView(this->mLogicalDevice, &imageViewCreateInfo, nullptr, &imageView);
+
+	return imageView;
+}
+
+void TextureStreamer::StartStreaming(TextureHandle p_handle)
+{
+	StreamedTexture& texture = *this->mTextures[p_handle];
+
+	float waitTime = std::chrono::duration<float, std::milli>(Clock::now() - texture.requestTime).count();
+
+	if (!texture.decoded)
+	{
+		std::cout << "[Streaming] " << texture.source << ", keeping the placeholder" << std::endl;
+
+		texture.state = State::Failed;
+		return;
+	}
+
+	std::cout << "[Streaming] " << texture.source << " : " << texture.levels[0].width << "x" << texture.levels[0].height << ", " << texture.levels.size() << " levels decoded in " << texture.decodeTime << " ms (" << waitTime << " ms after the request)" << std::endl;
+
+	if (!this->CreateImage(texture.levels[0].width, texture.levels[0].height, (uint32_t)texture.levels.size(), texture.format, texture.image, texture.memory))
+	{
+		std::cout << "[Streaming] " << texture.filePath << " : image creation failed, keeping the placeholder" << std::endl;
+
+		texture.state = State::Failed;
+		return;
+	}
+
+	texture.state			= State::Decoded;
+	texture.residentLevel	= (uint32_t)texture.levels.size();
+
+	this->mStreaming.push_back(p_handle);
+}
+
+VkDeviceSize TextureStreamer::StreamLevels(StreamedTexture& p_texture, VkDeviceSize p_budget, bool p_forceOne)
+{
+	VkDeviceSize uploaded = 0;
+
+	uint32_t levelCount		= (uint32_t)p_texture.levels.size();
+	uint32_t residentLevel	= p_texture.residentLevel;
+
+	while (residentLevel > 0)
+	{
+		const ImageLevel& level = p_texture.levels[residentLevel - 1];
+
+		if (uploaded + level.size > p_budget && !(p_forceOne && uploaded == 0))
+			break;
+
+		ImageLevel stagedLevel = level;
+		stagedLevel.offset = 0;
+
+		if (!this->mUploadContext->UploadImageLevels(p_texture.data + level.offset, level.size, p_texture.image, &stagedLevel, 1, residentLevel - 1))
+			break;
+
+		uploaded += level.size;
+		residentLevel--;
+	}
+
+	if (residentLevel == p_texture.residentLevel)
+		return 0;
+
+	//The new levels are recorded in this frame's batch, which is submitted before the frame that will sample them
+	if (p_texture.view != VK_NULL_HANDLE)
+		this->mRetiredViews.push_back({ p_texture.view, this->mFrameIndex });
+
+	p_texture.residentLevel = residentLevel;
+	p_texture.view			= this->CreateView(p_texture.image, p_texture.format, residentLevel, levelCount - residentLevel);
+	p_texture.version++;
+
+	float elapsed = std::chrono::duration<float, std::milli>(Clock::now() - p_texture.requestTime).count();
+
+	if (p_texture.state == State::Decoded)
+	{
+		std::cout << "[Streaming] " << p_texture.filePath << " : first " << levelCount - residentLevel << " levels (" << p_texture.levels[residentLevel].width << "x" << p_texture.levels[residentLevel].height << ") visible " << elapsed << " ms after the request" << std::endl;
+
+		p_texture.state = State::Streaming;
+	}
+
+	if (residentLevel == 0)
+	{
+		std::cout << "[Streaming] " << p_texture.filePath << " : fully resident " << elapsed << " ms after the request" << std::endl;
+
+		//Everything is in staging already
+		p_texture.state = State::Resident;
+		p_texture.file.Close();
+		p_texture.pixels.clear();
+		p_texture.pixels.shrink_to_fit();
+		p_texture.data = nullptr;
+	}
+
+	return uploaded;
+}
+
+void TextureStreamer::Update()
+{
+	this->mFrameIndex++;
+
+	//A view replaced during frame N was last bound by frame N - 1 : once mFramesInFlight more frames passed their fence wait, nothing uses it
+	auto retired = std::remove_if(this->mRetiredViews.begin(), this->mRetiredViews.end(), [this](const RetiredView& p_retired)
+	{
+		if (p_retired.frame + this->mFramesInFlight > this->mFrameIndex)
+			return false;
+
+		vkDestroyImageView(this->mLogicalDevice, p_retired.view, nullptr);
+		return true;
+	});
+
+	this->mRetiredViews.erase(retired, this->mRetiredViews.end());
+
+	std::vector<TextureHandle> decoded;
+
+	{
+		std::lock_guard<std::mutex> lock(this->mMutex);
+
+		decoded.swap(this->mDecoded);
+	}
+
+	for (TextureHandle handle : decoded)
+		this->StartStreaming(handle);
+
+	//Oldest requests first, each one gets at least a level per frame so large levels can't stall
+	VkDeviceSize budget = this->mUploadBudget;
+
+	for (TextureHandle handle : this->mStreaming)
+	{
+		StreamedTexture& texture = *this->mTextures[handle];
+
+		VkDeviceSize uploaded = this->StreamLevels(texture, budget, true);
+
+		budget -= std::min(budget, uploaded);
+	}
+
+	auto resident = std::remove_if(this->mStreaming.begin(), this->mStreaming.end(), [this](TextureHandle p_handle)
+	{
+		return this->mTextures[p_handle]->state == State::Resident;
+	});
+
+	this->mStreaming.erase(resident, this->mStreaming.end());
+
+	this->mUploadContext->Submit();
+}
+
+void TextureStreamer::PatchDescriptor(TextureHandle p_handle, VkDescriptorSet p_set, uint32_t p_binding, VkSampler p_sampler, uint32_t& p_version)
+{
+	const StreamedTexture& texture = *this->mTextures[p_handle];
+
+	if (p_version == texture.version)
+		return;
+
+	VkDescriptorImageInfo descriptorImageInfo{};
+
+	descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	descriptorImageInfo.imageView	= this->GetView(p_handle);
+	descriptorImageInfo.sampler		= p_sampler;
+
+	VkWriteDescriptorSet writeDescriptorSet{};
+
+	writeDescriptorSet.sType			= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	writeDescriptorSet.dstSet			= p_set;
+	writeDescriptorSet.dstBinding		= p_binding;
+	writeDescriptorSet.dstArrayElement	= 0;
+	writeDescriptorSet.descriptorType	= VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	writeDescriptorSet.descriptorCount	= 1;
+	writeDescriptorSet.pImageInfo		= &descriptorImageInfo;
+
+	vkUpdateDescriptorSets(this->mLogicalDevice, 1, &writeDescriptorSet, 0, nullptr);
+
+	p_version = texture.version;
+}
+
+VkImageView TextureStreamer::GetView(TextureHandle p_handle) const
+{
+	VkImageView view = this->mTextures[p_handle]->view;
+
+	return view != VK_NULL_HANDLE ? view : this->mPlaceholderView;
+}
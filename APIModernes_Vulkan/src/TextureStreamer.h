@@ -0,0 +1,133 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TextureFile.h"
+#include "VKMemoryAllocator.h"
+#include "VKUploadContext.h"
+
+typedef uint32_t TextureHandle;
+
+//
+//Background texture loading : files are read, transcoded and mip-mapped on worker threads, the render thread only uploads.
+//Levels go up smallest first under a per frame byte budget, the view of a texture grows one level at a time as they become
+//resident and a 1x1 placeholder stands in until the first ones are there.
+//Views change while frames are in flight, so descriptor sets are patched one frame at a time right before they're recorded
+//and old views are only destroyed once every frame that may have bound them is done.
+//
+class TextureStreamer
+{
+public:
+	enum class State
+	{
+		Queued,		//Waiting for a worker
+		Decoded,	//CPU data ready and image created, no level resident yet
+		Streaming,	//Some levels resident
+		Resident,	//Every level resident, CPU data freed
+		Failed		//Keeps the placeholder
+	};
+
+private:
+	using Clock = std::chrono::high_resolution_clock;
+
+	struct StreamedTexture
+	{
+		TextureHandle	handle = 0;
+		std::string		filePath;
+		bool			srgb = true;
+
+		//Written by the worker that decodes it, read by the render thread once it's in mDecoded
+		TextureFile				file;		//Kept mapped when its blocks are uploaded as is
+		std::vector<uint8_t>	pixels;		//Decoded or transcoded chain otherwise
+		const uint8_t*			data		= nullptr;
+		VkFormat				format		= VK_FORMAT_UNDEFINED;
+		std::vector<ImageLevel>	levels;		//Level 0 first, offsets relative to data
+		std::string				source;		//What the worker did, logged by the render thread
+		float					decodeTime	= 0.0f;
+		bool					decoded		= false;
+
+		//Render thread only
+		State				state			= State::Queued;
+		VkImage				image			= VK_NULL_HANDLE;
+		MemoryAllocation	memory;
+		uint32_t			residentLevel	= 0;	//First resident mip, levels.size() when none is
+		VkImageView			view			= VK_NULL_HANDLE;
+		uint32_t			version			= 0;	//Bumped every time view changes
+		Clock::time_point	requestTime;
+	};
+
+	struct RetiredView
+	{
+		VkImageView view;
+		uint64_t	frame;
+	};
+
+	VkPhysicalDevice	mPhysicalDevice = VK_NULL_HANDLE;
+	VkDevice			mLogicalDevice	= VK_NULL_HANDLE;
+	VKMemoryAllocator*	mAllocator		= nullptr;
+	VKUploadContext*	mUploadContext	= nullptr;
+
+	uint32_t		mFramesInFlight = 1;
+	VkDeviceSize	mUploadBudget	= 0;
+	uint64_t		mFrameIndex		= 0;
+
+	std::vector<std::unique_ptr<StreamedTexture>>	mTextures;	//Indexed by TextureHandle
+	std::vector<TextureHandle>						mStreaming;	//Request order
+	std::vector<RetiredView>						mRetiredViews;
+
+	VkImage				mPlaceholderImage = VK_NULL_HANDLE;
+	MemoryAllocation	mPlaceholderMemory;
+	VkImageView			mPlaceholderView  = VK_NULL_HANDLE;
+
+	//Worker side
+	std::vector<std::thread>		mWorkers;
+	std::mutex						mMutex;
+	std::condition_variable			mCondition;
+	std::deque<StreamedTexture*>	mQueue;
+	std::vector<TextureHandle>		mDecoded;
+	bool							mStopping = false;
+
+private:
+	void WorkerLoop();
+	void Decode(StreamedTexture& p_texture);
+
+	//The device samples p_format with a linear filter
+	bool CanSample(VkFormat p_format) const;
+
+	bool CreateImage(uint32_t p_width, uint32_t p_height, uint32_t p_mipLevels, VkFormat p_format, VkImage& p_image, MemoryAllocation& p_memory);
+	VkImageView CreateView(VkImage p_image, VkFormat p_format, uint32_t p_baseLevel, uint32_t p_levelCount);
+
+	void StartStreaming(TextureHandle p_handle);
+	//Uploads as many of the missing levels as p_budget allows, at least one when p_forceOne. Returns the bytes uploaded
+	VkDeviceSize StreamLevels(StreamedTexture& p_texture, VkDeviceSize p_budget, bool p_forceOne);
+
+public:
+	//p_threadCount = 0 : every core but one
+	bool Init(VkPhysicalDevice p_physicalDevice, VkDevice p_logicalDevice, VKMemoryAllocator* p_allocator, VKUploadContext* p_uploadContext, uint32_t p_framesInFlight, VkDeviceSize p_uploadBudget, uint32_t p_threadCount = 0);
+	//The device must be idle
+	void Release();
+
+	//A .ktx2 next to p_filePath is preferred when it exists and the device can use it. p_srgb only applies to the image file
+	TextureHandle Request(const char* p_filePath, bool p_srgb = true);
+
+	//Once per frame, after the frame's fence wait and before its command buffer is recorded.
+	//Records and submits this frame's uploads, the frame being prepared may already sample them
+	void Update();
+
+	//Writes the texture's current view to p_binding of p_set when it changed since p_version.
+	//p_set must not be in use by the GPU, which holds for the set of the frame being prepared
+	void PatchDescriptor(TextureHandle p_handle, VkDescriptorSet p_set, uint32_t p_binding, VkSampler p_sampler, uint32_t& p_version);
+
+	VkImageView GetView(TextureHandle p_handle) const;
+	uint32_t	GetVersion(TextureHandle p_handle) const { return this->mTextures[p_handle]->version; }
+	State		GetState(TextureHandle p_handle) const { return this->mTextures[p_handle]->state; }
+};
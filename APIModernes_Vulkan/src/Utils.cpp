@@ -1,4 +1,16 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
 
 #include "Utils.h"
 
@@ -20,3 +32,193 @@ std::vector<char> ParseShaderFile(const char* p_fileName)
 
 	return parsedFile;
 }
+
+uint64_t HashBytes(const void* p_data, size_t p_size, uint64_t p_seed)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(p_data);
+
+	uint64_t hash = p_seed;
+
+	for (size_t i = 0; i < p_size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001B3ull;
+	}
+
+	return hash;
+}
+
+bool AtomicReplaceFile(const std::string& p_source, const std::string& p_target)
+{
+#ifdef _WIN32
+	return MoveFileExA(p_source.c_str(), p_target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	return std::rename(p_source.c_str(), p_target.c_str()) == 0;
+#endif
+}
+
+const char* GetPresentModeName(VkPresentModeKHR p_presentMode)
+{
+	switch (p_presentMode)
+	{
+	case VK_PRESENT_MODE_IMMEDIATE_KHR:		return "IMMEDIATE";
+	case VK_PRESENT_MODE_MAILBOX_KHR:		return "MAILBOX";
+	case VK_PRESENT_MODE_FIFO_KHR:			return "FIFO";
+	case VK_PRESENT_MODE_FIFO_RELAXED_KHR:	return "FIFO_RELAXED";
+	default:								return "UNKNOWN";
+	}
+}
+
+//Value of "--p_name=value", nullptr when p_argument is another option
+static const char* GetOptionValue(const char* p_argument, const char* p_name)
+{
+	size_t length = strlen(p_name);
+
+	if (strncmp(p_argument, p_name, length) != 0 || p_argument[length] != '=')
+		return nullptr;
+
+	return p_argument + length + 1;
+}
+
+//The capture pattern is handed to snprintf with the frame number : exactly one %u or %0Nu, any other % written %%
+static bool IsValidCapturePattern(const std::string& p_pattern)
+{
+	uint32_t frameNumbers = 0;
+
+	for (size_t c = 0; c < p_pattern.size(); c++)
+	{
+		if (p_pattern[c] != '%')
+			continue;
+
+		c++;
+
+		if (c < p_pattern.size() && p_pattern[c] == '%')
+			continue;
+
+		//Zero padded width
+		if (c < p_pattern.size() && p_pattern[c] == '0')
+		{
+			c++;
+
+			while (c < p_pattern.size() && isdigit((unsigned char)p_pattern[c]))
+				c++;
+		}
+
+		if (c >= p_pattern.size() || p_pattern[c] != 'u')
+			return false;
+
+		frameNumbers++;
+	}
+
+	return frameNumbers == 1;
+}
+
+void ParseCommandLine(int p_argc, char** p_argv, FramePacing& p_pacing, HeadlessSettings& p_headless, CaptureSettings& p_capture)
+{
+	for (int i = 1; i < p_argc; i++)
+	{
+		const char* argument	= p_argv[i];
+		const char* value		= nullptr;
+
+		if ((value = GetOptionValue(argument, "--frames-in-flight")))
+		{
+			p_pacing.framesInFlight = (uint32_t)strtoul(value, nullptr, 10);
+		}
+		else if ((value = GetOptionValue(argument, "--present-mode")))
+		{
+			const VkPresentModeKHR presentModes[] = { VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR };
+
+			bool found = false;
+
+			for (VkPresentModeKHR presentMode : presentModes)
+			{
+				//Case insensitive, "mailbox" or "MAILBOX"
+				const char* name = GetPresentModeName(presentMode);
+
+				size_t c = 0;
+
+				while (name[c] && toupper((unsigned char)value[c]) == name[c])
+					c++;
+
+				if (!name[c] && !value[c])
+				{
+					p_pacing.presentMode	= presentMode;
+					found					= true;
+				}
+			}
+
+			if (!found)
+				std::cout << "[FramePacing] unknown present mode " << value << ", FIFO, FIFO_RELAXED, MAILBOX or IMMEDIATE" << std::endl;
+		}
+		else if (strcmp(argument, "--wait-before-input") == 0)
+		{
+			p_pacing.waitBeforeInput = true;
+		}
+		else if ((value = GetOptionValue(argument, "--frame-stats")))
+		{
+			p_pacing.statsInterval = (uint32_t)strtoul(value, nullptr, 10);
+		}
+		else if (strcmp(argument, "--headless") == 0)
+		{
+			p_headless.enabled = true;
+		}
+		else if ((value = GetOptionValue(argument, "--frames")))
+		{
+			p_headless.frameCount = std::max((uint32_t)strtoul(value, nullptr, 10), 1u);
+		}
+		else if ((value = GetOptionValue(argument, "--output")))
+		{
+			p_headless.outputPath = value;
+		}
+		else if ((value = GetOptionValue(argument, "--capture")))
+		{
+			p_capture.outputPattern = value;
+		}
+		else
+		{
+			std::cout << "[CommandLine] unknown option " << argument << std::endl;
+		}
+	}
+
+	if (p_pacing.framesInFlight < 1 || p_pacing.framesInFlight > 3)
+	{
+		std::cout << "[FramePacing] " << p_pacing.framesInFlight << " frames in flight out of [1, 3], clamped" << std::endl;
+
+		p_pacing.framesInFlight = std::min(std::max(p_pacing.framesInFlight, 1u), 3u);
+	}
+
+	if (p_capture.IsEnabled() && !IsValidCapturePattern(p_capture.outputPattern))
+	{
+		std::cout << "[Capture] " << p_capture.outputPattern << " needs exactly one %u or %0Nu for the frame number and %% for any other %, capture disabled" << std::endl;
+
+		p_capture.outputPattern.clear();
+	}
+}
+
+bool WriteImagePPM(const char* p_filePath, const uint8_t* p_pixels, uint32_t p_width, uint32_t p_height, uint32_t p_rowPitch, bool p_bgra)
+{
+	std::ofstream file(p_filePath, std::ios::binary);
+
+	file << "P6\n" << p_width << " " << p_height << "\n255\n";
+
+	std::vector<uint8_t> row(p_width * 3);
+
+	uint32_t red	= p_bgra ? 2 : 0;
+	uint32_t blue	= p_bgra ? 0 : 2;
+
+	for (uint32_t y = 0; y < p_height; y++)
+	{
+		const uint8_t* pixel = p_pixels + (size_t)y * p_rowPitch;
+
+		for (uint32_t x = 0; x < p_width; x++, pixel += 4)
+		{
+			row[x * 3]		= pixel[red];
+			row[x * 3 + 1]	= pixel[1];
+			row[x * 3 + 2]	= pixel[blue];
+		}
+
+		file.write(reinterpret_cast<const char*>(row.data()), row.size());
+	}
+
+	return file.good();
+}
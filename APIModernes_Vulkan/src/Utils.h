@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstdint>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "glm/glm.hpp"
@@ -8,6 +10,8 @@
 
 #include "vulkan/vulkan.h"
 
+#include "VKMemoryAllocator.h"
+
 #pragma region App Parameters
 
 #define APP_NAME	"API Graphiques modernes : vulkan"
@@ -25,6 +29,42 @@
 #define ENGINE_VERSION_PATCH	0	
 
 #define MODEL_PATH "models/model.obj"
+#define SPLIT_LARGE_MESHES 0 //Meshes over 65536 vertices : 1 = 16 bits sub-meshes, 0 = one 32 bits draw
+#define VERTEX_FORMAT VertexFormat::Packed16 //Float32 : 32 bytes per vertex, Packed16 : 16 bytes
+
+#define STAGING_RING_SIZE (32ull * 1024 * 1024)
+
+#define TEXTURE_PATH "textures/texture.png" //The .ktx2 of the same name is used instead when it exists
+#define STREAMING_UPLOAD_BUDGET (4ull * 1024 * 1024) //Texture bytes uploaded per frame, a texture always gets at least one level
+#define STREAMING_THREAD_COUNT 0 //Texture decoding threads, 0 = every core but one
+
+#define MIPMAP_BENCHMARK 0 //1 = time the CPU and GPU mip generation on the texture at startup
+
+#define PIPELINE_CACHE_PATH "pipeline.cache"
+#define PIPELINE_CACHE_MAX_SIZE (32ull * 1024 * 1024) //Bigger caches are neither loaded nor saved
+#define PIPELINE_CACHE_BENCHMARK 0 //1 = also time the pipeline creation without cache at startup
+#define PIPELINE_COMPILE_THREAD_COUNT 0 //Pipeline compilation threads, 0 = every core but one
+
+#define FRAMES_IN_FLIGHT 2 //1 to 3 : more keeps the GPU busier, fewer lowers the latency. --frames-in-flight=N
+#define PRESENT_MODE VK_PRESENT_MODE_FIFO_KHR //FIFO, FIFO_RELAXED, MAILBOX or IMMEDIATE, FIFO when the surface lacks it. --present-mode=mailbox
+#define WAIT_BEFORE_INPUT 0 //1 = wait for the frame in flight before polling input rather than after, the input is fresher. --wait-before-input
+#define FRAME_STATS_INTERVAL 0 //Frames between two printed timing reports, 0 = none. --frame-stats=N
+
+#define HEADLESS 0 //1 = no window, surface nor swapchain : renders offscreen and writes the last frame to HEADLESS_OUTPUT. --headless
+#define HEADLESS_FRAME_COUNT 1 //Frames rendered once everything is loaded, animated at a fixed 60 Hz step. --frames=N
+#define HEADLESS_OUTPUT "frame.ppm" //--output=path
+
+#define CAPTURE_OUTPUT "" //Every frame is read back in the background and written as a PPM to this pattern of the frame number, "capture/frame_%06u.ppm", empty = none. --capture=pattern
+
+#define RENDER_GRAPH_DUMP 0 //1 = print the passes, barriers and memory aliasing the render graph compiles on the first frame
+
+#define SHADER_DIRECTORY "./shaders"
+#define SHADER_HOT_RELOAD 0 //1 = sources saved in SHADER_DIRECTORY are recompiled and the pipelines using them rebuilt, needs glslc
+#ifdef _WIN32
+#define SHADER_COMPILER "%VK_SDK_PATH%/Bin/glslc.exe"
+#else
+#define SHADER_COMPILER "glslc"
+#endif
 
 #pragma endregion App Parameters
 
@@ -39,6 +79,25 @@ struct Vertex
 	}
 };
 
+enum class VertexFormat : uint32_t
+{
+	Float32,	//Vertex
+	Packed16	//PackedVertex
+};
+
+//Half the size of Vertex, the vertex fetch turns every field back into floats so shaders read both the same way
+struct PackedVertex
+{
+	int16_t		pos[4];			//snorm16 inside the mesh bounds, w = 1
+	uint8_t		color[4];		//unorm8
+	uint16_t	textCoords[2];	//half
+};
+
+inline uint32_t GetVertexStride(VertexFormat p_format)
+{
+	return p_format == VertexFormat::Packed16 ? sizeof(PackedVertex) : sizeof(Vertex);
+}
+
 namespace std {
 	template<> struct hash<Vertex> {
 		size_t operator()(Vertex const& vertex) const {
@@ -62,11 +121,17 @@ struct DeviceSupportedQueues
 {
 	uint32_t graphicsFamily = UINT32_MAX;
 	uint32_t presentFamily	= UINT32_MAX;
+	uint32_t transferFamily = UINT32_MAX; //Optional, family without graphics for uploads
 	
 	bool isComplete()
 	{
 		return (graphicsFamily != UINT32_MAX) && (presentFamily != UINT32_MAX);
 	}
+
+	bool hasTransferFamily()
+	{
+		return transferFamily != UINT32_MAX;
+	}
 };
 
 struct SwapChainCapabilities
@@ -100,27 +165,71 @@ struct SwapChainDescription
 
 	std::vector<VkImage>		images;
 	std::vector<VkImageView>	imageViews;
+};
 
-	std::vector<VkFramebuffer>	frameBuffers;
+//Latency against throughput, picked per deployment
+struct FramePacing
+{
+	uint32_t			framesInFlight	= FRAMES_IN_FLIGHT;
+	VkPresentModeKHR	presentMode		= PRESENT_MODE;
+	bool				waitBeforeInput = WAIT_BEFORE_INPUT != 0;
+	uint32_t			statsInterval	= FRAME_STATS_INTERVAL;
 };
 
-struct GraphicPipelineDescription
+//Same frames on every run : everything is loaded before the first one and the animation doesn't follow the clock
+struct HeadlessSettings
 {
-	std::vector<VkPipelineShaderStageCreateInfo> mShaderStages;
+	bool		enabled		= HEADLESS != 0;
+	uint32_t	frameCount	= HEADLESS_FRAME_COUNT;
+	std::string outputPath	= HEADLESS_OUTPUT;
+};
 
-	VkPipelineLayout	vkPipelineLayout;
-	VkRenderPass		vkRenderPass;
-	VkPipeline			vkPipeline;
+//Frames read back while rendering, windowed they're dropped rather than slowing the frame rate down, headless none is
+struct CaptureSettings
+{
+	std::string outputPattern = CAPTURE_OUTPUT; //printf pattern taking the frame number : one %u or %0Nu, other % written %%
 
-	const int MAX_CONCURENT_FRAMES = 2; //Would like this parametrable !
+	bool IsEnabled() const { return !this->outputPattern.empty(); }
 };
 
-struct DepthRessources
+struct GraphicPipelineDescription
 {
-	VkImage			depthImage;
-	VkDeviceMemory	depthMemory;
-	VkImageView		depthImageView;
+	VkPipelineLayout	vkPipelineLayout;
+	VkRenderPass		vkRenderPass; //Owned by the render graph
+
+	uint32_t framesInFlight = FRAMES_IN_FLIGHT; //From the frame pacing, fixed once the renderer is initialized
 };
+
 #pragma endregion Vulkan Renderer
 
-std::vector<char> ParseShaderFile(const char* p_fileName);
\ No newline at end of file
+std::vector<char> ParseShaderFile(const char* p_fileName);
+
+//FNV-1a 64, p_seed chains calls. Good enough to notice a changed file, not to resist collisions on purpose
+uint64_t HashBytes(const void* p_data, size_t p_size, uint64_t p_seed = 0xCBF29CE484222325ull);
+
+//Runs p_function(thread) on p_threadCount threads, the caller being thread 0
+template<typename Function>
+void RunOnThreads(uint32_t p_threadCount, const Function& p_function)
+{
+	std::vector<std::thread> threads;
+
+	for (uint32_t i = 1; i < p_threadCount; i++)
+		threads.emplace_back(p_function, i);
+
+	p_function(0);
+
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
+//Replaces p_target by p_source in one step, readers and crashes see either the old file or the new one, never a missing or half written one.
+//Not ReplaceFile() : windows.h defines it as a macro
+bool AtomicReplaceFile(const std::string& p_source, const std::string& p_target);
+
+const char* GetPresentModeName(VkPresentModeKHR p_presentMode);
+
+//The App Parameters defaults, overridden by the command line options next to them. Unknown options are logged and ignored
+void ParseCommandLine(int p_argc, char** p_argv, FramePacing& p_pacing, HeadlessSettings& p_headless, CaptureSettings& p_capture);
+
+//Binary PPM, RGB without the alpha. p_pixels are 8 bits RGBA, or BGRA with p_bgra (most swapchains)
+bool WriteImagePPM(const char* p_filePath, const uint8_t* p_pixels, uint32_t p_width, uint32_t p_height, uint32_t p_rowPitch, bool p_bgra = false);
\ No newline at end of file
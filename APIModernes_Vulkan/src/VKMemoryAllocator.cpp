@@ -0,0 +1,688 @@
+#include "VKMemoryAllocator.h"
+
+#include <algorithm>
+
+#pragma region Helpers
+
+inline VkDeviceSize AlignUp(VkDeviceSize p_value, VkDeviceSize p_alignment)
+{
+	return (p_value + p_alignment - 1) & ~(p_alignment - 1);
+}
+
+inline VkDeviceSize AlignDown(VkDeviceSize p_value, VkDeviceSize p_alignment)
+{
+	return p_value & ~(p_alignment - 1);
+}
+
+inline uint32_t CountBits(uint32_t p_value)
+{
+	uint32_t count = 0;
+
+	for (; p_value; p_value &= p_value - 1)
+		count++;
+
+	return count;
+}
+
+inline VkDeviceSize NextPowerOfTwo(VkDeviceSize p_value)
+{
+	VkDeviceSize result = 1;
+
+	while (result < p_value)
+		result <<= 1;
+
+	return result;
+}
+
+inline VkDeviceSize PreviousPowerOfTwo(VkDeviceSize p_value)
+{
+	VkDeviceSize result = 1;
+
+	while ((result << 1) <= p_value)
+		result <<= 1;
+
+	return result;
+}
+
+//Same test as the spec : resource A ends on the page resource B starts on
+inline bool OnSamePage(VkDeviceSize p_endA, VkDeviceSize p_startB, VkDeviceSize p_pageSize)
+{
+	return (p_endA & ~(p_pageSize - 1)) >= (p_startB & ~(p_pageSize - 1));
+}
+
+#pragma endregion Helpers
+
+#pragma region Block metadata
+
+BlockMetadata::BlockMetadata(VkDeviceSize p_size, VkDeviceSize p_granularity)
+	: mSize(p_size), mGranularity(std::max<VkDeviceSize>(p_granularity, 1))
+{
+}
+
+FreeListMetadata::FreeListMetadata(VkDeviceSize p_size, VkDeviceSize p_granularity)
+	: BlockMetadata(p_size, p_granularity)
+{
+	this->mRanges[0] = { p_size, true, false };
+}
+
+bool FreeListMetadata::Allocate(VkDeviceSize p_size, VkDeviceSize p_alignment, bool p_isLinear, VkDeviceSize& p_offset)
+{
+	if (p_size == 0 || p_size > this->mSize - this->mUsedSize)
+		return false;
+
+	auto		 bestRange  = this->mRanges.end();
+	VkDeviceSize bestOffset = 0;
+
+	for (auto it = this->mRanges.begin(); it != this->mRanges.end(); it++)
+	{
+		if (!it->second.isFree || it->second.size < p_size)
+			continue;
+
+		//Best fit : no need to look at ranges bigger than the current best one
+		if (bestRange != this->mRanges.end() && it->second.size >= bestRange->second.size)
+			continue;
+
+		VkDeviceSize offset = AlignUp(it->first, p_alignment);
+
+		//Linear and optimal resources can't share a granularity page
+		if (this->mGranularity > 1 && it != this->mRanges.begin())
+		{
+			auto previous = std::prev(it);
+
+			if (!previous->second.isFree && previous->second.isLinear != p_isLinear && OnSamePage(previous->first + previous->second.size - 1, offset, this->mGranularity))
+				offset = AlignUp(offset, this->mGranularity);
+		}
+
+		VkDeviceSize end = offset + p_size;
+
+		if (end > it->first + it->second.size)
+			continue;
+
+		if (this->mGranularity > 1)
+		{
+			auto next = std::next(it);
+
+			if (next != this->mRanges.end() && !next->second.isFree && next->second.isLinear != p_isLinear && OnSamePage(end - 1, next->first, this->mGranularity))
+				continue;
+		}
+
+		bestRange  = it;
+		bestOffset = offset;
+	}
+
+	if (bestRange == this->mRanges.end())
+		return false;
+
+	//
+	//Split the range in [padding][allocation][remainder]
+	//
+
+	VkDeviceSize rangeStart = bestRange->first;
+	VkDeviceSize rangeEnd	= rangeStart + bestRange->second.size;
+	VkDeviceSize end		= bestOffset + p_size;
+
+	this->mRanges.erase(bestRange);
+
+	if (bestOffset > rangeStart)
+		this->mRanges[rangeStart] = { bestOffset - rangeStart, true, false };
+
+	this->mRanges[bestOffset] = { p_size, false, p_isLinear };
+
+	if (rangeEnd > end)
+		this->mRanges[end] = { rangeEnd - end, true, false };
+
+	this->mUsedSize += p_size;
+	this->mAllocationCount++;
+
+	p_offset = bestOffset;
+
+	return true;
+}
+
+void FreeListMetadata::Free(VkDeviceSize p_offset)
+{
+	auto it = this->mRanges.find(p_offset);
+
+	if (it == this->mRanges.end() || it->second.isFree)
+		return;
+
+	this->mUsedSize -= it->second.size;
+	this->mAllocationCount--;
+
+	it->second.isFree = true;
+
+	//Merge with the next range
+	auto next = std::next(it);
+	if (next != this->mRanges.end() && next->second.isFree)
+	{
+		it->second.size += next->second.size;
+		this->mRanges.erase(next);
+	}
+
+	//Merge with the previous one
+	if (it != this->mRanges.begin())
+	{
+		auto previous = std::prev(it);
+		if (previous->second.isFree)
+		{
+			previous->second.size += it->second.size;
+			this->mRanges.erase(it);
+		}
+	}
+}
+
+BuddyMetadata::BuddyMetadata(VkDeviceSize p_size, VkDeviceSize p_granularity)
+	: BlockMetadata(p_size, p_granularity)
+{
+	this->mUsableSize = PreviousPowerOfTwo(p_size);
+
+	VkDeviceSize nodeSize = this->mUsableSize;
+
+	do
+	{
+		this->mLevelCount++;
+		nodeSize >>= 1;
+	} while (nodeSize >= MIN_NODE_SIZE);
+
+	this->mFreeNodes.resize(this->mLevelCount);
+	this->mFreeNodes[0].insert(0);
+}
+
+bool BuddyMetadata::Allocate(VkDeviceSize p_size, VkDeviceSize p_alignment, bool /*p_isLinear*/, VkDeviceSize& p_offset)
+{
+	if (p_size == 0)
+		return false;
+
+	//Nodes are aligned on their own size, so rounding up to the granularity keeps linear and optimal resources on separate pages
+	VkDeviceSize nodeSize = NextPowerOfTwo(std::max({ p_size, p_alignment, (VkDeviceSize)MIN_NODE_SIZE, this->mGranularity }));
+
+	if (nodeSize > this->mUsableSize)
+		return false;
+
+	uint32_t targetLevel = 0;
+	while ((this->mUsableSize >> targetLevel) > nodeSize)
+		targetLevel++;
+
+	if (targetLevel >= this->mLevelCount)
+		targetLevel = this->mLevelCount - 1;
+
+	//Smallest free node that is big enough
+	int level = (int)targetLevel;
+	while (level >= 0 && this->mFreeNodes[level].empty())
+		level--;
+
+	if (level < 0)
+		return false;
+
+	VkDeviceSize offset = *this->mFreeNodes[level].begin();
+	this->mFreeNodes[level].erase(this->mFreeNodes[level].begin());
+
+	//Split down to the wanted size, the right halves become free
+	while ((uint32_t)level < targetLevel)
+	{
+		level++;
+		this->mFreeNodes[level].insert(offset + (this->mUsableSize >> level));
+	}
+
+	this->mAllocatedNodes[offset] = targetLevel;
+
+	this->mUsedSize += this->mUsableSize >> targetLevel;
+	this->mAllocationCount++;
+
+	p_offset = offset;
+
+	return true;
+}
+
+void BuddyMetadata::Free(VkDeviceSize p_offset)
+{
+	auto it = this->mAllocatedNodes.find(p_offset);
+
+	if (it == this->mAllocatedNodes.end())
+		return;
+
+	uint32_t	 level	= it->second;
+	VkDeviceSize offset = p_offset;
+
+	this->mAllocatedNodes.erase(it);
+
+	this->mUsedSize -= this->mUsableSize >> level;
+	this->mAllocationCount--;
+
+	//Merge back with the buddy as long as it is free
+	while (level > 0)
+	{
+		VkDeviceSize buddy = offset ^ (this->mUsableSize >> level);
+
+		auto buddyIt = this->mFreeNodes[level].find(buddy);
+
+		if (buddyIt == this->mFreeNodes[level].end())
+			break;
+
+		this->mFreeNodes[level].erase(buddyIt);
+		offset = std::min(offset, buddy);
+		level--;
+	}
+
+	this->mFreeNodes[level].insert(offset);
+}
+
+#pragma endregion Block metadata
+
+#pragma region Allocator
+
+bool VKMemoryAllocator::Init(VkPhysicalDevice p_physicalDevice, VkDevice p_logicalDevice, AllocationStrategy p_strategy)
+{
+	this->mLogicalDevice = p_logicalDevice;
+	this->mStrategy		 = p_strategy;
+
+	vkGetPhysicalDeviceMemoryProperties(p_physicalDevice, &this->mMemoryProperties);
+
+	VkPhysicalDeviceProperties physicalDeviceProperties;
+	vkGetPhysicalDeviceProperties(p_physicalDevice, &physicalDeviceProperties);
+
+	this->mBufferImageGranularity = std::max<VkDeviceSize>(physicalDeviceProperties.limits.bufferImageGranularity, 1);
+	this->mNonCoherentAtomSize	  = std::max<VkDeviceSize>(physicalDeviceProperties.limits.nonCoherentAtomSize, 1);
+
+	this->mPools.clear();
+	this->mPools.resize(this->mMemoryProperties.memoryTypeCount);
+
+	return true;
+}
+
+void VKMemoryAllocator::Release()
+{
+	for (MemoryTypePool& pool : this->mPools)
+	{
+		for (MemoryBlock& block : pool.blocks)
+		{
+			if (block.memory == VK_NULL_HANDLE)
+				continue;
+
+			if (block.mappedData)
+				vkUnmapMemory(this->mLogicalDevice, block.memory);
+
+			vkFreeMemory(this->mLogicalDevice, block.memory, nullptr);
+		}
+	}
+
+	this->mPools.clear();
+}
+
+VkDeviceSize VKMemoryAllocator::GetBlockSize(uint32_t p_memoryTypeIndex) const
+{
+	uint32_t	 heapIndex = this->mMemoryProperties.memoryTypes[p_memoryTypeIndex].heapIndex;
+	VkDeviceSize heapSize  = this->mMemoryProperties.memoryHeaps[heapIndex].size;
+
+	//Small heaps (BAR, integrated...) get smaller blocks so one block doesn't eat everything
+	return PreviousPowerOfTwo(std::min(this->mPreferredBlockSize, heapSize / 8));
+}
+
+bool VKMemoryAllocator::IsHostVisible(uint32_t p_memoryTypeIndex) const
+{
+	return (this->mMemoryProperties.memoryTypes[p_memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+}
+
+VkDeviceSize VKMemoryAllocator::GetMemorySize(const MemoryAllocation& p_allocation) const
+{
+	if (p_allocation.blockIndex == UINT32_MAX)
+		return p_allocation.size;
+
+	return this->mPools[p_allocation.memoryTypeIndex].blocks[p_allocation.blockIndex].metadata->GetSize();
+}
+
+std::vector<uint32_t> VKMemoryAllocator::FindMemoryTypes(uint32_t p_typeBits, MemoryUsage p_usage) const
+{
+	//Required flags by priority, the first tier that matches wins. "avoided" only orders types inside a tier
+	std::vector<VkMemoryPropertyFlags> tiers;
+	VkMemoryPropertyFlags avoided = 0;
+
+	switch (p_usage)
+	{
+	case MemoryUsage::GpuOnly:
+		tiers	= { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0 };
+		avoided = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT; //Leave the BAR to the ones that need it
+		break;
+
+	case MemoryUsage::Upload:
+		tiers	= { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT };
+		avoided = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+		break;
+
+	case MemoryUsage::Readback:
+		tiers	= { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT };
+		avoided = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		break;
+
+	case MemoryUsage::ReBarPreferred:
+		tiers	= { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT };
+		avoided = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+		break;
+	}
+
+	//Never hand out those unless someone explicitly asks for them
+	const VkMemoryPropertyFlags excluded = VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT | VK_MEMORY_PROPERTY_PROTECTED_BIT | VK_MEMORY_PROPERTY_DEVICE_COHERENT_BIT_AMD;
+
+	std::vector<uint32_t> result;
+
+	for (VkMemoryPropertyFlags required : tiers)
+	{
+		std::vector<uint32_t> tier;
+
+		for (uint32_t i = 0; i < this->mMemoryProperties.memoryTypeCount; i++)
+		{
+			VkMemoryPropertyFlags flags = this->mMemoryProperties.memoryTypes[i].propertyFlags;
+
+			if (!(p_typeBits & (1u << i)) || (flags & required) != required || (flags & excluded))
+				continue;
+
+			if (std::find(result.begin(), result.end(), i) == result.end())
+				tier.push_back(i);
+		}
+
+		std::stable_sort(tier.begin(), tier.end(), [&](uint32_t a, uint32_t b) {
+			return CountBits(this->mMemoryProperties.memoryTypes[a].propertyFlags & avoided) < CountBits(this->mMemoryProperties.memoryTypes[b].propertyFlags & avoided);
+		});
+
+		result.insert(result.end(), tier.begin(), tier.end());
+	}
+
+	return result;
+}
+
+bool VKMemoryAllocator::CreateBlock(uint32_t p_memoryTypeIndex, uint32_t& p_blockIndex)
+{
+	VkDeviceSize blockSize = this->GetBlockSize(p_memoryTypeIndex);
+
+	VkMemoryAllocateInfo memoryAllocateInfo{};
+
+	memoryAllocateInfo.sType			= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memoryAllocateInfo.allocationSize	= blockSize;
+	memoryAllocateInfo.memoryTypeIndex	= p_memoryTypeIndex;
+
+	MemoryBlock block;
+
+	if (vkAllocateMemory(this->mLogicalDevice, &memoryAllocateInfo, nullptr, &block.memory) != VK_SUCCESS)
+		return false;
+
+	//Host visible blocks stay mapped for their whole life, a memory object can only be mapped once anyway
+	if (this->IsHostVisible(p_memoryTypeIndex) && vkMapMemory(this->mLogicalDevice, block.memory, 0, VK_WHOLE_SIZE, 0, &block.mappedData) != VK_SUCCESS)
+	{
+		vkFreeMemory(this->mLogicalDevice, block.memory, nullptr);
+		return false;
+	}
+
+	if (this->mStrategy == AllocationStrategy::Buddy)
+		block.metadata = std::make_unique<BuddyMetadata>(blockSize, this->mBufferImageGranularity);
+	else
+		block.metadata = std::make_unique<FreeListMetadata>(blockSize, this->mBufferImageGranularity);
+
+	std::vector<MemoryBlock>& blocks = this->mPools[p_memoryTypeIndex].blocks;
+
+	for (uint32_t i = 0; i < blocks.size(); i++)
+	{
+		if (blocks[i].memory == VK_NULL_HANDLE)
+		{
+			blocks[i]	 = std::move(block);
+			p_blockIndex = i;
+			return true;
+		}
+	}
+
+	blocks.push_back(std::move(block));
+	p_blockIndex = (uint32_t)blocks.size() - 1;
+
+	return true;
+}
+
+bool VKMemoryAllocator::AllocateDedicated(VkDeviceSize p_size, uint32_t p_memoryTypeIndex, MemoryAllocation& p_allocation)
+{
+	VkMemoryAllocateInfo memoryAllocateInfo{};
+
+	memoryAllocateInfo.sType			= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memoryAllocateInfo.allocationSize	= p_size;
+	memoryAllocateInfo.memoryTypeIndex	= p_memoryTypeIndex;
+
+	MemoryAllocation allocation;
+
+	if (vkAllocateMemory(this->mLogicalDevice, &memoryAllocateInfo, nullptr, &allocation.memory) != VK_SUCCESS)
+		return false;
+
+	if (this->IsHostVisible(p_memoryTypeIndex) && vkMapMemory(this->mLogicalDevice, allocation.memory, 0, VK_WHOLE_SIZE, 0, &allocation.mappedData) != VK_SUCCESS)
+	{
+		vkFreeMemory(this->mLogicalDevice, allocation.memory, nullptr);
+		return false;
+	}
+
+	allocation.offset			= 0;
+	allocation.size				= p_size;
+	allocation.memoryTypeIndex	= p_memoryTypeIndex;
+	allocation.blockIndex		= UINT32_MAX;
+	allocation.propertyFlags	= this->mMemoryProperties.memoryTypes[p_memoryTypeIndex].propertyFlags;
+
+	this->mPools[p_memoryTypeIndex].dedicatedAllocationCount++;
+	this->mPools[p_memoryTypeIndex].dedicatedBytes += p_size;
+
+	p_allocation = allocation;
+
+	return true;
+}
+
+bool VKMemoryAllocator::Allocate(const VkMemoryRequirements& p_requirements, uint32_t p_memoryTypeIndex, bool p_isLinear, MemoryAllocation& p_allocation)
+{
+	if (p_memoryTypeIndex >= this->mPools.size())
+		return false;
+
+	//Big resources would waste most of a block, give them their own memory
+	if (p_requirements.size > this->GetBlockSize(p_memoryTypeIndex) / 2)
+		return this->AllocateDedicated(p_requirements.size, p_memoryTypeIndex, p_allocation);
+
+	std::vector<MemoryBlock>& blocks = this->mPools[p_memoryTypeIndex].blocks;
+
+	VkDeviceSize offset		= 0;
+	uint32_t	 blockIndex = UINT32_MAX;
+
+	for (uint32_t i = 0; i < blocks.size(); i++)
+	{
+		if (blocks[i].memory != VK_NULL_HANDLE && blocks[i].metadata->Allocate(p_requirements.size, p_requirements.alignment, p_isLinear, offset))
+		{
+			blockIndex = i;
+			break;
+		}
+	}
+
+	if (blockIndex == UINT32_MAX)
+	{
+		if (!this->CreateBlock(p_memoryTypeIndex, blockIndex))
+			return this->AllocateDedicated(p_requirements.size, p_memoryTypeIndex, p_allocation); //Last chance
+
+		if (!blocks[blockIndex].metadata->Allocate(p_requirements.size, p_requirements.alignment, p_isLinear, offset))
+			return false;
+	}
+
+	MemoryBlock& block = blocks[blockIndex];
+
+	p_allocation.memory				= block.memory;
+	p_allocation.offset				= offset;
+	p_allocation.size				= p_requirements.size;
+	p_allocation.memoryTypeIndex	= p_memoryTypeIndex;
+	p_allocation.blockIndex			= blockIndex;
+	p_allocation.mappedData			= block.mappedData ? (char*)block.mappedData + offset : nullptr;
+	p_allocation.propertyFlags		= this->mMemoryProperties.memoryTypes[p_memoryTypeIndex].propertyFlags;
+
+	return true;
+}
+
+bool VKMemoryAllocator::Allocate(const VkMemoryRequirements& p_requirements, MemoryUsage p_usage, bool p_isLinear, MemoryAllocation& p_allocation)
+{
+	//A full heap is not the end, the next best type may still have room
+	for (uint32_t memoryTypeIndex : this->FindMemoryTypes(p_requirements.memoryTypeBits, p_usage))
+	{
+		if (this->Allocate(p_requirements, memoryTypeIndex, p_isLinear, p_allocation))
+			return true;
+	}
+
+	return false;
+}
+
+void VKMemoryAllocator::Free(MemoryAllocation& p_allocation)
+{
+	if (p_allocation.memory == VK_NULL_HANDLE || p_allocation.memoryTypeIndex >= this->mPools.size())
+		return;
+
+	MemoryTypePool& pool = this->mPools[p_allocation.memoryTypeIndex];
+
+	if (p_allocation.blockIndex == UINT32_MAX)
+	{
+		if (p_allocation.mappedData)
+			vkUnmapMemory(this->mLogicalDevice, p_allocation.memory);
+
+		vkFreeMemory(this->mLogicalDevice, p_allocation.memory, nullptr);
+
+		pool.dedicatedAllocationCount--;
+		pool.dedicatedBytes -= p_allocation.size;
+	}
+	else
+	{
+		MemoryBlock& block = pool.blocks[p_allocation.blockIndex];
+
+		block.metadata->Free(p_allocation.offset);
+
+		//Keep one empty block around so a load/unload loop doesn't hit vkAllocateMemory every time
+		if (block.metadata->IsEmpty())
+		{
+			bool hasOtherEmptyBlock = false;
+
+			for (uint32_t i = 0; i < pool.blocks.size(); i++)
+			{
+				if (i != p_allocation.blockIndex && pool.blocks[i].memory != VK_NULL_HANDLE && pool.blocks[i].metadata->IsEmpty())
+					hasOtherEmptyBlock = true;
+			}
+
+			if (hasOtherEmptyBlock)
+			{
+				if (block.mappedData)
+					vkUnmapMemory(this->mLogicalDevice, block.memory);
+
+				vkFreeMemory(this->mLogicalDevice, block.memory, nullptr);
+
+				block.memory	 = VK_NULL_HANDLE;
+				block.mappedData = nullptr;
+				block.metadata.reset();
+			}
+		}
+	}
+
+	p_allocation = MemoryAllocation();
+}
+
+bool VKMemoryAllocator::AllocateForBuffer(VkBuffer p_buffer, MemoryUsage p_usage, MemoryAllocation& p_allocation)
+{
+	VkMemoryRequirements memoryRequirements;
+	vkGetBufferMemoryRequirements(this->mLogicalDevice, p_buffer, &memoryRequirements);
+
+	if (!this->Allocate(memoryRequirements, p_usage, true, p_allocation))
+		return false;
+
+	return vkBindBufferMemory(this->mLogicalDevice, p_buffer, p_allocation.memory, p_allocation.offset) == VK_SUCCESS;
+}
+
+bool VKMemoryAllocator::AllocateForImage(VkImage p_image, VkImageTiling p_tiling, MemoryUsage p_usage, MemoryAllocation& p_allocation)
+{
+	VkMemoryRequirements memoryRequirements;
+	vkGetImageMemoryRequirements(this->mLogicalDevice, p_image, &memoryRequirements);
+
+	if (!this->Allocate(memoryRequirements, p_usage, p_tiling == VK_IMAGE_TILING_LINEAR, p_allocation))
+		return false;
+
+	return vkBindImageMemory(this->mLogicalDevice, p_image, p_allocation.memory, p_allocation.offset) == VK_SUCCESS;
+}
+
+VkMappedMemoryRange VKMemoryAllocator::GetMappedRange(const MemoryAllocation& p_allocation, VkDeviceSize p_offset, VkDeviceSize p_size) const
+{
+	VkDeviceSize size = p_size == VK_WHOLE_SIZE ? p_allocation.size - p_offset : p_size;
+
+	//Ranges have to be nonCoherentAtomSize aligned, and may not go past the memory object
+	VkMappedMemoryRange mappedMemoryRange{};
+
+	mappedMemoryRange.sType	 = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+	mappedMemoryRange.memory = p_allocation.memory;
+	mappedMemoryRange.offset = AlignDown(p_allocation.offset + p_offset, this->mNonCoherentAtomSize);
+	mappedMemoryRange.size	 = std::min(AlignUp(p_allocation.offset + p_offset + size, this->mNonCoherentAtomSize), this->GetMemorySize(p_allocation)) - mappedMemoryRange.offset;
+
+	return mappedMemoryRange;
+}
+
+void VKMemoryAllocator::Flush(const MemoryAllocation& p_allocation, VkDeviceSize p_offset, VkDeviceSize p_size)
+{
+	if (p_allocation.memory == VK_NULL_HANDLE || (p_allocation.propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+		return;
+
+	VkMappedMemoryRange mappedMemoryRange = this->GetMappedRange(p_allocation, p_offset, p_size);
+
+	vkFlushMappedMemoryRanges(this->mLogicalDevice, 1, &mappedMemoryRange);
+}
+
+void VKMemoryAllocator::Invalidate(const MemoryAllocation& p_allocation, VkDeviceSize p_offset, VkDeviceSize p_size)
+{
+	if (p_allocation.memory == VK_NULL_HANDLE || (p_allocation.propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+		return;
+
+	VkMappedMemoryRange mappedMemoryRange = this->GetMappedRange(p_allocation, p_offset, p_size);
+
+	vkInvalidateMappedMemoryRanges(this->mLogicalDevice, 1, &mappedMemoryRange);
+}
+
+MemoryStats VKMemoryAllocator::GetHeapStats(uint32_t p_heapIndex) const
+{
+	MemoryStats stats;
+
+	for (uint32_t i = 0; i < this->mPools.size(); i++)
+	{
+		if (this->mMemoryProperties.memoryTypes[i].heapIndex != p_heapIndex)
+			continue;
+
+		const MemoryTypePool& pool = this->mPools[i];
+
+		for (const MemoryBlock& block : pool.blocks)
+		{
+			if (block.memory == VK_NULL_HANDLE)
+				continue;
+
+			stats.blockCount++;
+			stats.allocationCount	+= block.metadata->GetAllocationCount();
+			stats.bytesReserved		+= block.metadata->GetSize();
+			stats.bytesUsed			+= block.metadata->GetUsedSize();
+		}
+
+		stats.allocationCount			+= pool.dedicatedAllocationCount;
+		stats.dedicatedAllocationCount	+= pool.dedicatedAllocationCount;
+		stats.bytesReserved				+= pool.dedicatedBytes;
+		stats.bytesUsed					+= pool.dedicatedBytes;
+	}
+
+	return stats;
+}
+
+MemoryStats VKMemoryAllocator::GetStats() const
+{
+	MemoryStats total;
+
+	for (uint32_t i = 0; i < this->mMemoryProperties.memoryHeapCount; i++)
+	{
+		MemoryStats heap = this->GetHeapStats(i);
+
+		total.blockCount				+= heap.blockCount;
+		total.allocationCount			+= heap.allocationCount;
+		total.dedicatedAllocationCount	+= heap.dedicatedAllocationCount;
+		total.bytesReserved				+= heap.bytesReserved;
+		total.bytesUsed					+= heap.bytesUsed;
+	}
+
+	return total;
+}
+
+#pragma endregion Allocator
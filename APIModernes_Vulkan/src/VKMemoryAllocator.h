@@ -0,0 +1,169 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+
+#include <cstdint>
+#include <vector>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <memory>
+
+enum class AllocationStrategy
+{
+	FreeList,	//Best fit over a sorted range list, low waste
+	Buddy		//Power of two nodes, fast and cheap to merge but rounds sizes up
+};
+
+//Where a resource should live, the allocator picks the memory type and falls back by priority when the ideal one doesn't exist
+enum class MemoryUsage
+{
+	GpuOnly,		//DEVICE_LOCAL, only touched by the GPU (vertex/index buffers, textures, attachments)
+	Upload,			//HOST_VISIBLE system memory, written once by the CPU then copied (staging)
+	Readback,		//HOST_VISIBLE | HOST_CACHED, written by the GPU and read by the CPU
+	ReBarPreferred	//DEVICE_LOCAL | HOST_VISIBLE when the device exposes it (ReBAR/SAM, integrated), Upload otherwise
+};
+
+struct MemoryAllocation
+{
+	VkDeviceMemory	memory			= VK_NULL_HANDLE;
+	VkDeviceSize	offset			= 0;
+	VkDeviceSize	size			= 0;
+	uint32_t		memoryTypeIndex = UINT32_MAX;
+	uint32_t		blockIndex		= UINT32_MAX;	//UINT32_MAX means dedicated allocation
+	void*			mappedData		= nullptr;		//Already offset, only set for host visible memory
+
+	VkMemoryPropertyFlags propertyFlags = 0;		//Flags of the memory type that was actually chosen
+};
+
+struct MemoryStats
+{
+	uint32_t		blockCount					= 0;
+	uint32_t		allocationCount				= 0;
+	uint32_t		dedicatedAllocationCount	= 0;
+	VkDeviceSize	bytesReserved				= 0;	//Sum of every VkDeviceMemory we own
+	VkDeviceSize	bytesUsed					= 0;	//What the sub-allocations actually cover
+};
+
+#pragma region Block metadata
+//
+//Placement logic only : no vulkan call in there, so it can be exercised on the CPU without a device
+//
+
+class BlockMetadata
+{
+protected:
+	VkDeviceSize mSize				= 0;
+	VkDeviceSize mUsedSize			= 0;
+	VkDeviceSize mGranularity		= 1;	//bufferImageGranularity
+	uint32_t	 mAllocationCount	= 0;
+
+public:
+	BlockMetadata(VkDeviceSize p_size, VkDeviceSize p_granularity);
+	virtual ~BlockMetadata() = default;
+
+	virtual bool Allocate(VkDeviceSize p_size, VkDeviceSize p_alignment, bool p_isLinear, VkDeviceSize& p_offset) = 0;
+	virtual void Free(VkDeviceSize p_offset) = 0;
+
+	VkDeviceSize GetSize()			  const { return this->mSize; }
+	VkDeviceSize GetUsedSize()		  const { return this->mUsedSize; }
+	uint32_t	 GetAllocationCount() const { return this->mAllocationCount; }
+	bool		 IsEmpty()			  const { return this->mAllocationCount == 0; }
+};
+
+class FreeListMetadata : public BlockMetadata
+{
+private:
+	struct Range
+	{
+		VkDeviceSize size;
+		bool		 isFree;
+		bool		 isLinear;
+	};
+
+	std::map<VkDeviceSize, Range> mRanges; //Keyed by offset, always covers the whole block
+
+public:
+	FreeListMetadata(VkDeviceSize p_size, VkDeviceSize p_granularity);
+
+	bool Allocate(VkDeviceSize p_size, VkDeviceSize p_alignment, bool p_isLinear, VkDeviceSize& p_offset) override;
+	void Free(VkDeviceSize p_offset) override;
+};
+
+class BuddyMetadata : public BlockMetadata
+{
+private:
+	static constexpr VkDeviceSize MIN_NODE_SIZE = 256;
+
+	VkDeviceSize mUsableSize = 0; //Largest power of two that fits in the block
+	uint32_t	 mLevelCount = 0;
+
+	std::vector<std::set<VkDeviceSize>>		   mFreeNodes;		//Per level, level 0 is the whole block
+	std::unordered_map<VkDeviceSize, uint32_t> mAllocatedNodes; //Offset -> level
+
+public:
+	BuddyMetadata(VkDeviceSize p_size, VkDeviceSize p_granularity);
+
+	bool Allocate(VkDeviceSize p_size, VkDeviceSize p_alignment, bool p_isLinear, VkDeviceSize& p_offset) override;
+	void Free(VkDeviceSize p_offset) override;
+};
+#pragma endregion Block metadata
+
+class VKMemoryAllocator
+{
+private:
+	struct MemoryBlock
+	{
+		VkDeviceMemory					memory		= VK_NULL_HANDLE; //VK_NULL_HANDLE means the slot can be reused
+		void*							mappedData	= nullptr;
+		std::unique_ptr<BlockMetadata>	metadata;
+	};
+
+	struct MemoryTypePool
+	{
+		std::vector<MemoryBlock> blocks;
+		uint32_t				 dedicatedAllocationCount	= 0;
+		VkDeviceSize			 dedicatedBytes				= 0;
+	};
+
+	VkDevice							mLogicalDevice			= VK_NULL_HANDLE;
+	VkPhysicalDeviceMemoryProperties	mMemoryProperties{};
+	VkDeviceSize						mBufferImageGranularity = 1;
+	VkDeviceSize						mNonCoherentAtomSize	= 1;
+	VkDeviceSize						mPreferredBlockSize		= 64ull * 1024 * 1024;
+	AllocationStrategy					mStrategy				= AllocationStrategy::FreeList;
+
+	std::vector<MemoryTypePool> mPools; //One per memory type
+
+private:
+	VkDeviceSize GetBlockSize(uint32_t p_memoryTypeIndex) const;
+	bool IsHostVisible(uint32_t p_memoryTypeIndex) const;
+	VkDeviceSize GetMemorySize(const MemoryAllocation& p_allocation) const;
+	VkMappedMemoryRange GetMappedRange(const MemoryAllocation& p_allocation, VkDeviceSize p_offset, VkDeviceSize p_size) const;
+
+	bool CreateBlock(uint32_t p_memoryTypeIndex, uint32_t& p_blockIndex);
+	bool AllocateDedicated(VkDeviceSize p_size, uint32_t p_memoryTypeIndex, MemoryAllocation& p_allocation);
+
+public:
+	bool Init(VkPhysicalDevice p_physicalDevice, VkDevice p_logicalDevice, AllocationStrategy p_strategy = AllocationStrategy::FreeList);
+	void Release();
+
+	//Memory types allowed by p_typeBits that fit p_usage, best one first. Empty if nothing fits
+	std::vector<uint32_t> FindMemoryTypes(uint32_t p_typeBits, MemoryUsage p_usage) const;
+
+	bool Allocate(const VkMemoryRequirements& p_requirements, uint32_t p_memoryTypeIndex, bool p_isLinear, MemoryAllocation& p_allocation);
+	bool Allocate(const VkMemoryRequirements& p_requirements, MemoryUsage p_usage, bool p_isLinear, MemoryAllocation& p_allocation);
+	void Free(MemoryAllocation& p_allocation);
+
+	bool AllocateForBuffer(VkBuffer p_buffer, MemoryUsage p_usage, MemoryAllocation& p_allocation);
+	bool AllocateForImage(VkImage p_image, VkImageTiling p_tiling, MemoryUsage p_usage, MemoryAllocation& p_allocation);
+
+	//No-op on coherent memory
+	void Flush(const MemoryAllocation& p_allocation, VkDeviceSize p_offset = 0, VkDeviceSize p_size = VK_WHOLE_SIZE);
+	void Invalidate(const MemoryAllocation& p_allocation, VkDeviceSize p_offset = 0, VkDeviceSize p_size = VK_WHOLE_SIZE);
+
+	MemoryStats GetStats() const;
+	MemoryStats GetHeapStats(uint32_t p_heapIndex) const;
+
+	const VkPhysicalDeviceMemoryProperties& GetMemoryProperties() const { return this->mMemoryProperties; }
+};
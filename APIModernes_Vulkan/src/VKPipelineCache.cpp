@@ -0,0 +1,179 @@
+#include "VKPipelineCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "Utils.h"
+
+constexpr uint32_t VKPipelineCache::MAGIC;
+constexpr uint32_t VKPipelineCache::VERSION;
+
+bool VKPipelineCache::Init(VkDevice p_logicalDevice, const VkPhysicalDeviceProperties& p_deviceProperties, const char* p_filePath, size_t p_maxSize)
+{
+	this->mLogicalDevice	= p_logicalDevice;
+	this->mDeviceProperties = p_deviceProperties;
+	this->mFilePath			= p_filePath;
+	this->mMaxSize			= p_maxSize;
+
+	std::vector<uint8_t> data;
+
+	this->Load(data);
+
+	VkPipelineCacheCreateInfo pipelineCacheCreateInfo{};
+
+	pipelineCacheCreateInfo.sType			= VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	pipelineCacheCreateInfo.initialDataSize = data.size();
+	pipelineCacheCreateInfo.pInitialData	= data.empty() ? nullptr : data.data();
+
+	if (vkCreatePipelineCache(this->mLogicalDevice, &pipelineCacheCreateInfo, nullptr, &this->mCache) == VK_SUCCESS)
+	{
+		this->mLoadedSize	= data.size();
+		this->mSavedHash	= data.empty() ? 0 : HashBytes(data.data(), data.size());
+		return true;
+	}
+
+	//The driver may still refuse data it produced itself, start over
+	std::cout << "[PipelineCache] " << this->mFilePath << " : rejected by the driver, starting empty" << std::endl;
+
+	pipelineCacheCreateInfo.initialDataSize = 0;
+	pipelineCacheCreateInfo.pInitialData	= nullptr;
+
+	return vkCreatePipelineCache(this->mLogicalDevice, &pipelineCacheCreateInfo, nullptr, &this->mCache) == VK_SUCCESS;
+}
+
+void VKPipelineCache::Release()
+{
+	if (this->mCache == VK_NULL_HANDLE)
+		return;
+
+	this->Save();
+
+	vkDestroyPipelineCache(this->mLogicalDevice, this->mCache, nullptr);
+	this->mCache = VK_NULL_HANDLE;
+}
+
+void VKPipelineCache::Load(std::vector<uint8_t>& p_data)
+{
+	p_data.clear();
+
+	std::ifstream file(this->mFilePath, std::ios::binary | std::ios::ate);
+
+	if (!file.is_open())
+	{
+		std::cout << "[PipelineCache] " << this->mFilePath << " : no cache yet, pipelines are compiled from scratch" << std::endl;
+		return;
+	}
+
+	size_t		fileSize = (size_t)file.tellg();
+	FileHeader	header{};
+
+	file.seekg(0);
+
+	const char* reason = nullptr;
+
+	if (fileSize < sizeof(FileHeader) || !file.read((char*)&header, sizeof(header)))
+		reason = "truncated header";
+	else if (header.magic != MAGIC || header.version != VERSION)
+		reason = "not a cache of this version";
+	else if (header.dataSize > this->mMaxSize)
+		reason = "over the size limit";
+	else if (header.dataSize != fileSize - sizeof(FileHeader))
+		reason = "truncated data";
+
+	if (!reason)
+	{
+		p_data.resize((size_t)header.dataSize);
+
+		if (!file.read((char*)p_data.data(), p_data.size()))
+			reason = "read error";
+		else if (HashBytes(p_data.data(), p_data.size()) != header.dataHash)
+			reason = "corrupted data";
+		else if (!this->IsCompatible(p_data.data(), p_data.size()))
+			reason = "made by another device or driver";
+	}
+
+	if (reason)
+	{
+		std::cout << "[PipelineCache] " << this->mFilePath << " : " << reason << ", starting empty" << std::endl;
+
+		p_data.clear();
+		file.close();
+
+		std::remove(this->mFilePath.c_str()); //Replaced on the next save anyway, don't trip on it again before that
+	}
+}
+
+bool VKPipelineCache::IsCompatible(const uint8_t* p_data, size_t p_size) const
+{
+	VkPipelineCacheHeaderVersionOne header;
+
+	if (p_size < sizeof(header))
+		return false;
+
+	memcpy(&header, p_data, sizeof(header));
+
+	return header.headerSize >= sizeof(header)
+		&& header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+		&& header.vendorID == this->mDeviceProperties.vendorID
+		&& header.deviceID == this->mDeviceProperties.deviceID
+		&& memcmp(header.pipelineCacheUUID, this->mDeviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+bool VKPipelineCache::Save()
+{
+	size_t dataSize = 0;
+
+	if (vkGetPipelineCacheData(this->mLogicalDevice, this->mCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+		return false;
+
+	if (dataSize > this->mMaxSize)
+	{
+		std::cout << "[PipelineCache] " << dataSize / 1024 << " KB of pipelines is over the " << this->mMaxSize / 1024 << " KB limit, not saved" << std::endl;
+		return false;
+	}
+
+	std::vector<uint8_t> data(dataSize);
+
+	//May return less than asked if pipelines were added in between, VK_INCOMPLETE then
+	if (vkGetPipelineCacheData(this->mLogicalDevice, this->mCache, &dataSize, data.data()) != VK_SUCCESS)
+		return false;
+
+	data.resize(dataSize);
+
+	uint64_t hash = HashBytes(data.data(), data.size());
+
+	if (hash == this->mSavedHash)
+		return true;
+
+	FileHeader header{};
+
+	header.magic	= MAGIC;
+	header.version	= VERSION;
+	header.dataSize = data.size();
+	header.dataHash = hash;
+
+	std::string tmpPath = this->mFilePath + ".tmp";
+
+	std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+		return false;
+
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)data.data(), data.size());
+	file.close();
+
+	if (file.fail() || !AtomicReplaceFile(tmpPath, this->mFilePath))
+	{
+		std::remove(tmpPath.c_str());
+		return false;
+	}
+
+	this->mSavedHash = hash;
+
+	std::cout << "[PipelineCache] " << this->mFilePath << " : saved " << data.size() / 1024 << " KB" << std::endl;
+
+	return true;
+}
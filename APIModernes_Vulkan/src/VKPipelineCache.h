@@ -0,0 +1,55 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+//VkPipelineCache kept on disk between runs.
+//File layout : FileHeader | driver blob. The header hashes the blob so a torn or corrupted file is caught before the driver sees it,
+//the driver blob itself must come from the same vendor, device and pipelineCacheUUID (a driver update changes the UUID).
+//Anything that doesn't match is thrown away and the cache starts empty, it's never an error.
+//
+class VKPipelineCache
+{
+private:
+	static constexpr uint32_t MAGIC		= 0x48435050; //"PPCH"
+	static constexpr uint32_t VERSION	= 1;
+
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t dataSize;
+		uint64_t dataHash;
+	};
+
+	VkDevice					mLogicalDevice	= VK_NULL_HANDLE;
+	VkPipelineCache				mCache			= VK_NULL_HANDLE;
+	VkPhysicalDeviceProperties	mDeviceProperties{};
+
+	std::string mFilePath;
+	size_t		mMaxSize		= 0;	//Bytes of driver data, above that the cache isn't loaded nor saved
+	size_t		mLoadedSize		= 0;	//0 when the cache started empty
+	uint64_t	mSavedHash		= 0;	//Hash of what is on disk, saves are skipped while the data doesn't change
+
+private:
+	//Empty p_data when the file is missing or invalid, the reason is logged
+	void Load(std::vector<uint8_t>& p_data);
+	bool IsCompatible(const uint8_t* p_data, size_t p_size) const;
+
+public:
+	bool Init(VkDevice p_logicalDevice, const VkPhysicalDeviceProperties& p_deviceProperties, const char* p_filePath, size_t p_maxSize);
+	//Saves then destroys the cache
+	void Release();
+
+	//Written to a temporary file then moved over the old one, a crash mid-save leaves the previous cache intact.
+	//Does nothing when the driver data didn't change since the last load/save
+	bool Save();
+
+	VkPipelineCache Get()		const { return this->mCache; }
+	bool			IsWarm()	const { return this->mLoadedSize > 0; }
+	size_t			GetLoadedSize() const { return this->mLoadedSize; }
+};
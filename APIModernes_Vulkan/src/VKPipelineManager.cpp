@@ -0,0 +1,744 @@
+#include "VKPipelineManager.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <unordered_set>
+
+#include "VKRenderer.h"
+
+static_assert(sizeof(PipelineState) == 22 * sizeof(uint32_t) + 2 * sizeof(uint64_t), "PipelineState must not have padding, it is hashed and compared as raw bytes");
+
+bool PipelineState::operator==(const PipelineState& p_other) const
+{
+	return memcmp(this, &p_other, sizeof(PipelineState)) == 0;
+}
+
+//No padding, the raw bytes are the state
+size_t PipelineStateHash::operator()(const PipelineState& p_state) const
+{
+	uint64_t hash = HashBytes(&p_state, sizeof(PipelineState));
+
+	return (size_t)(hash ^ (hash >> 32));
+}
+
+//Create infos of one pipeline, they point at each other so they're kept together until the driver call
+struct PipelineCreateStorage
+{
+	std::array<VkPipelineShaderStageCreateInfo, 2>		stages{};
+	std::array<VkSpecializationInfo, 2>					specializations{};
+	VkVertexInputBindingDescription						binding{};
+
+	VkPipelineVertexInputStateCreateInfo	vertexInput{};
+	VkPipelineInputAssemblyStateCreateInfo	inputAssembly{};
+	VkPipelineViewportStateCreateInfo		viewport{};
+	VkPipelineRasterizationStateCreateInfo	rasterization{};
+	VkPipelineMultisampleStateCreateInfo	multisample{};
+	VkPipelineDepthStencilStateCreateInfo	depthStencil{};
+	VkPipelineColorBlendAttachmentState		blendAttachment{};
+	VkPipelineColorBlendStateCreateInfo		colorBlend{};
+};
+
+static const std::array<VkDynamicState, 2> DYNAMIC_STATES = {
+	VK_DYNAMIC_STATE_VIEWPORT,
+	VK_DYNAMIC_STATE_SCISSOR
+};
+
+static void FillCreateInfo(const PipelineState& p_state, VkShaderModule p_vertexModule, VkShaderModule p_fragmentModule, const std::vector<VkVertexInputAttributeDescription>& p_attributes, const SpecializationConstants& p_vertexConstants, const SpecializationConstants& p_fragmentConstants, const VkPipelineDynamicStateCreateInfo& p_dynamicState, PipelineCreateStorage& p_storage, VkGraphicsPipelineCreateInfo& p_createInfo)
+{
+	p_storage.specializations[0] = p_vertexConstants.GetInfo();
+	p_storage.specializations[1] = p_fragmentConstants.GetInfo();
+
+	p_storage.stages[0].sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	p_storage.stages[0].stage				= VK_SHADER_STAGE_VERTEX_BIT;
+	p_storage.stages[0].module				= p_vertexModule;
+	p_storage.stages[0].pName				= "main";
+	p_storage.stages[0].pSpecializationInfo = p_vertexConstants.IsEmpty() ? nullptr : &p_storage.specializations[0];
+
+	p_storage.stages[1].sType				= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	p_storage.stages[1].stage				= VK_SHADER_STAGE_FRAGMENT_BIT;
+	p_storage.stages[1].module				= p_fragmentModule;
+	p_storage.stages[1].pName				= "main";
+	p_storage.stages[1].pSpecializationInfo = p_fragmentConstants.IsEmpty() ? nullptr : &p_storage.specializations[1];
+
+	p_storage.binding = VKRenderer::GetBindingDescription(p_state.vertexFormat);
+
+	p_storage.vertexInput.sType								= VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	p_storage.vertexInput.vertexBindingDescriptionCount		= 1;
+	p_storage.vertexInput.pVertexBindingDescriptions		= &p_storage.binding;
+	p_storage.vertexInput.vertexAttributeDescriptionCount	= static_cast<uint32_t>(p_attributes.size());
+	p_storage.vertexInput.pVertexAttributeDescriptions		= p_attributes.data();
+
+	p_storage.inputAssembly.sType					= VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	p_storage.inputAssembly.topology				= p_state.topology;
+	p_storage.inputAssembly.primitiveRestartEnable	= VK_FALSE;
+
+	p_storage.viewport.sType			= VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	p_storage.viewport.viewportCount	= 1;
+	p_storage.viewport.scissorCount		= 1;
+
+	p_storage.rasterization.sType					= VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	p_storage.rasterization.depthClampEnable		= VK_FALSE;
+	p_storage.rasterization.rasterizerDiscardEnable = VK_FALSE;
+	p_storage.rasterization.polygonMode				= p_state.polygonMode;
+	p_storage.rasterization.lineWidth				= 1.0f;
+	p_storage.rasterization.cullMode				= p_state.cullMode;
+	p_storage.rasterization.frontFace				= p_state.frontFace;
+	p_storage.rasterization.depthBiasEnable			= VK_FALSE;
+
+	p_storage.multisample.sType					= VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	p_storage.multisample.sampleShadingEnable	= VK_FALSE;
+	p_storage.multisample.rasterizationSamples	= p_state.samples;
+
+	p_storage.depthStencil.sType					= VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	p_storage.depthStencil.depthTestEnable			= p_state.depthTest;
+	p_storage.depthStencil.depthWriteEnable			= p_state.depthWrite;
+	p_storage.depthStencil.depthCompareOp			= p_state.depthCompareOp;
+	p_storage.depthStencil.depthBoundsTestEnable	= VK_FALSE;
+	p_storage.depthStencil.stencilTestEnable		= VK_FALSE;
+
+	p_storage.blendAttachment.blendEnable			= p_state.blendEnable;
+	p_storage.blendAttachment.srcColorBlendFactor	= p_state.srcColorFactor;
+	p_storage.blendAttachment.dstColorBlendFactor	= p_state.dstColorFactor;
+	p_storage.blendAttachment.colorBlendOp			= p_state.colorBlendOp;
+	p_storage.blendAttachment.srcAlphaBlendFactor	= p_state.srcAlphaFactor;
+	p_storage.blendAttachment.dstAlphaBlendFactor	= p_state.dstAlphaFactor;
+	p_storage.blendAttachment.alphaBlendOp			= p_state.alphaBlendOp;
+	p_storage.blendAttachment.colorWriteMask		= p_state.colorWriteMask;
+
+	p_storage.colorBlend.sType				= VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	p_storage.colorBlend.logicOpEnable		= VK_FALSE;
+	p_storage.colorBlend.attachmentCount	= 1;
+	p_storage.colorBlend.pAttachments		= &p_storage.blendAttachment;
+
+	p_createInfo = VkGraphicsPipelineCreateInfo{};
+
+	p_createInfo.sType					= VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	p_createInfo.layout					= p_state.layout;
+	p_createInfo.renderPass				= p_state.renderPass;
+	p_createInfo.subpass				= p_state.subpass;
+	p_createInfo.stageCount				= static_cast<uint32_t>(p_storage.stages.size());
+	p_createInfo.pStages				= p_storage.stages.data();
+	p_createInfo.pDynamicState			= &p_dynamicState;
+	p_createInfo.pVertexInputState		= &p_storage.vertexInput;
+	p_createInfo.pInputAssemblyState	= &p_storage.inputAssembly;
+	p_createInfo.pViewportState			= &p_storage.viewport;
+	p_createInfo.pRasterizationState	= &p_storage.rasterization;
+	p_createInfo.pMultisampleState		= &p_storage.multisample;
+	p_createInfo.pDepthStencilState		= &p_storage.depthStencil;
+	p_createInfo.pColorBlendState		= &p_storage.colorBlend;
+	p_createInfo.basePipelineHandle		= VK_NULL_HANDLE;
+	p_createInfo.basePipelineIndex		= -1;
+}
+
+bool VKPipelineManager::Init(VkDevice p_logicalDevice, VKPipelineCache* p_pipelineCache, uint32_t p_framesInFlight, uint32_t p_threadCount)
+{
+	this->mLogicalDevice	= p_logicalDevice;
+	this->mPipelineCache	= p_pipelineCache;
+	this->mFramesInFlight	= p_framesInFlight;
+
+	this->mSpecializations.assign(1, SpecializationConstants()); //NO_SPECIALIZATION
+
+	if (p_threadCount == 0)
+		p_threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+	this->mThreadCount = p_threadCount;
+
+	for (uint32_t i = 0; i < p_threadCount; i++)
+		this->mWorkers.emplace_back(&VKPipelineManager::WorkerLoop, this);
+
+	return true;
+}
+
+void VKPipelineManager::Release()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mMutex);
+
+		this->mStopping = true;
+	}
+
+	this->mCondition.notify_all();
+
+	for (std::thread& worker : this->mWorkers)
+		worker.join();
+
+	this->mWorkers.clear();
+
+	for (auto& pipeline : this->mPipelines)
+		vkDestroyPipeline(this->mLogicalDevice, pipeline.second.pipeline, nullptr);
+
+	//Finished after the last Update()
+	for (const PendingPipeline& pending : this->mCompleted)
+		vkDestroyPipeline(this->mLogicalDevice, pending.pipeline, nullptr);
+
+	for (const RetiredPipeline& retired : this->mRetiredPipelines)
+		vkDestroyPipeline(this->mLogicalDevice, retired.pipeline, nullptr);
+
+	for (const Shader& shader : this->mShaders)
+		vkDestroyShaderModule(this->mLogicalDevice, shader.module, nullptr);
+
+	for (VkShaderModule module : this->mRetiredModules)
+		vkDestroyShaderModule(this->mLogicalDevice, module, nullptr);
+
+	for (auto& pipelineLayout : this->mPipelineLayouts)
+		vkDestroyPipelineLayout(this->mLogicalDevice, pipelineLayout.second, nullptr);
+
+	for (auto& setLayout : this->mSetLayouts)
+		vkDestroyDescriptorSetLayout(this->mLogicalDevice, setLayout.second, nullptr);
+
+	this->mPipelines.clear();
+	this->mCompleted.clear();
+	this->mQueue.clear();
+	this->mRetiredPipelines.clear();
+	this->mShaders.clear();
+	this->mSpecializations.clear();
+	this->mRetiredModules.clear();
+	this->mPipelineLayouts.clear();
+	this->mSetLayouts.clear();
+	this->mInFlight = 0;
+}
+
+bool VKPipelineManager::CreateShaderModule(const char* p_filePath, VkShaderModule& p_module, ShaderReflection& p_reflection) const
+{
+	std::vector<char> byteCode = ParseShaderFile(p_filePath);
+
+	if (byteCode.empty())
+	{
+		std::cout << "[Pipelines] " << p_filePath << " : can't read the shader" << std::endl;
+		return false;
+	}
+
+	if (!SpirvReflection::Reflect(byteCode, p_reflection))
+	{
+		std::cout << "[Pipelines] " << p_filePath << " : can't reflect the shader" << std::endl;
+		return false;
+	}
+
+	VkShaderModuleCreateInfo shaderModuleCreateInfo{};
+
+	shaderModuleCreateInfo.sType	= VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	shaderModuleCreateInfo.codeSize = byteCode.size();
+	shaderModuleCreateInfo.pCode	= (uint32_t*)byteCode.data();
+
+	return vkCreateShaderModule(this->mLogicalDevice, &shaderModuleCreateInfo, nullptr, &p_module) == VK_SUCCESS;
+}
+
+ShaderId VKPipelineManager::LoadShader(const char* p_filePath)
+{
+	for (ShaderId id = 0; id < this->mShaders.size(); id++)
+	{
+		if (this->mShaders[id].filePath == p_filePath)
+			return id;
+	}
+
+	Shader shader;
+
+	shader.filePath = p_filePath;
+
+	if (!this->CreateShaderModule(p_filePath, shader.module, shader.reflection))
+		return INVALID_SHADER_ID;
+
+	this->mShaders.push_back(shader);
+
+	return static_cast<ShaderId>(this->mShaders.size() - 1);
+}
+
+uint32_t VKPipelineManager::ReloadShader(const char* p_filePath)
+{
+	std::vector<ShaderId> reloaded;
+
+	for (ShaderId id = 0; id < this->mShaders.size(); id++)
+	{
+		Shader& shader = this->mShaders[id];
+
+		if (shader.filePath != p_filePath)
+			continue;
+
+		VkShaderModule		shaderModule = VK_NULL_HANDLE;
+		ShaderReflection	reflection;
+
+		if (!this->CreateShaderModule(p_filePath, shaderModule, reflection))
+			continue; //Keeps the previous one
+
+		if (!(reflection == shader.reflection))
+		{
+			std::cout << "[Pipelines] " << p_filePath << " : bindings, push constants or inputs changed, restart to use it" << std::endl;
+
+			vkDestroyShaderModule(this->mLogicalDevice, shaderModule, nullptr);
+			continue;
+		}
+
+		//Queued compilations may still reference it
+		this->mRetiredModules.push_back(shader.module);
+
+		shader.module = shaderModule;
+		reloaded.push_back(id);
+	}
+
+	if (reloaded.empty())
+		return 0;
+
+	std::vector<PendingPipeline> rebuilt;
+
+	for (auto& pipeline : this->mPipelines)
+	{
+		const PipelineState&	state = pipeline.first;
+		PipelineEntry&			entry = pipeline.second;
+
+		bool usesShader = false;
+
+		for (ShaderId id : reloaded)
+			usesShader |= state.vertexShader == id || state.fragmentShader == id;
+
+		PendingPipeline pending;
+
+		if (!usesShader || !this->MakePending(state, pending))
+			continue;
+
+		if (entry.pipeline == VK_NULL_HANDLE)
+			entry.status = Status::Compiling; //A failed one gets another chance
+
+		pending.version = ++entry.version;
+		rebuilt.push_back(pending);
+	}
+
+	this->Enqueue(rebuilt);
+
+	std::cout << "[Pipelines] " << p_filePath << " reloaded, " << rebuilt.size() << " pipelines to rebuild" << std::endl;
+
+	return static_cast<uint32_t>(rebuilt.size());
+}
+
+bool VKPipelineManager::CheckConstants(const Shader& p_shader, const SpecializationConstants& p_constants) const
+{
+	uint32_t mismatch = p_shader.reflection.FindMismatchedConstant(p_constants);
+
+	if (mismatch == UINT32_MAX)
+		return true;
+
+	uint32_t constantId = p_constants.GetId(mismatch);
+
+	bool declared = std::any_of(p_shader.reflection.specConstants.begin(), p_shader.reflection.specConstants.end(), [constantId](const ShaderSpecConstant& p_constant)
+	{
+		return p_constant.id == constantId;
+	});
+
+	std::cout << "[Pipelines] " << p_shader.filePath << " doesn't declare constant_id " << constantId << (declared ? " with this type" : "") << std::endl;
+
+	return false;
+}
+
+SpecializationId VKPipelineManager::RegisterSpecialization(const SpecializationConstants& p_constants)
+{
+	for (SpecializationId id = 0; id < this->mSpecializations.size(); id++)
+	{
+		if (this->mSpecializations[id] == p_constants)
+			return id;
+	}
+
+	this->mSpecializations.push_back(p_constants);
+
+	return static_cast<SpecializationId>(this->mSpecializations.size() - 1);
+}
+
+bool VKPipelineManager::MakePending(const PipelineState& p_state, PendingPipeline& p_pending) const
+{
+	if (p_state.vertexShader >= this->mShaders.size() || p_state.fragmentShader >= this->mShaders.size())
+	{
+		std::cout << "[Pipelines] state with an invalid shader id skipped" << std::endl;
+		return false;
+	}
+
+	if (p_state.vertexConstants >= this->mSpecializations.size() || p_state.fragmentConstants >= this->mSpecializations.size())
+	{
+		std::cout << "[Pipelines] state with an invalid specialization id skipped" << std::endl;
+		return false;
+	}
+
+	p_pending.state				= p_state;
+	p_pending.vertexModule		= this->mShaders[p_state.vertexShader].module;
+	p_pending.fragmentModule	= this->mShaders[p_state.fragmentShader].module;
+	p_pending.vertexConstants	= this->mSpecializations[p_state.vertexConstants];
+	p_pending.fragmentConstants = this->mSpecializations[p_state.fragmentConstants];
+	p_pending.pipeline			= VK_NULL_HANDLE;
+
+	if (!this->CheckConstants(this->mShaders[p_state.vertexShader], p_pending.vertexConstants) || !this->CheckConstants(this->mShaders[p_state.fragmentShader], p_pending.fragmentConstants))
+		return false;
+
+	p_pending.attributes.clear();
+
+	//The vertex format describes the whole vertex, only what the shader reads is fetched
+	auto vertexAttributes = VKRenderer::GetAttributeDescriptions(p_state.vertexFormat);
+
+	for (const ShaderVertexInput& input : this->mShaders[p_state.vertexShader].reflection.vertexInputs)
+	{
+		auto attribute = std::find_if(vertexAttributes.begin(), vertexAttributes.end(), [&input](const VkVertexInputAttributeDescription& p_attribute)
+		{
+			return p_attribute.location == input.location;
+		});
+
+		if (attribute == vertexAttributes.end())
+		{
+			std::cout << "[Pipelines] " << this->mShaders[p_state.vertexShader].filePath << " reads location " << input.location << " the vertex format doesn't have" << std::endl;
+			return false;
+		}
+
+		p_pending.attributes.push_back(*attribute);
+	}
+
+	return true;
+}
+
+VkResult VKPipelineManager::Compile(std::vector<PendingPipeline>& p_pipelines)
+{
+	VkPipelineDynamicStateCreateInfo pipelineDynamicStateCreateInfo{};
+
+	pipelineDynamicStateCreateInfo.sType				= VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	pipelineDynamicStateCreateInfo.dynamicStateCount	= static_cast<uint32_t>(DYNAMIC_STATES.size());
+	pipelineDynamicStateCreateInfo.pDynamicStates		= DYNAMIC_STATES.data();
+
+	//Sized once, the create infos point into it
+	std::vector<PipelineCreateStorage>			storages(p_pipelines.size());
+	std::vector<VkGraphicsPipelineCreateInfo>	createInfos(p_pipelines.size());
+	std::vector<VkPipeline>						pipelines(p_pipelines.size(), VK_NULL_HANDLE);
+
+	for (size_t i = 0; i < p_pipelines.size(); i++)
+		FillCreateInfo(p_pipelines[i].state, p_pipelines[i].vertexModule, p_pipelines[i].fragmentModule, p_pipelines[i].attributes, p_pipelines[i].vertexConstants, p_pipelines[i].fragmentConstants, pipelineDynamicStateCreateInfo, storages[i], createInfos[i]);
+
+	using Clock = std::chrono::high_resolution_clock;
+
+	auto start = Clock::now();
+
+	VkResult result = vkCreateGraphicsPipelines(this->mLogicalDevice, this->mPipelineCache->Get(), static_cast<uint32_t>(createInfos.size()), createInfos.data(), nullptr, pipelines.data());
+
+	//One string so lines from several threads don't interleave
+	std::string log = "[Pipelines] " + std::to_string(pipelines.size()) + " pipelines created in one call in " + std::to_string(std::chrono::duration<float, std::milli>(Clock::now() - start).count())
+					+ " ms with a " + (this->mPipelineCache->IsWarm() ? "warm" : "cold") + " cache (" + std::to_string(this->mPipelineCache->GetLoadedSize() / 1024) + " KB loaded)";
+
+#if PIPELINE_CACHE_BENCHMARK
+	//Same pipelines without any cache, drivers keeping their own on disk will still blur the difference
+	std::vector<VkPipeline> uncachedPipelines(createInfos.size(), VK_NULL_HANDLE);
+
+	start = Clock::now();
+
+	if (vkCreateGraphicsPipelines(this->mLogicalDevice, VK_NULL_HANDLE, static_cast<uint32_t>(createInfos.size()), createInfos.data(), nullptr, uncachedPipelines.data()) == VK_SUCCESS)
+		log += ", " + std::to_string(std::chrono::duration<float, std::milli>(Clock::now() - start).count()) + " ms without";
+
+	for (VkPipeline pipeline : uncachedPipelines)
+		vkDestroyPipeline(this->mLogicalDevice, pipeline, nullptr);
+#endif
+
+	std::cout << log + "\n" << std::flush;
+
+	//On failure the pipelines that could be created are still returned, the others are VK_NULL_HANDLE
+	bool createdAny = false;
+
+	for (size_t i = 0; i < p_pipelines.size(); i++)
+	{
+		p_pipelines[i].pipeline = pipelines[i];
+		createdAny |= pipelines[i] != VK_NULL_HANDLE;
+	}
+
+	//Right away rather than only on exit, a crash later on still keeps what was compiled
+	if (createdAny)
+	{
+		std::lock_guard<std::mutex> lock(this->mSaveMutex);
+
+		this->mPipelineCache->Save();
+	}
+
+	return result;
+}
+
+bool VKPipelineManager::CreatePipelines(const PipelineState* p_states, uint32_t p_count)
+{
+	//States without a pipeline yet, each one once
+	std::vector<PendingPipeline>							missing;
+	std::unordered_set<PipelineState, PipelineStateHash>	batch;
+	bool													valid = true;
+
+	for (uint32_t i = 0; i < p_count; i++)
+	{
+		if (this->mPipelines.count(p_states[i]) != 0 || batch.count(p_states[i]) != 0)
+			continue;
+
+		PendingPipeline pending;
+
+		if (!this->MakePending(p_states[i], pending))
+		{
+			valid = false;
+			continue;
+		}
+
+		batch.insert(p_states[i]);
+		missing.push_back(pending);
+	}
+
+	if (missing.empty())
+		return valid;
+
+	VkResult result = this->Compile(missing);
+
+	for (const PendingPipeline& pending : missing)
+	{
+		PipelineEntry& entry = this->mPipelines[pending.state];
+
+		entry.pipeline	= pending.pipeline;
+		entry.status	= pending.pipeline != VK_NULL_HANDLE ? Status::Ready : Status::Failed;
+	}
+
+	return valid && result == VK_SUCCESS;
+}
+
+void VKPipelineManager::RequestPipelines(const PipelineState* p_states, uint32_t p_count)
+{
+	std::vector<PendingPipeline> queued;
+
+	for (uint32_t i = 0; i < p_count; i++)
+	{
+		//Also catches the duplicates of this request, their entry was just added
+		if (this->mPipelines.count(p_states[i]) != 0)
+			continue;
+
+		PendingPipeline pending;
+
+		if (!this->MakePending(p_states[i], pending))
+			continue;
+
+		this->mPipelines[p_states[i]].status = Status::Compiling;
+		queued.push_back(pending);
+	}
+
+	this->Enqueue(queued);
+}
+
+void VKPipelineManager::Enqueue(const std::vector<PendingPipeline>& p_pipelines)
+{
+	if (p_pipelines.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(this->mMutex);
+
+		this->mQueue.insert(this->mQueue.end(), p_pipelines.begin(), p_pipelines.end());
+		this->mInFlight += static_cast<uint32_t>(p_pipelines.size());
+	}
+
+	this->mCondition.notify_all();
+}
+
+void VKPipelineManager::WorkerLoop()
+{
+	for (;;)
+	{
+		std::vector<PendingPipeline> batch;
+
+		{
+			std::unique_lock<std::mutex> lock(this->mMutex);
+
+			this->mCondition.wait(lock, [this] { return this->mStopping || !this->mQueue.empty(); });
+
+			if (this->mStopping)
+				return;
+
+			//An even share of the queue, each worker compiles its part in one call
+			size_t count = (this->mQueue.size() + this->mThreadCount - 1) / this->mThreadCount;
+
+			batch.assign(this->mQueue.begin(), this->mQueue.begin() + count);
+			this->mQueue.erase(this->mQueue.begin(), this->mQueue.begin() + count);
+		}
+
+		this->Compile(batch);
+
+		std::lock_guard<std::mutex> lock(this->mMutex);
+
+		this->mCompleted.insert(this->mCompleted.end(), batch.begin(), batch.end());
+		this->mInFlight -= static_cast<uint32_t>(batch.size());
+	}
+}
+
+void VKPipelineManager::Update()
+{
+	this->mFrameIndex++;
+
+	std::vector<PendingPipeline>	completed;
+	bool							idle;
+
+	{
+		std::lock_guard<std::mutex> lock(this->mMutex);
+
+		completed.swap(this->mCompleted);
+		idle = this->mInFlight == 0;
+	}
+
+	for (const PendingPipeline& pending : completed)
+	{
+		PipelineEntry& entry = this->mPipelines[pending.state];
+
+		//A newer rebuild is on its way, this one was never bound
+		if (pending.version != entry.version)
+		{
+			vkDestroyPipeline(this->mLogicalDevice, pending.pipeline, nullptr);
+			continue;
+		}
+
+		if (pending.pipeline == VK_NULL_HANDLE)
+		{
+			//A failed rebuild keeps drawing with the previous pipeline
+			entry.status = entry.pipeline != VK_NULL_HANDLE ? Status::Ready : Status::Failed;
+			continue;
+		}
+
+		if (entry.pipeline != VK_NULL_HANDLE)
+			this->mRetiredPipelines.push_back({ entry.pipeline, this->mFrameIndex });
+
+		entry.pipeline	= pending.pipeline;
+		entry.status	= Status::Ready;
+	}
+
+	//A pipeline replaced during frame N was last bound by frame N - 1, same as the streamer's views
+	auto retired = std::remove_if(this->mRetiredPipelines.begin(), this->mRetiredPipelines.end(), [this](const RetiredPipeline& p_retired)
+	{
+		if (p_retired.frame + this->mFramesInFlight > this->mFrameIndex)
+			return false;
+
+		vkDestroyPipeline(this->mLogicalDevice, p_retired.pipeline, nullptr);
+		return true;
+	});
+
+	this->mRetiredPipelines.erase(retired, this->mRetiredPipelines.end());
+
+	//Modules are only read while pipelines are created
+	if (idle)
+	{
+		for (VkShaderModule module : this->mRetiredModules)
+			vkDestroyShaderModule(this->mLogicalDevice, module, nullptr);
+
+		this->mRetiredModules.clear();
+	}
+}
+
+VkDescriptorSetLayout VKPipelineManager::GetSetLayout(const std::vector<ShaderBinding>& p_bindings)
+{
+	std::vector<uint32_t> key;
+
+	for (const ShaderBinding& binding : p_bindings)
+		key.insert(key.end(), { binding.binding, (uint32_t)binding.type, binding.count, binding.stages });
+
+	auto setLayout = this->mSetLayouts.find(key);
+
+	if (setLayout != this->mSetLayouts.end())
+		return setLayout->second;
+
+	std::vector<VkDescriptorSetLayoutBinding> layoutBindings(p_bindings.size());
+
+	for (size_t i = 0; i < p_bindings.size(); i++)
+	{
+		layoutBindings[i].binding			= p_bindings[i].binding;
+		layoutBindings[i].descriptorType	= p_bindings[i].type;
+		layoutBindings[i].descriptorCount	= p_bindings[i].count;
+		layoutBindings[i].stageFlags		= p_bindings[i].stages;
+	}
+
+	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo{};
+
+	descriptorSetLayoutCreateInfo.sType			= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	descriptorSetLayoutCreateInfo.bindingCount	= static_cast<uint32_t>(layoutBindings.size());
+	descriptorSetLayoutCreateInfo.pBindings		= layoutBindings.data();
+
+	VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+
+	if (vkCreateDescriptorSetLayout(this->mLogicalDevice, &descriptorSetLayoutCreateInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS)
+		return VK_NULL_HANDLE;
+
+	this->mSetLayouts.emplace(key, descriptorSetLayout);
+
+	return descriptorSetLayout;
+}
+
+VkPipelineLayout VKPipelineManager::GetPipelineLayout(ShaderId p_vertexShader, ShaderId p_fragmentShader, std::vector<VkDescriptorSetLayout>* p_setLayouts)
+{
+	if (p_vertexShader >= this->mShaders.size() || p_fragmentShader >= this->mShaders.size())
+		return VK_NULL_HANDLE;
+
+	ShaderReflection reflection = this->mShaders[p_vertexShader].reflection;
+
+	if (!reflection.Merge(this->mShaders[p_fragmentShader].reflection))
+		return VK_NULL_HANDLE;
+
+	//Sets in between the used ones get an empty layout
+	std::vector<VkDescriptorSetLayout>	setLayouts(reflection.GetSetCount());
+	std::vector<uint64_t>				key;
+
+	for (uint32_t set = 0; set < setLayouts.size(); set++)
+	{
+		setLayouts[set] = this->GetSetLayout(reflection.GetSetBindings(set));
+
+		if (setLayouts[set] == VK_NULL_HANDLE)
+			return VK_NULL_HANDLE;
+
+		key.push_back((uint64_t)setLayouts[set]);
+	}
+
+	for (const VkPushConstantRange& range : reflection.pushConstants)
+		key.insert(key.end(), { (uint64_t)range.stageFlags, (uint64_t)range.offset, (uint64_t)range.size });
+
+	if (p_setLayouts)
+		*p_setLayouts = setLayouts;
+
+	auto pipelineLayout = this->mPipelineLayouts.find(key);
+
+	if (pipelineLayout != this->mPipelineLayouts.end())
+		return pipelineLayout->second;
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+
+	pipelineLayoutInfo.sType					= VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount			= static_cast<uint32_t>(setLayouts.size());
+	pipelineLayoutInfo.pSetLayouts				= setLayouts.data();
+	pipelineLayoutInfo.pushConstantRangeCount	= static_cast<uint32_t>(reflection.pushConstants.size());
+	pipelineLayoutInfo.pPushConstantRanges		= reflection.pushConstants.data();
+
+	VkPipelineLayout layout = VK_NULL_HANDLE;
+
+	if (vkCreatePipelineLayout(this->mLogicalDevice, &pipelineLayoutInfo, nullptr, &layout) != VK_SUCCESS)
+		return VK_NULL_HANDLE;
+
+	this->mPipelineLayouts.emplace(key, layout);
+
+	std::cout << "[Pipelines] layout with " << setLayouts.size() << " sets and " << reflection.pushConstants.size() << " push constant ranges (" << this->mPipelineLayouts.size() << " layouts, " << this->mSetLayouts.size() << " set layouts)" << std::endl;
+
+	return layout;
+}
+
+VkPipeline VKPipelineManager::GetPipeline(const PipelineState& p_state)
+{
+	if (this->mPipelines.count(p_state) == 0)
+		this->CreatePipelines(&p_state, 1);
+
+	return this->Find(p_state);
+}
+
+VkPipeline VKPipelineManager::Find(const PipelineState& p_state) const
+{
+	auto entry = this->mPipelines.find(p_state);
+
+	return entry != this->mPipelines.end() ? entry->second.pipeline : VK_NULL_HANDLE;
+}
+
+VkPipeline VKPipelineManager::FindOrFallback(const PipelineState& p_state, const PipelineState& p_fallback) const
+{
+	VkPipeline pipeline = this->Find(p_state);
+
+	return pipeline != VK_NULL_HANDLE ? pipeline : this->Find(p_fallback);
+}
+
+VKPipelineManager::Status VKPipelineManager::GetStatus(const PipelineState& p_state) const
+{
+	auto entry = this->mPipelines.find(p_state);
+
+	return entry != this->mPipelines.end() ? entry->second.status : Status::Unknown;
+}
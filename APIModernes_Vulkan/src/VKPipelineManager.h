@@ -0,0 +1,216 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "SpirvReflection.h"
+#include "Utils.h"
+#include "VKPipelineCache.h"
+
+typedef uint32_t ShaderId;			//Rather than a VkShaderModule : a reload swaps the module and the states keep their key
+typedef uint32_t SpecializationId;	//A shader permutation, one pipeline each specialized by the driver
+
+#define INVALID_SHADER_ID UINT32_MAX
+//Every constant keeps the default written in the shader
+#define NO_SPECIALIZATION 0
+
+//
+//Everything a graphics pipeline is built from. Compared and hashed as raw bytes, so every field is 4 or 8 bytes and
+//the struct has no padding : two states that compare equal always make the same pipeline.
+//Viewport and scissor are always dynamic, they're not part of the state
+//
+struct PipelineState
+{
+	ShaderId				vertexShader	= INVALID_SHADER_ID;
+	ShaderId				fragmentShader	= INVALID_SHADER_ID;
+	SpecializationId		vertexConstants	= NO_SPECIALIZATION;
+	SpecializationId		fragmentConstants = NO_SPECIALIZATION;
+	VertexFormat			vertexFormat	= VertexFormat::Float32;
+
+	VkPrimitiveTopology		topology		= VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	VkPolygonMode			polygonMode		= VK_POLYGON_MODE_FILL;
+	VkCullModeFlags			cullMode		= VK_CULL_MODE_BACK_BIT;
+	VkFrontFace				frontFace		= VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	VkSampleCountFlagBits	samples			= VK_SAMPLE_COUNT_1_BIT;
+
+	VkBool32				depthTest		= VK_TRUE;
+	VkBool32				depthWrite		= VK_TRUE;
+	VkCompareOp				depthCompareOp	= VK_COMPARE_OP_LESS;
+
+	VkBool32				blendEnable		= VK_FALSE;
+	VkBlendFactor			srcColorFactor	= VK_BLEND_FACTOR_SRC_ALPHA;
+	VkBlendFactor			dstColorFactor	= VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	VkBlendOp				colorBlendOp	= VK_BLEND_OP_ADD;
+	VkBlendFactor			srcAlphaFactor	= VK_BLEND_FACTOR_ONE;
+	VkBlendFactor			dstAlphaFactor	= VK_BLEND_FACTOR_ZERO;
+	VkBlendOp				alphaBlendOp	= VK_BLEND_OP_ADD;
+	VkColorComponentFlags	colorWriteMask	= VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+	uint32_t				subpass			= 0;
+	VkPipelineLayout		layout			= VK_NULL_HANDLE;
+	VkRenderPass			renderPass		= VK_NULL_HANDLE;
+
+	bool operator==(const PipelineState& p_other) const;
+};
+
+struct PipelineStateHash
+{
+	size_t operator()(const PipelineState& p_state) const;
+};
+
+//
+//Owns the shader modules and every graphics pipeline, one VkPipeline per distinct PipelineState.
+//Pipelines are created ahead of time, many per driver call, right away or on worker threads.
+//Only the render thread publishes them, so looking one up to draw never waits on a compilation
+//
+class VKPipelineManager
+{
+public:
+	enum class Status
+	{
+		Unknown,	//Never requested
+		Compiling,	//Queued or on a worker
+		Ready,		//Also while it's rebuilt after a shader reload
+		Failed		//Not retried until one of its shaders is reloaded
+	};
+
+private:
+	struct Shader
+	{
+		std::string			filePath;
+		VkShaderModule		module;
+		ShaderReflection	reflection;
+	};
+
+	struct PipelineEntry
+	{
+		VkPipeline	pipeline	= VK_NULL_HANDLE;
+		Status		status		= Status::Compiling;
+		uint32_t	version		= 0;	//Bumped by every rebuild, results of an older one are dropped
+	};
+
+	//A state with its modules, vertex attributes and constants resolved, everything a worker needs
+	struct PendingPipeline
+	{
+		PipelineState									state;
+		VkShaderModule									vertexModule	= VK_NULL_HANDLE;
+		VkShaderModule									fragmentModule	= VK_NULL_HANDLE;
+		std::vector<VkVertexInputAttributeDescription>	attributes;
+		SpecializationConstants							vertexConstants;
+		SpecializationConstants							fragmentConstants;
+		VkPipeline										pipeline		= VK_NULL_HANDLE;
+		uint32_t										version			= 0;
+	};
+
+	struct RetiredPipeline
+	{
+		VkPipeline	pipeline;
+		uint64_t	frame;
+	};
+
+	VkDevice			mLogicalDevice	= VK_NULL_HANDLE;
+	VKPipelineCache*	mPipelineCache	= nullptr;	//Internally synchronized, every worker compiles through it
+	std::mutex			mSaveMutex;		//VKPipelineCache::Save() is called from every compiling thread
+
+	//Render thread only
+	std::vector<Shader>														mShaders; //Indexed by ShaderId, reflected when loaded
+	std::vector<SpecializationConstants>									mSpecializations; //Indexed by SpecializationId
+	std::unordered_map<PipelineState, PipelineEntry, PipelineStateHash>		mPipelines;
+
+	uint32_t						mFramesInFlight = 1;
+	uint64_t						mFrameIndex		= 0;
+	std::vector<RetiredPipeline>	mRetiredPipelines;	//Replaced by a rebuild, frames in flight may still use them
+	std::vector<VkShaderModule>		mRetiredModules;	//Replaced by a reload, destroyed once no compilation is left
+
+	std::map<std::vector<uint32_t>, VkDescriptorSetLayout>	mSetLayouts;		//Keyed by their bindings
+	std::map<std::vector<uint64_t>, VkPipelineLayout>		mPipelineLayouts;	//Keyed by their set layouts and push constant ranges
+
+	//Worker side
+	std::vector<std::thread>		mWorkers;
+	uint32_t						mThreadCount = 0;
+	std::mutex						mMutex;
+	std::condition_variable			mCondition;
+	std::deque<PendingPipeline>		mQueue;
+	std::vector<PendingPipeline>	mCompleted;	//Published by the next Update()
+	uint32_t						mInFlight = 0;	//Queued or being compiled
+	bool							mStopping = false;
+
+private:
+	void WorkerLoop();
+
+	//False when the file can't be read or reflected
+	bool CreateShaderModule(const char* p_filePath, VkShaderModule& p_module, ShaderReflection& p_reflection) const;
+
+	VkDescriptorSetLayout GetSetLayout(const std::vector<ShaderBinding>& p_bindings);
+
+	//False when p_constants sets a constant p_shader doesn't declare, or with another type
+	bool CheckConstants(const Shader& p_shader, const SpecializationConstants& p_constants) const;
+
+	//Resolves the modules, the attributes the vertex shader reads and the constants, false when an id is invalid,
+	//an input isn't in the vertex format or a constant doesn't match the shader
+	bool MakePending(const PipelineState& p_state, PendingPipeline& p_pending) const;
+
+	//Creates every pipeline of p_pipelines in one driver call, callable from any thread.
+	//Failed ones are left to VK_NULL_HANDLE
+	VkResult Compile(std::vector<PendingPipeline>& p_pipelines);
+
+	void Enqueue(const std::vector<PendingPipeline>& p_pipelines);
+
+public:
+	//p_threadCount = 0 : every core but one
+	bool Init(VkDevice p_logicalDevice, VKPipelineCache* p_pipelineCache, uint32_t p_framesInFlight, uint32_t p_threadCount = 0);
+	//The device must be idle. Waits for the pipelines being compiled, the queued ones are dropped
+	void Release();
+
+	//Loads and reflects a SPIR-V file once, the same path gives back the same id. INVALID_SHADER_ID when it can't be loaded
+	ShaderId LoadShader(const char* p_filePath);
+
+	//Reads p_filePath again for every shader loaded from it and rebuilds the pipelines using them on the workers.
+	//Until a rebuilt pipeline is ready Find() keeps returning the previous one. Returns the number of pipelines rebuilt.
+	//The shader must keep the same interface, its pipeline layout can't change under the pipelines using it
+	uint32_t ReloadShader(const char* p_filePath);
+
+	//Layout of the interface of both shaders merged, pipelines whose shaders declare the same share it.
+	//p_setLayouts receives its set layouts indexed by set number. Owned by the manager, VK_NULL_HANDLE when the stages disagree
+	VkPipelineLayout GetPipelineLayout(ShaderId p_vertexShader, ShaderId p_fragmentShader, std::vector<VkDescriptorSetLayout>* p_setLayouts = nullptr);
+
+	const ShaderReflection& GetReflection(ShaderId p_shader) const { return this->mShaders[p_shader].reflection; }
+
+	//Id of a set of constant values to put in PipelineState::vertexConstants or fragmentConstants, the same values give
+	//back the same id so the same permutation is always the same pipeline. Empty constants are NO_SPECIALIZATION
+	SpecializationId RegisterSpecialization(const SpecializationConstants& p_constants);
+
+	//Creates the pipelines of every state that doesn't have one yet in one driver call, duplicates included only once.
+	//Blocks until they're done. False when one of them failed, the others are still usable
+	bool CreatePipelines(const PipelineState* p_states, uint32_t p_count);
+
+	//Same as CreatePipelines() on the worker threads, one driver call per worker, returns right away
+	void RequestPipelines(const PipelineState* p_states, uint32_t p_count);
+
+	//Once per frame on the render thread after the frame's fence wait, publishes what the workers compiled since the last call
+	//and destroys what no frame in flight can use anymore
+	void Update();
+
+	//Creates the pipeline on a miss and waits for it, prefer CreatePipelines() or RequestPipelines() ahead of time.
+	//VK_NULL_HANDLE while a requested one is still compiling
+	VkPipeline GetPipeline(const PipelineState& p_state);
+
+	//Hash lookup without a lock that never reaches the driver. VK_NULL_HANDLE until the state's pipeline is ready, never creates one
+	VkPipeline Find(const PipelineState& p_state) const;
+	//The pipeline of p_fallback while p_state's one isn't ready
+	VkPipeline FindOrFallback(const PipelineState& p_state, const PipelineState& p_fallback) const;
+
+	Status	GetStatus(const PipelineState& p_state) const;
+	bool	IsReady(const PipelineState& p_state) const { return this->GetStatus(p_state) == Status::Ready; }
+
+	size_t GetPipelineCount() const { return this->mPipelines.size(); }
+};
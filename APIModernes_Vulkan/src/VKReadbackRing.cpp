@@ -0,0 +1,242 @@
+#include "VKReadbackRing.h"
+
+#include <algorithm>
+#include <iostream>
+
+bool VKReadbackRing::Init(VkDevice p_logicalDevice, VKMemoryAllocator* p_allocator, uint32_t p_slotCount, const ReadbackCallback& p_callback, bool p_dropWhenBusy)
+{
+	this->mLogicalDevice	= p_logicalDevice;
+	this->mAllocator		= p_allocator;
+	this->mCallback			= p_callback;
+	this->mDropWhenBusy		= p_dropWhenBusy;
+
+	//Buffers are created by the first Record() of each slot, at the size of what it copies
+	this->mSlots.resize(p_slotCount);
+
+	this->mStopping = false;
+
+	//A single worker : the consumer sees the frames in order, what a video encoder needs
+	this->mWorker = std::thread(&VKReadbackRing::WorkerLoop, this);
+
+	return true;
+}
+
+void VKReadbackRing::Release()
+{
+	if (this->mLogicalDevice == VK_NULL_HANDLE)
+		return;
+
+	//The device is idle, every copy recorded is done
+	this->Update();
+
+	{
+		std::lock_guard<std::mutex> lock(this->mMutex);
+
+		this->mStopping = true;
+	}
+
+	this->mCondition.notify_all();
+
+	//Drains the queue first
+	if (this->mWorker.joinable())
+		this->mWorker.join();
+
+	for (Slot& slot : this->mSlots)
+	{
+		vkDestroyBuffer(this->mLogicalDevice, slot.buffer, nullptr);
+		this->mAllocator->Free(slot.memory);
+	}
+
+	this->mSlots.clear();
+
+	std::cout << "[Readback] " << this->mReadCount << " frames read back, " << this->mDroppedCount << " dropped" << std::endl;
+
+	this->mLogicalDevice = VK_NULL_HANDLE;
+}
+
+uint32_t VKReadbackRing::GetPixelSize(VkFormat p_format)
+{
+	switch (p_format)
+	{
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SRGB:
+	case VK_FORMAT_B8G8R8A8_UNORM:
+	case VK_FORMAT_B8G8R8A8_SRGB:
+	case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
+	case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
+	case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+	case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
+		return 4;
+	case VK_FORMAT_R16G16B16A16_SFLOAT:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+bool VKReadbackRing::Record(VkCommandBuffer p_commandBuffer, uint32_t p_slot, VkImage p_image, VkFormat p_format, VkExtent2D p_extent, VkFence p_fence, uint64_t p_frameIndex)
+{
+	uint32_t pixelSize = GetPixelSize(p_format);
+
+	if (pixelSize == 0 || p_slot >= this->mSlots.size())
+		return false;
+
+	Slot& slot = this->mSlots[p_slot];
+
+	{
+		std::unique_lock<std::mutex> lock(this->mMutex);
+
+		//Copying : Update() wasn't called since the slot's fence wait, it will be picked up later
+		if (slot.state == SlotState::Copying || (slot.state == SlotState::Consuming && this->mDropWhenBusy))
+		{
+			this->mDroppedCount++;
+			return false;
+		}
+
+		this->mCondition.wait(lock, [&slot] { return slot.state == SlotState::Free; });
+	}
+
+	//Free : neither the GPU nor the consumer uses the buffer anymore, it can be replaced
+	VkDeviceSize size = (VkDeviceSize)p_extent.width * p_extent.height * pixelSize;
+
+	if (slot.size < size)
+	{
+		vkDestroyBuffer(this->mLogicalDevice, slot.buffer, nullptr);
+		this->mAllocator->Free(slot.memory);
+
+		slot.buffer = VK_NULL_HANDLE;
+		slot.size	= 0;
+
+		VkBufferCreateInfo bufferCreateInfo{};
+
+		bufferCreateInfo.sType			= VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCreateInfo.size			= size;
+		bufferCreateInfo.usage			= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		bufferCreateInfo.sharingMode	= VK_SHARING_MODE_EXCLUSIVE;
+
+		if (vkCreateBuffer(this->mLogicalDevice, &bufferCreateInfo, nullptr, &slot.buffer) != VK_SUCCESS)
+		{
+			slot.buffer = VK_NULL_HANDLE;
+			return false;
+		}
+
+		//Host cached : the consumer reads every byte, uncached reads would be several times slower
+		if (!this->mAllocator->AllocateForBuffer(slot.buffer, MemoryUsage::Readback, slot.memory) || !slot.memory.mappedData)
+		{
+			std::cout << "[Readback] can't allocate " << size << " bytes" << std::endl;
+
+			vkDestroyBuffer(this->mLogicalDevice, slot.buffer, nullptr);
+			this->mAllocator->Free(slot.memory);
+
+			slot.buffer = VK_NULL_HANDLE;
+			slot.memory = MemoryAllocation();
+			return false;
+		}
+
+		slot.size = size;
+	}
+
+	VkBufferImageCopy region{};
+
+	region.imageSubresource.aspectMask	= VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount	= 1;
+	region.imageExtent					= { p_extent.width, p_extent.height, 1 };
+
+	vkCmdCopyImageToBuffer(p_commandBuffer, p_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer, 1, &region);
+
+	//Made visible to the host by the fence signal
+	VkBufferMemoryBarrier hostBarrier{};
+
+	hostBarrier.sType				= VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	hostBarrier.srcAccessMask		= VK_ACCESS_TRANSFER_WRITE_BIT;
+	hostBarrier.dstAccessMask		= VK_ACCESS_HOST_READ_BIT;
+	hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	hostBarrier.buffer				= slot.buffer;
+	hostBarrier.size				= VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(p_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+
+	slot.fence				= p_fence;
+	slot.frame.pixels		= static_cast<const uint8_t*>(slot.memory.mappedData);
+	slot.frame.width		= p_extent.width;
+	slot.frame.height		= p_extent.height;
+	slot.frame.rowPitch		= p_extent.width * pixelSize;
+	slot.frame.format		= p_format;
+	slot.frame.frameIndex	= p_frameIndex;
+
+	std::lock_guard<std::mutex> lock(this->mMutex);
+
+	slot.state = SlotState::Copying;
+
+	return true;
+}
+
+void VKReadbackRing::Update()
+{
+	std::vector<uint32_t> done;
+
+	{
+		std::lock_guard<std::mutex> lock(this->mMutex);
+
+		for (uint32_t i = 0; i < this->mSlots.size(); i++)
+		{
+			Slot& slot = this->mSlots[i];
+
+			if (slot.state != SlotState::Copying || vkGetFenceStatus(this->mLogicalDevice, slot.fence) != VK_SUCCESS)
+				continue;
+
+			this->mAllocator->Invalidate(slot.memory);
+
+			slot.state = SlotState::Consuming;
+			done.push_back(i);
+		}
+
+		if (done.empty())
+			return;
+
+		//Slots don't finish in slot order
+		std::sort(done.begin(), done.end(), [this](uint32_t p_a, uint32_t p_b)
+		{
+			return this->mSlots[p_a].frame.frameIndex < this->mSlots[p_b].frame.frameIndex;
+		});
+
+		this->mQueue.insert(this->mQueue.end(), done.begin(), done.end());
+		this->mReadCount += done.size();
+	}
+
+	this->mCondition.notify_all();
+}
+
+void VKReadbackRing::WorkerLoop()
+{
+	for (;;)
+	{
+		uint32_t index;
+
+		{
+			std::unique_lock<std::mutex> lock(this->mMutex);
+
+			this->mCondition.wait(lock, [this] { return this->mStopping || !this->mQueue.empty(); });
+
+			//Stopping, but what's queued is still consumed
+			if (this->mQueue.empty())
+				return;
+
+			index = this->mQueue.front();
+			this->mQueue.pop_front();
+		}
+
+		//Outside the lock : the render thread only blocks on the consumer when it waits for this very slot
+		if (this->mCallback)
+			this->mCallback(this->mSlots[index].frame);
+
+		{
+			std::lock_guard<std::mutex> lock(this->mMutex);
+
+			this->mSlots[index].state = SlotState::Free;
+		}
+
+		this->mCondition.notify_all();
+	}
+}
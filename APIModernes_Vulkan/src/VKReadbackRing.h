@@ -0,0 +1,95 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "VKMemoryAllocator.h"
+
+//A rendered frame on the CPU, the pixels point into the ring and are only valid during the callback
+struct ReadbackFrame
+{
+	const uint8_t*	pixels		= nullptr;
+	uint32_t		width		= 0;
+	uint32_t		height		= 0;
+	uint32_t		rowPitch	= 0;	//Bytes
+	VkFormat		format		= VK_FORMAT_UNDEFINED;
+	uint64_t		frameIndex	= 0;
+};
+
+//Called on the ring's worker thread, one frame at a time in the order they were rendered
+typedef std::function<void(const ReadbackFrame&)> ReadbackCallback;
+
+//
+//Reads rendered frames back without stalling the render loop. One host cached buffer per frame in flight : the frame's
+//command buffer copies its color target in, the render thread polls the frame's fence without waiting on it and hands
+//the buffer to a worker thread, which gives it to the consumer (image writer, video encoder...) straight from the mapping.
+//The render thread only ever records a copy and checks fences, the GPU copy overlaps the next frames.
+//A slot still with the consumer when its frame in flight comes back is either skipped (the frame is dropped, counted)
+//or waited for, for offscreen runs where every frame matters more than the frame rate
+//
+class VKReadbackRing
+{
+private:
+	enum class SlotState
+	{
+		Free,
+		Copying,	//Recorded, its fence isn't signaled yet
+		Consuming	//Queued or with the consumer
+	};
+
+	struct Slot
+	{
+		VkBuffer			buffer	= VK_NULL_HANDLE;
+		MemoryAllocation	memory;
+		VkDeviceSize		size	= 0;
+		SlotState			state	= SlotState::Free;
+		VkFence				fence	= VK_NULL_HANDLE;	//Of the submission that copies into it
+		ReadbackFrame		frame;
+	};
+
+	VkDevice			mLogicalDevice	= VK_NULL_HANDLE;
+	VKMemoryAllocator*	mAllocator		= nullptr;
+	ReadbackCallback	mCallback;
+	bool				mDropWhenBusy	= true;
+
+	std::vector<Slot>	mSlots;			//Indexed by frame in flight, states guarded by mMutex
+	uint64_t			mReadCount		= 0;
+	uint64_t			mDroppedCount	= 0;
+
+	//Worker side
+	std::thread				mWorker;
+	std::mutex				mMutex;
+	std::condition_variable mCondition;
+	std::deque<uint32_t>	mQueue;		//Slots to consume, oldest frame first
+	bool					mStopping = false;
+
+private:
+	void WorkerLoop();
+
+	//Bytes per pixel of the formats the ring can read back, 0 for the others
+	static uint32_t GetPixelSize(VkFormat p_format);
+
+public:
+	//p_slotCount : frames in flight. p_dropWhenBusy : skip a frame rather than wait for the consumer
+	bool Init(VkDevice p_logicalDevice, VKMemoryAllocator* p_allocator, uint32_t p_slotCount, const ReadbackCallback& p_callback, bool p_dropWhenBusy = true);
+	//The device must be idle. The frames already copied are still handed to the consumer before the worker stops
+	void Release();
+
+	//Records the copy of p_image, in TRANSFER_SRC_OPTIMAL and visible to transfers, into the slot of the frame in flight.
+	//p_fence is the one the command buffer is submitted with. False when the frame is dropped or the format isn't readable
+	bool Record(VkCommandBuffer p_commandBuffer, uint32_t p_slot, VkImage p_image, VkFormat p_format, VkExtent2D p_extent, VkFence p_fence, uint64_t p_frameIndex);
+
+	//Once per frame on the render thread, after the frame's fence wait and before the fence is reset.
+	//Non blocking, hands every slot whose copy is done to the worker
+	void Update();
+
+	uint64_t GetReadCount() const		{ return this->mReadCount; }
+	uint64_t GetDroppedCount() const	{ return this->mDroppedCount; }
+};
@@ -1,5 +1,9 @@
-#include <unordered_map>
+#include <algorithm>
 #include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
 #include <set>
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -10,13 +14,30 @@
 #define GLFW_INCLUDE_VULKAN
 #include "GLFW/glfw3.h"
 
+#include "VertexDeduplicator.h" //Before the implementation, tinyobj can only be included once with it
+
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "tinyobjloader/tiny_obj_loader.h"
 
 #include "Utils.h"
 
 #include "VKRenderer.h"
+#include "MeshOptimizer.h"
+#include "MipmapGenerator.h"
+#include "VertexPacker.h"
+
+//triangle.frag's "layout(constant_id = 0) const bool USE_VERTEX_COLOR"
+static const SpecializationConstant<bool> USE_VERTEX_COLOR{ 0 };
+
+VKRenderer::VKRenderer(const FramePacing& p_pacing, bool p_headless)
+{
+	this->mHeadless = p_headless;
 
+	this->mPacing = p_pacing;
+	this->mPacing.framesInFlight = std::min(std::max(p_pacing.framesInFlight, 1u), 3u);
+
+	this->mGraphicsPipeline.framesInFlight = this->mPacing.framesInFlight;
+}
 
 bool VKRenderer::CreateVKInstance()
 {
@@ -40,7 +61,11 @@ bool VKRenderer::CreateVKInstance()
 	VkInstanceCreateInfo instanceCreateInfo{};
 
 	uint32_t glfwExtentionCount = 0;
-	const char** glfwExtentionsChr = glfwGetRequiredInstanceExtensions(&glfwExtentionCount);
+	const char** glfwExtentionsChr = nullptr;
+
+	//Headless needs no surface extension, glfw isn't even initialized
+	if (!this->mHeadless)
+		glfwExtentionsChr = glfwGetRequiredInstanceExtensions(&glfwExtentionCount);
 
 	instanceCreateInfo.sType					= VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 	instanceCreateInfo.pApplicationInfo			= &applicationInfo;
@@ -137,6 +162,10 @@ bool VKRenderer::DeviceIsSupported(const VkPhysicalDevice& p_device)
 
 	bool extentionsSupported = this->CheckDeviceExtentions(p_device);
 
+	//Servers rendering headless may only have a CPU implementation (lavapipe)
+	if (this->mHeadless)
+		return true;
+
 	return (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU && deviceFeatures.geometryShader);
 }
 
@@ -150,26 +179,36 @@ DeviceSupportedQueues VKRenderer::GetDeviceSupportedQueues(const VkPhysicalDevic
 	std::vector<VkQueueFamilyProperties> queueFamilies(queueCount);
 	vkGetPhysicalDeviceQueueFamilyProperties(p_device, &queueCount, queueFamilies.data());
 
+	bool transferIsDedicated = false;
+
 	uint32_t i = 0;
 	for (const VkQueueFamilyProperties& queues : queueFamilies)
 	{
-		if (queues.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+		if ((queues.queueFlags & VK_QUEUE_GRAPHICS_BIT) && result.graphicsFamily == UINT32_MAX)
 			result.graphicsFamily = i;
 
 		VkBool32 presentSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(p_device, i, this->mRenderingSurface, &presentSupport);
 
-		if (presentSupport)
+		if (!this->mHeadless)
+			vkGetPhysicalDeviceSurfaceSupportKHR(p_device, i, this->mRenderingSurface, &presentSupport);
+
+		if (presentSupport && result.presentFamily == UINT32_MAX)
 			result.presentFamily = i;
 
-		if (result.isComplete())
+		//Families without graphics are the copy engines, they run next to rendering. Transfer only beats async compute
+		if ((queues.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queues.queueFlags & VK_QUEUE_GRAPHICS_BIT) && !transferIsDedicated)
 		{
-			return result;
+			result.transferFamily	= i;
+			transferIsDedicated		= !(queues.queueFlags & VK_QUEUE_COMPUTE_BIT);
 		}
 
 		i++;
 	}
 
+	//Nothing is presented, the present queue is only there to be complete
+	if (this->mHeadless)
+		result.presentFamily = result.graphicsFamily;
+
 	return result;
 }
 
@@ -218,10 +257,15 @@ PhysicalDeviceDescription VKRenderer::GetBestDevice(const std::vector<VkPhysical
 		if (!supportedQueues.isComplete())
 			continue;
 		
-		SwapChainCapabilities parameters = this->GetSwapChainParameters(device);
+		SwapChainCapabilities parameters;
 
-		if (!parameters.isComplete())
-			continue;
+		if (!this->mHeadless)
+		{
+			parameters = this->GetSwapChainParameters(device);
+
+			if (!parameters.isComplete())
+				continue;
+		}
 		
 		VkPhysicalDeviceFeatures deviceFeatures;
 		vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
@@ -253,6 +297,9 @@ bool VKRenderer::CreateLogicalDevice()
 		this->mPhysicalDevice.supportedQueues.graphicsFamily
 	};
 
+	if (this->mPhysicalDevice.supportedQueues.hasTransferFamily())
+		queuesIdx.insert(this->mPhysicalDevice.supportedQueues.transferFamily);
+
 	constexpr float queuePriorities = 1.0f;
 
 	for (uint32_t queue : queuesIdx)
@@ -275,7 +322,7 @@ bool VKRenderer::CreateLogicalDevice()
 	deviceCreateInfo.queueCreateInfoCount		= (uint32_t)deviceQueueCreateInfos.size();
 	deviceCreateInfo.enabledLayerCount			= 0;
 	deviceCreateInfo.ppEnabledExtensionNames	= this->mExtensions.data();
-	deviceCreateInfo.enabledExtensionCount		= (uint32_t)this->mExtensions.size();
+	deviceCreateInfo.enabledExtensionCount		= this->mHeadless ? 0 : (uint32_t)this->mExtensions.size(); //Only the swapchain
 
 #ifdef _DEBUG
 	deviceCreateInfo.ppEnabledLayerNames = this->mValidationLayers.data();
@@ -287,6 +334,11 @@ bool VKRenderer::CreateLogicalDevice()
 	vkGetDeviceQueue(this->mLogicalDevice, this->mPhysicalDevice.supportedQueues.graphicsFamily, 0, &this->mGraphicsQueue);
 	vkGetDeviceQueue(this->mLogicalDevice, this->mPhysicalDevice.supportedQueues.presentFamily , 0, &this->mPresentQueue);
 
+	if (this->mPhysicalDevice.supportedQueues.hasTransferFamily())
+		vkGetDeviceQueue(this->mLogicalDevice, this->mPhysicalDevice.supportedQueues.transferFamily, 0, &this->mTransferQueue);
+	else
+		this->mTransferQueue = this->mGraphicsQueue;
+
 	return result;
 }
 
@@ -326,11 +378,20 @@ inline VkExtent2D VKRenderer::GetSwapchainExtent(const VkSurfaceCapabilitiesKHR&
 	}
 }
 
-bool VKRenderer::CreateSwapChain()
+bool VKRenderer::CreateSwapChain(VkSwapchainKHR p_oldSwapChain)
 {
 	VkSurfaceFormatKHR	imageFormat = GetSwapchainSurfaceFormat(this->mPhysicalDevice.swapChainParameters.formats);
 	VkExtent2D			imageExtent = GetSwapchainExtent(this->mPhysicalDevice.swapChainParameters.surfaceCapabilities);
 
+	//FIFO is the only one always there
+	const std::vector<VkPresentModeKHR>& presentModes	= this->mPhysicalDevice.swapChainParameters.presentModes;
+	VkPresentModeKHR					 presentMode	= VK_PRESENT_MODE_FIFO_KHR;
+
+	if (std::find(presentModes.begin(), presentModes.end(), this->mPacing.presentMode) != presentModes.end())
+		presentMode = this->mPacing.presentMode;
+	else
+		std::cout << "[FramePacing] " << GetPresentModeName(this->mPacing.presentMode) << " isn't supported by the surface, FIFO instead" << std::endl;
+
 	uint32_t imageCount = this->mPhysicalDevice.swapChainParameters.surfaceCapabilities.minImageCount + 1;
 
 	if (this->mPhysicalDevice.swapChainParameters.surfaceCapabilities.maxImageCount > 0 && imageCount > this->mPhysicalDevice.swapChainParameters.surfaceCapabilities.maxImageCount)
@@ -345,8 +406,8 @@ bool VKRenderer::CreateSwapChain()
 
 	swapchainCreateInfoKHR.sType			= VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
 	swapchainCreateInfoKHR.surface			= this->mRenderingSurface;
-	swapchainCreateInfoKHR.oldSwapchain		= VK_NULL_HANDLE;
-	swapchainCreateInfoKHR.presentMode		= VK_PRESENT_MODE_FIFO_KHR;		//Hardcoded
+	swapchainCreateInfoKHR.oldSwapchain		= p_oldSwapChain;	//Lets the driver reuse its resources
+	swapchainCreateInfoKHR.presentMode		= presentMode;
 	swapchainCreateInfoKHR.clipped			= VK_TRUE;
 
 	swapchainCreateInfoKHR.imageFormat		= imageFormat.format;
@@ -357,6 +418,21 @@ bool VKRenderer::CreateSwapChain()
 	swapchainCreateInfoKHR.imageArrayLayers = 1;
 	swapchainCreateInfoKHR.imageUsage		= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
+	//Read back : the images are copied from
+	if (this->mFrameConsumer)
+	{
+		if (this->mPhysicalDevice.swapChainParameters.surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+		{
+			swapchainCreateInfoKHR.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		}
+		else
+		{
+			std::cout << "[Readback] the swapchain images can't be copied from, nothing will be read back" << std::endl;
+
+			this->mFrameConsumer = nullptr;
+		}
+	}
+
 	swapchainCreateInfoKHR.minImageCount	= imageCount;
 	
 	if (this->mPhysicalDevice.supportedQueues.graphicsFamily != this->mPhysicalDevice.supportedQueues.presentFamily)
@@ -427,48 +503,170 @@ bool VKRenderer::CreateSwapChain()
 	}
 }
 
-bool VKRenderer::CreateDescriptorSetLayout()
+bool VKRenderer::RecreateSwapChain()
+{
+	using Clock = std::chrono::high_resolution_clock;
+
+	Clock::time_point start = Clock::now();
+
+	VkSurfaceCapabilitiesKHR& surfaceCapabilities = this->mPhysicalDevice.swapChainParameters.surfaceCapabilities;
+
+	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(this->mPhysicalDevice.physicalDevice, this->mRenderingSurface, &surfaceCapabilities);
+
+	VkExtent2D extent = this->GetSwapchainExtent(surfaceCapabilities);
+
+	//Minimized, nothing to present to
+	if (extent.width == 0 || extent.height == 0)
+		return false;
+
+	//The old swapchain is retired by the call even when it fails, so it's always kept until no frame uses it
+	SwapChainDescription oldSwapChain = this->mSwapChain;
+
+	this->mSwapChain = SwapChainDescription{};
+
+	bool result = this->CreateSwapChain(oldSwapChain.vkSwapChain);
+
+	if (oldSwapChain.vkSwapChain != VK_NULL_HANDLE)
+		this->mRetiredSwapChains.push_back({ oldSwapChain, this->mFrameIndex });
+
+	if (!result)
+		return false;
+
+	//Same format almost every time, otherwise the pipeline needs a render pass of the new one
+	if (this->mSwapChain.imageFormat != oldSwapChain.imageFormat)
+	{
+		this->mGraphicsPipeline.vkRenderPass = this->mRenderGraph.GetCompatibleRenderPass({ this->mSwapChain.imageFormat }, this->mDepthFormat);
+
+		for (PipelineState& state : this->mPipelineStates)
+			state.renderPass = this->mGraphicsPipeline.vkRenderPass;
+
+		this->mPipelineManager.RequestPipelines(this->mPipelineStates, 2);
+	}
+
+	//The depth buffer follows by itself : the render graph sees a new size and makes a new one
+
+	std::cout << "[Swapchain] recreated at " << extent.width << "x" << extent.height << " in " << std::chrono::duration<float, std::milli>(Clock::now() - start).count() << " ms" << std::endl;
+
+	return true;
+}
+
+void VKRenderer::DestroySwapChain(SwapChainDescription& p_swapChain)
+{
+	for (const VkImageView& imageView : p_swapChain.imageViews)
+	{
+		this->mRenderGraph.ForgetImageView(imageView);
+		vkDestroyImageView(this->mLogicalDevice, imageView, nullptr);
+	}
+
+	vkDestroySwapchainKHR(this->mLogicalDevice, p_swapChain.vkSwapChain, nullptr);
+
+	p_swapChain = SwapChainDescription{};
+}
+
+bool VKRenderer::CreateOffscreenTargets()
+{
+	SwapChainDescription targets{};
+
+	targets.imageFormat = VK_FORMAT_R8G8B8A8_SRGB; //What SaveFrame() writes, no swizzle
+	targets.extent		= { WINDOW_WIDTH, WINDOW_HEIGHT };
+
+	targets.images.resize(this->mGraphicsPipeline.framesInFlight);
+	targets.imageViews.resize(this->mGraphicsPipeline.framesInFlight);
+	this->mOffscreenMemory.resize(this->mGraphicsPipeline.framesInFlight);
+
+	bool result = true;
+
+	for (uint32_t i = 0; i < this->mGraphicsPipeline.framesInFlight; i++)
+	{
+		result &= this->CreateImage(targets.extent.width, targets.extent.height, 1, targets.imageFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, MemoryUsage::GpuOnly, targets.images[i], this->mOffscreenMemory[i]);
+
+		if (result)
+			targets.imageViews[i] = this->CreateImageView(targets.images[i], targets.imageFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+	}
+
+	this->mSwapChain = targets;
+
+	return result;
+}
+
+void VKRenderer::DestroyOffscreenTargets()
+{
+	for (size_t i = 0; i < this->mSwapChain.images.size(); i++)
+	{
+		if (this->mSwapChain.imageViews[i] != VK_NULL_HANDLE)
+		{
+			this->mRenderGraph.ForgetImageView(this->mSwapChain.imageViews[i]);
+			vkDestroyImageView(this->mLogicalDevice, this->mSwapChain.imageViews[i], nullptr);
+		}
+
+		vkDestroyImage(this->mLogicalDevice, this->mSwapChain.images[i], nullptr);
+		this->mAllocator.Free(this->mOffscreenMemory[i]);
+	}
+
+	this->mOffscreenMemory.clear();
+	this->mSwapChain = SwapChainDescription{};
+}
+
+bool VKRenderer::AcquireSwapChainImage(uint32_t& p_imageIndex, float& p_acquireTime)
 {
-	VkDescriptorSetLayoutBinding uboLayoutBinding{};
+	using Clock = std::chrono::high_resolution_clock;
+
+	if (this->mRenderingWindow->TakeFramebufferResized())
+		this->mSwapChainOutdated = true;
+
+	if (this->mSwapChainOutdated || this->mSwapChain.vkSwapChain == VK_NULL_HANDLE)
+	{
+		//Minimized or failed : the frame is skipped, the fence stays signaled for the next try
+		if (!this->RecreateSwapChain())
+			return false;
+
+		this->mSwapChainOutdated = false;
+	}
 
-	uboLayoutBinding.binding = 0;
-	uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	uboLayoutBinding.descriptorCount = 1;
-	uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	Clock::time_point acquireStart = Clock::now();
 
-	VkDescriptorSetLayoutBinding samplerLayoutBinding{};
+	VkResult acquireResult = vkAcquireNextImageKHR(this->mLogicalDevice, this->mSwapChain.vkSwapChain, UINT64_MAX, this->mImageAviableSemaphore[this->mCurrentFrame], VK_NULL_HANDLE, &p_imageIndex);
 
-	samplerLayoutBinding.binding = 1;
-	samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	samplerLayoutBinding.descriptorCount = 1;
-	samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	//Nothing was signaled, recreate and acquire again right away so the resize doesn't cost a frame
+	if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR)
+	{
+		if (!this->RecreateSwapChain())
+			return false;
 
-	std::array<VkDescriptorSetLayoutBinding, 2> bindings = { uboLayoutBinding, samplerLayoutBinding };
+		acquireResult = vkAcquireNextImageKHR(this->mLogicalDevice, this->mSwapChain.vkSwapChain, UINT64_MAX, this->mImageAviableSemaphore[this->mCurrentFrame], VK_NULL_HANDLE, &p_imageIndex);
+	}
 
-	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo{};
+	p_acquireTime = std::chrono::duration<float, std::milli>(Clock::now() - acquireStart).count();
 
-	descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-	descriptorSetLayoutCreateInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-	descriptorSetLayoutCreateInfo.pBindings = bindings.data();
+	//Suboptimal still acquired an image and signals the semaphore, it's drawn and the swapchain recreated after its present
+	if (acquireResult == VK_SUBOPTIMAL_KHR)
+	{
+		this->mSwapChainOutdated = true;
+	}
+	else if (acquireResult != VK_SUCCESS)
+	{
+		this->mSwapChainOutdated = true;
+		return false;
+	}
 
-	return vkCreateDescriptorSetLayout(this->mLogicalDevice, &descriptorSetLayoutCreateInfo, nullptr, &this->mDescriptorSetLayout) == VK_SUCCESS;
+	return true;
 }
 
 bool VKRenderer::CreateUniformBuffers()
 {
 	VkDeviceSize bufferSize = sizeof(UniformBufferObject);
 
-	mUniformBuffers.resize(this->mGraphicsPipeline.MAX_CONCURENT_FRAMES);
-	mUniformBuffersMemory.resize(this->mGraphicsPipeline.MAX_CONCURENT_FRAMES);
-	mUniformBuffersMap.resize(this->mGraphicsPipeline.MAX_CONCURENT_FRAMES);
+	mUniformBuffers.resize(this->mGraphicsPipeline.framesInFlight);
+	mUniformBuffersMemory.resize(this->mGraphicsPipeline.framesInFlight);
+	mUniformBuffersMap.resize(this->mGraphicsPipeline.framesInFlight);
 	
 	bool result = true;
 
-	for (size_t i = 0; i < this->mGraphicsPipeline.MAX_CONCURENT_FRAMES; i++)
+	for (size_t i = 0; i < this->mGraphicsPipeline.framesInFlight; i++)
 	{
-		result &= this->CreateBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, this->mUniformBuffers[i], this->mUniformBuffersMemory[i]);
+		result &= this->CreateBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, MemoryUsage::ReBarPreferred, this->mUniformBuffers[i], this->mUniformBuffersMemory[i]);
 
-		vkMapMemory(this->mLogicalDevice, this->mUniformBuffersMemory[i], 0, bufferSize, 0, &this->mUniformBuffersMap[i]);
+		this->mUniformBuffersMap[i] = this->mUniformBuffersMemory[i].mappedData;
 	}
 	return result;
 }
@@ -478,10 +676,10 @@ bool VKRenderer::CreateDescriptorPool()
 	std::array<VkDescriptorPoolSize, 2> descriptorPoolSize{};
 
 	descriptorPoolSize[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	descriptorPoolSize[0].descriptorCount = (uint32_t)(this->mGraphicsPipeline.MAX_CONCURENT_FRAMES);
+	descriptorPoolSize[0].descriptorCount = (uint32_t)(this->mGraphicsPipeline.framesInFlight);
 
 	descriptorPoolSize[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	descriptorPoolSize[1].descriptorCount = (uint32_t)(this->mGraphicsPipeline.MAX_CONCURENT_FRAMES);
+	descriptorPoolSize[1].descriptorCount = (uint32_t)(this->mGraphicsPipeline.framesInFlight);
 
 
 	VkDescriptorPoolCreateInfo descriptorPoolCreateInfo{};
@@ -489,27 +687,28 @@ bool VKRenderer::CreateDescriptorPool()
 	descriptorPoolCreateInfo.sType			= VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 	descriptorPoolCreateInfo.poolSizeCount	= (uint32_t)descriptorPoolSize.size();
 	descriptorPoolCreateInfo.pPoolSizes		= descriptorPoolSize.data();
-	descriptorPoolCreateInfo.maxSets		= (uint32_t)(this->mGraphicsPipeline.MAX_CONCURENT_FRAMES);
+	descriptorPoolCreateInfo.maxSets		= (uint32_t)(this->mGraphicsPipeline.framesInFlight);
 
 	return vkCreateDescriptorPool(this->mLogicalDevice, &descriptorPoolCreateInfo, nullptr, &this->mDescriptorPool) == VK_SUCCESS;
 }
 
 bool VKRenderer::CreateDescriptorSets()
 {
-	std::vector<VkDescriptorSetLayout> layouts(this->mGraphicsPipeline.MAX_CONCURENT_FRAMES, this->mDescriptorSetLayout);
+	std::vector<VkDescriptorSetLayout> layouts(this->mGraphicsPipeline.framesInFlight, this->mDescriptorSetLayout);
 
 	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{};
 
 	descriptorSetAllocateInfo.sType					= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 	descriptorSetAllocateInfo.descriptorPool		= this->mDescriptorPool;
-	descriptorSetAllocateInfo.descriptorSetCount	= (uint32_t)(this->mGraphicsPipeline.MAX_CONCURENT_FRAMES);
+	descriptorSetAllocateInfo.descriptorSetCount	= (uint32_t)(this->mGraphicsPipeline.framesInFlight);
 	descriptorSetAllocateInfo.pSetLayouts			= layouts.data();
 
-	this->mDescriptorSets.resize(this->mGraphicsPipeline.MAX_CONCURENT_FRAMES);
+	this->mDescriptorSets.resize(this->mGraphicsPipeline.framesInFlight);
+	this->mTextureDescriptorVersions.assign(this->mGraphicsPipeline.framesInFlight, this->mTextureStreamer.GetVersion(this->mTexture));
 
 	bool result = vkAllocateDescriptorSets(this->mLogicalDevice, &descriptorSetAllocateInfo, this->mDescriptorSets.data()) == VK_SUCCESS;
 
-	for (size_t i = 0; i < this->mGraphicsPipeline.MAX_CONCURENT_FRAMES; i++)
+	for (size_t i = 0; i < this->mGraphicsPipeline.framesInFlight; i++)
 	{
 		VkDescriptorBufferInfo descriptorUniformBufferInfo{};
 
@@ -520,7 +719,7 @@ bool VKRenderer::CreateDescriptorSets()
 		VkDescriptorImageInfo descriptorImageInfo{};
 
 		descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		descriptorImageInfo.imageView	= this->mTextureImageView;
+		descriptorImageInfo.imageView	= this->mTextureStreamer.GetView(this->mTexture); //Placeholder until the texture streams in, patched in Render()
 		descriptorImageInfo.sampler		= this->mTextureSampler;
 
 		std::array<VkWriteDescriptorSet, 2>  writeDescriptorSet{}; //This will need to be an array when i'll do maths stuff
@@ -552,233 +751,64 @@ bool VKRenderer::CreateDescriptorSets()
 
 bool VKRenderer::SetupGraphicsPipeline()
 {
-	//
-	//Fixed functions
-	//
-
-	std::vector<VkDynamicState> dynamicStates = {
-		VK_DYNAMIC_STATE_VIEWPORT,
-		VK_DYNAMIC_STATE_SCISSOR
-	};
-
-	VkPipelineDynamicStateCreateInfo pipelineDynamicStateCreateInfo{};
-
-	pipelineDynamicStateCreateInfo.sType				= VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-	pipelineDynamicStateCreateInfo.dynamicStateCount	= static_cast<uint32_t>(dynamicStates.size());
-	pipelineDynamicStateCreateInfo.pDynamicStates		= dynamicStates.data();
-
-	auto bindingDescription = VKRenderer::GetBindingDescription();
-	auto attributeDescriptions = VKRenderer::GetAttributeDescriptions();
-
-	VkPipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo{};
-
-	pipelineVertexInputStateCreateInfo.sType							= VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	pipelineVertexInputStateCreateInfo.vertexBindingDescriptionCount	= 1;
-	pipelineVertexInputStateCreateInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-	pipelineVertexInputStateCreateInfo.pVertexBindingDescriptions		= &bindingDescription;
-	pipelineVertexInputStateCreateInfo.pVertexAttributeDescriptions		= attributeDescriptions.data();
-
-	VkPipelineInputAssemblyStateCreateInfo pipelineInputAssemblyStateCreateInfo{};
-
-	pipelineInputAssemblyStateCreateInfo.sType					= VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-	pipelineInputAssemblyStateCreateInfo.topology				= VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-	pipelineInputAssemblyStateCreateInfo.primitiveRestartEnable = VK_FALSE;
-
-
-	VkPipelineViewportStateCreateInfo pipelineViewportStateCreateInfo{};
-
-	pipelineViewportStateCreateInfo.sType			= VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-	pipelineViewportStateCreateInfo.viewportCount	= 1;
-	pipelineViewportStateCreateInfo.scissorCount	= 1;
-
-
-	VkPipelineRasterizationStateCreateInfo pipelineRasterizationStateCreateInfo{};
-
-	pipelineRasterizationStateCreateInfo.sType						= VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-	pipelineRasterizationStateCreateInfo.depthClampEnable			= VK_FALSE;
-	pipelineRasterizationStateCreateInfo.rasterizerDiscardEnable	= VK_FALSE;
-	pipelineRasterizationStateCreateInfo.polygonMode				= VK_POLYGON_MODE_FILL;
-	pipelineRasterizationStateCreateInfo.lineWidth					= 1.0f;
-	pipelineRasterizationStateCreateInfo.cullMode					= VK_CULL_MODE_BACK_BIT;
-	pipelineRasterizationStateCreateInfo.frontFace					= VK_FRONT_FACE_COUNTER_CLOCKWISE;
-	pipelineRasterizationStateCreateInfo.depthBiasEnable			= VK_FALSE;
-
-
-	VkPipelineMultisampleStateCreateInfo pipelineMultisampleStateCreateInfo{};
-
-	pipelineMultisampleStateCreateInfo.sType				= VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-	pipelineMultisampleStateCreateInfo.sampleShadingEnable	= VK_FALSE;
-	pipelineMultisampleStateCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-
-
-	VkPipelineColorBlendAttachmentState pipelineColorBlendAttachmentState{};
-
-	pipelineColorBlendAttachmentState.colorWriteMask	= VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-	pipelineColorBlendAttachmentState.blendEnable		= VK_FALSE;
-
-
-	VkPipelineColorBlendStateCreateInfo pipelineColorBlendStateCreateInfo{};
-	
-	pipelineColorBlendStateCreateInfo.sType				= VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-	pipelineColorBlendStateCreateInfo.logicOpEnable		= VK_FALSE;
-	pipelineColorBlendStateCreateInfo.attachmentCount	= 1;
-	pipelineColorBlendStateCreateInfo.pAttachments		= &pipelineColorBlendAttachmentState;
-
 	//
 	//Shaders
 	//
 
-	std::vector<char> vertexByteCode	= ParseShaderFile("./shaders/triangle.vert.spv");
-	std::vector<char> fragmentByteCode	= ParseShaderFile("./shaders/triangle.frag.spv");
+	ShaderId vertexShader	= this->mPipelineManager.LoadShader(SHADER_DIRECTORY "/triangle.vert.spv");
+	ShaderId fragmentShader = this->mPipelineManager.LoadShader(SHADER_DIRECTORY "/triangle.frag.spv");
 
-	if(vertexByteCode.empty() || fragmentByteCode.empty())
+	if (vertexShader == INVALID_SHADER_ID || fragmentShader == INVALID_SHADER_ID)
 		return false;
 
-	this->mVertexShader		= this->LoadShader(vertexByteCode);
-	this->mFragmentShader	= this->LoadShader(fragmentByteCode);
-
-	VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-
-	vertShaderStageInfo.sType	= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-	vertShaderStageInfo.stage	= VK_SHADER_STAGE_VERTEX_BIT;
-	vertShaderStageInfo.module	= this->mVertexShader;
-	vertShaderStageInfo.pName	= "main";
-
-
-	VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-
-	fragShaderStageInfo.sType	= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-	fragShaderStageInfo.stage	= VK_SHADER_STAGE_FRAGMENT_BIT;
-	fragShaderStageInfo.module	= this->mFragmentShader;
-	fragShaderStageInfo.pName	= "main";
-		
-	this->mGraphicsPipeline.mShaderStages = { vertShaderStageInfo, fragShaderStageInfo };
-
 	//
 	//Pipeline layout
 	//
 
-	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+	//Reflected from the shaders, owned by the pipeline manager
+	std::vector<VkDescriptorSetLayout> setLayouts;
 
-	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-	pipelineLayoutInfo.setLayoutCount = 1;
-	pipelineLayoutInfo.pSetLayouts = &this->mDescriptorSetLayout;
+	this->mGraphicsPipeline.vkPipelineLayout = this->mPipelineManager.GetPipelineLayout(vertexShader, fragmentShader, &setLayouts);
 
-	if (vkCreatePipelineLayout(this->mLogicalDevice, &pipelineLayoutInfo, nullptr, &this->mGraphicsPipeline.vkPipelineLayout) != VK_SUCCESS)
+	if (this->mGraphicsPipeline.vkPipelineLayout == VK_NULL_HANDLE || setLayouts.empty())
 		return false;
 
+	this->mDescriptorSetLayout = setLayouts[0];
+
 	//
 	//Render pass
 	//
 
-	VkAttachmentReference subPassColorAttachement{};
-
-	subPassColorAttachement.attachment = 0;
-	subPassColorAttachement.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-	VkAttachmentDescription depthAttachmentDescription{};
-
-	depthAttachmentDescription.format			= this->FindDepthFormat();
-	depthAttachmentDescription.samples			= VK_SAMPLE_COUNT_1_BIT;
-	depthAttachmentDescription.loadOp			= VK_ATTACHMENT_LOAD_OP_CLEAR;
-	depthAttachmentDescription.storeOp			= VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	depthAttachmentDescription.stencilLoadOp	= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-	depthAttachmentDescription.stencilStoreOp	= VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	depthAttachmentDescription.initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED;
-	depthAttachmentDescription.finalLayout		= VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-
-	VkAttachmentReference depthAttachmentRef{};
-	depthAttachmentRef.attachment = 1;
-	depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-
-	VkSubpassDescription subpassDescription{};
-	
-	subpassDescription.colorAttachmentCount = 1;
-	subpassDescription.pipelineBindPoint	= VK_PIPELINE_BIND_POINT_GRAPHICS;
-	subpassDescription.colorAttachmentCount = 1;
-	subpassDescription.pColorAttachments	= &subPassColorAttachement;
-	subpassDescription.pDepthStencilAttachment = &depthAttachmentRef;
-
-
-	VkAttachmentDescription colorAttachment{};
-	
-	colorAttachment.format			= this->mSwapChain.imageFormat;
-	colorAttachment.samples			= VK_SAMPLE_COUNT_1_BIT;
-	colorAttachment.loadOp			= VK_ATTACHMENT_LOAD_OP_CLEAR;
-	colorAttachment.storeOp			= VK_ATTACHMENT_STORE_OP_STORE;
-	colorAttachment.stencilLoadOp	= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-	colorAttachment.stencilStoreOp	= VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	colorAttachment.initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED;
-	colorAttachment.finalLayout		= VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-
-	VkSubpassDependency subpassDependency{};
-
-	subpassDependency.srcSubpass	= VK_SUBPASS_EXTERNAL;
-	subpassDependency.dstSubpass	= 0;
-	subpassDependency.srcStageMask	= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-	subpassDependency.srcAccessMask = 0;
-	subpassDependency.dstStageMask	= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-	subpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-
-	std::array<VkAttachmentDescription, 2> attachmentDescription{colorAttachment, depthAttachmentDescription};
-
-
-	VkRenderPassCreateInfo renderPassCreateInfo{};
-
-	renderPassCreateInfo.sType				= VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-	renderPassCreateInfo.attachmentCount	= attachmentDescription.size();
-	renderPassCreateInfo.pAttachments		= attachmentDescription.data();
-	renderPassCreateInfo.subpassCount		= 1;
-	renderPassCreateInfo.pSubpasses			= &subpassDescription;
-	renderPassCreateInfo.dependencyCount	= 1;
-	renderPassCreateInfo.pDependencies		= &subpassDependency;
-
-
-	VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilStateCreateInfo{};
-
-	pipelineDepthStencilStateCreateInfo.sType				= VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-	pipelineDepthStencilStateCreateInfo.depthTestEnable		= VK_TRUE;
-	pipelineDepthStencilStateCreateInfo.depthWriteEnable	= VK_TRUE;
-	pipelineDepthStencilStateCreateInfo.depthCompareOp		= VK_COMPARE_OP_LESS;
-	pipelineDepthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
-	pipelineDepthStencilStateCreateInfo.stencilTestEnable = VK_FALSE;
-
-
+	//Only compatible with the one the render graph begins, which is all a pipeline needs
+	this->mDepthFormat					= this->FindDepthFormat();
+	this->mGraphicsPipeline.vkRenderPass	= this->mRenderGraph.GetCompatibleRenderPass({ this->mSwapChain.imageFormat }, this->mDepthFormat);
 
-	if (vkCreateRenderPass(this->mLogicalDevice, &renderPassCreateInfo, nullptr, &this->mGraphicsPipeline.vkRenderPass) != VK_SUCCESS)
+	if (this->mGraphicsPipeline.vkRenderPass == VK_NULL_HANDLE)
 		return false;
 
 	//
 	//Graphics pipeline object
 	//
 
-	VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo{};
+	PipelineState state;
 
-	graphicsPipelineCreateInfo.sType		= VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	graphicsPipelineCreateInfo.layout		= this->mGraphicsPipeline.vkPipelineLayout;
-	graphicsPipelineCreateInfo.renderPass	= this->mGraphicsPipeline.vkRenderPass;
-	graphicsPipelineCreateInfo.subpass		= 0;
-	graphicsPipelineCreateInfo.stageCount	= 2;
-	graphicsPipelineCreateInfo.pStages		= this->mGraphicsPipeline.mShaderStages.data();
+	state.vertexShader		= vertexShader;
+	state.fragmentShader	= fragmentShader;
+	state.vertexFormat		= VERTEX_FORMAT;
+	state.layout			= this->mGraphicsPipeline.vkPipelineLayout;
+	state.renderPass		= this->mGraphicsPipeline.vkRenderPass;
 
-	graphicsPipelineCreateInfo.pDynamicState		= &pipelineDynamicStateCreateInfo;
-	graphicsPipelineCreateInfo.pVertexInputState	= &pipelineVertexInputStateCreateInfo;
-	graphicsPipelineCreateInfo.pInputAssemblyState	= &pipelineInputAssemblyStateCreateInfo;
-	graphicsPipelineCreateInfo.pViewportState		= &pipelineViewportStateCreateInfo;
-	graphicsPipelineCreateInfo.pRasterizationState	= &pipelineRasterizationStateCreateInfo;
-	graphicsPipelineCreateInfo.pMultisampleState	= &pipelineMultisampleStateCreateInfo;
-	graphicsPipelineCreateInfo.pColorBlendState		= &pipelineColorBlendStateCreateInfo;
+	//Same shaders, each permutation is its own pipeline with the branch folded by the driver
+	for (uint32_t i = 0; i < 2; i++)
+	{
+		this->mPipelineStates[i]					= state;
+		this->mPipelineStates[i].fragmentConstants	= this->mPipelineManager.RegisterSpecialization(SpecializationConstants().Set(USE_VERTEX_COLOR, i == 1));
+	}
 
-	graphicsPipelineCreateInfo.pDepthStencilState	= &pipelineDepthStencilStateCreateInfo;
-	graphicsPipelineCreateInfo.basePipelineHandle	= VK_NULL_HANDLE;
-	graphicsPipelineCreateInfo.basePipelineIndex	= -1;
+	//Compiles while the model and texture load, nothing is drawn with them before both are there anyway
+	this->mPipelineManager.RequestPipelines(this->mPipelineStates, 2);
 
-	return vkCreateGraphicsPipelines(this->mLogicalDevice, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, nullptr, &this->mGraphicsPipeline.vkPipeline) == VK_SUCCESS;
+	return true;
 }
 
 VkFormat VKRenderer::FindSupportedFormat(const std::vector<VkFormat>& p_candidates, VkImageTiling p_tiling, VkFormatFeatureFlags p_features) {
@@ -796,6 +826,8 @@ VkFormat VKRenderer::FindSupportedFormat(const std::vector<VkFormat>& p_candidat
 			return format;
 		}
 	}
+
+	return VK_FORMAT_UNDEFINED;
 }
 
 
@@ -804,43 +836,14 @@ VkFormat VKRenderer::FindDepthFormat()
 	return this->FindSupportedFormat({ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT }, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
 }
 
-bool VKRenderer::CreateDepthRessources()
-{
-	bool result = false;
-
-	VkFormat depthFormat = this->FindDepthFormat();
-
-	result = this->CreateImage(this->mSwapChain.extent.width, this->mSwapChain.extent.height, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, this->mDepthRessources.depthImage, this->mDepthRessources.depthMemory);
-	this->mDepthRessources.depthImageView = this->CreateImageView(this->mDepthRessources.depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
-
-	return result;
-}
-
-bool VKRenderer::CreateFrameBuffers()
+bool VKRenderer::SupportsLinearBlit(VkFormat p_format)
 {
-	this->mSwapChain.frameBuffers.resize(this->mSwapChain.imageViews.size());
-
-	for (int i = 0; i < this->mSwapChain.frameBuffers.capacity(); i++)
-	{
-		std::array<VkImageView,2> attachments = {
-			this->mSwapChain.imageViews[i],
-			this->mDepthRessources.depthImageView
-		};
-
-		VkFramebufferCreateInfo framebufferCreateInfo{};
+	VkFormatFeatureFlags features = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
 
-		framebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-		framebufferCreateInfo.height = this->mSwapChain.extent.height;
-		framebufferCreateInfo.width = this->mSwapChain.extent.width;
-		framebufferCreateInfo.renderPass = this->mGraphicsPipeline.vkRenderPass;
-		framebufferCreateInfo.layers = 1;
-		framebufferCreateInfo.attachmentCount = attachments.size();
-		framebufferCreateInfo.pAttachments = attachments.data();
+	VkFormatProperties props;
+	vkGetPhysicalDeviceFormatProperties(this->mPhysicalDevice.physicalDevice, p_format, &props);
 
-		vkCreateFramebuffer(this->mLogicalDevice, &framebufferCreateInfo, nullptr, &this->mSwapChain.frameBuffers[i]) == VK_SUCCESS;
-	}
-
-	return true;
+	return (props.optimalTilingFeatures & features) == features;
 }
 
 bool VKRenderer::CreateCommandBuffer()
@@ -861,7 +864,7 @@ bool VKRenderer::CreateCommandBuffer()
 	//Command buffers
 	//
 
-	mCommandBuffer.resize(this->mGraphicsPipeline.MAX_CONCURENT_FRAMES);
+	mCommandBuffer.resize(this->mGraphicsPipeline.framesInFlight);
 
 	VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
 
@@ -875,98 +878,162 @@ bool VKRenderer::CreateCommandBuffer()
 	return result;
 }
 
-VkCommandBuffer VKRenderer::BeginSingleTimeCommands() {
-	VkCommandBufferAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	allocInfo.commandPool = this->mCommandPool;
-	allocInfo.commandBufferCount = 1;
+void VKRenderer::BenchmarkMipmaps(const uint8_t* p_pixels, uint32_t p_width, uint32_t p_height)
+{
+	using Clock = std::chrono::high_resolution_clock;
 
-	VkCommandBuffer commandBuffer;
-	vkAllocateCommandBuffers(this->mLogicalDevice, &allocInfo, &commandBuffer);
+	const uint32_t RUN_COUNT = 8; //Best run is kept for both paths
 
-	VkCommandBufferBeginInfo beginInfo{};
-	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	uint32_t		levelCount	= MipmapGenerator::GetLevelCount(p_width, p_height);
+	VkDeviceSize	imageSize	= VkDeviceSize(p_width) * p_height * 4;
 
-	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	//CPU : the whole chain, the same work the texture streamer does on its workers
+	std::vector<uint8_t>	chain;
+	std::vector<ImageLevel> levels;
 
-	return commandBuffer;
-}
+	float cpuTime = std::numeric_limits<float>::max();
 
-void VKRenderer::EndSingleTimeCommands(VkCommandBuffer p_commandBuffer) {
-	vkEndCommandBuffer(p_commandBuffer);
+	for (uint32_t run = 0; run < RUN_COUNT; run++)
+	{
+		auto start = Clock::now();
 
-	VkSubmitInfo submitInfo{};
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &p_commandBuffer;
+		MipmapGenerator::GenerateRgba8(p_pixels, p_width, p_height, true, chain, levels);
 
-	vkQueueSubmit(this->mGraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-	vkQueueWaitIdle(this->mGraphicsQueue);
+		cpuTime = std::min(cpuTime, std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+	}
 
-	vkFreeCommandBuffers(this->mLogicalDevice, this->mCommandPool, 1, &p_commandBuffer);
-}
-void VKRenderer::CopyBufferToImage(VkBuffer p_buffer, VkImage p_image, uint32_t p_width, uint32_t p_height) {
-	VkCommandBuffer commandBuffer = this->BeginSingleTimeCommands();
-
-	VkBufferImageCopy bufferImageCopy{};
-	bufferImageCopy.bufferOffset = 0;
-	bufferImageCopy.bufferRowLength = 0;
-	bufferImageCopy.bufferImageHeight = 0;
-	bufferImageCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	bufferImageCopy.imageSubresource.mipLevel = 0;
-	bufferImageCopy.imageSubresource.baseArrayLayer = 0;
-	bufferImageCopy.imageSubresource.layerCount = 1;
-	bufferImageCopy.imageOffset = { 0, 0, 0 };
-	bufferImageCopy.imageExtent = {
-		p_width,
-		p_height,
-		1
-	};
+	std::cout << "[Mipmaps] " << p_width << "x" << p_height << ", " << levelCount << " levels : CPU box filter " << cpuTime << " ms";
 
-	vkCmdCopyBufferToImage(commandBuffer, p_buffer, p_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufferImageCopy);
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(this->mPhysicalDevice.physicalDevice, &queueFamilyCount, nullptr);
 
-	this->EndSingleTimeCommands(commandBuffer);
-}
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(this->mPhysicalDevice.physicalDevice, &queueFamilyCount, queueFamilies.data());
 
-bool VKRenderer::CreateTextureImage()
-{
-	const char* filePath = "textures/texture.png"; //WOAH
+	uint32_t timestampBits = queueFamilies[this->mPhysicalDevice.supportedQueues.graphicsFamily].timestampValidBits;
 
-	bool result = false;
+	if (!this->SupportsLinearBlit(VK_FORMAT_R8G8B8A8_SRGB) || timestampBits == 0)
+	{
+		std::cout << ", GPU blits not measurable on this device" << std::endl;
+		return;
+	}
 
-	int texWidth, texHeight, texChannels;
-	stbi_uc* pixels = stbi_load(filePath, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-	VkDeviceSize imageSize = texWidth * texHeight * 4;
+	//GPU : blits only, level 0 is copied again before each run and timestamps bracket the blit chain
+	VkBuffer			stagingBuffer	= VK_NULL_HANDLE;
+	MemoryAllocation	stagingMemory;
+	VkImage				image			= VK_NULL_HANDLE;
+	MemoryAllocation	imageMemory;
 
-	if (!pixels)
-		return false;
+	bool result = this->CreateBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, MemoryUsage::Upload, stagingBuffer, stagingMemory);
+	result &= this->CreateImage(p_width, p_height, levelCount, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, MemoryUsage::GpuOnly, image, imageMemory);
+
+	if (result)
+	{
+		memcpy(stagingMemory.mappedData, p_pixels, (size_t)imageSize);
+		this->mAllocator.Flush(stagingMemory);
 
-	VkBuffer stagingBuffer;
-	VkDeviceMemory stagingBufferMemory;
-	result &= this->CreateBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+		VkQueryPoolCreateInfo queryPoolCreateInfo{};
 
-	void* data;
-	vkMapMemory(this->mLogicalDevice, stagingBufferMemory, 0, imageSize, 0, &data);
-	memcpy(data, pixels, static_cast<size_t>(imageSize));
-	vkUnmapMemory(this->mLogicalDevice, stagingBufferMemory);
+		queryPoolCreateInfo.sType		= VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolCreateInfo.queryType	= VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolCreateInfo.queryCount	= RUN_COUNT * 2;
 
-	stbi_image_free(pixels);
+		VkQueryPool queryPool;
+		vkCreateQueryPool(this->mLogicalDevice, &queryPoolCreateInfo, nullptr, &queryPool);
 
-	result &= this->CreateImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, this->mTextureImage, this->mTextureImageMemory);
+		VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
 
-	this->TransitionImageLayout(this->mTextureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-	this->CopyBufferToImage(stagingBuffer, this->mTextureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-	this->TransitionImageLayout(this->mTextureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		commandBufferAllocateInfo.sType					= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		commandBufferAllocateInfo.level					= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		commandBufferAllocateInfo.commandPool			= this->mCommandPool;
+		commandBufferAllocateInfo.commandBufferCount	= 1;
 
-	vkDestroyBuffer(this->mLogicalDevice, stagingBuffer, nullptr);
-	vkFreeMemory(this->mLogicalDevice, stagingBufferMemory, nullptr);
+		VkCommandBuffer commandBuffer;
+		vkAllocateCommandBuffers(this->mLogicalDevice, &commandBufferAllocateInfo, &commandBuffer);
 
-	return result;
+		VkCommandBufferBeginInfo beginInfo{};
+
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		vkCmdResetQueryPool(commandBuffer, queryPool, 0, RUN_COUNT * 2);
+
+		for (uint32_t run = 0; run < RUN_COUNT; run++)
+		{
+			VkImageMemoryBarrier imageMemoryBarrier{};
+
+			imageMemoryBarrier.sType							= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			imageMemoryBarrier.oldLayout						= VK_IMAGE_LAYOUT_UNDEFINED; //Previous run is thrown away
+			imageMemoryBarrier.newLayout						= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			imageMemoryBarrier.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+			imageMemoryBarrier.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+			imageMemoryBarrier.srcAccessMask					= VK_ACCESS_SHADER_READ_BIT;
+			imageMemoryBarrier.dstAccessMask					= VK_ACCESS_TRANSFER_WRITE_BIT;
+			imageMemoryBarrier.image							= image;
+			imageMemoryBarrier.subresourceRange.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+			imageMemoryBarrier.subresourceRange.baseMipLevel	= 0;
+			imageMemoryBarrier.subresourceRange.levelCount		= levelCount;
+			imageMemoryBarrier.subresourceRange.baseArrayLayer	= 0;
+			imageMemoryBarrier.subresourceRange.layerCount		= 1;
+
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+
+			VkBufferImageCopy bufferImageCopy{};
+
+			bufferImageCopy.imageSubresource.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+			bufferImageCopy.imageSubresource.layerCount		= 1;
+			bufferImageCopy.imageExtent						= { p_width, p_height, 1 };
+
+			vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufferImageCopy);
+
+			//Transfer stage timestamps : the first one is written once the copy is done
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, queryPool, run * 2);
+			VKUploadContext::RecordMipmapBlits(commandBuffer, image, p_width, p_height, levelCount);
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, queryPool, run * 2 + 1);
+		}
+
+		vkEndCommandBuffer(commandBuffer);
+
+		VkSubmitInfo submitInfo{};
+
+		submitInfo.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount	= 1;
+		submitInfo.pCommandBuffers		= &commandBuffer;
+
+		vkQueueSubmit(this->mGraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+		vkQueueWaitIdle(this->mGraphicsQueue); //Startup only
+
+		std::vector<uint64_t> timestamps(RUN_COUNT * 2);
+		vkGetQueryPoolResults(this->mLogicalDevice, queryPool, 0, RUN_COUNT * 2, timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+
+		uint64_t timestampMask	= timestampBits >= 64 ? UINT64_MAX : (1ull << timestampBits) - 1;
+		float	 gpuTime		= std::numeric_limits<float>::max();
+
+		for (uint32_t run = 0; run < RUN_COUNT; run++)
+		{
+			uint64_t ticks = (timestamps[run * 2 + 1] - timestamps[run * 2]) & timestampMask;
+
+			gpuTime = std::min(gpuTime, ticks * this->mPhysicalDevice.deviceProperties.limits.timestampPeriod / 1e6f);
+		}
+
+		std::cout << ", GPU blits " << gpuTime << " ms" << std::endl;
+
+		vkFreeCommandBuffers(this->mLogicalDevice, this->mCommandPool, 1, &commandBuffer);
+		vkDestroyQueryPool(this->mLogicalDevice, queryPool, nullptr);
+	}
+	else
+	{
+		std::cout << ", GPU benchmark resources could not be created" << std::endl;
+	}
+
+	vkDestroyImage(this->mLogicalDevice, image, nullptr);
+	this->mAllocator.Free(imageMemory);
+	vkDestroyBuffer(this->mLogicalDevice, stagingBuffer, nullptr);
+	this->mAllocator.Free(stagingMemory);
 }
 
-VkImageView VKRenderer::CreateImageView(VkImage p_image, VkFormat p_format, VkImageAspectFlags p_aspectFlags)
+VkImageView VKRenderer::CreateImageView(VkImage p_image, VkFormat p_format, VkImageAspectFlags p_aspectFlags, uint32_t p_mipLevels)
 {
 	VkImageViewCreateInfo imageViewCreateInfo{};
 
@@ -976,7 +1043,7 @@ VkImageView VKRenderer::CreateImageView(VkImage p_image, VkFormat p_format, VkIm
 	imageViewCreateInfo.format = p_format;
 	imageViewCreateInfo.subresourceRange.aspectMask = p_aspectFlags;
 	imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
-	imageViewCreateInfo.subresourceRange.levelCount = 1;
+	imageViewCreateInfo.subresourceRange.levelCount = p_mipLevels;
 	imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
 	imageViewCreateInfo.subresourceRange.layerCount = 1;
 
@@ -987,64 +1054,6 @@ VkImageView VKRenderer::CreateImageView(VkImage p_image, VkFormat p_format, VkIm
 	return imageView;
 }
 
-bool VKRenderer::CreateTextureImageView()
-{
-	this->mTextureImageView = this->CreateImageView(this->mTextureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
-
-	return true;
-}
-
-void VKRenderer::TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout)
-{
-	VkCommandBuffer commandBuffer = this->BeginSingleTimeCommands();
-
-	VkImageMemoryBarrier imageMemoryBarrier{};
-
-	imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-	imageMemoryBarrier.oldLayout = oldLayout;
-	imageMemoryBarrier.newLayout = newLayout;
-	imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	imageMemoryBarrier.image = image;
-	imageMemoryBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	imageMemoryBarrier.subresourceRange.baseMipLevel = 0;
-	imageMemoryBarrier.subresourceRange.levelCount = 1;
-	imageMemoryBarrier.subresourceRange.baseArrayLayer = 0;
-	imageMemoryBarrier.subresourceRange.layerCount = 1;
-
-	VkPipelineStageFlags sourceStage;
-	VkPipelineStageFlags destinationStage;
-
-	if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-		imageMemoryBarrier.srcAccessMask = 0;
-		imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-		sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-		destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-	}
-	else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-		imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-		sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-		destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-	}
-	else {
-		return;
-	}
-
-	vkCmdPipelineBarrier(
-		commandBuffer,
-		sourceStage, destinationStage,
-		0,
-		0, nullptr,
-		0, nullptr,
-		1, &imageMemoryBarrier
-	);
-
-	this->EndSingleTimeCommands(commandBuffer);
-}
-
 bool VKRenderer::CreateTextureSampler()
 {
 	VkSamplerCreateInfo samplerCreateInfo{};
@@ -1062,97 +1071,26 @@ bool VKRenderer::CreateTextureSampler()
 	samplerCreateInfo.compareEnable = VK_FALSE;
 	samplerCreateInfo.compareOp = VK_COMPARE_OP_ALWAYS;
 	samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+	samplerCreateInfo.mipLodBias = 0.0f;
+	samplerCreateInfo.minLod = 0.0f;
+	samplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE; //The view limits the levels, it grows while the texture streams in
 
 	return vkCreateSampler(this->mLogicalDevice, &samplerCreateInfo, nullptr, &this->mTextureSampler) == VK_SUCCESS;
 }
 
 
-uint32_t VKRenderer::FindMemoryType(const uint32_t& p_filterBits, VkMemoryPropertyFlags properties)
-{
-	VkPhysicalDeviceMemoryProperties physicalDeviceMemoryProperties;
-
-	vkGetPhysicalDeviceMemoryProperties(this->mPhysicalDevice.physicalDevice, &physicalDeviceMemoryProperties);
-
-	for (uint32_t i = 0; i < physicalDeviceMemoryProperties.memoryTypeCount; i++) 
-	{
-		if ((p_filterBits & (1 << i)) && (physicalDeviceMemoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
-			return i;
-	}
-}
-
 bool VKRenderer::CreateVertexBuffer()
 {
-	VkDeviceSize bufferSize = sizeof(this->vertices[0]) * this->vertices.size();
-
-	VkBuffer stagingBuffer;
-	VkDeviceMemory stagingBufferMemory;
-
-	bool result = this->CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory) == VK_SUCCESS;
-
-	//
-	//Copy data to buffer
-	//
-
-	void* data;
-	vkMapMemory(this->mLogicalDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-	memcpy(data, this->vertices.data(), bufferSize);
-	vkUnmapMemory(this->mLogicalDevice, stagingBufferMemory);
-
-	//
-	//stagering to vertex buffer
-	//
-
-	result&= this->CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, this->mVertexBuffer, this->mVertexBufferMemory) == VK_SUCCESS;
+	VkDeviceSize bufferSize = (VkDeviceSize)GetVertexStride(this->mModel.vertexFormat) * this->mModel.vertexCount;
 
-	this->CopyBuffer(stagingBuffer, this->mVertexBuffer, bufferSize);
+	bool result = this->CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, MemoryUsage::GpuOnly, this->mVertexBuffer, this->mVertexBufferMemory);
 
-	vkDestroyBuffer(this->mLogicalDevice, stagingBuffer, nullptr);
-	vkFreeMemory(this->mLogicalDevice, stagingBufferMemory, nullptr);
+	result &= this->mUploadContext.UploadBuffer(this->mModel.vertices, bufferSize, this->mVertexBuffer);
 
 	return result;
 }
 
-void VKRenderer::CopyBuffer(VkBuffer p_srcBuffer, VkBuffer p_dstBuffer, VkDeviceSize p_size)
-{
-	VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
-
-	commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	commandBufferAllocateInfo.commandPool = this->mCommandPool;
-	commandBufferAllocateInfo.commandBufferCount = 1;
-
-	VkCommandBuffer commandBuffer;
-	vkAllocateCommandBuffers(this->mLogicalDevice, &commandBufferAllocateInfo, &commandBuffer);
-
-	VkCommandBufferBeginInfo beginInfo{};
-
-	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-	vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-	VkBufferCopy bufferCopy{};
-
-	bufferCopy.size = p_size;
-
-	vkCmdCopyBuffer(commandBuffer, p_srcBuffer, p_dstBuffer, 1, &bufferCopy);
-
-	vkEndCommandBuffer(commandBuffer);
-
-	VkSubmitInfo submitInfo{};
-
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &commandBuffer;
-
-	vkQueueSubmit(this->mGraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-	vkQueueWaitIdle(this->mGraphicsQueue);
-
-	vkFreeCommandBuffers(this->mLogicalDevice, this->mCommandPool, 1, &commandBuffer);
-}
-
-
-void VKRenderer::RecordCommandBuffer(VkCommandBuffer& p_commandBuffer, uint32_t p_imageIndex)
+void VKRenderer::RecordCommandBuffer(VkCommandBuffer& p_commandBuffer, uint32_t p_imageIndex, std::vector<VkSemaphore>& p_uploadSemaphores, bool p_readback, uint64_t p_readbackFrame)
 {
 	VkCommandBufferBeginInfo commandBufferBeginInfo{};
 
@@ -1160,80 +1098,110 @@ void VKRenderer::RecordCommandBuffer(VkCommandBuffer& p_commandBuffer, uint32_t
 
 	vkBeginCommandBuffer(p_commandBuffer, &commandBufferBeginInfo);
 
-	VkRenderPassBeginInfo renderPassBeginInfo{};
+	if (this->mTimestampPool != VK_NULL_HANDLE)
+	{
+		vkCmdResetQueryPool(p_commandBuffer, this->mTimestampPool, this->mCurrentFrame * 2, 2);
+		vkCmdWriteTimestamp(p_commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, this->mTimestampPool, this->mCurrentFrame * 2);
+	}
 
-	renderPassBeginInfo.sType				= VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassBeginInfo.renderPass			= this->mGraphicsPipeline.vkRenderPass;
-	renderPassBeginInfo.framebuffer			= this->mSwapChain.frameBuffers[p_imageIndex];
-	renderPassBeginInfo.renderArea.extent	= this->mSwapChain.extent;
-	renderPassBeginInfo.renderArea.offset	= { 0,0 };
+	//Take back what the transfer queue uploaded since last frame
+	this->mUploadContext.AcquireOwnership(p_commandBuffer, this->mPresentFence[this->mCurrentFrame], p_uploadSemaphores);
 
-	std::array<VkClearValue, 2> clearValues{};
-	clearValues[0].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
-	clearValues[1].depthStencil = { 1.0f, 0 };
+	//
+	//Frame graph : the swapchain image comes in from the acquire and leaves to the present, the depth buffer only lives for the frame
+	//
 
-	renderPassBeginInfo.clearValueCount		= clearValues.size();
-	renderPassBeginInfo.pClearValues		= clearValues.data();
+	RenderGraphTextureDescription backbufferDescription;
 
-	vkCmdBeginRenderPass(p_commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	backbufferDescription.width	= this->mSwapChain.extent.width;
+	backbufferDescription.height	= this->mSwapChain.extent.height;
+	backbufferDescription.format	= this->mSwapChain.imageFormat;
 
-	vkCmdBindPipeline(p_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->mGraphicsPipeline.vkPipeline);
+	RenderGraphTextureDescription depthDescription = backbufferDescription;
 
-	VkViewport viewport{};
-	viewport.x = 0.0f;
-	viewport.y = 0.0f;
-	viewport.width	= (float)(this->mSwapChain.extent.width);
-	viewport.height = (float)(this->mSwapChain.extent.height);
-	viewport.minDepth = 0.0f;
-	viewport.maxDepth = 1.0f;
+	depthDescription.format = this->mDepthFormat;
 
-	vkCmdSetViewport(p_commandBuffer, 0, 1, &viewport);
+	RenderGraphTexture backbuffer;
 
-	VkRect2D scissor{};
-	scissor.offset = { 0, 0 };
-	scissor.extent = this->mSwapChain.extent;
+	//Headless : left ready to be copied out, and only drawn again once the last copy is done
+	if (this->mHeadless)
+		backbuffer = this->mRenderGraph.ImportTexture("backbuffer", this->mSwapChain.images[p_imageIndex], this->mSwapChain.imageViews[p_imageIndex], backbufferDescription,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT);
+	else
+		backbuffer = this->mRenderGraph.ImportTexture("backbuffer", this->mSwapChain.images[p_imageIndex], this->mSwapChain.imageViews[p_imageIndex], backbufferDescription,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+	RenderGraphTexture depth = this->mRenderGraph.CreateTexture("depth", depthDescription);
 
-	vkCmdSetScissor(p_commandBuffer, 0, 1, &scissor);
+	this->mRenderGraph.AddPass("main", [&](RenderGraphPassBuilder& p_builder)
+	{
+		p_builder.ClearColor(backbuffer, { {0.0f, 0.0f, 0.0f, 1.0f} });
+		p_builder.ClearDepth(depth);
+	},
+	[this](const RenderGraphContext& p_context)
+	{
+		vkCmdBindDescriptorSets(p_context.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->mGraphicsPipeline.vkPipelineLayout, 0, 1, &this->mDescriptorSets[this->mCurrentFrame], 0, nullptr);
 
-	vkCmdBindPipeline(p_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->mGraphicsPipeline.vkPipeline);
+		//A lookup that never reaches the driver, VK_NULL_HANDLE while the pipeline compiles
+		VkPipeline pipeline = this->mPipelineManager.FindOrFallback(this->mPipelineStates[this->mVertexColor], this->mPipelineStates[!this->mVertexColor]);
 
-	vkCmdBindDescriptorSets(p_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->mGraphicsPipeline.vkPipelineLayout, 0, 1, &this->mDescriptorSets[this->mCurrentFrame], 0, nullptr);
+		//Still loading or compiling : the frame is only cleared
+		if (this->mModelReady && pipeline != VK_NULL_HANDLE)
+		{
+			vkCmdBindPipeline(p_context.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 
-	VkBuffer vertexBuffers[] = { this->mVertexBuffer };
-	VkDeviceSize offsets[] = { 0 };
-	vkCmdBindVertexBuffers(p_commandBuffer, 0, 1, vertexBuffers, offsets);
+			VkBuffer vertexBuffers[] = { this->mVertexBuffer };
+			VkDeviceSize offsets[] = { 0 };
+			vkCmdBindVertexBuffers(p_context.commandBuffer, 0, 1, vertexBuffers, offsets);
 
-	vkCmdBindIndexBuffer(p_commandBuffer, this->mIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+			vkCmdBindIndexBuffer(p_context.commandBuffer, this->mIndexBuffer, 0, this->mModel.indexSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
 
-	vkCmdDrawIndexed(p_commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+			for (uint32_t i = 0; i < this->mModel.subMeshCount; i++)
+			{
+				const SubMesh& subMesh = this->mModel.subMeshes[i];
 
-	vkCmdEndRenderPass(p_commandBuffer);
-	vkEndCommandBuffer(p_commandBuffer);
-}
+				vkCmdDrawIndexed(p_context.commandBuffer, subMesh.indexCount, 1, subMesh.firstIndex, subMesh.vertexOffset, 0);
+			}
+		}
+	});
 
-VkShaderModule VKRenderer::LoadShader(const std::vector<char>& p_byteCode)
-{
-	if (p_byteCode.empty())
-		return VkShaderModule(); //bad :(
+	//Copied out after the main pass, windowed it's only given to the present after the copy
+	if (p_readback)
+	{
+		this->mRenderGraph.AddPass("readback", [&](RenderGraphPassBuilder& p_builder)
+		{
+			p_builder.Read(backbuffer, TextureAccess::TransferSrc);
+			p_builder.SetSideEffects();
+		},
+		[this, p_imageIndex, p_readbackFrame](const RenderGraphContext& p_context)
+		{
+			this->mReadbackRing.Record(p_context.commandBuffer, this->mCurrentFrame, this->mSwapChain.images[p_imageIndex], this->mSwapChain.imageFormat, this->mSwapChain.extent,
+				this->mPresentFence[this->mCurrentFrame], p_readbackFrame);
+		});
+	}
 
-	VkShaderModuleCreateInfo shaderModuleCreateInfo{};
+	if (this->mRenderGraph.Compile())
+	{
+#if RENDER_GRAPH_DUMP
+		if (!this->mFirstFrameRendered)
+			std::cout << this->mRenderGraph.Describe();
+#endif
+		this->mRenderGraph.Execute(p_commandBuffer);
+	}
 
-	shaderModuleCreateInfo.sType	= VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-	shaderModuleCreateInfo.codeSize = p_byteCode.size();
-	shaderModuleCreateInfo.pCode	= (uint32_t*)p_byteCode.data();
+	if (this->mTimestampPool != VK_NULL_HANDLE)
+	{
+		vkCmdWriteTimestamp(p_commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, this->mTimestampPool, this->mCurrentFrame * 2 + 1);
+		this->mTimestampsWritten[this->mCurrentFrame] = 1;
+	}
 
-	VkShaderModule shaderModule;
-	if (vkCreateShaderModule(this->mLogicalDevice, &shaderModuleCreateInfo, nullptr, &shaderModule) == VK_SUCCESS)
-		return shaderModule;
-	else
-		return VkShaderModule(); //I really dont know what to do with that
+	vkEndCommandBuffer(p_commandBuffer);
 }
 
 bool VKRenderer::CreateSyncObjects()
 {
-	mRenderingSemaphore.resize(this->mGraphicsPipeline.MAX_CONCURENT_FRAMES);
-	mImageAviableSemaphore.resize(this->mGraphicsPipeline.MAX_CONCURENT_FRAMES);
-	mPresentFence.resize(this->mGraphicsPipeline.MAX_CONCURENT_FRAMES);
+	mRenderingSemaphore.resize(this->mGraphicsPipeline.framesInFlight);
+	mImageAviableSemaphore.resize(this->mGraphicsPipeline.framesInFlight);
+	mPresentFence.resize(this->mGraphicsPipeline.framesInFlight);
 
 	VkSemaphoreCreateInfo semaphoreCreateInfo{};
 
@@ -1244,7 +1212,7 @@ bool VKRenderer::CreateSyncObjects()
 	fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
 	fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-	for(int i = 0; i < this->mGraphicsPipeline.MAX_CONCURENT_FRAMES; i++)
+	for (uint32_t i = 0; i < this->mGraphicsPipeline.framesInFlight; i++)
 	{ 
 		vkCreateSemaphore(this->mLogicalDevice, &semaphoreCreateInfo, nullptr, &this->mImageAviableSemaphore[i]);
 		vkCreateSemaphore(this->mLogicalDevice, &semaphoreCreateInfo, nullptr, &this->mRenderingSemaphore[i]);
@@ -1254,7 +1222,36 @@ bool VKRenderer::CreateSyncObjects()
 	return true;
 }
 
-bool VKRenderer::CreateBuffer(VkDeviceSize p_size, VkBufferUsageFlags p_usage, VkMemoryPropertyFlags p_properties, VkBuffer& p_buffer, VkDeviceMemory& p_bufferMemory)
+bool VKRenderer::CreateTimestampQueries()
+{
+	this->mTimestampsWritten.assign(this->mGraphicsPipeline.framesInFlight, 0);
+
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(this->mPhysicalDevice.physicalDevice, &queueFamilyCount, nullptr);
+
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(this->mPhysicalDevice.physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+	uint32_t timestampBits = queueFamilies[this->mPhysicalDevice.supportedQueues.graphicsFamily].timestampValidBits;
+
+	if (timestampBits == 0)
+	{
+		std::cout << "[FrameStats] no timestamps on the graphics queue, GPU time left out" << std::endl;
+		return true;
+	}
+
+	this->mTimestampMask = timestampBits >= 64 ? UINT64_MAX : (1ull << timestampBits) - 1;
+
+	VkQueryPoolCreateInfo queryPoolCreateInfo{};
+
+	queryPoolCreateInfo.sType		= VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolCreateInfo.queryType	= VK_QUERY_TYPE_TIMESTAMP;
+	queryPoolCreateInfo.queryCount	= this->mGraphicsPipeline.framesInFlight * 2;
+
+	return vkCreateQueryPool(this->mLogicalDevice, &queryPoolCreateInfo, nullptr, &this->mTimestampPool) == VK_SUCCESS;
+}
+
+bool VKRenderer::CreateBuffer(VkDeviceSize p_size, VkBufferUsageFlags p_usage, MemoryUsage p_memoryUsage, VkBuffer& p_buffer, MemoryAllocation& p_bufferMemory)
 {
 	VkBufferCreateInfo bufferCreateInfo{};
 
@@ -1265,24 +1262,12 @@ bool VKRenderer::CreateBuffer(VkDeviceSize p_size, VkBufferUsageFlags p_usage, V
 
 	bool result = vkCreateBuffer(this->mLogicalDevice, &bufferCreateInfo, nullptr, &p_buffer) == VK_SUCCESS;
 
-	VkMemoryRequirements memoryRequirements;
-
-	vkGetBufferMemoryRequirements(this->mLogicalDevice, p_buffer, &memoryRequirements);
-
-	VkMemoryAllocateInfo memoryAllocateInfo{};
-
-	memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	memoryAllocateInfo.allocationSize = memoryRequirements.size;
-	memoryAllocateInfo.memoryTypeIndex = this->FindMemoryType(memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-	result &= vkAllocateMemory(this->mLogicalDevice, &memoryAllocateInfo, nullptr, &p_bufferMemory) == VK_SUCCESS;
-
-	vkBindBufferMemory(this->mLogicalDevice, p_buffer, p_bufferMemory, 0);
+	result &= this->mAllocator.AllocateForBuffer(p_buffer, p_memoryUsage, p_bufferMemory);
 
 	return result;
 }
 
-bool VKRenderer::CreateImage(uint32_t p_width, uint32_t p_height, VkFormat p_format, VkImageTiling p_tiling, VkImageUsageFlags p_usage, VkMemoryPropertyFlags p_properties, VkImage& p_image, VkDeviceMemory& p_imageMemory)
+bool VKRenderer::CreateImage(uint32_t p_width, uint32_t p_height, uint32_t p_mipLevels, VkFormat p_format, VkImageTiling p_tiling, VkImageUsageFlags p_usage, MemoryUsage p_memoryUsage, VkImage& p_image, MemoryAllocation& p_imageMemory)
 {
 	bool result = false;
 
@@ -1293,7 +1278,7 @@ bool VKRenderer::CreateImage(uint32_t p_width, uint32_t p_height, VkFormat p_for
 	imageCreateInfo.extent.width = p_width;
 	imageCreateInfo.extent.height = p_height;
 	imageCreateInfo.extent.depth = 1;
-	imageCreateInfo.mipLevels = 1;
+	imageCreateInfo.mipLevels = p_mipLevels;
 	imageCreateInfo.arrayLayers = 1;
 	imageCreateInfo.format = p_format;
 	imageCreateInfo.tiling = p_tiling;
@@ -1304,41 +1289,18 @@ bool VKRenderer::CreateImage(uint32_t p_width, uint32_t p_height, VkFormat p_for
 
 	result = vkCreateImage(this->mLogicalDevice, &imageCreateInfo, nullptr, &p_image) == VK_SUCCESS;
 
-	VkMemoryRequirements memRequirements;
-	vkGetImageMemoryRequirements(this->mLogicalDevice, p_image, &memRequirements);
-
-	VkMemoryAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memRequirements.size;
-	allocInfo.memoryTypeIndex = this->FindMemoryType(memRequirements.memoryTypeBits, p_properties);
-
-	result &= vkAllocateMemory(this->mLogicalDevice, &allocInfo, nullptr, &p_imageMemory) == VK_SUCCESS;
-
-	vkBindImageMemory(this->mLogicalDevice, p_image, p_imageMemory, 0);
+	result &= this->mAllocator.AllocateForImage(p_image, p_tiling, p_memoryUsage, p_imageMemory);
 
 	return result;
 }
 
 bool VKRenderer::CreateIndexBuffer()
 {
-	VkDeviceSize bufferSize = sizeof(this->indices[0]) * this->indices.size();
-
-	VkBuffer stagingBuffer;
-	VkDeviceMemory stagingBufferMemory;
-
-	bool result = this->CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory) == VK_SUCCESS;
+	VkDeviceSize bufferSize = (VkDeviceSize)this->mModel.indexSize * this->mModel.indexCount;
 
-	void* data;
-	vkMapMemory(this->mLogicalDevice , stagingBufferMemory, 0, bufferSize, 0, &data);
-	memcpy(data, this->indices.data(), (size_t)bufferSize);
-	vkUnmapMemory(this->mLogicalDevice, stagingBufferMemory);
+	bool result = this->CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, MemoryUsage::GpuOnly, this->mIndexBuffer, this->mIndexBufferMemory);
 
-	result &= this->CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, this->mIndexBuffer, this->mIndexBufferMemory) == VK_SUCCESS;
-
-	this->CopyBuffer(stagingBuffer, this->mIndexBuffer, bufferSize);
-
-	vkDestroyBuffer(this->mLogicalDevice, stagingBuffer, nullptr);
-	vkFreeMemory(this->mLogicalDevice, stagingBufferMemory, nullptr);
+	result &= this->mUploadContext.UploadBuffer(this->mModel.indices, bufferSize, this->mIndexBuffer);
 
 	return result;
 }
@@ -1352,29 +1314,73 @@ bool VKRenderer::Init(Window* p_window)
 {
 	__super::Init(p_window);
 
+	this->mInitStart = std::chrono::high_resolution_clock::now();
+
+	//Nothing here waits for the model : it's read on its own thread, the buffers are created once it's done
+	this->mModelLoading = std::async(std::launch::async, &VKRenderer::LoadModel, this, MODEL_PATH);
+
 	bool result = this->CreateVKInstance();
 	
-	result &= glfwCreateWindowSurface(this->mVKInstance, this->mRenderingWindow->mWindow , nullptr, &this->mRenderingSurface) == VK_SUCCESS;
+	if (!this->mHeadless)
+		result &= glfwCreateWindowSurface(this->mVKInstance, this->mRenderingWindow->mWindow , nullptr, &this->mRenderingSurface) == VK_SUCCESS;
 
 	result &= this->PickPhysicalDevice();
 	result &= this->CreateLogicalDevice();
-	result &= this->CreateSwapChain();
-	result &= this->CreateDepthRessources();
-	result &= this->CreateDescriptorSetLayout();
+	result &= this->mPipelineCache.Init(this->mLogicalDevice, this->mPhysicalDevice.deviceProperties, PIPELINE_CACHE_PATH, PIPELINE_CACHE_MAX_SIZE);
+	result &= this->mPipelineManager.Init(this->mLogicalDevice, &this->mPipelineCache, this->mGraphicsPipeline.framesInFlight, PIPELINE_COMPILE_THREAD_COUNT);
+	result &= this->mAllocator.Init(this->mPhysicalDevice.physicalDevice, this->mLogicalDevice);
+	result &= this->mStagingRing.Init(this->mLogicalDevice, &this->mAllocator, STAGING_RING_SIZE);
+	result &= this->mRenderGraph.Init(this->mLogicalDevice, &this->mAllocator, this->mGraphicsPipeline.framesInFlight);
+	DeviceSupportedQueues& queues = this->mPhysicalDevice.supportedQueues;
+
+	result &= this->mUploadContext.Init(this->mLogicalDevice, this->mTransferQueue, queues.hasTransferFamily() ? queues.transferFamily : queues.graphicsFamily, queues.graphicsFamily, &this->mStagingRing);
+	result &= this->mTextureStreamer.Init(this->mPhysicalDevice.physicalDevice, this->mLogicalDevice, &this->mAllocator, &this->mUploadContext, this->mGraphicsPipeline.framesInFlight, STREAMING_UPLOAD_BUDGET, STREAMING_THREAD_COUNT);
+
+	this->mTexture = this->mTextureStreamer.Request(TEXTURE_PATH);
+
+	result &= this->mHeadless ? this->CreateOffscreenTargets() : this->CreateSwapChain();
+
+	//After the swapchain, which drops the consumer when its images can't be copied from
+	if (this->mFrameConsumer)
+		result &= this->mReadbackRing.Init(this->mLogicalDevice, &this->mAllocator, this->mGraphicsPipeline.framesInFlight, this->mFrameConsumer, !this->mHeadless);
+
 	result &= this->SetupGraphicsPipeline();
-	result &= this->CreateFrameBuffers();
 	result &= this->CreateCommandBuffer();
-	result &= this->CreateTextureImage();
-	result &= this->CreateTextureImageView();
 	result &= this->CreateTextureSampler();
-	result &= this->LoadModel(MODEL_PATH);
-	result &= this->CreateVertexBuffer();
-	result &= this->CreateIndexBuffer();
 	result &= this->CreateUniformBuffers();
 	result &= this->CreateDescriptorPool();
 	result &= this->CreateDescriptorSets();
 	result &= this->CreateSyncObjects();
 
+	if (this->mPacing.statsInterval != 0)
+		result &= this->CreateTimestampQueries();
+
+	std::string pacingLabel = std::string(this->mHeadless ? "headless" : GetPresentModeName(this->mPacing.presentMode)) + ", " + std::to_string(this->mGraphicsPipeline.framesInFlight) + " frames in flight";
+
+	if (this->mPacing.waitBeforeInput)
+		pacingLabel += ", wait before input";
+
+	std::cout << "[FramePacing] " << pacingLabel << std::endl;
+
+	this->mFrameStats.Init(pacingLabel, this->mPacing.statsInterval);
+
+#if SHADER_HOT_RELOAD
+	result &= this->mShaderWatcher.Init(SHADER_DIRECTORY, SHADER_COMPILER);
+#endif
+
+#if MIPMAP_BENCHMARK
+	int texWidth, texHeight, texChannels;
+
+	if (stbi_uc* pixels = stbi_load(TEXTURE_PATH, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha))
+	{
+		this->BenchmarkMipmaps(pixels, (uint32_t)texWidth, (uint32_t)texHeight);
+		stbi_image_free(pixels);
+	}
+#endif
+
+	//Same queue as rendering : submission order + the batch's final barrier are enough, no need to wait here
+	this->mUploadTicket = this->mUploadContext.Submit();
+
 	return result;
 }
 
@@ -1382,66 +1388,73 @@ void VKRenderer::Release()
 {
 	vkDeviceWaitIdle(this->mLogicalDevice); //Smol security
 
+	this->mShaderWatcher.Release();
+	this->mReadbackRing.Release(); //Consumes what was read back before the worker stops
+
+	if (this->mModelLoading.valid())
+		this->mModelLoading.wait();
+
 	//Sync objects
-	for (int i = 0; i < this->mGraphicsPipeline.MAX_CONCURENT_FRAMES; i++)
+	for (uint32_t i = 0; i < this->mGraphicsPipeline.framesInFlight; i++)
 	{ 
 		vkDestroySemaphore(this->mLogicalDevice, this->mImageAviableSemaphore[i], nullptr);
 		vkDestroySemaphore(this->mLogicalDevice, this->mRenderingSemaphore[i], nullptr);
 		vkDestroyFence(this->mLogicalDevice, this->mPresentFence[i], nullptr);
 	}
 
+	vkDestroyQueryPool(this->mLogicalDevice, this->mTimestampPool, nullptr);
+
 	//Vertex Buffer
 	vkDestroyBuffer(this->mLogicalDevice, this->mVertexBuffer, nullptr);
-	vkFreeMemory(this->mLogicalDevice, this->mVertexBufferMemory, nullptr);
+	this->mAllocator.Free(this->mVertexBufferMemory);
 
 	//Index Buffer
 	vkDestroyBuffer(this->mLogicalDevice, this->mIndexBuffer, nullptr);
-	vkFreeMemory(this->mLogicalDevice, this->mIndexBufferMemory, nullptr);
+	this->mAllocator.Free(this->mIndexBufferMemory);
 
 	//Texture
 	vkDestroySampler(this->mLogicalDevice, this->mTextureSampler, nullptr);
-	vkDestroyImageView(this->mLogicalDevice, this->mTextureImageView, nullptr);
-	vkDestroyImage(this->mLogicalDevice, this->mTextureImage, nullptr);
-	vkFreeMemory(this->mLogicalDevice, this->mTextureImageMemory, nullptr);
+	this->mTextureStreamer.Release();
 
 	//Command buffer
-	vkFreeCommandBuffers(this->mLogicalDevice, this->mCommandPool, this->mGraphicsPipeline.MAX_CONCURENT_FRAMES, this->mCommandBuffer.data());
+	vkFreeCommandBuffers(this->mLogicalDevice, this->mCommandPool, this->mGraphicsPipeline.framesInFlight, this->mCommandBuffer.data());
 	vkDestroyCommandPool(this->mLogicalDevice, this->mCommandPool, nullptr);
 
-	//Framebuffers
-	for (VkFramebuffer frameBuffer : this->mSwapChain.frameBuffers)
-		vkDestroyFramebuffer(this->mLogicalDevice, frameBuffer, nullptr);
-
-	//Depth ressources
-	vkDestroyImage(this->mLogicalDevice, this->mDepthRessources.depthImage, nullptr);
-	vkDestroyImageView(this->mLogicalDevice, this->mDepthRessources.depthImageView, nullptr);
-	vkFreeMemory(this->mLogicalDevice, this->mDepthRessources.depthMemory, nullptr);
+	//Render passes, framebuffers and transient images
+	this->mRenderGraph.Release();
 
 	//Descriptors
-	vkDestroyDescriptorSetLayout(this->mLogicalDevice, this->mDescriptorSetLayout, nullptr);
 	vkDestroyDescriptorPool(this->mLogicalDevice, this->mDescriptorPool, nullptr);
-	for (size_t i = 0; i < this->mGraphicsPipeline.MAX_CONCURENT_FRAMES; i++)
+	for (size_t i = 0; i < this->mGraphicsPipeline.framesInFlight; i++)
 	{
 		vkDestroyBuffer(this->mLogicalDevice, this->mUniformBuffers[i], nullptr);
-		vkFreeMemory(this->mLogicalDevice, this->mUniformBuffersMemory[i], nullptr);
+		this->mAllocator.Free(this->mUniformBuffersMemory[i]);
 	}
 
 	//Pipeline
-	vkDestroyPipeline(this->mLogicalDevice, this->mGraphicsPipeline.vkPipeline, nullptr);
-	vkDestroyPipelineLayout(this->mLogicalDevice, this->mGraphicsPipeline.vkPipelineLayout, nullptr);
-	vkDestroyRenderPass(this->mLogicalDevice, this->mGraphicsPipeline.vkRenderPass, nullptr);
-
-	//shader modules
-	vkDestroyShaderModule(this->mLogicalDevice, this->mFragmentShader, nullptr);
-	vkDestroyShaderModule(this->mLogicalDevice, this->mVertexShader, nullptr);
+	this->mPipelineManager.Release();
+	this->mPipelineCache.Release();
 
 	//Swapchain
-	for (const VkImageView& imageView : this->mSwapChain.imageViews)
-		vkDestroyImageView(this->mLogicalDevice, imageView, nullptr);
-	vkDestroySwapchainKHR(this->mLogicalDevice, this->mSwapChain.vkSwapChain, nullptr);
+	for (RetiredSwapChain& retiredSwapChain : this->mRetiredSwapChains)
+		this->DestroySwapChain(retiredSwapChain.swapChain);
+	this->mRetiredSwapChains.clear();
+
+	//Headless, the swapchain and surface extensions aren't even enabled
+	if (this->mHeadless)
+		this->DestroyOffscreenTargets();
+	else
+		this->DestroySwapChain(this->mSwapChain);
 
 	//Other
-	vkDestroySurfaceKHR(this->mVKInstance, this->mRenderingSurface, nullptr);
+	if (this->mRenderingSurface != VK_NULL_HANDLE)
+		vkDestroySurfaceKHR(this->mVKInstance, this->mRenderingSurface, nullptr);
+
+	//Every resource is gone, give the memory blocks back
+	this->mModelCache.Close();
+	this->mUploadContext.Release();
+	this->mStagingRing.Release();
+	this->mAllocator.Release();
 
 	//
 	//Always destory device/instance at the very end !
@@ -1461,87 +1474,328 @@ void VKRenderer::UpdateUniformBuffer()
 	auto currentTime = std::chrono::high_resolution_clock::now();
 	float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
 
+	//Same frames on every run
+	if (this->mHeadless)
+		time = this->mAnimationFrame / 60.0f;
+
 
 	ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+
+	//Packed positions are in [-1, 1] inside the bounds
+	if (this->mModelReady && this->mModel.vertexFormat == VertexFormat::Packed16)
+		ubo.model *= VertexPacker::GetDequantizeMatrix(this->mModel.bounds);
 	ubo.view = glm::lookAt(glm::vec3(-20.0f, -20.0f, -20.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
 	ubo.proj = glm::perspective(glm::radians(45.0f), this->mSwapChain.extent.width / (float)this->mSwapChain.extent.height, 0.1f, 100.0f);
 	ubo.proj[1][1] *= -1;
 
 	memcpy(this->mUniformBuffersMap[this->mCurrentFrame], &ubo, sizeof(ubo));
+	this->mAllocator.Flush(this->mUniformBuffersMemory[this->mCurrentFrame], 0, sizeof(ubo));
+}
+
+void VKRenderer::WaitForFrame()
+{
+	using Clock = std::chrono::high_resolution_clock;
+
+	Clock::time_point start = Clock::now();
+
+	vkWaitForFences(this->mLogicalDevice, 1, &this->mPresentFence[this->mCurrentFrame], VK_TRUE, UINT64_MAX);
+
+	this->mFenceWaitTime += std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+}
+
+bool VKRenderer::IsReady() const
+{
+	//What failed to load won't ever change the frame either
+	bool modelReady = this->mModelReady || !this->mModelLoading.valid();
+
+	TextureStreamer::State textureState = this->mTextureStreamer.GetState(this->mTexture);
+
+	bool textureReady = textureState == TextureStreamer::State::Resident || textureState == TextureStreamer::State::Failed;
+
+	VKPipelineManager::Status pipelineStatus = this->mPipelineManager.GetStatus(this->mPipelineStates[this->mVertexColor]);
+
+	bool pipelineReady = pipelineStatus == VKPipelineManager::Status::Ready || pipelineStatus == VKPipelineManager::Status::Failed;
+
+	return modelReady && textureReady && pipelineReady;
+}
+
+bool VKRenderer::SaveFrame(const char* p_filePath)
+{
+	if (!this->mHeadless || this->mFrameIndex == 0)
+		return false;
+
+	uint32_t lastFrame = (this->mCurrentFrame + this->mGraphicsPipeline.framesInFlight - 1) % this->mGraphicsPipeline.framesInFlight;
+
+	vkWaitForFences(this->mLogicalDevice, 1, &this->mPresentFence[lastFrame], VK_TRUE, UINT64_MAX);
+
+	VkExtent2D	 extent		= this->mSwapChain.extent;
+	VkDeviceSize imageSize	= (VkDeviceSize)extent.width * extent.height * 4;
+
+	VkBuffer			readbackBuffer = VK_NULL_HANDLE;
+	MemoryAllocation	readbackMemory;
+
+	if (!this->CreateBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, MemoryUsage::Readback, readbackBuffer, readbackMemory))
+		return false;
+
+	VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+
+	commandBufferAllocateInfo.sType					= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	commandBufferAllocateInfo.level					= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	commandBufferAllocateInfo.commandPool			= this->mCommandPool;
+	commandBufferAllocateInfo.commandBufferCount	= 1;
+
+	VkCommandBuffer commandBuffer;
+	vkAllocateCommandBuffers(this->mLogicalDevice, &commandBufferAllocateInfo, &commandBuffer);
+
+	VkCommandBufferBeginInfo beginInfo{};
+
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	//The render graph left the target in TRANSFER_SRC_OPTIMAL, visible to transfers
+	VkBufferImageCopy region{};
+
+	region.imageSubresource.aspectMask	= VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount	= 1;
+	region.imageExtent					= { extent.width, extent.height, 1 };
+
+	vkCmdCopyImageToBuffer(commandBuffer, this->mSwapChain.images[lastFrame], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer, 1, &region);
+
+	VkBufferMemoryBarrier hostBarrier{};
+
+	hostBarrier.sType				= VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	hostBarrier.srcAccessMask		= VK_ACCESS_TRANSFER_WRITE_BIT;
+	hostBarrier.dstAccessMask		= VK_ACCESS_HOST_READ_BIT;
+	hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	hostBarrier.buffer				= readbackBuffer;
+	hostBarrier.size				= VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+
+	vkEndCommandBuffer(commandBuffer);
+
+	VkSubmitInfo submitInfo{};
+
+	submitInfo.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount	= 1;
+	submitInfo.pCommandBuffers		= &commandBuffer;
+
+	vkQueueSubmit(this->mGraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+	vkQueueWaitIdle(this->mGraphicsQueue); //Once at the end of the run
+
+	this->mAllocator.Invalidate(readbackMemory);
+
+	bool result = WriteImagePPM(p_filePath, static_cast<const uint8_t*>(readbackMemory.mappedData), extent.width, extent.height, extent.width * 4);
+
+	vkFreeCommandBuffers(this->mLogicalDevice, this->mCommandPool, 1, &commandBuffer);
+	vkDestroyBuffer(this->mLogicalDevice, readbackBuffer, nullptr);
+	this->mAllocator.Free(readbackMemory);
+
+	std::cout << "[Headless] last of " << this->mAnimationFrame << " frames written to " << p_filePath << (result ? "" : " : failed") << std::endl;
+
+	return result;
+}
+
+void VKRenderer::ToggleVertexColor()
+{
+	this->mVertexColor = !this->mVertexColor;
+
+	std::cout << "[Pipelines] vertex colors " << (this->mVertexColor ? "on" : "off") << std::endl;
 }
 
 void VKRenderer::Render()
 {
+	using Clock = std::chrono::high_resolution_clock;
+
+	//Input was polled right before
+	Clock::time_point frameStart = Clock::now();
+
+	FrameTiming timing;
+
+	timing.frame = this->mFrameIndex != 0 ? std::chrono::duration<float, std::milli>(frameStart - this->mLastFrameStart).count() : -1.0f;
+
+	this->mLastFrameStart = frameStart;
+
 	//
 	//Frame prep
 	//
 
-	vkWaitForFences(this->mLogicalDevice, 1, &this->mPresentFence[this->mCurrentFrame], VK_TRUE, UINT64_MAX);
-	vkResetFences(this->mLogicalDevice, 1, &this->mPresentFence[this->mCurrentFrame]);
+	//Right away when WaitForFrame() already waited
+	this->WaitForFrame();
+
+	//Taken before anything streams in this frame so whether the frame counts never depends on timing
+	bool countsForAnimation = this->mHeadless && this->IsReady();
+
+	//Before the fence is reset : the frames whose copy is done go to the consumer
+	if (this->mFrameConsumer)
+		this->mReadbackRing.Update();
+
+	timing.fenceWait		= this->mFenceWaitTime;
+	this->mFenceWaitTime	= 0.0f;
 
-	uint32_t imageIndex;
-	vkAcquireNextImageKHR(this->mLogicalDevice, this->mSwapChain.vkSwapChain, UINT64_MAX, this->mImageAviableSemaphore[this->mCurrentFrame], VK_NULL_HANDLE, &imageIndex);
+	//The frame that used this slot is done, so are its timestamps
+	if (this->mTimestampPool != VK_NULL_HANDLE && this->mTimestampsWritten[this->mCurrentFrame])
+	{
+		uint64_t timestamps[2];
+
+		if (vkGetQueryPoolResults(this->mLogicalDevice, this->mTimestampPool, this->mCurrentFrame * 2, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+			timing.gpu = ((timestamps[1] - timestamps[0]) & this->mTimestampMask) * this->mPhysicalDevice.deviceProperties.limits.timestampPeriod / 1e6f;
+
+		this->mTimestampsWritten[this->mCurrentFrame] = 0;
+	}
+
+	//Swapchains replaced at least framesInFlight frames ago : every frame that used them is done
+	for (size_t i = 0; i < this->mRetiredSwapChains.size();)
+	{
+		if (this->mRetiredSwapChains[i].lastUsedFrame + this->mGraphicsPipeline.framesInFlight <= this->mFrameIndex)
+		{
+			this->DestroySwapChain(this->mRetiredSwapChains[i].swapChain);
+			this->mRetiredSwapChains.erase(this->mRetiredSwapChains.begin() + i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	//Headless : one offscreen target per frame in flight, nothing to wait for
+	uint32_t imageIndex = this->mCurrentFrame;
+
+	if (!this->mHeadless && !this->AcquireSwapChainImage(imageIndex, timing.acquire))
+		return;
+
+	//Only once something will be submitted with it, an early return must leave it signaled
+	vkResetFences(this->mLogicalDevice, 1, &this->mPresentFence[this->mCurrentFrame]);
 
 	vkResetCommandBuffer(this->mCommandBuffer[this->mCurrentFrame], 0);
 
+	//
+	//Streaming : whatever finished loading gets uploaded, this frame's descriptor set is free to patch
+	//
+
+	if (!this->mModelReady && this->mModelLoading.valid() && this->mModelLoading.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		if (this->mModelLoading.get())
+			this->mModelReady = this->CreateVertexBuffer() && this->CreateIndexBuffer();
+	}
+
+	this->mTextureStreamer.Update(); //Submits the model uploads too
+#if SHADER_HOT_RELOAD
+	for (const std::string& shaderPath : this->mShaderWatcher.TakeCompiled())
+		this->mPipelineManager.ReloadShader(shaderPath.c_str());
+#endif
+
+	this->mPipelineManager.Update(); //Publishes the pipelines compiled since last frame
+	this->mRenderGraph.Reset(); //This frame's fence is signaled, what no other frame uses can go
+
+	this->mTextureStreamer.PatchDescriptor(this->mTexture, this->mDescriptorSets[this->mCurrentFrame], 1, this->mTextureSampler, this->mTextureDescriptorVersions[this->mCurrentFrame]);
+
 	//
 	//Update objects data (idealy in engine class)
 	//
 
 	UpdateUniformBuffer();
 
+	//Headless only reads back the frames that count, numbered like the animation
+	bool		readback		= this->mFrameConsumer && (!this->mHeadless || countsForAnimation);
+	uint64_t	readbackFrame	= this->mHeadless ? this->mAnimationFrame : this->mFrameIndex;
+
+	if (countsForAnimation)
+		this->mAnimationFrame++;
+
 	//
 	//Command Buffer
 	//
 
-	this->RecordCommandBuffer(this->mCommandBuffer[this->mCurrentFrame], imageIndex);
+	std::vector<VkSemaphore> waitSemaphores;
+
+	if (!this->mHeadless)
+		waitSemaphores.push_back(this->mImageAviableSemaphore[this->mCurrentFrame]);
+
+	this->RecordCommandBuffer(this->mCommandBuffer[this->mCurrentFrame], imageIndex, waitSemaphores, readback, readbackFrame);
+
+	std::vector<VkPipelineStageFlags> waitStages(waitSemaphores.size(), VKUploadContext::CONSUMER_STAGES);
+
+	if (!this->mHeadless)
+		waitStages[0] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
 	VkSubmitInfo submitInfo{};
 
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-	VkSemaphore waitSemaphores[] = { this->mImageAviableSemaphore[this->mCurrentFrame] };
-	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-
-	submitInfo.waitSemaphoreCount = 1;
-	submitInfo.pWaitSemaphores = waitSemaphores;
-	submitInfo.pWaitDstStageMask = waitStages;
+	submitInfo.waitSemaphoreCount = (uint32_t)waitSemaphores.size();
+	submitInfo.pWaitSemaphores = waitSemaphores.data();
+	submitInfo.pWaitDstStageMask = waitStages.data();
 
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &this->mCommandBuffer[this->mCurrentFrame];
 
 	VkSemaphore signalSemaphores[] = { this->mRenderingSemaphore[this->mCurrentFrame] };
 
-	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.signalSemaphoreCount = this->mHeadless ? 0 : 1;
 	submitInfo.pSignalSemaphores = signalSemaphores;
 
 	vkQueueSubmit(this->mGraphicsQueue, 1, &submitInfo, this->mPresentFence[this->mCurrentFrame]);
+
+	timing.inputToSubmit = std::chrono::duration<float, std::milli>(Clock::now() - frameStart).count();
 	
 	//
 	//Present stuff
 	//
 
-	VkPresentInfoKHR presentInfo{};
+	if (!this->mHeadless)
+	{
+		VkPresentInfoKHR presentInfo{};
+
+		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+		presentInfo.waitSemaphoreCount = 1;
+		presentInfo.pWaitSemaphores = signalSemaphores;
+
+		VkSwapchainKHR swapChains[] = { this->mSwapChain.vkSwapChain };
 
-	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-	presentInfo.waitSemaphoreCount = 1;
-	presentInfo.pWaitSemaphores = signalSemaphores;
+		presentInfo.swapchainCount = 1;
+		presentInfo.pSwapchains = swapChains;
+		presentInfo.pImageIndices = &imageIndex;
 
-	VkSwapchainKHR swapChains[] = { this->mSwapChain.vkSwapChain };
+		VkResult presentResult = vkQueuePresentKHR(this->mPresentQueue, &presentInfo);
+
+		if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR)
+			this->mSwapChainOutdated = true;
+	}
+
+	if (!this->mFirstFrameRendered)
+	{
+		std::cout << "[Streaming] first frame submitted " << std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - this->mInitStart).count() << " ms after Init" << std::endl;
 
-	presentInfo.swapchainCount = 1;
-	presentInfo.pSwapchains = swapChains;
-	presentInfo.pImageIndices = &imageIndex;
+		this->mFirstFrameRendered = true;
+	}
 
-	vkQueuePresentKHR(this->mPresentQueue, &presentInfo);
+	this->mFrameStats.Add(timing);
 
-	this->mCurrentFrame = (this->mCurrentFrame + 1) % this->mGraphicsPipeline.MAX_CONCURENT_FRAMES;
+	this->mCurrentFrame = (this->mCurrentFrame + 1) % this->mGraphicsPipeline.framesInFlight;
+	this->mFrameIndex++;
 }
 
 //In a perfect world this would go to utils.h, but i dont have the time to do that anymore
 //Btw it look so uneficient xDDD
 bool VKRenderer::LoadModel(const char* p_filepath)
 {
+	using Clock = std::chrono::high_resolution_clock;
+
+	Clock::time_point start = Clock::now();
+
+	if (this->mModelCache.Open(p_filepath, VERTEX_FORMAT))
+	{
+		this->mModel = this->mModelCache.GetView();
+
+		std::cout << "[MeshCache] " << p_filepath << " : warm cache " << std::chrono::duration<float, std::milli>(Clock::now() - start).count() << " ms (" << this->mModel.vertexCount << " vertices, " << this->mModel.indexCount << " x " << this->mModel.indexSize * 8 << " bits indices, " << this->mModel.subMeshCount << " sub-meshes)" << std::endl;
+
+		return true;
+	}
+
 	bool result = false;
 
 	tinyobj::attrib_t attrib;
@@ -1551,32 +1805,49 @@ bool VKRenderer::LoadModel(const char* p_filepath)
 
 	result = tinyobj::LoadObj(&attrib, &shapes, &materials, &err, p_filepath);
 
-	std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+	std::vector<Vertex>		dedupVertices;
+	std::vector<uint32_t>	dedupIndices;
+	DeduplicationStats		dedupStats;
 
-	for (const auto& shape : shapes) {
-		for (const auto& index : shape.mesh.indices) {
-			Vertex vertex{};
+	VertexDeduplicator::Deduplicate(attrib, shapes, dedupVertices, dedupIndices, 0, &dedupStats);
 
-			vertex.pos = {
-				attrib.vertices[3 * index.vertex_index + 0],
-				attrib.vertices[3 * index.vertex_index + 1],
-				attrib.vertices[3 * index.vertex_index + 2]
-			};
+	std::cout << "[Dedup] " << p_filepath << " : " << dedupStats.cornerCount << " corners in " << dedupStats.milliseconds << " ms on " << dedupStats.threadCount << " threads (" << dedupStats.CornersPerSecond() / 1e6f << " M corners/s)" << std::endl;
 
-			vertex.textCoords = {
-				attrib.texcoords[2 * index.texcoord_index + 0],
-				1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-			};
+	MeshOptimizationStats optimizationStats;
 
-			vertex.color = { 1.0f, 1.0f, 1.0f };
+	MeshOptimizer::Optimize(dedupVertices, dedupIndices, &optimizationStats);
 
-			if (uniqueVertices.count(vertex) == 0) {
-				uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-				this->vertices.push_back(vertex);
-			}
+	std::cout << "[MeshOptimizer] " << p_filepath << " : ACMR " << optimizationStats.before.acmr << " -> " << optimizationStats.after.acmr << ", ATVR " << optimizationStats.before.atvr << " -> " << optimizationStats.after.atvr << ", " << optimizationStats.clusterCount << " clusters in " << optimizationStats.milliseconds << " ms" << std::endl;
 
-			this->indices.push_back(uniqueVertices[vertex]);
-		}
+	MeshIndexer::Build(std::move(dedupVertices), dedupIndices, SPLIT_LARGE_MESHES, this->mModelData);
+
+	if (VERTEX_FORMAT == VertexFormat::Packed16)
+	{
+		QuantizationReport report;
+
+		VertexPacker::Pack(this->mModelData, &report);
+
+		std::cout << "[VertexPacker] " << p_filepath << " : position error " << report.maxPositionError << " (bound " << report.positionErrorBound << "), uv error " << report.maxTextCoordError << " (bound " << report.textCoordErrorBound << "), color error " << report.maxColorError << " (bound " << report.colorErrorBound << ")" << std::endl;
+	}
+
+	this->mModel = this->mModelData.GetView();
+
+	float coldTime = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+	if (!result || !MeshCache::Write(p_filepath, this->mModel))
+		return result;
+
+	//Read it back right away : next launches take this path, so it doubles as the warm side of the benchmark.
+	//Mapping is lazy, the pages are only touched by the upload memcpy, which both paths pay the same
+	start = Clock::now();
+
+	if (this->mModelCache.Open(p_filepath, VERTEX_FORMAT))
+	{
+		this->mModel = this->mModelCache.GetView();
+
+		std::cout << "[MeshCache] " << p_filepath << " : cold OBJ " << coldTime << " ms, warm cache " << std::chrono::duration<float, std::milli>(Clock::now() - start).count() << " ms (" << this->mModel.vertexCount << " vertices, " << this->mModel.indexCount << " x " << this->mModel.indexSize * 8 << " bits indices, " << this->mModel.subMeshCount << " sub-meshes)" << std::endl;
+
+		this->mModelData.Clear();
 	}
 
 	return result;
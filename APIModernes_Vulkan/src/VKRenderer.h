@@ -4,16 +4,41 @@
 
 #include <vector>
 #include <array>
+#include <chrono>
+#include <future>
 
 #include "Utils.h"
+#include "VKMemoryAllocator.h"
+#include "VKPipelineCache.h"
+#include "VKPipelineManager.h"
+#include "VKReadbackRing.h"
+#include "VKStagingRing.h"
+#include "VKUploadContext.h"
+#include "MeshCache.h"
+#include "FrameStats.h"
+#include "MeshIndexer.h"
+#include "RenderGraph.h"
+#include "ShaderWatcher.h"
+#include "TextureStreamer.h"
 
 #include "IRenderer.h"
 
 class VKRenderer : public IRenderer
 {
 private :
-	std::vector<Vertex> vertices;
-	std::vector<uint16_t> indices;
+	//Replaced by a recreation, frames in flight may still use its images
+	struct RetiredSwapChain
+	{
+		SwapChainDescription	swapChain;
+		uint64_t				lastUsedFrame;
+	};
+
+	MeshData	mModelData;
+	MeshCache	mModelCache;
+	MeshView	mModel; //What gets uploaded and drawn, from the cache when possible, from mModelData otherwise
+
+	std::future<bool>	mModelLoading;		 //LoadModel() runs in the background, nothing is drawn until it's done
+	bool				mModelReady = false; //Buffers created and uploaded
 
 	//Would like this to be parametrable ?
 	const std::vector<const char*> mValidationLayers = { "VK_LAYER_KHRONOS_validation" };
@@ -21,19 +46,31 @@ private :
 
 	VkInstance		mVKInstance;
 	VkDevice		mLogicalDevice;
-	VkSurfaceKHR	mRenderingSurface;
+	VkSurfaceKHR	mRenderingSurface = VK_NULL_HANDLE; //None headless
 
 	VkQueue			mPresentQueue;
 	VkQueue			mGraphicsQueue;
+	VkQueue			mTransferQueue; //Same as mGraphicsQueue when the device has no transfer only family
 
 	PhysicalDeviceDescription	mPhysicalDevice;
-	SwapChainDescription		mSwapChain;
+	SwapChainDescription		mSwapChain; //Headless : offscreen targets, one per frame in flight, no VkSwapchainKHR
+	std::vector<RetiredSwapChain> mRetiredSwapChains;
+	bool						mSwapChainOutdated = false; //Out of date, suboptimal or resized, recreated before the next acquire
 	GraphicPipelineDescription  mGraphicsPipeline;
-	DepthRessources				mDepthRessources;
+	VKPipelineCache				mPipelineCache;
+	VKPipelineManager			mPipelineManager;
+	PipelineState				mPipelineStates[2]; //Of the model, the permutations of triangle.frag without and with vertex colors, looked up when recording
+	bool						mVertexColor = true; //Index of the permutation drawn, both are compiled so toggling never waits
+	ShaderWatcher				mShaderWatcher; //Only started with SHADER_HOT_RELOAD
+	RenderGraph					mRenderGraph;
+	VkFormat					mDepthFormat = VK_FORMAT_UNDEFINED;
+
+	VKMemoryAllocator			mAllocator;
+	VKStagingRing				mStagingRing;
+	VKUploadContext				mUploadContext;
+	UploadTicket				mUploadTicket = 0;
+	TextureStreamer				mTextureStreamer;
 
-
-	VkShaderModule mVertexShader;
-	VkShaderModule mFragmentShader;
 	
 	//-------
 	std::vector<VkDescriptorSet>	mDescriptorSets;
@@ -41,7 +78,7 @@ private :
 	VkDescriptorPool				mDescriptorPool;
 
 	std::vector<VkBuffer>		mUniformBuffers;
-	std::vector<VkDeviceMemory> mUniformBuffersMemory;
+	std::vector<MemoryAllocation> mUniformBuffersMemory;
 	std::vector<void*>			mUniformBuffersMap;
 	//-------
 
@@ -56,19 +93,43 @@ private :
 	std::vector<VkFence>		mPresentFence;
 	//------
 
+	//------ Headless
+	bool							mHeadless = false;
+	std::vector<MemoryAllocation>	mOffscreenMemory;	//Of the images in mSwapChain
+	uint64_t						mAnimationFrame = 0; //Frames since IsReady(), the animation time instead of the clock
+	//------
+
+	//------ Capture
+	ReadbackCallback	mFrameConsumer; //Empty : nothing is read back
+	VKReadbackRing		mReadbackRing;
+	//------
+
+	//------ Frame pacing
+	FramePacing					mPacing;
+	FrameStats					mFrameStats;
+	float						mFenceWaitTime = 0.0f;				//Of the current frame, ms, WaitForFrame() may run before Render()
+	VkQueryPool					mTimestampPool = VK_NULL_HANDLE;	//Two per frame in flight, only with stats
+	uint64_t					mTimestampMask = 0;
+	std::vector<uint8_t>		mTimestampsWritten;					//Per frame in flight, its command buffer wrote them
+	std::chrono::high_resolution_clock::time_point	mLastFrameStart;
+	//------
+
 	//------ TODO : this would fit in a Model class
-	VkBuffer		mVertexBuffer;
-	VkDeviceMemory	mVertexBufferMemory;
-	VkBuffer		mIndexBuffer;
-	VkDeviceMemory	mIndexBufferMemory;
-	VkImage			mTextureImage;
-	VkDeviceMemory	mTextureImageMemory;
-	VkImageView		mTextureImageView;
-	VkSampler		mTextureSampler;
+	VkBuffer			mVertexBuffer = VK_NULL_HANDLE;
+	MemoryAllocation	mVertexBufferMemory;
+	VkBuffer			mIndexBuffer = VK_NULL_HANDLE;
+	MemoryAllocation	mIndexBufferMemory;
+	TextureHandle		mTexture = 0;
+	std::vector<uint32_t> mTextureDescriptorVersions; //Per frame in flight, the texture view version its set holds
+	VkSampler			mTextureSampler;
 	//
 
 
 	uint32_t mCurrentFrame = 0;
+	uint64_t mFrameIndex = 0; //Frames rendered since Init
+
+	std::chrono::high_resolution_clock::time_point	mInitStart;
+	bool											mFirstFrameRendered = false;
 
 private :
 	bool CreateVKInstance();
@@ -89,10 +150,23 @@ private :
 
 	VkExtent2D GetSwapchainExtent(const VkSurfaceCapabilitiesKHR& surfaceCapabilities);
 
-	//TODO : VKRenderer::CreateLogicalDevice : presentMode is hardcoded to FIFO (i dont want anything else, but could be cool to make it parametrable)
-	bool CreateSwapChain();
+	//Present mode from the frame pacing, FIFO when the surface doesn't have it
+	bool CreateSwapChain(VkSwapchainKHR p_oldSwapChain = VK_NULL_HANDLE);
 
-	bool CreateDescriptorSetLayout();
+	//New swapchain at the window's current size, the old one is handed to the driver to reuse and only destroyed once
+	//no frame in flight uses it, without waiting for the device. False while the window is minimized
+	bool RecreateSwapChain();
+
+	void DestroySwapChain(SwapChainDescription& p_swapChain);
+
+	//Headless stand-in for the swapchain : color images of the window size, copied out by SaveFrame()
+	bool CreateOffscreenTargets();
+	//Views, images and memory only, there's no swapchain to destroy headless
+	void DestroyOffscreenTargets();
+
+	//Acquires the next swapchain image, recreating the swapchain first when it's outdated.
+	//False when the frame has to be skipped (minimized, out of date twice)
+	bool AcquireSwapChainImage(uint32_t& p_imageIndex, float& p_acquireTime);
 
 	bool CreateUniformBuffers();
 
@@ -106,15 +180,13 @@ private :
 
 	VkFormat FindDepthFormat();
 
-	bool CreateDepthRessources();
-
-	bool CreateFrameBuffers();
+	//Blit source/destination with a linear filter, what GPU mip generation needs
+	bool SupportsLinearBlit(VkFormat p_format);
 
 	bool CreateCommandBuffer();
 
-	bool CreateTextureImage();
-
-	bool CreateTextureImageView(); 
+	//Prints the CPU box filter time next to the GPU blit time for a full chain of the given RGBA8 image
+	void BenchmarkMipmaps(const uint8_t* p_pixels, uint32_t p_width, uint32_t p_height);
 
 	bool CreateTextureSampler();
 
@@ -122,44 +194,66 @@ private :
 
 	bool CreateIndexBuffer();
 
-	void RecordCommandBuffer(VkCommandBuffer& commandBuffer, uint32_t imageIndex);
+	//p_readback : the frame is also copied to the readback ring, handed to the consumer as p_readbackFrame
+	void RecordCommandBuffer(VkCommandBuffer& commandBuffer, uint32_t imageIndex, std::vector<VkSemaphore>& uploadSemaphores, bool p_readback, uint64_t p_readbackFrame);
 
 	bool CreateSyncObjects();
 
-	uint32_t FindMemoryType(const uint32_t& p_filterBits, VkMemoryPropertyFlags properties);
-
-	bool CreateBuffer(VkDeviceSize p_size, VkBufferUsageFlags p_usage, VkMemoryPropertyFlags p_properties, VkBuffer& p_buffer, VkDeviceMemory& p_bufferMemory);
-	bool CreateImage(uint32_t p_width, uint32_t p_height, VkFormat p_format, VkImageTiling p_tiling, VkImageUsageFlags p_usage, VkMemoryPropertyFlags p_properties, VkImage& p_image, VkDeviceMemory& p_imageMemory);
+	//GPU frame time for the stats, false only when creating the pool fails, the stats go without it on devices without timestamps
+	bool CreateTimestampQueries();
 
-	void CopyBufferToImage(VkBuffer p_buffer, VkImage p_image, uint32_t p_width, uint32_t p_height);
-	void TransitionImageLayout(VkImage p_image, VkFormat p_format, VkImageLayout p_oldLayout, VkImageLayout p_newLayout);
-	void CopyBuffer(VkBuffer p_srcBuffer, VkBuffer p_dstBuffer, VkDeviceSize p_size);
+	bool CreateBuffer(VkDeviceSize p_size, VkBufferUsageFlags p_usage, MemoryUsage p_memoryUsage, VkBuffer& p_buffer, MemoryAllocation& p_bufferMemory);
+	bool CreateImage(uint32_t p_width, uint32_t p_height, uint32_t p_mipLevels, VkFormat p_format, VkImageTiling p_tiling, VkImageUsageFlags p_usage, MemoryUsage p_memoryUsage, VkImage& p_image, MemoryAllocation& p_imageMemory);
 
-	VkImageView CreateImageView(VkImage p_image, VkFormat p_format, VkImageAspectFlags p_aspectFlags);
 
-	VkCommandBuffer BeginSingleTimeCommands();
-	void EndSingleTimeCommands(VkCommandBuffer p_commandBuffer);
+	VkImageView CreateImageView(VkImage p_image, VkFormat p_format, VkImageAspectFlags p_aspectFlags, uint32_t p_mipLevels);
 
 	void UpdateUniformBuffer();
 
 public:
-	VkShaderModule LoadShader(const std::vector<char>& p_byteCode); //TODO : put LoadShader() in a Ressource manager or smth
+	//p_headless : no window, surface nor present, frames are only rendered offscreen
+	VKRenderer(const FramePacing& p_pacing = FramePacing(), bool p_headless = false);
 
-	static VkVertexInputBindingDescription GetBindingDescription()
+	//Before Init(). Every frame is read back in the background and handed to p_consumer on a worker thread.
+	//Windowed, frames are dropped while the consumer is behind, headless the renderer waits for it
+	void SetFrameConsumer(const ReadbackCallback& p_consumer) { this->mFrameConsumer = p_consumer; }
+
+	static VkVertexInputBindingDescription GetBindingDescription(VertexFormat p_format)
 	{	
 		VkVertexInputBindingDescription vertexInputBindingDescription{};
 
 		vertexInputBindingDescription.binding	= 0;
-		vertexInputBindingDescription.stride	= sizeof(Vertex);
+		vertexInputBindingDescription.stride	= GetVertexStride(p_format);
 		vertexInputBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
 		return vertexInputBindingDescription;
 	}
 
-	static std::array<VkVertexInputAttributeDescription, 3> GetAttributeDescriptions() 
+	//Same locations in both formats, only the fetch format changes so the shaders work with either
+	static std::array<VkVertexInputAttributeDescription, 3> GetAttributeDescriptions(VertexFormat p_format) 
 	{
 		std::array<VkVertexInputAttributeDescription, 3> vertexInputAttributeDescription{};
 
+		if (p_format == VertexFormat::Packed16)
+		{
+			vertexInputAttributeDescription[0].binding = 0;
+			vertexInputAttributeDescription[0].location = 0;
+			vertexInputAttributeDescription[0].format = VK_FORMAT_R16G16B16A16_SNORM;
+			vertexInputAttributeDescription[0].offset = offsetof(PackedVertex, PackedVertex::pos);
+
+			vertexInputAttributeDescription[1].binding = 0;
+			vertexInputAttributeDescription[1].location = 1;
+			vertexInputAttributeDescription[1].format = VK_FORMAT_R8G8B8A8_UNORM;
+			vertexInputAttributeDescription[1].offset = offsetof(PackedVertex, PackedVertex::color);
+
+			vertexInputAttributeDescription[2].binding = 0;
+			vertexInputAttributeDescription[2].location = 2;
+			vertexInputAttributeDescription[2].format = VK_FORMAT_R16G16_SFLOAT;
+			vertexInputAttributeDescription[2].offset = offsetof(PackedVertex, PackedVertex::textCoords);
+
+			return vertexInputAttributeDescription;
+		}
+
 		vertexInputAttributeDescription[0].binding = 0;
 		vertexInputAttributeDescription[0].location = 0;
 		vertexInputAttributeDescription[0].format = VK_FORMAT_R32G32B32_SFLOAT;
@@ -186,5 +280,10 @@ public:
 	bool Init(Window* p_window) override;
 	void Release() override;
 	void Render() override;
+	void WaitForFrame() override;
+	bool IsReady() const override;
+	//Waits for the last frame and writes it as a binary PPM
+	bool SaveFrame(const char* p_filePath) override;
+	void ToggleVertexColor() override;
 	bool LoadModel(const char* p_filepath);
 };
\ No newline at end of file
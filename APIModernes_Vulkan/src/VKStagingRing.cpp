@@ -0,0 +1,203 @@
+#include "VKStagingRing.h"
+
+static inline VkDeviceSize AlignOffset(VkDeviceSize p_value, VkDeviceSize p_alignment)
+{
+	return (p_value + p_alignment - 1) / p_alignment * p_alignment; //Copy alignments are not always powers of two (3 bytes texels)
+}
+
+bool VKStagingRing::Init(VkDevice p_logicalDevice, VKMemoryAllocator* p_allocator, VkDeviceSize p_size)
+{
+	this->mLogicalDevice	= p_logicalDevice;
+	this->mAllocator		= p_allocator;
+	this->mSize				= p_size;
+
+	VkBufferCreateInfo bufferCreateInfo{};
+
+	bufferCreateInfo.sType			= VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferCreateInfo.size			= p_size;
+	bufferCreateInfo.usage			= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	bufferCreateInfo.sharingMode	= VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateBuffer(this->mLogicalDevice, &bufferCreateInfo, nullptr, &this->mBuffer) != VK_SUCCESS)
+		return false;
+
+	return this->mAllocator->AllocateForBuffer(this->mBuffer, MemoryUsage::Upload, this->mMemory) && this->mMemory.mappedData;
+}
+
+void VKStagingRing::Release()
+{
+	for (PendingRegion& pending : this->mPending)
+	{
+		if (pending.fence != VK_NULL_HANDLE)
+			vkWaitForFences(this->mLogicalDevice, 1, &pending.fence, VK_TRUE, UINT64_MAX);
+
+		this->ReleaseDedicated(pending.dedicated);
+	}
+
+	this->mPending.clear();
+	this->ReleaseDedicated(this->mUncommittedDedicated);
+
+	vkDestroyBuffer(this->mLogicalDevice, this->mBuffer, nullptr);
+	this->mAllocator->Free(this->mMemory);
+
+	this->mBuffer = VK_NULL_HANDLE;
+}
+
+bool VKStagingRing::TryAllocate(VkDeviceSize p_size, VkDeviceSize p_alignment, VkDeviceSize& p_offset)
+{
+	if (this->IsEmpty())
+		this->mHead = this->mTail = 0;
+	else if (this->mHead == this->mTail)
+		return false; //Full
+
+	VkDeviceSize offset = AlignOffset(this->mHead, p_alignment);
+
+	if (this->mHead >= this->mTail)
+	{
+		if (offset + p_size <= this->mSize)
+		{
+			p_offset	= offset;
+			this->mHead = offset + p_size;
+			return true;
+		}
+
+		//Wrap around, the end of the ring is wasted until the tail passes it
+		if (p_size <= this->mTail)
+		{
+			p_offset	= 0;
+			this->mHead = p_size;
+			return true;
+		}
+
+		return false;
+	}
+
+	if (offset + p_size <= this->mTail)
+	{
+		p_offset	= offset;
+		this->mHead = offset + p_size;
+		return true;
+	}
+
+	return false;
+}
+
+bool VKStagingRing::AllocateDedicated(VkDeviceSize p_size, StagingRegion& p_region)
+{
+	DedicatedStaging dedicated{};
+
+	VkBufferCreateInfo bufferCreateInfo{};
+
+	bufferCreateInfo.sType			= VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferCreateInfo.size			= p_size;
+	bufferCreateInfo.usage			= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	bufferCreateInfo.sharingMode	= VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateBuffer(this->mLogicalDevice, &bufferCreateInfo, nullptr, &dedicated.buffer) != VK_SUCCESS)
+		return false;
+
+	if (!this->mAllocator->AllocateForBuffer(dedicated.buffer, MemoryUsage::Upload, dedicated.memory))
+	{
+		vkDestroyBuffer(this->mLogicalDevice, dedicated.buffer, nullptr);
+		return false;
+	}
+
+	p_region.buffer		= dedicated.buffer;
+	p_region.offset		= 0;
+	p_region.size		= p_size;
+	p_region.mappedData = dedicated.memory.mappedData;
+
+	this->mUncommittedDedicated.push_back(dedicated);
+
+	return true;
+}
+
+void VKStagingRing::ReleaseDedicated(std::vector<DedicatedStaging>& p_dedicated)
+{
+	for (DedicatedStaging& dedicated : p_dedicated)
+	{
+		vkDestroyBuffer(this->mLogicalDevice, dedicated.buffer, nullptr);
+		this->mAllocator->Free(dedicated.memory);
+	}
+
+	p_dedicated.clear();
+}
+
+bool VKStagingRing::Allocate(VkDeviceSize p_size, VkDeviceSize p_alignment, StagingRegion& p_region)
+{
+	//Oversized uploads would stall the ring for nothing
+	if (p_size > this->mSize / 2)
+		return this->AllocateDedicated(p_size, p_region);
+
+	VkDeviceSize offset = 0;
+
+	this->Retire();
+
+	while (!this->TryAllocate(p_size, p_alignment, offset))
+	{
+		if (this->mPending.empty())
+			return false; //Only uncommitted work in the way, nothing to wait on
+
+		vkWaitForFences(this->mLogicalDevice, 1, &this->mPending.front().fence, VK_TRUE, UINT64_MAX);
+		this->Retire();
+	}
+
+	this->mHasUncommitted = true;
+
+	p_region.buffer		= this->mBuffer;
+	p_region.offset		= offset;
+	p_region.size		= p_size;
+	p_region.mappedData = (char*)this->mMemory.mappedData + offset;
+
+	return true;
+}
+
+void VKStagingRing::Flush(const StagingRegion& p_region)
+{
+	if (p_region.buffer == this->mBuffer)
+	{
+		this->mAllocator->Flush(this->mMemory, p_region.offset, p_region.size);
+		return;
+	}
+
+	for (DedicatedStaging& dedicated : this->mUncommittedDedicated)
+	{
+		if (dedicated.buffer == p_region.buffer)
+			this->mAllocator->Flush(dedicated.memory);
+	}
+}
+
+void VKStagingRing::Commit(VkFence p_fence)
+{
+	if (!this->mHasUncommitted && this->mUncommittedDedicated.empty())
+		return;
+
+	PendingRegion pending;
+
+	pending.end			= this->mHead;
+	pending.fence		= p_fence;
+	pending.dedicated	= std::move(this->mUncommittedDedicated);
+
+	this->mPending.push_back(std::move(pending));
+
+	this->mUncommittedDedicated.clear();
+	this->mHasUncommitted = false;
+
+	this->Retire();
+}
+
+void VKStagingRing::Retire()
+{
+	while (!this->mPending.empty())
+	{
+		PendingRegion& pending = this->mPending.front();
+
+		if (pending.fence != VK_NULL_HANDLE && vkGetFenceStatus(this->mLogicalDevice, pending.fence) != VK_SUCCESS)
+			break;
+
+		this->mTail = pending.end;
+		this->ReleaseDedicated(pending.dedicated);
+
+		this->mPending.pop_front();
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+
+#include <deque>
+#include <vector>
+
+#include "VKMemoryAllocator.h"
+
+struct StagingRegion
+{
+	VkBuffer		buffer		= VK_NULL_HANDLE;
+	VkDeviceSize	offset		= 0;
+	VkDeviceSize	size		= 0;
+	void*			mappedData	= nullptr;
+};
+
+//
+//One persistently mapped upload buffer that every upload sub-allocates from.
+//Regions are handed out linearly and given back in submission order once the fence they were committed with is signaled.
+//Uploads that don't fit in the ring get their own buffer, released the same way.
+//
+class VKStagingRing
+{
+private:
+	struct DedicatedStaging
+	{
+		VkBuffer			buffer;
+		MemoryAllocation	memory;
+	};
+
+	struct PendingRegion
+	{
+		VkDeviceSize					end;		//Ring head when the region was committed
+		VkFence							fence;		//VK_NULL_HANDLE means the GPU is already done with it
+		std::vector<DedicatedStaging>	dedicated;
+	};
+
+	VkDevice			mLogicalDevice	= VK_NULL_HANDLE;
+	VKMemoryAllocator*	mAllocator		= nullptr;
+
+	VkBuffer			mBuffer = VK_NULL_HANDLE;
+	MemoryAllocation	mMemory;
+	VkDeviceSize		mSize	= 0;
+
+	VkDeviceSize		mHead	= 0; //Next free byte
+	VkDeviceSize		mTail	= 0; //Oldest byte still in flight
+
+	bool							mHasUncommitted = false;
+	std::vector<DedicatedStaging>	mUncommittedDedicated;
+	std::deque<PendingRegion>		mPending;
+
+private:
+	bool IsEmpty() const { return this->mPending.empty() && !this->mHasUncommitted; }
+
+	bool TryAllocate(VkDeviceSize p_size, VkDeviceSize p_alignment, VkDeviceSize& p_offset);
+	bool AllocateDedicated(VkDeviceSize p_size, StagingRegion& p_region);
+	void ReleaseDedicated(std::vector<DedicatedStaging>& p_dedicated);
+
+public:
+	bool Init(VkDevice p_logicalDevice, VKMemoryAllocator* p_allocator, VkDeviceSize p_size);
+	void Release();
+
+	//Blocks on the oldest fence only when the ring is full
+	bool Allocate(VkDeviceSize p_size, VkDeviceSize p_alignment, StagingRegion& p_region);
+	void Flush(const StagingRegion& p_region);
+
+	//Everything allocated since the last Commit is given back once p_fence is signaled
+	void Commit(VkFence p_fence);
+
+	//Non blocking, recycles every region whose fence is signaled
+	void Retire();
+};
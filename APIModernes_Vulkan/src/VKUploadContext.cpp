@@ -0,0 +1,468 @@
+#include "VKUploadContext.h"
+
+#include <cstring>
+
+constexpr VkPipelineStageFlags VKUploadContext::CONSUMER_STAGES;
+
+bool VKUploadContext::Init(VkDevice p_logicalDevice, VkQueue p_queue, uint32_t p_queueFamily, uint32_t p_graphicsFamily, VKStagingRing* p_stagingRing)
+{
+	this->mLogicalDevice	= p_logicalDevice;
+	this->mQueue			= p_queue;
+	this->mStagingRing		= p_stagingRing;
+	this->mQueueFamily		= p_queueFamily;
+	this->mGraphicsFamily	= p_graphicsFamily;
+
+	VkCommandPoolCreateInfo commandPoolCreateInfo{};
+
+	commandPoolCreateInfo.sType				= VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	commandPoolCreateInfo.flags				= VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	commandPoolCreateInfo.queueFamilyIndex	= p_queueFamily;
+
+	return vkCreateCommandPool(this->mLogicalDevice, &commandPoolCreateInfo, nullptr, &this->mCommandPool) == VK_SUCCESS;
+}
+
+void VKUploadContext::Release()
+{
+	for (Batch& batch : this->mBatches)
+	{
+		if (batch.ticket != 0)
+			vkWaitForFences(this->mLogicalDevice, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+
+		vkDestroyFence(this->mLogicalDevice, batch.fence, nullptr);
+		vkDestroySemaphore(this->mLogicalDevice, batch.semaphore, nullptr);
+	}
+
+	this->mBatches.clear();
+	this->mRecording = -1;
+
+	vkDestroyCommandPool(this->mLogicalDevice, this->mCommandPool, nullptr); //Frees the command buffers too
+}
+
+void VKUploadContext::Poll()
+{
+	for (Batch& batch : this->mBatches)
+	{
+		if (batch.ticket == 0 || vkGetFenceStatus(this->mLogicalDevice, batch.fence) != VK_SUCCESS)
+			continue;
+
+		//The semaphore can only be signaled again once the graphics side has consumed it
+		if (!batch.acquired || (batch.acquireFence != VK_NULL_HANDLE && vkGetFenceStatus(this->mLogicalDevice, batch.acquireFence) != VK_SUCCESS))
+			continue;
+
+		batch.ticket		= 0;
+		batch.acquireFence	= VK_NULL_HANDLE;
+	}
+
+	this->mStagingRing->Retire();
+}
+
+int VKUploadContext::AcquireBatch()
+{
+	this->Poll();
+
+	for (int i = 0; i < (int)this->mBatches.size(); i++)
+	{
+		if (this->mBatches[i].ticket == 0)
+			return i;
+	}
+
+	//Everything is in flight, grow the pool
+	Batch batch;
+
+	VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+
+	commandBufferAllocateInfo.sType					= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	commandBufferAllocateInfo.level					= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	commandBufferAllocateInfo.commandPool			= this->mCommandPool;
+	commandBufferAllocateInfo.commandBufferCount	= 1;
+
+	vkAllocateCommandBuffers(this->mLogicalDevice, &commandBufferAllocateInfo, &batch.commandBuffer);
+
+	VkFenceCreateInfo fenceCreateInfo{};
+
+	fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+	vkCreateFence(this->mLogicalDevice, &fenceCreateInfo, nullptr, &batch.fence);
+
+	if (this->TransfersOwnership())
+	{
+		VkSemaphoreCreateInfo semaphoreCreateInfo{};
+
+		semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+		vkCreateSemaphore(this->mLogicalDevice, &semaphoreCreateInfo, nullptr, &batch.semaphore);
+	}
+
+	this->mBatches.push_back(batch);
+
+	return (int)this->mBatches.size() - 1;
+}
+
+VkCommandBuffer VKUploadContext::GetCommandBuffer()
+{
+	if (this->mRecording >= 0)
+		return this->mBatches[this->mRecording].commandBuffer;
+
+	this->mRecording = this->AcquireBatch();
+
+	Batch& batch = this->mBatches[this->mRecording];
+
+	vkResetFences(this->mLogicalDevice, 1, &batch.fence);
+	vkResetCommandBuffer(batch.commandBuffer, 0);
+
+	VkCommandBufferBeginInfo beginInfo{};
+
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	vkBeginCommandBuffer(batch.commandBuffer, &beginInfo);
+
+	return batch.commandBuffer;
+}
+
+bool VKUploadContext::Stage(const void* p_data, VkDeviceSize p_size, VkDeviceSize p_alignment, StagingRegion& p_staging)
+{
+	//The ring is full of what we recorded so far : send it and try again
+	if (!this->mStagingRing->Allocate(p_size, p_alignment, p_staging))
+	{
+		this->Submit();
+
+		if (!this->mStagingRing->Allocate(p_size, p_alignment, p_staging))
+			return false;
+	}
+
+	memcpy(p_staging.mappedData, p_data, (size_t)p_size);
+	this->mStagingRing->Flush(p_staging);
+
+	return true;
+}
+
+bool VKUploadContext::UploadBuffer(const void* p_data, VkDeviceSize p_size, VkBuffer p_dstBuffer, VkDeviceSize p_dstOffset)
+{
+	StagingRegion staging;
+
+	if (!this->Stage(p_data, p_size, 4, staging))
+		return false;
+
+	this->CopyBuffer(staging.buffer, staging.offset, p_dstBuffer, p_dstOffset, p_size);
+
+	return true;
+}
+
+bool VKUploadContext::UploadImageLevels(const void* p_data, VkDeviceSize p_size, VkImage p_image, const ImageLevel* p_levels, uint32_t p_levelCount, uint32_t p_baseLevel)
+{
+	StagingRegion staging;
+
+	//16 keeps the level offsets valid for block compressed formats too
+	if (!this->Stage(p_data, p_size, 16, staging))
+		return false;
+
+	this->TransitionImageLayout(p_image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, p_levelCount, p_baseLevel);
+
+	for (uint32_t level = 0; level < p_levelCount; level++)
+		this->CopyBufferToImage(staging.buffer, staging.offset + p_levels[level].offset, p_image, p_levels[level].width, p_levels[level].height, p_baseLevel + level);
+
+	this->TransitionImageLayout(p_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, p_levelCount, p_baseLevel);
+
+	return true;
+}
+
+void VKUploadContext::CopyBuffer(VkBuffer p_srcBuffer, VkDeviceSize p_srcOffset, VkBuffer p_dstBuffer, VkDeviceSize p_dstOffset, VkDeviceSize p_size)
+{
+	VkBufferCopy bufferCopy{};
+
+	bufferCopy.srcOffset	= p_srcOffset;
+	bufferCopy.dstOffset	= p_dstOffset;
+	bufferCopy.size			= p_size;
+
+	vkCmdCopyBuffer(this->GetCommandBuffer(), p_srcBuffer, p_dstBuffer, 1, &bufferCopy);
+
+	if (this->TransfersOwnership())
+	{
+		VkBufferMemoryBarrier bufferMemoryBarrier{};
+
+		bufferMemoryBarrier.sType				= VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		bufferMemoryBarrier.srcQueueFamilyIndex = this->mQueueFamily;
+		bufferMemoryBarrier.dstQueueFamilyIndex = this->mGraphicsFamily;
+		bufferMemoryBarrier.buffer				= p_dstBuffer;
+		bufferMemoryBarrier.offset				= p_dstOffset;
+		bufferMemoryBarrier.size				= p_size;
+
+		this->mBufferReleases.push_back(bufferMemoryBarrier);
+	}
+}
+
+void VKUploadContext::CopyBufferToImage(VkBuffer p_buffer, VkDeviceSize p_bufferOffset, VkImage p_image, uint32_t p_width, uint32_t p_height, uint32_t p_mipLevel)
+{
+	VkBufferImageCopy bufferImageCopy{};
+
+	bufferImageCopy.bufferOffset					= p_bufferOffset;
+	bufferImageCopy.bufferRowLength					= 0;
+	bufferImageCopy.bufferImageHeight				= 0;
+	bufferImageCopy.imageSubresource.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+	bufferImageCopy.imageSubresource.mipLevel		= p_mipLevel;
+	bufferImageCopy.imageSubresource.baseArrayLayer = 0;
+	bufferImageCopy.imageSubresource.layerCount		= 1;
+	bufferImageCopy.imageOffset						= { 0, 0, 0 };
+	bufferImageCopy.imageExtent						= { p_width, p_height, 1 };
+
+	vkCmdCopyBufferToImage(this->GetCommandBuffer(), p_buffer, p_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufferImageCopy);
+}
+
+void VKUploadContext::TransitionImageLayout(VkImage p_image, VkImageLayout p_oldLayout, VkImageLayout p_newLayout, uint32_t p_levelCount, uint32_t p_baseLevel)
+{
+	VkImageMemoryBarrier imageMemoryBarrier{};
+
+	imageMemoryBarrier.sType							= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	imageMemoryBarrier.oldLayout						= p_oldLayout;
+	imageMemoryBarrier.newLayout						= p_newLayout;
+	imageMemoryBarrier.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+	imageMemoryBarrier.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+	imageMemoryBarrier.image							= p_image;
+	imageMemoryBarrier.subresourceRange.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+	imageMemoryBarrier.subresourceRange.baseMipLevel	= p_baseLevel;
+	imageMemoryBarrier.subresourceRange.levelCount		= p_levelCount;
+	imageMemoryBarrier.subresourceRange.baseArrayLayer	= 0;
+	imageMemoryBarrier.subresourceRange.layerCount		= 1;
+
+	VkPipelineStageFlags sourceStage;
+	VkPipelineStageFlags destinationStage;
+
+	if (p_oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && p_newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+	{
+		imageMemoryBarrier.srcAccessMask = 0;
+		imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+		sourceStage			= VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		destinationStage	= VK_PIPELINE_STAGE_TRANSFER_BIT;
+	}
+	else if (p_oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && p_newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL && this->TransfersOwnership())
+	{
+		//Release half, the layout transition happens once and the graphics queue repeats the same barrier to acquire
+		imageMemoryBarrier.srcQueueFamilyIndex	= this->mQueueFamily;
+		imageMemoryBarrier.dstQueueFamilyIndex	= this->mGraphicsFamily;
+		imageMemoryBarrier.srcAccessMask		= VK_ACCESS_TRANSFER_WRITE_BIT;
+		imageMemoryBarrier.dstAccessMask		= 0;
+
+		sourceStage			= VK_PIPELINE_STAGE_TRANSFER_BIT;
+		destinationStage	= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+
+		VkImageMemoryBarrier acquireBarrier = imageMemoryBarrier;
+
+		acquireBarrier.srcAccessMask = 0;
+		acquireBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		this->GetCommandBuffer(); //Make sure mRecording is valid
+		this->mBatches[this->mRecording].imageAcquires.push_back(acquireBarrier);
+	}
+	else if (p_oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && p_newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+	{
+		imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		sourceStage			= VK_PIPELINE_STAGE_TRANSFER_BIT;
+		destinationStage	= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	}
+	else
+	{
+		return;
+	}
+
+	vkCmdPipelineBarrier(this->GetCommandBuffer(), sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+}
+
+void VKUploadContext::RecordMipmapBlits(VkCommandBuffer p_commandBuffer, VkImage p_image, uint32_t p_width, uint32_t p_height, uint32_t p_levelCount)
+{
+	VkImageMemoryBarrier imageMemoryBarrier{};
+
+	imageMemoryBarrier.sType							= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	imageMemoryBarrier.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+	imageMemoryBarrier.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+	imageMemoryBarrier.image							= p_image;
+	imageMemoryBarrier.subresourceRange.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+	imageMemoryBarrier.subresourceRange.levelCount		= 1;
+	imageMemoryBarrier.subresourceRange.baseArrayLayer	= 0;
+	imageMemoryBarrier.subresourceRange.layerCount		= 1;
+
+	int32_t width	= (int32_t)p_width;
+	int32_t height	= (int32_t)p_height;
+
+	for (uint32_t level = 1; level < p_levelCount; level++)
+	{
+		//Previous level : written -> blit source
+		imageMemoryBarrier.subresourceRange.baseMipLevel	= level - 1;
+		imageMemoryBarrier.oldLayout						= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		imageMemoryBarrier.newLayout						= VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		imageMemoryBarrier.srcAccessMask					= VK_ACCESS_TRANSFER_WRITE_BIT;
+		imageMemoryBarrier.dstAccessMask					= VK_ACCESS_TRANSFER_READ_BIT;
+
+		vkCmdPipelineBarrier(p_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+
+		int32_t nextWidth	= width > 1 ? width / 2 : 1;
+		int32_t nextHeight	= height > 1 ? height / 2 : 1;
+
+		VkImageBlit imageBlit{};
+
+		imageBlit.srcOffsets[0]					= { 0, 0, 0 };
+		imageBlit.srcOffsets[1]					= { width, height, 1 };
+		imageBlit.srcSubresource.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+		imageBlit.srcSubresource.mipLevel		= level - 1;
+		imageBlit.srcSubresource.baseArrayLayer = 0;
+		imageBlit.srcSubresource.layerCount		= 1;
+		imageBlit.dstOffsets[0]					= { 0, 0, 0 };
+		imageBlit.dstOffsets[1]					= { nextWidth, nextHeight, 1 };
+		imageBlit.dstSubresource.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+		imageBlit.dstSubresource.mipLevel		= level;
+		imageBlit.dstSubresource.baseArrayLayer = 0;
+		imageBlit.dstSubresource.layerCount		= 1;
+
+		vkCmdBlitImage(p_commandBuffer, p_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, p_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageBlit, VK_FILTER_LINEAR);
+
+		//Previous level is final
+		imageMemoryBarrier.oldLayout		= VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		imageMemoryBarrier.newLayout		= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageMemoryBarrier.srcAccessMask	= VK_ACCESS_TRANSFER_READ_BIT;
+		imageMemoryBarrier.dstAccessMask	= VK_ACCESS_SHADER_READ_BIT;
+
+		vkCmdPipelineBarrier(p_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+
+		width	= nextWidth;
+		height	= nextHeight;
+	}
+
+	//Last level was only written
+	imageMemoryBarrier.subresourceRange.baseMipLevel	= p_levelCount - 1;
+	imageMemoryBarrier.oldLayout						= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	imageMemoryBarrier.newLayout						= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	imageMemoryBarrier.srcAccessMask					= VK_ACCESS_TRANSFER_WRITE_BIT;
+	imageMemoryBarrier.dstAccessMask					= VK_ACCESS_SHADER_READ_BIT;
+
+	vkCmdPipelineBarrier(p_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+}
+
+UploadTicket VKUploadContext::Submit()
+{
+	if (this->mRecording < 0)
+		return 0;
+
+	Batch& batch = this->mBatches[this->mRecording];
+
+	if (this->TransfersOwnership())
+	{
+		//Release every buffer written by the batch, graphics acquires them with the same barriers
+		for (VkBufferMemoryBarrier& release : this->mBufferReleases)
+		{
+			release.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			release.dstAccessMask = 0;
+
+			VkBufferMemoryBarrier acquire = release;
+
+			acquire.srcAccessMask = 0;
+			acquire.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+			batch.bufferAcquires.push_back(acquire);
+		}
+
+		if (!this->mBufferReleases.empty())
+			vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, (uint32_t)this->mBufferReleases.size(), this->mBufferReleases.data(), 0, nullptr);
+
+		this->mBufferReleases.clear();
+	}
+	else
+	{
+		//One barrier for every buffer copied in the batch instead of one per copy
+		VkMemoryBarrier memoryBarrier{};
+
+		memoryBarrier.sType			= VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		memoryBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+		vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, CONSUMER_STAGES, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+	}
+
+	vkEndCommandBuffer(batch.commandBuffer);
+
+	VkSubmitInfo submitInfo{};
+
+	submitInfo.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount	= 1;
+	submitInfo.pCommandBuffers		= &batch.commandBuffer;
+
+	if (this->TransfersOwnership())
+	{
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores	= &batch.semaphore;
+
+		batch.acquired = false;
+	}
+
+	vkQueueSubmit(this->mQueue, 1, &submitInfo, batch.fence);
+
+	batch.ticket = this->mNextTicket++;
+	this->mRecording = -1;
+
+	//Staging regions used by this batch come back once its fence is signaled
+	this->mStagingRing->Commit(batch.fence);
+
+	return batch.ticket;
+}
+
+bool VKUploadContext::IsComplete(UploadTicket p_ticket)
+{
+	this->Poll();
+
+	for (const Batch& batch : this->mBatches)
+	{
+		if (batch.ticket != 0 && batch.ticket <= p_ticket)
+			return false;
+	}
+
+	return true;
+}
+
+void VKUploadContext::Wait(UploadTicket p_ticket)
+{
+	std::vector<VkFence> fences;
+
+	for (const Batch& batch : this->mBatches)
+	{
+		if (batch.ticket != 0 && batch.ticket <= p_ticket)
+			fences.push_back(batch.fence);
+	}
+
+	if (!fences.empty())
+		vkWaitForFences(this->mLogicalDevice, (uint32_t)fences.size(), fences.data(), VK_TRUE, UINT64_MAX);
+
+	this->Poll();
+}
+
+void VKUploadContext::AcquireOwnership(VkCommandBuffer p_commandBuffer, VkFence p_submitFence, std::vector<VkSemaphore>& p_waitSemaphores)
+{
+	if (!this->TransfersOwnership())
+		return;
+
+	std::vector<VkBufferMemoryBarrier>	bufferAcquires;
+	std::vector<VkImageMemoryBarrier>	imageAcquires;
+
+	for (Batch& batch : this->mBatches)
+	{
+		if (batch.ticket == 0 || batch.acquired)
+			continue;
+
+		bufferAcquires.insert(bufferAcquires.end(), batch.bufferAcquires.begin(), batch.bufferAcquires.end());
+		imageAcquires.insert(imageAcquires.end(), batch.imageAcquires.begin(), batch.imageAcquires.end());
+
+		p_waitSemaphores.push_back(batch.semaphore);
+
+		batch.bufferAcquires.clear();
+		batch.imageAcquires.clear();
+		batch.acquired		= true;
+		batch.acquireFence	= p_submitFence;
+	}
+
+	if (bufferAcquires.empty() && imageAcquires.empty())
+		return;
+
+	//The semaphore wait already orders us after the transfer queue, the source stages just have to chain with it
+	vkCmdPipelineBarrier(p_commandBuffer, CONSUMER_STAGES, CONSUMER_STAGES, 0, 0, nullptr, (uint32_t)bufferAcquires.size(), bufferAcquires.data(), (uint32_t)imageAcquires.size(), imageAcquires.data());
+}
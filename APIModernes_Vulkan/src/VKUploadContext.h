@@ -0,0 +1,101 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+
+#include <vector>
+
+#include "VKStagingRing.h"
+
+typedef uint64_t UploadTicket; //Grows with every submit, 0 is always complete
+
+//One mip level inside a blob holding the whole chain
+struct ImageLevel
+{
+	VkDeviceSize	offset	= 0;
+	VkDeviceSize	size	= 0;
+	uint32_t		width	= 0;
+	uint32_t		height	= 0;
+};
+
+//
+//Records many copies and barriers into one command buffer and submits them at once.
+//Submit() doesn't wait : it hands back a ticket that can be polled or waited on while the CPU keeps loading.
+//
+//When it runs on a dedicated transfer family, every resource it writes is released to the graphics family at the end of the batch.
+//The matching acquire barriers are recorded by the renderer through AcquireOwnership(), whose submit waits on the batch semaphore.
+//
+class VKUploadContext
+{
+public:
+	//Stages that may consume uploaded data, used for the semaphore wait and the acquire barriers
+	static constexpr VkPipelineStageFlags CONSUMER_STAGES = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+private:
+	struct Batch
+	{
+		VkCommandBuffer commandBuffer	= VK_NULL_HANDLE;
+		VkFence			fence			= VK_NULL_HANDLE;
+		UploadTicket	ticket			= 0; //0 means the batch is free
+
+		//Ownership transfer only
+		VkSemaphore							semaphore		= VK_NULL_HANDLE;
+		bool								acquired		= true;
+		VkFence								acquireFence	= VK_NULL_HANDLE; //Fence of the graphics submit that waited on the semaphore
+		std::vector<VkBufferMemoryBarrier>	bufferAcquires;
+		std::vector<VkImageMemoryBarrier>	imageAcquires;
+	};
+
+	VkDevice		mLogicalDevice	= VK_NULL_HANDLE;
+	VkQueue			mQueue			= VK_NULL_HANDLE;
+	VkCommandPool	mCommandPool	= VK_NULL_HANDLE;
+	VKStagingRing*	mStagingRing	= nullptr;
+
+	uint32_t		mQueueFamily	= UINT32_MAX;
+	uint32_t		mGraphicsFamily = UINT32_MAX;
+
+	std::vector<Batch>	mBatches;
+	int					mRecording	= -1; //Index of the batch being recorded
+	UploadTicket		mNextTicket = 1;
+
+	std::vector<VkBufferMemoryBarrier> mBufferReleases; //Buffers written by the batch being recorded
+
+private:
+	bool TransfersOwnership() const { return this->mQueueFamily != this->mGraphicsFamily; }
+
+	int AcquireBatch();
+	void Poll();
+
+	//Copies p_data into the staging ring, submits what was recorded so far if the ring is full
+	bool Stage(const void* p_data, VkDeviceSize p_size, VkDeviceSize p_alignment, StagingRegion& p_staging);
+
+public:
+	//p_queueFamily == p_graphicsFamily means uploads share the graphics queue and no ownership transfer happens
+	bool Init(VkDevice p_logicalDevice, VkQueue p_queue, uint32_t p_queueFamily, uint32_t p_graphicsFamily, VKStagingRing* p_stagingRing);
+	void Release();
+
+	//Begins a batch if none is being recorded
+	VkCommandBuffer GetCommandBuffer();
+
+	//Staging + copy, the destination is readable by any stage once the batch is done
+	bool UploadBuffer(const void* p_data, VkDeviceSize p_size, VkBuffer p_dstBuffer, VkDeviceSize p_dstOffset = 0);
+	//Uploads pre-built levels, p_data holds all of them at the offsets given by p_levels. p_levels[i] goes to mip p_baseLevel + i,
+	//the other mips of the image are left alone. Leaves the written levels in SHADER_READ_ONLY_OPTIMAL
+	bool UploadImageLevels(const void* p_data, VkDeviceSize p_size, VkImage p_image, const ImageLevel* p_levels, uint32_t p_levelCount, uint32_t p_baseLevel = 0);
+
+	void CopyBuffer(VkBuffer p_srcBuffer, VkDeviceSize p_srcOffset, VkBuffer p_dstBuffer, VkDeviceSize p_dstOffset, VkDeviceSize p_size);
+	void CopyBufferToImage(VkBuffer p_buffer, VkDeviceSize p_bufferOffset, VkImage p_image, uint32_t p_width, uint32_t p_height, uint32_t p_mipLevel = 0);
+	void TransitionImageLayout(VkImage p_image, VkImageLayout p_oldLayout, VkImageLayout p_newLayout, uint32_t p_levelCount = 1, uint32_t p_baseLevel = 0);
+	//Blit chain on any graphics command buffer, used to time the GPU against the CPU mips.
+	//Every level must be in TRANSFER_DST_OPTIMAL with level 0 written, they all end up in SHADER_READ_ONLY_OPTIMAL
+	static void RecordMipmapBlits(VkCommandBuffer p_commandBuffer, VkImage p_image, uint32_t p_width, uint32_t p_height, uint32_t p_levelCount);
+
+	//Returns 0 if nothing was recorded
+	UploadTicket Submit();
+
+	bool IsComplete(UploadTicket p_ticket);
+	void Wait(UploadTicket p_ticket);
+
+	//Records the acquire side of every submitted batch into a graphics command buffer.
+	//The submit of that command buffer must wait on p_waitSemaphores at CONSUMER_STAGES and signal p_submitFence. No-op without ownership transfer
+	void AcquireOwnership(VkCommandBuffer p_commandBuffer, VkFence p_submitFence, std::vector<VkSemaphore>& p_waitSemaphores);
+};
@@ -0,0 +1,237 @@
+#include "VertexDeduplicator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#pragma region Helpers
+static constexpr uint32_t PARTITION_BITS	= 8;
+static constexpr uint32_t PARTITION_COUNT	= 1u << PARTITION_BITS;
+static constexpr uint32_t EMPTY_SLOT		= UINT32_MAX;
+
+static_assert(sizeof(Vertex) == 8 * sizeof(float), "Vertex is hashed and compared as raw words, it must not have padding");
+
+static inline uint64_t Mix(uint64_t p_value)
+{
+	//murmur3 finalizer
+	p_value ^= p_value >> 33;
+	p_value *= 0xFF51AFD7ED558CCDull;
+	p_value ^= p_value >> 33;
+	p_value *= 0xC4CEB9FE1A85EC53ull;
+	p_value ^= p_value >> 33;
+
+	return p_value;
+}
+
+static inline Vertex MakeVertex(const tinyobj::attrib_t& p_attrib, const tinyobj::index_t& p_index)
+{
+	Vertex vertex{};
+
+	//+ 0.0f turns -0.0f into 0.0f : the raw bits compare like the floats do
+	vertex.pos = {
+		p_attrib.vertices[3 * p_index.vertex_index + 0] + 0.0f,
+		p_attrib.vertices[3 * p_index.vertex_index + 1] + 0.0f,
+		p_attrib.vertices[3 * p_index.vertex_index + 2] + 0.0f
+	};
+
+	if (p_index.texcoord_index >= 0)
+	{
+		vertex.textCoords = {
+			p_attrib.texcoords[2 * p_index.texcoord_index + 0] + 0.0f,
+			1.0f - p_attrib.texcoords[2 * p_index.texcoord_index + 1]
+		};
+	}
+
+	vertex.color = { 1.0f, 1.0f, 1.0f };
+
+	return vertex;
+}
+
+static inline bool SameVertex(const Vertex& p_a, const Vertex& p_b)
+{
+	return memcmp(&p_a, &p_b, sizeof(Vertex)) == 0;
+}
+#pragma endregion Helpers
+
+uint64_t VertexDeduplicator::HashVertex(const Vertex& p_vertex)
+{
+	uint64_t words[4];
+	memcpy(words, &p_vertex, sizeof(words));
+
+	uint64_t hash = 0x9E3779B97F4A7C15ull;
+
+	for (uint64_t word : words)
+		hash = Mix(hash ^ word) + 0x9E3779B97F4A7C15ull;
+
+	return hash;
+}
+
+void VertexDeduplicator::Deduplicate(const tinyobj::attrib_t& p_attrib, const std::vector<tinyobj::shape_t>& p_shapes, std::vector<Vertex>& p_vertices, std::vector<uint32_t>& p_indices, uint32_t p_threadCount, DeduplicationStats* p_stats)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	std::vector<tinyobj::index_t> corners;
+
+	for (const tinyobj::shape_t& shape : p_shapes)
+		corners.insert(corners.end(), shape.mesh.indices.begin(), shape.mesh.indices.end());
+
+	const uint32_t cornerCount = (uint32_t)corners.size();
+
+	uint32_t threadCount = p_threadCount ? p_threadCount : std::thread::hardware_concurrency();
+	threadCount = std::max(1u, std::min(threadCount, cornerCount / 4096 + 1)); //Small meshes aren't worth the threads
+
+	//Contiguous corner ranges, one per thread
+	auto chunkBegin = [&](uint32_t p_chunk) { return (uint32_t)((uint64_t)cornerCount * p_chunk / threadCount); };
+
+	std::vector<uint64_t> hashes(cornerCount);
+	std::vector<uint32_t> histograms((size_t)threadCount * PARTITION_COUNT, 0);
+
+	//1 : hash every corner and count how many land in each partition
+	RunOnThreads(threadCount, [&](uint32_t p_thread)
+	{
+		uint32_t* histogram = &histograms[(size_t)p_thread * PARTITION_COUNT];
+
+		for (uint32_t i = chunkBegin(p_thread); i < chunkBegin(p_thread + 1); i++)
+		{
+			hashes[i] = HashVertex(MakeVertex(p_attrib, corners[i]));
+			histogram[hashes[i] >> (64 - PARTITION_BITS)]++;
+		}
+	});
+
+	//2 : stable scatter of the corners by partition, chunk order keeps them sorted by corner inside a partition
+	std::vector<uint32_t> partitionBegin(PARTITION_COUNT + 1, 0);
+	uint32_t offset = 0;
+
+	for (uint32_t partition = 0; partition < PARTITION_COUNT; partition++)
+	{
+		partitionBegin[partition] = offset;
+
+		for (uint32_t thread = 0; thread < threadCount; thread++)
+		{
+			uint32_t count = histograms[(size_t)thread * PARTITION_COUNT + partition];
+
+			histograms[(size_t)thread * PARTITION_COUNT + partition] = offset;
+			offset += count;
+		}
+	}
+
+	partitionBegin[PARTITION_COUNT] = offset;
+
+	std::vector<uint32_t> sorted(cornerCount);
+
+	RunOnThreads(threadCount, [&](uint32_t p_thread)
+	{
+		uint32_t* cursor = &histograms[(size_t)p_thread * PARTITION_COUNT];
+
+		for (uint32_t i = chunkBegin(p_thread); i < chunkBegin(p_thread + 1); i++)
+			sorted[cursor[hashes[i] >> (64 - PARTITION_BITS)]++] = i;
+	});
+
+	//3 : each partition finds the first occurrence of every corner, partitions are picked up by whichever thread is free
+	std::vector<uint32_t>	firstOccurrence(cornerCount);
+	std::atomic<uint32_t>	nextPartition(0);
+
+	RunOnThreads(threadCount, [&](uint32_t /*p_thread*/)
+	{
+		//Slot = (hash tag, corner), reused across partitions
+		std::vector<uint64_t> table;
+
+		for (uint32_t partition = nextPartition++; partition < PARTITION_COUNT; partition = nextPartition++)
+		{
+			uint32_t begin	= partitionBegin[partition];
+			uint32_t end	= partitionBegin[partition + 1];
+
+			if (begin == end)
+				continue;
+
+			size_t capacity = 16;
+
+			while (capacity < (size_t)(end - begin) * 2)
+				capacity *= 2;
+
+			table.assign(capacity, EMPTY_SLOT);
+
+			const size_t mask = capacity - 1;
+
+			for (uint32_t j = begin; j < end; j++)
+			{
+				uint32_t corner = sorted[j];
+				uint64_t hash	= hashes[corner];
+				uint32_t tag	= (uint32_t)hash;
+				Vertex	 vertex = MakeVertex(p_attrib, corners[corner]);
+
+				//The top bits picked the partition, use the low ones for the slot
+				for (size_t slot = (size_t)hash & mask;; slot = (slot + 1) & mask)
+				{
+					uint32_t other = (uint32_t)table[slot];
+
+					if (other == EMPTY_SLOT)
+					{
+						table[slot]				= ((uint64_t)tag << 32) | corner;
+						firstOccurrence[corner] = corner;
+						break;
+					}
+
+					if ((uint32_t)(table[slot] >> 32) == tag && SameVertex(vertex, MakeVertex(p_attrib, corners[other])))
+					{
+						firstOccurrence[corner] = other; //Corners come in order, the one in the table is the first
+						break;
+					}
+				}
+			}
+		}
+	});
+
+	//4 : number unique vertices in corner order, a prefix sum over the chunks gives every thread its base
+	std::vector<uint32_t> chunkUniqueCount(threadCount + 1, 0);
+
+	RunOnThreads(threadCount, [&](uint32_t p_thread)
+	{
+		uint32_t count = 0;
+
+		for (uint32_t i = chunkBegin(p_thread); i < chunkBegin(p_thread + 1); i++)
+			count += firstOccurrence[i] == i;
+
+		chunkUniqueCount[p_thread + 1] = count;
+	});
+
+	for (uint32_t thread = 0; thread < threadCount; thread++)
+		chunkUniqueCount[thread + 1] += chunkUniqueCount[thread];
+
+	p_vertices.resize(chunkUniqueCount[threadCount]);
+	p_indices.resize(cornerCount);
+
+	std::vector<uint32_t>& vertexIds = sorted; //Free by now
+
+	RunOnThreads(threadCount, [&](uint32_t p_thread)
+	{
+		uint32_t id = chunkUniqueCount[p_thread];
+
+		for (uint32_t i = chunkBegin(p_thread); i < chunkBegin(p_thread + 1); i++)
+		{
+			if (firstOccurrence[i] != i)
+				continue;
+
+			vertexIds[i]	= id;
+			p_vertices[id]	= MakeVertex(p_attrib, corners[i]);
+			id++;
+		}
+	});
+
+	//5 : first occurrences may live in another chunk, so this waits for every id to be written
+	RunOnThreads(threadCount, [&](uint32_t p_thread)
+	{
+		for (uint32_t i = chunkBegin(p_thread); i < chunkBegin(p_thread + 1); i++)
+			p_indices[i] = vertexIds[firstOccurrence[i]];
+	});
+
+	if (p_stats)
+	{
+		p_stats->threadCount	= threadCount;
+		p_stats->cornerCount	= cornerCount;
+		p_stats->vertexCount	= p_vertices.size();
+		p_stats->milliseconds	= std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+}
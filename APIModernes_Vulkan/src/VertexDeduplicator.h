@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "tinyobjloader/tiny_obj_loader.h"
+
+#include "Utils.h"
+
+struct DeduplicationStats
+{
+	uint32_t	threadCount		= 0;
+	uint64_t	cornerCount		= 0;	//Indices read from the OBJ
+	uint64_t	vertexCount		= 0;	//Unique vertices kept
+	float		milliseconds	= 0.0f;
+
+	float CornersPerSecond() const { return this->milliseconds > 0.0f ? this->cornerCount * 1000.0f / this->milliseconds : 0.0f; }
+};
+
+//
+//Turns OBJ corners into unique vertices + indices on every core.
+//Corners are hashed in parallel, bucketed by hash into partitions, then each partition is deduplicated by one thread
+//in an open-addressing table. Vertices are numbered by first occurrence, so the output is the same as the sequential
+//loop and identical from one run (or thread count) to the next.
+//
+class VertexDeduplicator
+{
+public:
+	//p_threadCount = 0 uses every hardware thread
+	static void Deduplicate(const tinyobj::attrib_t& p_attrib, const std::vector<tinyobj::shape_t>& p_shapes, std::vector<Vertex>& p_vertices, std::vector<uint32_t>& p_indices, uint32_t p_threadCount = 0, DeduplicationStats* p_stats = nullptr);
+
+	//64 bits, avalanches every bit of the vertex (std::hash<Vertex> in Utils.h collides a lot on grid like data)
+	static uint64_t HashVertex(const Vertex& p_vertex);
+};
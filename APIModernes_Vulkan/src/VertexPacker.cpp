@@ -0,0 +1,100 @@
+#include "VertexPacker.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "glm/gtc/matrix_transform.hpp"
+#include "glm/gtc/packing.hpp"
+
+//Center and half size of the box positions are quantized in, flat axes get a unit size so nothing divides by 0
+static void GetQuantizationBox(const MeshBounds& p_bounds, glm::vec3& p_center, glm::vec3& p_halfExtent)
+{
+	p_center		= (p_bounds.min + p_bounds.max) * 0.5f;
+	p_halfExtent	= (p_bounds.max - p_bounds.min) * 0.5f;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (!(p_halfExtent[axis] > 0.0f))
+			p_halfExtent[axis] = 1.0f;
+	}
+}
+
+static inline int16_t EncodeSnorm16(float p_value)
+{
+	return (int16_t)std::lround(std::min(std::max(p_value, -1.0f), 1.0f) * 32767.0f);
+}
+
+static inline uint8_t EncodeUnorm8(float p_value)
+{
+	return (uint8_t)std::lround(std::min(std::max(p_value, 0.0f), 1.0f) * 255.0f);
+}
+
+glm::mat4 VertexPacker::GetDequantizeMatrix(const MeshBounds& p_bounds)
+{
+	glm::vec3 center;
+	glm::vec3 halfExtent;
+
+	GetQuantizationBox(p_bounds, center, halfExtent);
+
+	return glm::scale(glm::translate(glm::mat4(1.0f), center), halfExtent);
+}
+
+void VertexPacker::Pack(MeshData& p_mesh, QuantizationReport* p_report)
+{
+	glm::vec3 center;
+	glm::vec3 halfExtent;
+
+	GetQuantizationBox(p_mesh.bounds, center, halfExtent);
+
+	QuantizationReport	report;
+	float				maxTextCoord = 0.0f;
+
+	p_mesh.packedVertices.resize(p_mesh.vertices.size());
+
+	for (size_t i = 0; i < p_mesh.vertices.size(); i++)
+	{
+		const Vertex&	vertex = p_mesh.vertices[i];
+		PackedVertex&	packed = p_mesh.packedVertices[i];
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			packed.pos[axis] = EncodeSnorm16((vertex.pos[axis] - center[axis]) / halfExtent[axis]);
+
+			float decoded = center[axis] + packed.pos[axis] / 32767.0f * halfExtent[axis];
+
+			report.maxPositionError = std::max(report.maxPositionError, std::abs(decoded - vertex.pos[axis]));
+		}
+
+		packed.pos[3] = 32767;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			packed.color[axis] = EncodeUnorm8(vertex.color[axis]);
+
+			report.maxColorError = std::max(report.maxColorError, std::abs(packed.color[axis] / 255.0f - vertex.color[axis]));
+		}
+
+		packed.color[3] = 255;
+
+		for (int axis = 0; axis < 2; axis++)
+		{
+			packed.textCoords[axis] = (uint16_t)glm::packHalf1x16(vertex.textCoords[axis]);
+
+			report.maxTextCoordError	= std::max(report.maxTextCoordError, std::abs(glm::unpackHalf1x16(packed.textCoords[axis]) - vertex.textCoords[axis]));
+			maxTextCoord				= std::max(maxTextCoord, std::abs(vertex.textCoords[axis]));
+		}
+	}
+
+	report.positionErrorBound = std::max(halfExtent.x, std::max(halfExtent.y, halfExtent.z)) / 32767.0f * 0.5f;
+
+	//Halves have 10 mantissa bits, below 2^-14 the step is fixed (denormals)
+	int exponent = 0;
+	std::frexp(std::max(maxTextCoord, std::ldexp(1.0f, -14)), &exponent);
+	report.textCoordErrorBound = std::ldexp(1.0f, exponent - 1 - 11);
+
+	p_mesh.vertices.clear();
+	p_mesh.vertices.shrink_to_fit();
+
+	if (p_report)
+		*p_report = report;
+}
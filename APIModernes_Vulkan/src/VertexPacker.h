@@ -0,0 +1,30 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include "MeshIndexer.h"
+
+//Measured error next to the worst case the encoding allows, per attribute
+struct QuantizationReport
+{
+	float maxPositionError		= 0.0f; //Mesh units, any axis
+	float positionErrorBound	= 0.0f; //Half a snorm16 step on the longest axis
+	float maxTextCoordError		= 0.0f;
+	float textCoordErrorBound	= 0.0f; //Half a half-float step at the largest coordinate
+	float maxColorError			= 0.0f;
+	float colorErrorBound		= 0.5f / 255.0f;
+};
+
+//
+//Vertex -> PackedVertex. Positions are stored relative to the mesh bounds, the matrix from GetDequantizeMatrix()
+//brings them back and is meant to be folded into the model matrix so the vertex shader stays the same.
+//
+class VertexPacker
+{
+public:
+	//Fills p_mesh.packedVertices from p_mesh.vertices and p_mesh.bounds, then drops the float vertices
+	static void Pack(MeshData& p_mesh, QuantizationReport* p_report = nullptr);
+
+	//snorm [-1, 1] -> mesh space
+	static glm::mat4 GetDequantizeMatrix(const MeshBounds& p_bounds);
+};
@@ -16,10 +16,24 @@ Window* Window::Create(const std::string& p_windowName, const int& p_width, cons
 {	
 	GLFWwindow* window = glfwCreateWindow(p_width, p_height, p_windowName.c_str(), nullptr, nullptr);
 
-	if (window)
-		return new Window(window);
-	else
+	if (!window)
 		return nullptr;
+
+	Window* createdWindow = new Window(window);
+
+	glfwSetWindowUserPointer(window, createdWindow);
+	glfwSetFramebufferSizeCallback(window, &Window::OnFramebufferResized);
+
+	return createdWindow;
+}
+
+void Window::OnFramebufferResized(GLFWwindow* p_window, int p_width, int p_height)
+{
+	Window* window = static_cast<Window*>(glfwGetWindowUserPointer(p_window));
+
+	window->mWidth				= p_width;
+	window->mHeight				= p_height;
+	window->mFramebufferResized = true;
 }
 
 void Window::Destroy()
@@ -33,3 +47,25 @@ bool Window::ShouldClose()
 {
 	return glfwWindowShouldClose(mWindow);
 }
+
+bool Window::TakeFramebufferResized()
+{
+	bool resized = this->mFramebufferResized;
+
+	this->mFramebufferResized = false;
+
+	return resized;
+}
+
+void Window::WaitWhileMinimized()
+{
+	int width, height;
+
+	glfwGetFramebufferSize(this->mWindow, &width, &height);
+
+	while ((width == 0 || height == 0) && !this->ShouldClose())
+	{
+		glfwWaitEvents();
+		glfwGetFramebufferSize(this->mWindow, &width, &height);
+	}
+}
@@ -18,6 +18,10 @@ private:
 
 	bool mShouldBeDestroyed = false;
 
+	bool mFramebufferResized = false;
+
+	static void OnFramebufferResized(GLFWwindow* p_window, int p_width, int p_height);
+
 public :
 
 	GLFWwindow* mWindow = nullptr; //Read only but whatever
@@ -27,5 +31,11 @@ public :
 	void Destroy();
 
 	bool ShouldClose();
+
+	//True once after the framebuffer changed size, the swapchain has to follow
+	bool TakeFramebufferResized();
+
+	//Blocks on the window events while the framebuffer is 0x0 (minimized), returns right away otherwise or once closed
+	void WaitWhileMinimized();
 };
 
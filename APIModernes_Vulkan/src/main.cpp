@@ -3,15 +3,20 @@
 #include "Utils.h"
 
 //TODO : VkRenderer : Remove every member function that does not acces members outside the class !
-//TODO : VkRenderer : Window resizeing
 
-int main()
+int main(int argc, char** argv)
 {
+	FramePacing		pacing;
+	HeadlessSettings	headless;
+	CaptureSettings		capture;
+
+	ParseCommandLine(argc, argv, pacing, headless, capture);
+
 	Application::Create();
 
 	Application app = Application::Get();
 
-	int result = app.Run(APP_NAME, WINDOW_WIDTH, WINDOW_HEIGHT);
+	int result = app.Run(APP_NAME, WINDOW_WIDTH, WINDOW_HEIGHT, pacing, headless, capture);
 
 	app.Destroy();
 
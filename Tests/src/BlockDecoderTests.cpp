@@ -0,0 +1,81 @@
+#include <cstring>
+#include <vector>
+
+#include "BlockDecoder.h"
+
+#include "Test.h"
+
+TEST(BlockDecoderBc1)
+{
+	//c0 = pure red > c1 = pure blue : four colors, every row reads indices 0, 1, 2, 3
+	const uint8_t fourColors[8] = { 0x00, 0xF8, 0x1F, 0x00, 0xE4, 0xE4, 0xE4, 0xE4 };
+	const uint8_t palette[4][4] = { { 255, 0, 0, 255 }, { 0, 0, 255, 255 }, { 170, 0, 85, 255 }, { 85, 0, 170, 255 } };
+
+	uint8_t texels[64];
+
+	BlockDecoder::DecodeBlock(VK_FORMAT_BC1_RGB_UNORM_BLOCK, fourColors, texels);
+
+	for (uint32_t texel = 0; texel < 16; texel++)
+		CHECK(memcmp(texels + texel * 4, palette[texel % 4], 4) == 0);
+
+	//Swapped endpoints : three colors and black, which is transparent only in the RGBA formats
+	const uint8_t threeColors[8] = { 0x1F, 0x00, 0x00, 0xF8, 0xE4, 0xE4, 0xE4, 0xE4 };
+	const uint8_t threePalette[4][4] = { { 0, 0, 255, 255 }, { 255, 0, 0, 255 }, { 128, 0, 128, 255 }, { 0, 0, 0, 255 } };
+
+	BlockDecoder::DecodeBlock(VK_FORMAT_BC1_RGB_UNORM_BLOCK, threeColors, texels);
+
+	for (uint32_t texel = 0; texel < 16; texel++)
+		CHECK(memcmp(texels + texel * 4, threePalette[texel % 4], 4) == 0);
+
+	BlockDecoder::DecodeBlock(VK_FORMAT_BC1_RGBA_UNORM_BLOCK, threeColors, texels);
+
+	CHECK(texels[3 * 4 + 3] == 0 && texels[2 * 4 + 3] == 255);
+}
+
+TEST(BlockDecoderBc7Mode6)
+{
+	//R 0 -> 127, G 127 -> 0, B 32 -> 32, A 127 -> 127, p-bits 0 and 1, texel i uses index i
+	const uint8_t block[16] = { 0x40, 0xC0, 0xFF, 0x0F, 0x00, 0x81, 0xFE, 0x7F, 0x11, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE };
+
+	const uint8_t expected[64] =
+	{
+		0, 254, 64, 254,	16, 238, 64, 254,	36, 218, 64, 254,	52, 203, 64, 254,
+		68, 187, 64, 254,	84, 171, 64, 254,	104, 151, 64, 254,	120, 135, 64, 254,
+		135, 120, 65, 255,	151, 104, 65, 255,	171, 84, 65, 255,	187, 68, 65, 255,
+		203, 52, 65, 255,	219, 37, 65, 255,	239, 17, 65, 255,	255, 1, 65, 255
+	};
+
+	uint8_t texels[64];
+
+	BlockDecoder::DecodeBlock(VK_FORMAT_BC7_UNORM_BLOCK, block, texels);
+
+	CHECK(memcmp(texels, expected, sizeof(expected)) == 0);
+
+	//Reserved mode 8 : transparent black
+	const uint8_t reserved[16] = {};
+
+	BlockDecoder::DecodeBlock(VK_FORMAT_BC7_UNORM_BLOCK, reserved, texels);
+
+	CHECK(std::vector<uint8_t>(texels, texels + 64) == std::vector<uint8_t>(64, 0));
+}
+
+TEST(BlockDecoderBc7Anchors)
+{
+	//Mode 1, partition 17 : the second subset's anchor is texel 2, not texel 1 where the subset starts.
+	//Subset 0 black -> white, subset 1 red -> blue, texel i uses index i % 8
+	const uint8_t block[16] = { 0x46, 0xC0, 0xFF, 0x03, 0xC0, 0x0F, 0x00, 0xC0, 0x0F, 0xFC, 0x12, 0xC7, 0xFA, 0x88, 0xC6, 0xFA };
+
+	const uint8_t expected[64] =
+	{
+		0, 0, 0, 255,		219, 2, 38, 255,	184, 2, 73, 255,	148, 2, 109, 255,
+		146, 146, 146, 255,	182, 182, 182, 255,	217, 217, 217, 255,	2, 2, 255, 255,
+		0, 0, 0, 255,		36, 36, 36, 255,	71, 71, 71, 255,	107, 107, 107, 255,
+		146, 146, 146, 255,	182, 182, 182, 255,	217, 217, 217, 255,	253, 253, 253, 255
+	};
+
+	uint8_t texels[64];
+
+	BlockDecoder::DecodeBlock(VK_FORMAT_BC7_UNORM_BLOCK, block, texels);
+
+	CHECK(memcmp(texels, expected, sizeof(expected)) == 0);
+}
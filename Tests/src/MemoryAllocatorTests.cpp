@@ -0,0 +1,176 @@
+#include "VKMemoryAllocator.h"
+
+#include "Test.h"
+
+//Last byte of one and first byte of the other on different granularity pages
+static bool OnDifferentPages(VkDeviceSize p_offsetA, VkDeviceSize p_sizeA, VkDeviceSize p_offsetB, VkDeviceSize p_granularity)
+{
+	return (p_offsetA + p_sizeA - 1) / p_granularity != p_offsetB / p_granularity;
+}
+
+#pragma region Free list
+
+TEST(FreeListAlignment)
+{
+	FreeListMetadata metadata(4096, 1);
+
+	VkDeviceSize a, b, c;
+
+	CHECK(metadata.Allocate(100, 1, true, a) && a == 0);
+	CHECK(metadata.Allocate(100, 256, true, b) && b == 256);
+	CHECK(metadata.Allocate(10, 64, true, c) && c % 64 == 0 && (c >= b + 100 || c + 10 <= b));
+
+	//The padding before an aligned allocation stays usable
+	VkDeviceSize d;
+
+	CHECK(metadata.Allocate(50, 1, true, d) && d + 50 <= 256 && d >= 100);
+}
+
+TEST(FreeListGranularity)
+{
+	const VkDeviceSize granularity = 1024;
+
+	FreeListMetadata metadata(16 * granularity, granularity);
+
+	VkDeviceSize linear, optimal, linear2;
+
+	CHECK(metadata.Allocate(100, 1, true, linear) && linear == 0);
+
+	//An image never shares a page with a buffer
+	CHECK(metadata.Allocate(100, 1, false, optimal) && OnDifferentPages(linear, 100, optimal, granularity));
+
+	//Resources of the same kind pack on the page
+	CHECK(metadata.Allocate(100, 1, true, linear2) && linear2 == 100);
+
+	//A hole freed right before an image on the same page doesn't take a buffer
+	FreeListMetadata images(16 * granularity, granularity);
+
+	VkDeviceSize first, second, buffer;
+
+	CHECK(images.Allocate(100, 1, false, first) && first == 0);
+	CHECK(images.Allocate(100, 1, false, second) && second == 100);
+
+	images.Free(first);
+
+	CHECK(images.Allocate(50, 1, true, buffer) && buffer != 0 && OnDifferentPages(second, 100, buffer, granularity));
+}
+
+TEST(FreeListCoalescing)
+{
+	FreeListMetadata metadata(4096, 1);
+
+	VkDeviceSize a, b, c;
+
+	CHECK(metadata.Allocate(256, 1, true, a) && a == 0);
+	CHECK(metadata.Allocate(256, 1, true, b) && b == 256);
+	CHECK(metadata.Allocate(256, 1, true, c) && c == 512);
+
+	//Freed neighbours merge into one range that fits what neither could alone
+	metadata.Free(b);
+	metadata.Free(a);
+
+	VkDeviceSize merged;
+
+	CHECK(metadata.Allocate(512, 1, true, merged) && merged == 0);
+
+	metadata.Free(merged);
+	metadata.Free(c);
+
+	CHECK(metadata.IsEmpty() && metadata.GetUsedSize() == 0);
+
+	//Back to a single range covering the block
+	VkDeviceSize whole;
+
+	CHECK(metadata.Allocate(4096, 1, true, whole) && whole == 0);
+}
+
+TEST(FreeListOutOfMemory)
+{
+	FreeListMetadata metadata(4096, 1);
+
+	VkDeviceSize offset;
+
+	CHECK(!metadata.Allocate(0, 1, true, offset));
+	CHECK(!metadata.Allocate(4097, 1, true, offset));
+
+	CHECK(metadata.Allocate(4000, 1, true, offset));
+	CHECK(!metadata.Allocate(100, 1, true, offset));
+
+	//Enough bytes left in total but not once aligned
+	VkDeviceSize small;
+
+	CHECK(metadata.Allocate(90, 1, true, small));
+	CHECK(!metadata.Allocate(4, 64, true, offset));
+
+	CHECK(metadata.GetAllocationCount() == 2 && metadata.GetUsedSize() == 4090);
+}
+
+#pragma endregion Free list
+
+#pragma region Buddy
+
+TEST(BuddySplitAndMerge)
+{
+	BuddyMetadata metadata(4096, 1);
+
+	VkDeviceSize a, b, c;
+
+	//The whole block is split down to the smallest node, the buddies are handed out next
+	CHECK(metadata.Allocate(256, 1, true, a) && a == 0);
+	CHECK(metadata.Allocate(256, 1, true, b) && b == 256);
+	CHECK(metadata.Allocate(1024, 1, true, c) && c == 1024);
+	CHECK(metadata.GetUsedSize() == 256 + 256 + 1024);
+
+	//Rounded up to the next power of two
+	VkDeviceSize d;
+
+	CHECK(metadata.Allocate(300, 1, true, d) && d == 512);
+	CHECK(metadata.GetUsedSize() == 256 + 256 + 1024 + 512);
+
+	//Every buddy merges back, the whole block is free again
+	metadata.Free(b);
+	metadata.Free(d);
+	metadata.Free(a);
+	metadata.Free(c);
+
+	CHECK(metadata.IsEmpty());
+
+	VkDeviceSize whole;
+
+	CHECK(metadata.Allocate(4096, 1, true, whole) && whole == 0);
+}
+
+TEST(BuddyAlignmentAndGranularity)
+{
+	BuddyMetadata metadata(8192, 1);
+
+	VkDeviceSize small, aligned;
+
+	CHECK(metadata.Allocate(256, 1, true, small));
+	CHECK(metadata.Allocate(256, 1024, true, aligned) && aligned % 1024 == 0);
+
+	const VkDeviceSize granularity = 2048;
+
+	BuddyMetadata paged(16384, granularity);
+
+	VkDeviceSize linear, optimal;
+
+	CHECK(paged.Allocate(256, 1, true, linear));
+	CHECK(paged.Allocate(256, 1, false, optimal) && OnDifferentPages(linear, 256, optimal, granularity));
+}
+
+TEST(BuddyOutOfMemory)
+{
+	//Only the largest power of two of the block is used
+	BuddyMetadata metadata(6000, 1);
+
+	VkDeviceSize offset;
+
+	CHECK(!metadata.Allocate(0, 1, true, offset));
+	CHECK(!metadata.Allocate(4097, 1, true, offset));
+
+	CHECK(metadata.Allocate(4096, 1, true, offset) && offset == 0);
+	CHECK(!metadata.Allocate(256, 1, true, offset));
+}
+
+#pragma endregion Buddy
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+#include "MeshOptimizer.h"
+
+#include "Test.h"
+
+#pragma region Helpers
+
+typedef std::array<uint32_t, 3> Triangle;
+
+//p_width x p_height quads in rows, two counter clockwise triangles each.
+//color.r holds the index of the vertex so triangles can still be matched once OptimizeVertexFetch renumbered them
+static void MakeGrid(uint32_t p_width, uint32_t p_height, std::vector<Vertex>& p_vertices, std::vector<uint32_t>& p_indices)
+{
+	p_vertices.clear();
+	p_indices.clear();
+
+	for (uint32_t y = 0; y <= p_height; y++)
+	{
+		for (uint32_t x = 0; x <= p_width; x++)
+		{
+			Vertex vertex{};
+
+			vertex.pos			= { (float)x, (float)y, 0.0f };
+			vertex.color		= { (float)p_vertices.size(), 0.0f, 0.0f };
+			vertex.textCoords	= { x / (float)p_width, y / (float)p_height };
+
+			p_vertices.push_back(vertex);
+		}
+	}
+
+	for (uint32_t y = 0; y < p_height; y++)
+	{
+		for (uint32_t x = 0; x < p_width; x++)
+		{
+			uint32_t corner = y * (p_width + 1) + x;
+			uint32_t above	= corner + p_width + 1;
+
+			p_indices.insert(p_indices.end(), { corner, corner + 1, above + 1, corner, above + 1, above });
+		}
+	}
+}
+
+//Triangles of the original vertices, each rotated to start at its smallest index : the same triangle in any rotation
+//compares equal, a flipped one doesn't
+static std::vector<Triangle> GetTriangles(const std::vector<Vertex>& p_vertices, const std::vector<uint32_t>& p_indices)
+{
+	std::vector<Triangle> triangles;
+
+	for (size_t i = 0; i + 2 < p_indices.size(); i += 3)
+	{
+		Triangle triangle;
+
+		for (uint32_t corner = 0; corner < 3; corner++)
+			triangle[corner] = (uint32_t)p_vertices[p_indices[i + corner]].color.r;
+
+		std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+		triangles.push_back(triangle);
+	}
+
+	std::sort(triangles.begin(), triangles.end());
+
+	return triangles;
+}
+
+#pragma endregion Helpers
+
+TEST(MeshOptimizerKeepsTriangles)
+{
+	std::vector<Vertex>		vertices;
+	std::vector<uint32_t>	indices;
+
+	MakeGrid(32, 32, vertices, indices);
+
+	//Shuffled whole triangles, the input order shouldn't matter
+	std::vector<Triangle> shuffled(indices.size() / 3);
+
+	for (size_t i = 0; i < shuffled.size(); i++)
+		shuffled[i] = { indices[i * 3], indices[i * 3 + 1], indices[i * 3 + 2] };
+
+	std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+
+	for (size_t i = 0; i < shuffled.size(); i++)
+		std::copy(shuffled[i].begin(), shuffled[i].end(), indices.begin() + i * 3);
+
+	std::vector<Triangle> expected = GetTriangles(vertices, indices);
+
+	MeshOptimizationStats stats;
+	MeshOptimizer::Optimize(vertices, indices, &stats);
+
+	CHECK(indices.size() == expected.size() * 3);
+	CHECK(vertices.size() == 33 * 33);
+	CHECK(GetTriangles(vertices, indices) == expected);
+
+	//Renumbered in first use order
+	uint32_t nextVertex = 0;
+	bool	 firstUse	= true;
+
+	for (uint32_t index : indices)
+	{
+		firstUse &= index <= nextVertex;
+		nextVertex = std::max(nextVertex, index + 1);
+	}
+
+	CHECK(firstUse);
+	CHECK(stats.after.acmr < stats.before.acmr);
+}
+
+TEST(MeshOptimizerGridCache)
+{
+	std::vector<Vertex>		vertices;
+	std::vector<uint32_t>	indices;
+
+	//Rows longer than the cache : each row loads its vertices again in input order
+	MakeGrid(64, 64, vertices, indices);
+
+	VertexCacheStats before = MeshOptimizer::AnalyzeVertexCache(indices, (uint32_t)vertices.size());
+
+	std::vector<uint32_t> reordered;
+	MeshOptimizer::OptimizeVertexCache(indices, (uint32_t)vertices.size(), reordered);
+
+	VertexCacheStats tipsify = MeshOptimizer::AnalyzeVertexCache(reordered, (uint32_t)vertices.size());
+
+	MeshOptimizationStats stats;
+	MeshOptimizer::Optimize(vertices, indices, &stats);
+
+	CHECK(before.acmr == stats.before.acmr);
+	CHECK(tipsify.acmr <= before.acmr);
+	CHECK(stats.after.acmr <= before.acmr);
+
+	//A vertex is transformed at least once, a grid can't go under 0.5 misses per triangle
+	CHECK(stats.after.atvr >= 1.0f && stats.after.acmr >= 0.5f);
+}
+
+TEST(MeshOptimizerEdgeCases)
+{
+	std::vector<Vertex>		vertices;
+	std::vector<uint32_t>	indices;
+
+	//Empty
+	MeshOptimizationStats stats;
+	MeshOptimizer::Optimize(vertices, indices, &stats);
+
+	CHECK(vertices.empty() && indices.empty());
+	CHECK(stats.before.acmr == 0.0f && stats.after.acmr == 0.0f && stats.clusterCount == 0);
+
+	//One triangle, with an unused vertex that is dropped
+	MakeGrid(1, 1, vertices, indices);
+
+	indices = { 3, 0, 1 };
+
+	MeshOptimizer::Optimize(vertices, indices, &stats);
+
+	CHECK(indices == std::vector<uint32_t>({ 0, 1, 2 }));
+	CHECK(vertices.size() == 3 && vertices[0].color.r == 3.0f && vertices[1].color.r == 0.0f && vertices[2].color.r == 1.0f);
+	CHECK(stats.after.acmr == 3.0f);
+
+	//Indices past the last whole triangle
+	MakeGrid(1, 1, vertices, indices);
+
+	indices.push_back(2);
+
+	std::vector<Triangle> expected = GetTriangles(vertices, indices);
+
+	CHECK(MeshOptimizer::AnalyzeVertexCache(indices, (uint32_t)vertices.size()).acmr == 2.0f);
+
+	MeshOptimizer::Optimize(vertices, indices);
+
+	CHECK(indices.size() == 6);
+	CHECK(GetTriangles(vertices, indices) == expected);
+
+	//Fewer indices than a triangle
+	MakeGrid(1, 1, vertices, indices);
+
+	indices = { 0, 1 };
+
+	MeshOptimizer::Optimize(vertices, indices);
+
+	CHECK(indices.empty() && vertices.empty());
+}
@@ -0,0 +1,203 @@
+#include <string>
+
+#include "RenderGraph.h"
+
+#include "Test.h"
+
+//Only Compile() and Describe() are called : no Vulkan call, the handles below are never used
+
+#pragma region Helpers
+
+static const RenderGraphTextureDescription COLOR_DESCRIPTION = { 64, 64, VK_FORMAT_R8G8B8A8_UNORM, VK_SAMPLE_COUNT_1_BIT };
+static const RenderGraphTextureDescription DEPTH_DESCRIPTION = { 64, 64, VK_FORMAT_D32_SFLOAT, VK_SAMPLE_COUNT_1_BIT };
+
+//What leaves the graph, like the swapchain image
+static RenderGraphTexture ImportBackBuffer(RenderGraph& p_graph)
+{
+	return p_graph.ImportTexture("backBuffer", (VkImage)1, (VkImageView)1, COLOR_DESCRIPTION,
+								 VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+								 VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+}
+
+//The barrier of p_texture in p_barriers, nullptr when there's none
+static const RenderGraphBarrier* FindBarrier(const std::vector<RenderGraphBarrier>& p_barriers, RenderGraphTexture p_texture)
+{
+	for (const RenderGraphBarrier& barrier : p_barriers)
+	{
+		if (barrier.texture == p_texture)
+			return &barrier;
+	}
+
+	return nullptr;
+}
+
+static const RenderGraphAttachment* FindAttachment(const std::vector<RenderGraphAttachment>& p_attachments, RenderGraphTexture p_texture)
+{
+	for (const RenderGraphAttachment& attachment : p_attachments)
+	{
+		if (attachment.texture == p_texture)
+			return &attachment;
+	}
+
+	return nullptr;
+}
+
+#pragma endregion Helpers
+
+TEST(RenderGraphCulling)
+{
+	RenderGraph graph;
+
+	RenderGraphTexture backBuffer	= ImportBackBuffer(graph);
+	RenderGraphTexture shadowMap	= graph.CreateTexture("shadowMap", DEPTH_DESCRIPTION);
+	RenderGraphTexture debug		= graph.CreateTexture("debug", COLOR_DESCRIPTION);
+	RenderGraphTexture query		= graph.CreateTexture("query", COLOR_DESCRIPTION);
+
+	//0 : written then cleared by pass 2 before anyone reads it
+	graph.AddPass("overwritten", [&](RenderGraphPassBuilder& p_builder) { p_builder.WriteDepth(shadowMap); }, nullptr);
+	//1 : nobody reads what it writes
+	graph.AddPass("debug", [&](RenderGraphPassBuilder& p_builder) { p_builder.ClearColor(debug, VkClearColorValue{}); }, nullptr);
+	//2 : read by pass 4
+	graph.AddPass("shadow", [&](RenderGraphPassBuilder& p_builder) { p_builder.ClearDepth(shadowMap); }, nullptr);
+	//3 : unread too, but kept for its side effects
+	graph.AddPass("query", [&](RenderGraphPassBuilder& p_builder) { p_builder.ClearColor(query, VkClearColorValue{}); p_builder.SetSideEffects(); }, nullptr);
+	//4 : writes what leaves the graph
+	graph.AddPass("main", [&](RenderGraphPassBuilder& p_builder) { p_builder.Read(shadowMap); p_builder.ClearColor(backBuffer, VkClearColorValue{}); }, nullptr);
+
+	CHECK(graph.Compile());
+
+	CHECK(graph.IsCulled(0));
+	CHECK(graph.IsCulled(1));
+	CHECK(!graph.IsCulled(2));
+	CHECK(!graph.IsCulled(3));
+	CHECK(!graph.IsCulled(4));
+
+	//Culled passes get nothing, and their textures no memory
+	CHECK(graph.GetBarriers(0).empty() && graph.GetAttachments(0).empty());
+	CHECK(graph.GetMemorySlot(debug) == UINT32_MAX);
+	CHECK(graph.GetMemorySlot(shadowMap) != UINT32_MAX);
+
+	std::string description = graph.Describe();
+
+	CHECK(description.find("pass overwritten (culled)") != std::string::npos);
+	CHECK(description.find("pass debug (culled)") != std::string::npos);
+	CHECK(description.find("pass shadow\n") != std::string::npos);
+	CHECK(description.find("pass query\n") != std::string::npos);
+}
+
+TEST(RenderGraphBarriers)
+{
+	RenderGraph graph;
+
+	RenderGraphTexture backBuffer	= ImportBackBuffer(graph);
+	RenderGraphTexture albedo		= graph.CreateTexture("albedo", COLOR_DESCRIPTION);
+	RenderGraphTexture depth		= graph.CreateTexture("depth", DEPTH_DESCRIPTION);
+
+	graph.AddPass("geometry", [&](RenderGraphPassBuilder& p_builder) { p_builder.ClearColor(albedo, VkClearColorValue{}); p_builder.ClearDepth(depth); }, nullptr);
+	graph.AddPass("lighting", [&](RenderGraphPassBuilder& p_builder) { p_builder.Read(albedo); p_builder.ClearColor(backBuffer, VkClearColorValue{}); }, nullptr);
+	graph.AddPass("overlay", [&](RenderGraphPassBuilder& p_builder) { p_builder.Read(albedo); p_builder.WriteColor(backBuffer); }, nullptr);
+
+	CHECK(graph.Compile());
+
+	//Transient attachments start undefined, cleared, stored only when read later
+	const RenderGraphBarrier*		albedoWrite		= FindBarrier(graph.GetBarriers(0), albedo);
+	const RenderGraphAttachment*	albedoTarget	= FindAttachment(graph.GetAttachments(0), albedo);
+	const RenderGraphAttachment*	depthTarget		= FindAttachment(graph.GetAttachments(0), depth);
+
+	CHECK(albedoWrite && albedoWrite->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && albedoWrite->newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+	CHECK(albedoTarget && albedoTarget->loadOp == VK_ATTACHMENT_LOAD_OP_CLEAR && albedoTarget->storeOp == VK_ATTACHMENT_STORE_OP_STORE);
+	CHECK(depthTarget && depthTarget->loadOp == VK_ATTACHMENT_LOAD_OP_CLEAR && depthTarget->storeOp == VK_ATTACHMENT_STORE_OP_DONT_CARE);
+
+	//Depth goes after the colors
+	CHECK(graph.GetAttachments(0).size() == 2 && graph.GetAttachments(0)[1].texture == depth);
+
+	//Read after write : waits for the color writes, transitions to shader read
+	const RenderGraphBarrier* albedoRead = FindBarrier(graph.GetBarriers(1), albedo);
+
+	CHECK(albedoRead && albedoRead->oldLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL && albedoRead->newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	CHECK(albedoRead && albedoRead->srcStages == VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT && albedoRead->srcAccess == VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+	CHECK(albedoRead && (albedoRead->dstAccess & VK_ACCESS_SHADER_READ_BIT) != 0);
+
+	//Already visible to the same reads, no second barrier
+	CHECK(FindBarrier(graph.GetBarriers(2), albedo) == nullptr);
+
+	//The back buffer is written twice in a row : loaded and waited for the second time, no layout change
+	const RenderGraphBarrier*		backBufferWrite		= FindBarrier(graph.GetBarriers(2), backBuffer);
+	const RenderGraphAttachment*	backBufferTarget	= FindAttachment(graph.GetAttachments(2), backBuffer);
+
+	CHECK(backBufferWrite && backBufferWrite->oldLayout == backBufferWrite->newLayout && backBufferWrite->srcStages == VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+	CHECK(backBufferTarget && backBufferTarget->loadOp == VK_ATTACHMENT_LOAD_OP_LOAD && backBufferTarget->storeOp == VK_ATTACHMENT_STORE_OP_STORE);
+
+	//Then left ready to present
+	const RenderGraphBarrier* present = FindBarrier(graph.GetFinalBarriers(), backBuffer);
+
+	CHECK(graph.GetFinalBarriers().size() == 1);
+	CHECK(present && present->oldLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL && present->newLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	CHECK(present && present->srcAccess == VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT && present->dstStages == VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+	std::string description = graph.Describe();
+
+	CHECK(description.find("barrier albedo COLOR_ATTACHMENT -> SHADER_READ_ONLY") != std::string::npos);
+	CHECK(description.find("attachment depth DEPTH_ATTACHMENT load clear store dont care") != std::string::npos);
+	CHECK(description.find("barrier backBuffer COLOR_ATTACHMENT -> PRESENT_SRC") != std::string::npos);
+}
+
+TEST(RenderGraphAliasing)
+{
+	RenderGraph graph;
+
+	RenderGraphTexture backBuffer	= ImportBackBuffer(graph);
+	RenderGraphTexture first		= graph.CreateTexture("first", COLOR_DESCRIPTION);
+	RenderGraphTexture second		= graph.CreateTexture("second", COLOR_DESCRIPTION);
+	RenderGraphTexture third		= graph.CreateTexture("third", COLOR_DESCRIPTION);
+
+	//A chain of post processes : each texture lives for two passes
+	graph.AddPass("0", [&](RenderGraphPassBuilder& p_builder) { p_builder.ClearColor(first, VkClearColorValue{}); }, nullptr);
+	graph.AddPass("1", [&](RenderGraphPassBuilder& p_builder) { p_builder.Read(first); p_builder.WriteColor(second); }, nullptr);
+	graph.AddPass("2", [&](RenderGraphPassBuilder& p_builder) { p_builder.Read(second); p_builder.WriteColor(third); }, nullptr);
+	graph.AddPass("3", [&](RenderGraphPassBuilder& p_builder) { p_builder.Read(third); p_builder.WriteColor(backBuffer); }, nullptr);
+
+	CHECK(graph.Compile());
+
+	//first is done when third starts, they share the memory, second overlaps both
+	CHECK(graph.GetMemorySlotCount() == 2);
+	CHECK(graph.GetMemorySlot(first) == graph.GetMemorySlot(third));
+	CHECK(graph.GetMemorySlot(second) != graph.GetMemorySlot(first));
+
+	//The imported texture never aliases
+	CHECK(graph.GetMemorySlot(backBuffer) == UINT32_MAX);
+
+	//third takes the memory over once the reads of first are done
+	const RenderGraphBarrier* takeOver = FindBarrier(graph.GetBarriers(2), third);
+
+	CHECK(takeOver && takeOver->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED);
+	CHECK(takeOver && (takeOver->srcStages & VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT) != 0);
+
+	std::string description = graph.Describe();
+
+	CHECK(description.find("memory slot 0 : first (passes 0 to 1)") != std::string::npos);
+	CHECK(description.find("memory slot 0 : third (passes 2 to 3)") != std::string::npos);
+	CHECK(description.find("memory slot 1 : second (passes 1 to 2)") != std::string::npos);
+}
+
+TEST(RenderGraphInvalidUse)
+{
+	//One pass can't have a texture in two layouts
+	RenderGraph twice;
+
+	RenderGraphTexture backBuffer = ImportBackBuffer(twice);
+
+	twice.AddPass("twice", [&](RenderGraphPassBuilder& p_builder) { p_builder.Read(backBuffer); p_builder.WriteColor(backBuffer); }, nullptr);
+
+	CHECK(!twice.Compile());
+
+	//Nor attachments of different sizes
+	RenderGraph sizes;
+
+	RenderGraphTexture target	= ImportBackBuffer(sizes);
+	RenderGraphTexture small	= sizes.CreateTexture("small", { 32, 32, VK_FORMAT_R8G8B8A8_UNORM, VK_SAMPLE_COUNT_1_BIT });
+
+	sizes.AddPass("sizes", [&](RenderGraphPassBuilder& p_builder) { p_builder.WriteColor(small); p_builder.WriteColor(target); }, nullptr);
+
+	CHECK(!sizes.Compile());
+}
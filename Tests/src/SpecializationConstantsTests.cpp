@@ -0,0 +1,82 @@
+#include <cstring>
+
+#include "SpirvReflection.h"
+#include "SpecializationConstants.h"
+
+#include "Test.h"
+
+static const SpecializationConstant<bool>		USE_VERTEX_COLOR{ 0 };
+static const SpecializationConstant<float>		EXPOSURE{ 1 };
+static const SpecializationConstant<uint32_t>	LIGHT_COUNT{ 2 };
+
+TEST(SpecializationConstantsPacking)
+{
+	SpecializationConstants constants;
+
+	CHECK(constants.IsEmpty() && constants.GetInfo().mapEntryCount == 0 && constants.GetInfo().dataSize == 0);
+
+	//Set out of order, packed by id
+	constants.Set(LIGHT_COUNT, 4u).Set(USE_VERTEX_COLOR, true).Set(EXPOSURE, 1.5f);
+
+	VkSpecializationInfo info = constants.GetInfo();
+
+	CHECK(info.mapEntryCount == 3);
+	CHECK(info.dataSize == 3 * sizeof(uint32_t));
+
+	for (uint32_t i = 0; i < info.mapEntryCount; i++)
+	{
+		CHECK(info.pMapEntries[i].constantID == i);
+		CHECK(info.pMapEntries[i].offset == i * sizeof(uint32_t));
+		CHECK(info.pMapEntries[i].size == sizeof(uint32_t));
+	}
+
+	const uint32_t* words = static_cast<const uint32_t*>(info.pData);
+
+	float exposure;
+	memcpy(&exposure, &words[1], sizeof(exposure));
+
+	CHECK(words[0] == VK_TRUE);
+	CHECK(exposure == 1.5f);
+	CHECK(words[2] == 4);
+
+	//Setting a constant again replaces its value without adding an entry
+	constants.Set(USE_VERTEX_COLOR, false);
+
+	CHECK(constants.GetCount() == 3 && static_cast<const uint32_t*>(constants.GetInfo().pData)[0] == VK_FALSE);
+}
+
+TEST(SpecializationConstantsEquality)
+{
+	SpecializationConstants a, b, c;
+
+	a.Set(USE_VERTEX_COLOR, true).Set(LIGHT_COUNT, 2u);
+	b.Set(LIGHT_COUNT, 2u).Set(USE_VERTEX_COLOR, true);
+	c.Set(USE_VERTEX_COLOR, false).Set(LIGHT_COUNT, 2u);
+
+	CHECK(a == b);
+	CHECK(!(a == c));
+	CHECK(!(a == SpecializationConstants()));
+}
+
+TEST(SpecializationConstantsTypeCheck)
+{
+	ShaderReflection reflection;
+
+	ShaderSpecConstant useVertexColor, lightCount;
+
+	useVertexColor.id	= 0;
+	useVertexColor.type	= SpecializationType::Bool;
+	lightCount.id		= 2;
+	lightCount.type		= SpecializationType::UInt;
+
+	reflection.specConstants = { useVertexColor, lightCount };
+
+	CHECK(reflection.FindMismatchedConstant(SpecializationConstants()) == UINT32_MAX);
+	CHECK(reflection.FindMismatchedConstant(SpecializationConstants().Set(USE_VERTEX_COLOR, true).Set(LIGHT_COUNT, 8u)) == UINT32_MAX);
+
+	//Declared as a bool in the shader
+	CHECK(reflection.FindMismatchedConstant(SpecializationConstants().Set(SpecializationConstant<uint32_t>{ 0 }, 1u)) == 0);
+
+	//Not declared at all, index 1 once sorted
+	CHECK(reflection.FindMismatchedConstant(SpecializationConstants().Set(USE_VERTEX_COLOR, true).Set(EXPOSURE, 1.0f)) == 1);
+}
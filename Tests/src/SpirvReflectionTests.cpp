@@ -0,0 +1,134 @@
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "SpirvReflection.h"
+
+#include "Test.h"
+
+#pragma region Helpers
+
+static std::vector<char> ReadShader(const char* p_fileName)
+{
+	std::ifstream file(gDataDirectory + "/shaders/" + p_fileName, std::ios::binary | std::ios::ate);
+
+	if (!file.is_open())
+		return {};
+
+	std::vector<char> byteCode((size_t)file.tellg());
+
+	file.seekg(0);
+	file.read(byteCode.data(), byteCode.size());
+
+	return byteCode;
+}
+
+static std::vector<char> ToByteCode(const std::vector<uint32_t>& p_words)
+{
+	std::vector<char> byteCode(p_words.size() * sizeof(uint32_t));
+
+	memcpy(byteCode.data(), p_words.data(), byteCode.size());
+
+	return byteCode;
+}
+
+static uint32_t Instruction(uint32_t p_opcode, uint32_t p_wordCount)
+{
+	return (p_wordCount << 16) | p_opcode;
+}
+
+#pragma endregion Helpers
+
+TEST(SpirvReflectionShaders)
+{
+	std::vector<char> vertexCode	= ReadShader("triangle.vert.spv");
+	std::vector<char> fragmentCode	= ReadShader("triangle.frag.spv");
+
+	CHECK(!vertexCode.empty() && !fragmentCode.empty());
+
+	ShaderReflection vertex, fragment;
+
+	CHECK(SpirvReflection::Reflect(vertexCode, vertex));
+	CHECK(SpirvReflection::Reflect(fragmentCode, fragment));
+
+	//layout(binding = 0) uniform UniformBufferObject
+	CHECK(vertex.stages == VK_SHADER_STAGE_VERTEX_BIT);
+	CHECK(vertex.bindings.size() == 1);
+	CHECK(!vertex.bindings.empty() && vertex.bindings[0].set == 0 && vertex.bindings[0].binding == 0 && vertex.bindings[0].type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER && vertex.bindings[0].count == 1);
+
+	//inPosition, inColor, inTexCoord
+	CHECK(vertex.vertexInputs.size() == 3);
+	CHECK(vertex.vertexInputs.size() == 3 && vertex.vertexInputs[0].location == 0 && vertex.vertexInputs[0].format == VK_FORMAT_R32G32B32_SFLOAT);
+	CHECK(vertex.vertexInputs.size() == 3 && vertex.vertexInputs[2].location == 2 && vertex.vertexInputs[2].format == VK_FORMAT_R32G32_SFLOAT);
+
+	//layout(binding = 1) uniform sampler2D texSampler
+	CHECK(fragment.stages == VK_SHADER_STAGE_FRAGMENT_BIT);
+	CHECK(fragment.bindings.size() == 1);
+	CHECK(!fragment.bindings.empty() && fragment.bindings[0].set == 0 && fragment.bindings[0].binding == 1 && fragment.bindings[0].type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+	CHECK(fragment.vertexInputs.empty());
+
+	//layout(constant_id = 0) const bool USE_VERTEX_COLOR
+	CHECK(fragment.specConstants.size() == 1 && fragment.specConstants[0].id == 0 && fragment.specConstants[0].type == SpecializationType::Bool);
+	CHECK(vertex.specConstants.empty());
+
+	//What the pipeline layout is made from : one set, each binding visible to its own stage
+	CHECK(vertex.Merge(fragment));
+	CHECK(vertex.GetSetCount() == 1 && vertex.GetSetBindings(0).size() == 2);
+	CHECK(vertex.bindings.size() == 2 && vertex.bindings[0].stages == VK_SHADER_STAGE_VERTEX_BIT && vertex.bindings[1].stages == VK_SHADER_STAGE_FRAGMENT_BIT);
+}
+
+TEST(SpirvReflectionMalformed)
+{
+	const uint32_t OpEntryPoint = 15, OpDecorate = 71, OpMemberDecorate = 72, OpTypeFloat = 22;
+	const uint32_t DecorationBinding = 33, DecorationOffset = 35, DecorationBlock = 2;
+
+	//Fragment shader "main" : the reflection needs a stage
+	std::vector<uint32_t> header = { 0x07230203, 0x00010000, 0, 16, 0, Instruction(OpEntryPoint, 5), 4, 4, 0x6E69616D, 0 };
+
+	//Well formed : decorations and a type, nothing to bind
+	std::vector<uint32_t> valid = header;
+
+	valid.insert(valid.end(), { Instruction(OpDecorate, 4), 1, DecorationBinding, 0 });
+	valid.insert(valid.end(), { Instruction(OpDecorate, 3), 2, DecorationBlock });
+	valid.insert(valid.end(), { Instruction(OpMemberDecorate, 5), 2, 0, DecorationOffset, 0 });
+	valid.insert(valid.end(), { Instruction(OpTypeFloat, 3), 3, 32 });
+
+	ShaderReflection reflection;
+
+	CHECK(SpirvReflection::Reflect(ToByteCode(valid), reflection));
+
+	//A binding without its number, the next instruction's first word would be read in its place
+	std::vector<uint32_t> decorate = header;
+
+	decorate.insert(decorate.end(), { Instruction(OpDecorate, 3), 1, DecorationBinding });
+	decorate.insert(decorate.end(), { Instruction(OpTypeFloat, 3), 3, 32 });
+
+	CHECK(!SpirvReflection::Reflect(ToByteCode(decorate), reflection));
+
+	//A member offset without the offset
+	std::vector<uint32_t> memberDecorate = header;
+
+	memberDecorate.insert(memberDecorate.end(), { Instruction(OpMemberDecorate, 4), 2, 0, DecorationOffset });
+	memberDecorate.insert(memberDecorate.end(), { Instruction(OpTypeFloat, 3), 3, 32 });
+
+	CHECK(!SpirvReflection::Reflect(ToByteCode(memberDecorate), reflection));
+
+	//Missing its member index and decoration
+	std::vector<uint32_t> shortMember = header;
+
+	shortMember.insert(shortMember.end(), { Instruction(OpMemberDecorate, 2), 2 });
+
+	CHECK(!SpirvReflection::Reflect(ToByteCode(shortMember), reflection));
+
+	//A real shader cut in the middle of its first instruction (OpCapability, 2 words)
+	std::vector<char> vertexCode = ReadShader("triangle.vert.spv");
+
+	vertexCode.resize(6 * sizeof(uint32_t));
+
+	CHECK(!SpirvReflection::Reflect(vertexCode, reflection));
+
+	std::vector<uint32_t> notSpirv = { 0xDEADBEEF, 0, 0, 0, 0 };
+
+	CHECK(!SpirvReflection::Reflect(ToByteCode(notSpirv), reflection));
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+//
+//Minimal test harness : TEST() functions register themselves, CHECK() logs the failed condition and carries on.
+//Only CPU side logic is tested, nothing here needs a device
+//
+
+struct TestCase
+{
+	const char* name;
+	void		(*function)();
+};
+
+extern bool			gRunBenchmarks;		//--benchmark
+extern std::string	gBenchmarkModel;	//--model=path, OBJ the benchmarks load instead of generating a mesh
+extern std::string	gDataDirectory;		//--data=path, the APIModernes_Vulkan folder, for the tests reading its shaders
+
+std::vector<TestCase>&	GetTests();
+void					ReportFailure(const char* p_condition, const char* p_file, int p_line);
+
+struct TestRegistrar
+{
+	TestRegistrar(const char* p_name, void (*p_function)()) { GetTests().push_back({ p_name, p_function }); }
+};
+
+#define TEST(p_name) \
+	static void p_name(); \
+	static TestRegistrar p_name##Registrar(#p_name, &p_name); \
+	static void p_name()
+
+#define CHECK(p_condition) \
+	do { if (!(p_condition)) ReportFailure(#p_condition, __FILE__, __LINE__); } while (false)
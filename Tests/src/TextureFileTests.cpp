@@ -0,0 +1,94 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "TextureFile.h"
+
+#include "Test.h"
+
+#pragma region Helpers
+
+static const char* TEST_FILE = "TextureFileTests.ktx2";
+
+static std::vector<uint8_t> ReadBytes(const char* p_filePath)
+{
+	std::ifstream file(p_filePath, std::ios::binary);
+
+	return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static bool OpenBytes(const std::vector<uint8_t>& p_bytes)
+{
+	{
+		std::ofstream file(TEST_FILE, std::ios::binary | std::ios::trunc);
+		file.write((const char*)p_bytes.data(), p_bytes.size());
+	}
+
+	TextureFile texture;
+
+	bool result = texture.Open(TEST_FILE);
+
+	texture.Close();
+	std::remove(TEST_FILE);
+
+	return result;
+}
+
+//Offset of the level index entry of p_level in the file
+static size_t GetLevelIndexOffset(uint32_t p_level)
+{
+	return sizeof(TextureFile::Header) + p_level * sizeof(TextureFile::LevelIndex);
+}
+
+#pragma endregion Helpers
+
+TEST(TextureFileValidation)
+{
+	//8x8 BC7, two levels
+	std::vector<uint8_t>	data(80, 0x40);
+	std::vector<ImageLevel> levels(2);
+
+	levels[0].offset = 0;	levels[0].size = 64;	levels[0].width = 8;	levels[0].height = 8;
+	levels[1].offset = 64;	levels[1].size = 16;	levels[1].width = 4;	levels[1].height = 4;
+
+	CHECK(TextureFile::Write(TEST_FILE, VK_FORMAT_BC7_UNORM_BLOCK, data.data(), levels, { { "KTXwriter", "Tests" } }));
+
+	std::vector<uint8_t> file = ReadBytes(TEST_FILE);
+
+	TextureFile texture;
+
+	CHECK(texture.Open(TEST_FILE));
+	CHECK(texture.GetFormat() == VK_FORMAT_BC7_UNORM_BLOCK && texture.GetWidth() == 8 && texture.GetHeight() == 8);
+	CHECK(texture.GetLevels().size() == 2 && texture.GetLevels()[0].size == 64 && texture.GetLevels()[1].size == 16);
+	CHECK(texture.GetDataSize() == 80);
+
+	texture.Close();
+
+	CHECK(OpenBytes(file));
+
+	//Truncated header
+	CHECK(!OpenBytes(std::vector<uint8_t>(file.begin(), file.begin() + sizeof(TextureFile::Header) / 2)));
+
+	//Header without its level index
+	CHECK(!OpenBytes(std::vector<uint8_t>(file.begin(), file.begin() + GetLevelIndexOffset(1))));
+
+	//Level 0 is the last one in the file, its data is cut
+	CHECK(!OpenBytes(std::vector<uint8_t>(file.begin(), file.end() - 1)));
+
+	//Level offsets past the end, or wrapping once the length is added
+	const uint64_t badOffsets[] = { file.size(), UINT64_MAX - 15 };
+
+	for (uint64_t offset : badOffsets)
+	{
+		std::vector<uint8_t> corrupted = file;
+
+		memcpy(corrupted.data() + GetLevelIndexOffset(1) + offsetof(TextureFile::LevelIndex, byteOffset), &offset, sizeof(offset));
+
+		CHECK(!OpenBytes(corrupted));
+	}
+
+	std::remove(TEST_FILE);
+}
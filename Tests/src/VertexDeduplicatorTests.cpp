@@ -0,0 +1,250 @@
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include "VertexDeduplicator.h"
+
+//After the header already included it, the implementation part isn't guarded
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tinyobjloader/tiny_obj_loader.h"
+
+#include "Test.h"
+
+#pragma region Helpers
+
+//What LoadModel() did before the deduplicator, the reference the output must match
+static void DeduplicateSequential(const tinyobj::attrib_t& p_attrib, const std::vector<tinyobj::shape_t>& p_shapes, std::vector<Vertex>& p_vertices, std::vector<uint32_t>& p_indices)
+{
+	std::unordered_map<Vertex, uint32_t> uniqueVertices;
+
+	p_vertices.clear();
+	p_indices.clear();
+
+	for (const tinyobj::shape_t& shape : p_shapes)
+	{
+		for (const tinyobj::index_t& index : shape.mesh.indices)
+		{
+			Vertex vertex{};
+
+			vertex.pos = {
+				p_attrib.vertices[3 * index.vertex_index + 0],
+				p_attrib.vertices[3 * index.vertex_index + 1],
+				p_attrib.vertices[3 * index.vertex_index + 2]
+			};
+
+			if (index.texcoord_index >= 0)
+			{
+				vertex.textCoords = {
+					p_attrib.texcoords[2 * index.texcoord_index + 0],
+					1.0f - p_attrib.texcoords[2 * index.texcoord_index + 1]
+				};
+			}
+
+			vertex.color = { 1.0f, 1.0f, 1.0f };
+
+			if (uniqueVertices.count(vertex) == 0)
+			{
+				uniqueVertices[vertex] = static_cast<uint32_t>(p_vertices.size());
+				p_vertices.push_back(vertex);
+			}
+
+			p_indices.push_back(uniqueVertices[vertex]);
+		}
+	}
+}
+
+//p_width x p_height quads, two triangles each, split in p_shapeCount shapes.
+//Every grid point is also written p_copies times in the position list so the same vertex comes from different OBJ indices
+static void MakeGrid(uint32_t p_width, uint32_t p_height, uint32_t p_shapeCount, uint32_t p_copies, tinyobj::attrib_t& p_attrib, std::vector<tinyobj::shape_t>& p_shapes)
+{
+	std::mt19937 random(42);
+
+	uint32_t pointCount = (p_width + 1) * (p_height + 1);
+
+	p_attrib = tinyobj::attrib_t();
+
+	for (uint32_t copy = 0; copy < p_copies; copy++)
+	{
+		for (uint32_t y = 0; y <= p_height; y++)
+		{
+			for (uint32_t x = 0; x <= p_width; x++)
+			{
+				p_attrib.vertices.insert(p_attrib.vertices.end(), { (float)x, (float)y, 0.0f });
+				p_attrib.texcoords.insert(p_attrib.texcoords.end(), { x / (float)p_width, y / (float)p_height });
+			}
+		}
+	}
+
+	p_shapes.assign(p_shapeCount, tinyobj::shape_t());
+
+	for (uint32_t y = 0; y < p_height; y++)
+	{
+		for (uint32_t x = 0; x < p_width; x++)
+		{
+			uint32_t corners[4] = { y * (p_width + 1) + x, y * (p_width + 1) + x + 1, (y + 1) * (p_width + 1) + x, (y + 1) * (p_width + 1) + x + 1 };
+			uint32_t triangles[6] = { corners[0], corners[1], corners[2], corners[2], corners[1], corners[3] };
+
+			tinyobj::mesh_t& mesh = p_shapes[(y * p_width + x) % p_shapeCount].mesh;
+
+			for (uint32_t corner : triangles)
+			{
+				tinyobj::index_t index;
+
+				//Any copy of the point, the vertex is the same
+				index.vertex_index		= (int)(corner + (random() % p_copies) * pointCount);
+				index.texcoord_index	= index.vertex_index;
+				index.normal_index		= -1;
+
+				mesh.indices.push_back(index);
+			}
+		}
+	}
+}
+
+static bool SameOutput(const std::vector<Vertex>& p_verticesA, const std::vector<uint32_t>& p_indicesA, const std::vector<Vertex>& p_verticesB, const std::vector<uint32_t>& p_indicesB)
+{
+	return p_verticesA.size() == p_verticesB.size() && p_indicesA == p_indicesB
+		&& memcmp(p_verticesA.data(), p_verticesB.data(), p_verticesA.size() * sizeof(Vertex)) == 0;
+}
+
+#pragma endregion Helpers
+
+TEST(DeduplicationMatchesSequential)
+{
+	tinyobj::attrib_t				attrib;
+	std::vector<tinyobj::shape_t>	shapes;
+
+	//Big enough to get several threads
+	MakeGrid(200, 150, 3, 3, attrib, shapes);
+
+	std::vector<Vertex>		expectedVertices;
+	std::vector<uint32_t>	expectedIndices;
+
+	DeduplicateSequential(attrib, shapes, expectedVertices, expectedIndices);
+
+	CHECK(expectedVertices.size() == 201 * 151);
+
+	for (uint32_t threadCount : { 1u, 2u, 3u, 8u, 0u })
+	{
+		std::vector<Vertex>		vertices;
+		std::vector<uint32_t>	indices;
+		DeduplicationStats		stats;
+
+		VertexDeduplicator::Deduplicate(attrib, shapes, vertices, indices, threadCount, &stats);
+
+		CHECK(SameOutput(vertices, indices, expectedVertices, expectedIndices));
+		CHECK(stats.cornerCount == 200 * 150 * 6 && stats.vertexCount == expectedVertices.size());
+	}
+}
+
+TEST(DeduplicationIsDeterministic)
+{
+	tinyobj::attrib_t				attrib;
+	std::vector<tinyobj::shape_t>	shapes;
+
+	MakeGrid(300, 300, 1, 4, attrib, shapes);
+
+	std::vector<Vertex>		firstVertices;
+	std::vector<uint32_t>	firstIndices;
+
+	VertexDeduplicator::Deduplicate(attrib, shapes, firstVertices, firstIndices, 8);
+
+	for (uint32_t run = 0; run < 4; run++)
+	{
+		std::vector<Vertex>		vertices;
+		std::vector<uint32_t>	indices;
+
+		VertexDeduplicator::Deduplicate(attrib, shapes, vertices, indices, 8);
+
+		CHECK(SameOutput(vertices, indices, firstVertices, firstIndices));
+	}
+}
+
+TEST(DeduplicationEdgeCases)
+{
+	tinyobj::attrib_t				attrib;
+	std::vector<tinyobj::shape_t>	shapes(1);
+
+	//-0.0f and 0.0f are the same position, a missing texcoord is (0, 0)
+	attrib.vertices		= { 0.0f, 0.0f, 0.0f,	-0.0f, 0.0f, -0.0f,		1.0f, 0.0f, 0.0f };
+	attrib.texcoords	= { 0.0f, 1.0f };
+
+	tinyobj::index_t withTexCoord		= { 0, -1, 0 };
+	tinyobj::index_t negativeZero		= { 1, -1, 0 };
+	tinyobj::index_t withoutTexCoord	= { 0, -1, -1 };
+	tinyobj::index_t other				= { 2, -1, -1 };
+
+	shapes[0].mesh.indices = { withTexCoord, negativeZero, withoutTexCoord, other, withTexCoord, other };
+
+	std::vector<Vertex>		vertices;
+	std::vector<uint32_t>	indices;
+
+	VertexDeduplicator::Deduplicate(attrib, shapes, vertices, indices);
+
+	//Flipped v of 1 is 0 : the first three corners are the same vertex
+	CHECK(vertices.size() == 2);
+	CHECK((indices == std::vector<uint32_t>{ 0, 0, 0, 1, 0, 1 }));
+
+	//Nothing in, nothing out
+	std::vector<tinyobj::shape_t> empty(2);
+
+	VertexDeduplicator::Deduplicate(attrib, empty, vertices, indices);
+
+	CHECK(vertices.empty() && indices.empty());
+}
+
+TEST(DeduplicationBenchmark)
+{
+	if (!gRunBenchmarks)
+		return;
+
+	using Clock = std::chrono::high_resolution_clock;
+
+	tinyobj::attrib_t				attrib;
+	std::vector<tinyobj::shape_t>	shapes;
+	std::string						name;
+
+	if (!gBenchmarkModel.empty())
+	{
+		std::vector<tinyobj::material_t>	materials;
+		std::string							error;
+
+		CHECK(tinyobj::LoadObj(&attrib, &shapes, &materials, &error, gBenchmarkModel.c_str()));
+
+		name = gBenchmarkModel;
+	}
+	else
+	{
+		//4M triangles
+		MakeGrid(2000, 1000, 16, 2, attrib, shapes);
+
+		name = "2000 x 1000 grid";
+	}
+
+	Clock::time_point start = Clock::now();
+
+	std::vector<Vertex>		expectedVertices;
+	std::vector<uint32_t>	expectedIndices;
+
+	DeduplicateSequential(attrib, shapes, expectedVertices, expectedIndices);
+
+	float sequentialTime = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+	std::cout << "  " << name << " : " << expectedIndices.size() / 3 << " triangles, " << expectedVertices.size() << " vertices" << std::endl;
+	std::cout << "  std::unordered_map : " << sequentialTime << " ms (" << expectedIndices.size() / sequentialTime / 1e3f << " M corners/s)" << std::endl;
+
+	for (uint32_t threadCount : { 1u, 2u, 4u, 0u })
+	{
+		std::vector<Vertex>		vertices;
+		std::vector<uint32_t>	indices;
+		DeduplicationStats		stats;
+
+		VertexDeduplicator::Deduplicate(attrib, shapes, vertices, indices, threadCount, &stats);
+
+		CHECK(SameOutput(vertices, indices, expectedVertices, expectedIndices));
+
+		std::cout << "  VertexDeduplicator, " << stats.threadCount << " threads : " << stats.milliseconds << " ms (" << stats.CornersPerSecond() / 1e6f << " M corners/s, x" << sequentialTime / stats.milliseconds << ")" << std::endl;
+	}
+}
@@ -0,0 +1,78 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "Test.h"
+
+//
+//Unit tests of the renderer's CPU side logic, one file per module of APIModernes_Vulkan/src.
+//
+//Tests [filter] [--benchmark] [--model=path] [--data=path]
+//	filter		 : only the tests whose name contains it
+//	--benchmark	 : also run the benchmarks, slow
+//	--model=path : OBJ the benchmarks run on, a generated mesh otherwise
+//	--data=path	 : the APIModernes_Vulkan folder, ../APIModernes_Vulkan by default (run from the Tests folder)
+//
+
+static uint32_t gFailureCount = 0;
+
+bool		gRunBenchmarks = false;
+std::string gBenchmarkModel;
+std::string gDataDirectory = "../APIModernes_Vulkan";
+
+std::vector<TestCase>& GetTests()
+{
+	static std::vector<TestCase> tests;
+
+	return tests;
+}
+
+void ReportFailure(const char* p_condition, const char* p_file, int p_line)
+{
+	std::cout << "  " << p_file << "(" << p_line << ") : CHECK(" << p_condition << ") failed" << std::endl;
+
+	gFailureCount++;
+}
+
+int main(int argc, char** argv)
+{
+	const char* filter = nullptr;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--benchmark") == 0)
+			gRunBenchmarks = true;
+		else if (strncmp(argv[i], "--model=", 8) == 0)
+			gBenchmarkModel = argv[i] + 8;
+		else if (strncmp(argv[i], "--data=", 7) == 0)
+			gDataDirectory = argv[i] + 7;
+		else
+			filter = argv[i];
+	}
+
+	uint32_t failedTests = 0;
+	uint32_t testCount	 = 0;
+
+	for (const TestCase& test : GetTests())
+	{
+		if (filter && !strstr(test.name, filter))
+			continue;
+
+		uint32_t failuresBefore = gFailureCount;
+
+		test.function();
+		testCount++;
+
+		bool passed = gFailureCount == failuresBefore;
+
+		if (!passed)
+			failedTests++;
+
+		std::cout << (passed ? "[ OK ] " : "[FAIL] ") << test.name << std::endl;
+	}
+
+	std::cout << "[Tests] " << testCount - failedTests << " / " << testCount << " passed" << std::endl;
+
+	return failedTests == 0 ? 0 : 1;
+}
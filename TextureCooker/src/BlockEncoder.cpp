@@ -0,0 +1,536 @@
+#include "BlockEncoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "Utils.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENCODER_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define ENCODER_USE_SSE2 0
+#endif
+
+#pragma region Helpers
+//Structure of arrays so 4 texels of one channel fill a register
+struct alignas(16) BlockTexels
+{
+	float channels[4][16];
+};
+
+static void LoadTexels(const uint8_t p_texels[64], BlockTexels& p_block)
+{
+	for (uint32_t texel = 0; texel < 16; texel++)
+	{
+		for (uint32_t channel = 0; channel < 4; channel++)
+			p_block.channels[channel][texel] = p_texels[texel * 4 + channel];
+	}
+}
+
+//Closest palette entry for every texel over the first p_channelCount channels, returns the summed squared error
+static float SelectIndices(const BlockTexels& p_block, const float (*p_palette)[4], uint32_t p_paletteSize, uint32_t p_channelCount, uint8_t p_indices[16])
+{
+	float totalError = 0.0f;
+
+#if ENCODER_USE_SSE2
+	alignas(16) int32_t indices[4];
+	alignas(16) float	errors[4];
+
+	for (uint32_t group = 0; group < 16; group += 4)
+	{
+		__m128 channels[4];
+
+		for (uint32_t channel = 0; channel < p_channelCount; channel++)
+			channels[channel] = _mm_load_ps(&p_block.channels[channel][group]);
+
+		__m128	bestError	= _mm_set1_ps(FLT_MAX);
+		__m128i bestIndex	= _mm_setzero_si128();
+
+		for (uint32_t entry = 0; entry < p_paletteSize; entry++)
+		{
+			__m128 error = _mm_setzero_ps();
+
+			for (uint32_t channel = 0; channel < p_channelCount; channel++)
+			{
+				__m128 difference = _mm_sub_ps(channels[channel], _mm_set1_ps(p_palette[entry][channel]));
+
+				error = _mm_add_ps(error, _mm_mul_ps(difference, difference));
+			}
+
+			__m128i closer = _mm_castps_si128(_mm_cmplt_ps(error, bestError));
+
+			bestError	= _mm_min_ps(error, bestError);
+			bestIndex	= _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32((int)entry)), _mm_andnot_si128(closer, bestIndex));
+		}
+
+		_mm_store_si128((__m128i*)indices, bestIndex);
+		_mm_store_ps(errors, bestError);
+
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			p_indices[group + i]	= (uint8_t)indices[i];
+			totalError				+= errors[i];
+		}
+	}
+#else
+	for (uint32_t texel = 0; texel < 16; texel++)
+	{
+		float bestError = FLT_MAX;
+
+		for (uint32_t entry = 0; entry < p_paletteSize; entry++)
+		{
+			float error = 0.0f;
+
+			for (uint32_t channel = 0; channel < p_channelCount; channel++)
+			{
+				float difference = p_block.channels[channel][texel] - p_palette[entry][channel];
+
+				error += difference * difference;
+			}
+
+			if (error < bestError)
+			{
+				bestError			= error;
+				p_indices[texel]	= (uint8_t)entry;
+			}
+		}
+
+		totalError += bestError;
+	}
+#endif
+
+	return totalError;
+}
+
+//Endpoints of the block along its principal axis, unquantized
+static void FitPrincipalAxis(const BlockTexels& p_block, uint32_t p_channelCount, float p_endpoint0[4], float p_endpoint1[4])
+{
+	float mean[4] = {};
+
+	for (uint32_t channel = 0; channel < p_channelCount; channel++)
+	{
+		for (uint32_t texel = 0; texel < 16; texel++)
+			mean[channel] += p_block.channels[channel][texel];
+
+		mean[channel] /= 16.0f;
+	}
+
+	float covariance[4][4] = {};
+
+	for (uint32_t texel = 0; texel < 16; texel++)
+	{
+		for (uint32_t i = 0; i < p_channelCount; i++)
+		{
+			for (uint32_t j = 0; j < p_channelCount; j++)
+				covariance[i][j] += (p_block.channels[i][texel] - mean[i]) * (p_block.channels[j][texel] - mean[j]);
+		}
+	}
+
+	//Power iteration from the row with the most variance
+	uint32_t startRow = 0;
+
+	for (uint32_t channel = 1; channel < p_channelCount; channel++)
+	{
+		if (covariance[channel][channel] > covariance[startRow][startRow])
+			startRow = channel;
+	}
+
+	float axis[4] = {};
+
+	for (uint32_t channel = 0; channel < p_channelCount; channel++)
+		axis[channel] = covariance[startRow][channel];
+
+	for (int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[4]	= {};
+		float length	= 0.0f;
+
+		for (uint32_t i = 0; i < p_channelCount; i++)
+		{
+			for (uint32_t j = 0; j < p_channelCount; j++)
+				next[i] += covariance[i][j] * axis[j];
+
+			length = std::max(length, std::fabs(next[i]));
+		}
+
+		if (length < 1e-6f)
+			break;
+
+		for (uint32_t channel = 0; channel < p_channelCount; channel++)
+			axis[channel] = next[channel] / length;
+	}
+
+	float minProjection = 0.0f;
+	float maxProjection = 0.0f;
+	float axisLength	= 0.0f;
+
+	for (uint32_t channel = 0; channel < p_channelCount; channel++)
+		axisLength += axis[channel] * axis[channel];
+
+	if (axisLength > 1e-12f)
+	{
+		minProjection = FLT_MAX;
+		maxProjection = -FLT_MAX;
+
+		for (uint32_t texel = 0; texel < 16; texel++)
+		{
+			float projection = 0.0f;
+
+			for (uint32_t channel = 0; channel < p_channelCount; channel++)
+				projection += (p_block.channels[channel][texel] - mean[channel]) * axis[channel];
+
+			minProjection = std::min(minProjection, projection);
+			maxProjection = std::max(maxProjection, projection);
+		}
+
+		minProjection /= axisLength;
+		maxProjection /= axisLength;
+	}
+
+	for (uint32_t channel = 0; channel < p_channelCount; channel++)
+	{
+		p_endpoint0[channel] = std::min(std::max(mean[channel] + axis[channel] * maxProjection, 0.0f), 255.0f);
+		p_endpoint1[channel] = std::min(std::max(mean[channel] + axis[channel] * minProjection, 0.0f), 255.0f);
+	}
+}
+
+//Endpoints minimizing the error for fixed indices, texel = e0 * (1 - w) + e1 * w. False if the system is degenerate
+static bool RefitEndpoints(const BlockTexels& p_block, const uint8_t p_indices[16], const float* p_weights, uint32_t p_channelCount, float p_endpoint0[4], float p_endpoint1[4])
+{
+	float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+	float ax[4] = {}, bx[4] = {};
+
+	for (uint32_t texel = 0; texel < 16; texel++)
+	{
+		float b = p_weights[p_indices[texel]];
+		float a = 1.0f - b;
+
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+
+		for (uint32_t channel = 0; channel < p_channelCount; channel++)
+		{
+			ax[channel] += a * p_block.channels[channel][texel];
+			bx[channel] += b * p_block.channels[channel][texel];
+		}
+	}
+
+	float determinant = aa * bb - ab * ab;
+
+	if (std::fabs(determinant) < 1e-6f)
+		return false;
+
+	for (uint32_t channel = 0; channel < p_channelCount; channel++)
+	{
+		p_endpoint0[channel] = std::min(std::max((bb * ax[channel] - ab * bx[channel]) / determinant, 0.0f), 255.0f);
+		p_endpoint1[channel] = std::min(std::max((aa * bx[channel] - ab * ax[channel]) / determinant, 0.0f), 255.0f);
+	}
+
+	return true;
+}
+
+//LSB first, the order every BC7 field is stored in
+class BitWriter
+{
+private:
+	uint8_t*	mData;
+	uint32_t	mPosition = 0;
+
+public:
+	explicit BitWriter(uint8_t* p_data, uint32_t p_size) : mData(p_data) { memset(p_data, 0, p_size); }
+
+	void Write(uint32_t p_value, uint32_t p_bitCount)
+	{
+		for (uint32_t i = 0; i < p_bitCount; i++, this->mPosition++)
+			this->mData[this->mPosition >> 3] |= uint8_t(((p_value >> i) & 1) << (this->mPosition & 7));
+	}
+};
+#pragma endregion Helpers
+
+#pragma region BC1
+struct Bc1Candidate
+{
+	uint16_t	color0;
+	uint16_t	color1;
+	uint8_t		indices[16];
+	float		error;
+};
+
+static inline uint16_t Quantize565(const float p_color[4])
+{
+	uint32_t r = (uint32_t)std::lround(p_color[0] * 31.0f / 255.0f);
+	uint32_t g = (uint32_t)std::lround(p_color[1] * 63.0f / 255.0f);
+	uint32_t b = (uint32_t)std::lround(p_color[2] * 31.0f / 255.0f);
+
+	return uint16_t((r << 11) | (g << 5) | b);
+}
+
+static inline void Expand565(uint16_t p_color, float p_rgb[4])
+{
+	uint32_t r = (p_color >> 11) & 31;
+	uint32_t g = (p_color >> 5) & 63;
+	uint32_t b = p_color & 31;
+
+	p_rgb[0] = float((r << 3) | (r >> 2));
+	p_rgb[1] = float((g << 2) | (g >> 4));
+	p_rgb[2] = float((b << 3) | (b >> 2));
+	p_rgb[3] = 255.0f;
+}
+
+//Four colors mode only, the palette is rebuilt exactly like the decoder does
+static void EvaluateBc1(const BlockTexels& p_block, const float p_endpoint0[4], const float p_endpoint1[4], Bc1Candidate& p_candidate)
+{
+	uint16_t color0 = Quantize565(p_endpoint0);
+	uint16_t color1 = Quantize565(p_endpoint1);
+
+	if (color0 < color1)
+		std::swap(color0, color1);
+
+	float palette[4][4];
+
+	Expand565(color0, palette[0]);
+	Expand565(color1, palette[1]);
+
+	for (uint32_t channel = 0; channel < 4; channel++)
+	{
+		uint32_t a = (uint32_t)palette[0][channel];
+		uint32_t b = (uint32_t)palette[1][channel];
+
+		palette[2][channel] = float((2 * a + b + 1) / 3);
+		palette[3][channel] = float((a + 2 * b + 1) / 3);
+	}
+
+	p_candidate.color0 = color0;
+	p_candidate.color1 = color1;
+
+	//Equal endpoints decode in the 3 colors mode, index 0 is still color0
+	p_candidate.error = SelectIndices(p_block, palette, color0 == color1 ? 1 : 4, 3, p_candidate.indices);
+}
+
+void BlockEncoder::EncodeBc1(const uint8_t p_texels[64], uint8_t p_block[8])
+{
+	static const float WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f }; //Share of color1 per index
+
+	BlockTexels block;
+	LoadTexels(p_texels, block);
+
+	float endpoint0[4];
+	float endpoint1[4];
+
+	FitPrincipalAxis(block, 3, endpoint0, endpoint1);
+
+	Bc1Candidate best;
+	EvaluateBc1(block, endpoint0, endpoint1, best);
+
+	for (int iteration = 0; iteration < 2 && best.error > 0.0f; iteration++)
+	{
+		//Indices were picked against (color0, color1) which may be swapped compared to the float endpoints
+		float refit0[4];
+		float refit1[4];
+
+		if (!RefitEndpoints(block, best.indices, WEIGHTS, 3, refit0, refit1))
+			break;
+
+		Bc1Candidate candidate;
+		EvaluateBc1(block, refit0, refit1, candidate);
+
+		if (candidate.error >= best.error)
+			break;
+
+		best = candidate;
+	}
+
+	uint32_t indices = 0;
+
+	for (uint32_t texel = 0; texel < 16; texel++)
+		indices |= uint32_t(best.indices[texel]) << (texel * 2);
+
+	p_block[0] = uint8_t(best.color0);
+	p_block[1] = uint8_t(best.color0 >> 8);
+	p_block[2] = uint8_t(best.color1);
+	p_block[3] = uint8_t(best.color1 >> 8);
+	memcpy(p_block + 4, &indices, 4);
+}
+#pragma endregion BC1
+
+#pragma region BC7
+static const uint8_t BC7_WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct Bc7Candidate
+{
+	uint32_t	endpoints[2][4];	//7 bits
+	uint32_t	pBits[2];
+	uint8_t		indices[16];
+	float		error;
+};
+
+//Tries the 4 p-bit combinations for these endpoints
+static void EvaluateBc7Mode6(const BlockTexels& p_block, const float p_endpoint0[4], const float p_endpoint1[4], Bc7Candidate& p_best)
+{
+	const float* endpoints[2] = { p_endpoint0, p_endpoint1 };
+
+	for (uint32_t pBits = 0; pBits < 4; pBits++)
+	{
+		Bc7Candidate candidate;
+
+		uint32_t values[2][4];
+
+		for (uint32_t endpoint = 0; endpoint < 2; endpoint++)
+		{
+			uint32_t pBit = (pBits >> endpoint) & 1;
+
+			candidate.pBits[endpoint] = pBit;
+
+			for (uint32_t channel = 0; channel < 4; channel++)
+			{
+				long quantized = std::lround((endpoints[endpoint][channel] - pBit) * 0.5f);
+
+				candidate.endpoints[endpoint][channel]	= (uint32_t)std::min(std::max(quantized, 0l), 127l);
+				values[endpoint][channel]				= (candidate.endpoints[endpoint][channel] << 1) | pBit;
+			}
+		}
+
+		float palette[16][4];
+
+		for (uint32_t entry = 0; entry < 16; entry++)
+		{
+			for (uint32_t channel = 0; channel < 4; channel++)
+				palette[entry][channel] = float(((64 - BC7_WEIGHTS_4[entry]) * values[0][channel] + BC7_WEIGHTS_4[entry] * values[1][channel] + 32) >> 6);
+		}
+
+		candidate.error = SelectIndices(p_block, palette, 16, 4, candidate.indices);
+
+		if (candidate.error < p_best.error)
+			p_best = candidate;
+	}
+}
+
+void BlockEncoder::EncodeBc7(const uint8_t p_texels[64], uint8_t p_block[16])
+{
+	static float weights[16];
+	static bool	 weightsReady = [] { for (uint32_t i = 0; i < 16; i++) weights[i] = BC7_WEIGHTS_4[i] / 64.0f; return true; }();
+	(void)weightsReady;
+
+	BlockTexels block;
+	LoadTexels(p_texels, block);
+
+	float endpoint0[4];
+	float endpoint1[4];
+
+	FitPrincipalAxis(block, 4, endpoint0, endpoint1);
+
+	Bc7Candidate best;
+	best.error = FLT_MAX;
+
+	EvaluateBc7Mode6(block, endpoint0, endpoint1, best);
+
+	for (int iteration = 0; iteration < 2 && best.error > 0.0f; iteration++)
+	{
+		float previousError = best.error;
+
+		if (!RefitEndpoints(block, best.indices, weights, 4, endpoint0, endpoint1))
+			break;
+
+		EvaluateBc7Mode6(block, endpoint0, endpoint1, best);
+
+		if (best.error >= previousError)
+			break;
+	}
+
+	//Texel 0 is stored without the top index bit : flip the endpoints if its index needs it
+	if (best.indices[0] >= 8)
+	{
+		for (uint32_t channel = 0; channel < 4; channel++)
+			std::swap(best.endpoints[0][channel], best.endpoints[1][channel]);
+
+		std::swap(best.pBits[0], best.pBits[1]);
+
+		for (uint32_t texel = 0; texel < 16; texel++)
+			best.indices[texel] = uint8_t(15 - best.indices[texel]);
+	}
+
+	BitWriter writer(p_block, 16);
+
+	writer.Write(1 << 6, 7); //Mode 6
+
+	for (uint32_t channel = 0; channel < 4; channel++)
+	{
+		writer.Write(best.endpoints[0][channel], 7);
+		writer.Write(best.endpoints[1][channel], 7);
+	}
+
+	writer.Write(best.pBits[0], 1);
+	writer.Write(best.pBits[1], 1);
+
+	for (uint32_t texel = 0; texel < 16; texel++)
+		writer.Write(best.indices[texel], texel == 0 ? 3 : 4);
+}
+#pragma endregion BC7
+
+bool BlockEncoder::CanEncode(VkFormat p_format)
+{
+	switch (p_format)
+	{
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void BlockEncoder::Encode(VkFormat p_format, const uint8_t* p_rgba, uint32_t p_width, uint32_t p_height, uint8_t* p_blocks, uint32_t p_threadCount)
+{
+	bool		isBc1		= p_format == VK_FORMAT_BC1_RGB_UNORM_BLOCK || p_format == VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+	uint32_t	blockSize	= isBc1 ? 8 : 16;
+
+	uint32_t blocksX = (p_width + 3) / 4;
+	uint32_t blocksY = (p_height + 3) / 4;
+
+	if (p_threadCount == 0)
+		p_threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	p_threadCount = std::min(p_threadCount, blocksY);
+
+	//Rows are handed out one at a time, blocks don't all cost the same
+	std::atomic<uint32_t> nextRow(0);
+
+	RunOnThreads(p_threadCount, [&](uint32_t)
+	{
+		uint8_t texels[64];
+
+		for (uint32_t blockY = nextRow++; blockY < blocksY; blockY = nextRow++)
+		{
+			for (uint32_t blockX = 0; blockX < blocksX; blockX++)
+			{
+				for (uint32_t y = 0; y < 4; y++)
+				{
+					uint32_t sourceY = std::min(blockY * 4 + y, p_height - 1);
+
+					for (uint32_t x = 0; x < 4; x++)
+					{
+						uint32_t sourceX = std::min(blockX * 4 + x, p_width - 1);
+
+						memcpy(texels + (y * 4 + x) * 4, p_rgba + (size_t(sourceY) * p_width + sourceX) * 4, 4);
+					}
+				}
+
+				uint8_t* block = p_blocks + (size_t(blockY) * blocksX + blockX) * blockSize;
+
+				if (isBc1)
+					EncodeBc1(texels, block);
+				else
+					EncodeBc7(texels, block);
+			}
+		}
+	});
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+#include "vulkan/vulkan.h"
+
+//
+//RGBA8 -> BC1 / BC7 block encoder for the offline cooker.
+//Endpoints come from the principal axis of the block then a least squares refit, index selection runs on 4 texels at once with SSE2.
+//BC7 only uses mode 6 (one subset, RGBA 7.7.7.7 + p-bits, 16 weights) : good on smooth content, fast enough to cook on every build.
+//
+class BlockEncoder
+{
+public:
+	//p_texels : 4x4 RGBA8 in row order
+	static void EncodeBc1(const uint8_t p_texels[64], uint8_t p_block[8]);
+	static void EncodeBc7(const uint8_t p_texels[64], uint8_t p_block[16]);
+
+	//BC1_RGB or BC7, UNORM or SRGB (the encoding is the same, only the format tag differs)
+	static bool CanEncode(VkFormat p_format);
+
+	//Whole level, edge blocks repeat the last row/column. Block rows are spread over p_threadCount threads (0 = every core)
+	static void Encode(VkFormat p_format, const uint8_t* p_rgba, uint32_t p_width, uint32_t p_height, uint8_t* p_blocks, uint32_t p_threadCount = 0);
+};
@@ -0,0 +1,285 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image/stb_image.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BlockDecoder.h"
+#include "BlockEncoder.h"
+#include "MappedFile.h"
+#include "MipmapGenerator.h"
+#include "TextureFile.h"
+#include "Utils.h"
+
+//
+//Offline texture cooker : PNG (or anything stb_image reads) -> KTX2 with a full BC1/BC7 mip chain the renderer maps and uploads as is.
+//Every output records a hash of its source and settings, inputs whose hash didn't change are skipped.
+//
+//TextureCooker [--format bc7|bc1] [--linear] [--threads N] [--force] <image>...
+//
+
+#define COOKER_VERSION		"1"
+#define SOURCE_HASH_KEY		"HMSourceHash"
+
+struct CookSettings
+{
+	VkFormat	format		= VK_FORMAT_BC7_SRGB_BLOCK;
+	bool		srgb		= true;
+	uint32_t	threadCount = 0;
+	bool		force		= false;
+};
+
+struct CookStats
+{
+	uint32_t	cooked		= 0;
+	uint32_t	upToDate	= 0;
+	uint32_t	failed		= 0;
+	double		megaPixels	= 0.0;
+	double		encodeTime	= 0.0; //Seconds
+};
+
+static std::string GetOutputPath(const std::string& p_inputPath)
+{
+	size_t extension = p_inputPath.find_last_of('.');
+	size_t separator = p_inputPath.find_last_of("/\\");
+
+	if (extension == std::string::npos || (separator != std::string::npos && extension < separator))
+		return p_inputPath + ".ktx2";
+
+	return p_inputPath.substr(0, extension) + ".ktx2";
+}
+
+static const char* GetFormatName(VkFormat p_format)
+{
+	switch (p_format)
+	{
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:	return "BC1 UNORM";
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:	return "BC1 SRGB";
+	case VK_FORMAT_BC7_UNORM_BLOCK:		return "BC7 UNORM";
+	case VK_FORMAT_BC7_SRGB_BLOCK:		return "BC7 SRGB";
+	default:							return "?";
+	}
+}
+
+//Of the encoded level 0 against the source, over the channels the format stores
+static double ComputePsnr(const uint8_t* p_source, const uint8_t* p_decoded, uint32_t p_width, uint32_t p_height, uint32_t p_channelCount)
+{
+	double squaredError = 0.0;
+
+	for (size_t texel = 0; texel < size_t(p_width) * p_height; texel++)
+	{
+		for (uint32_t channel = 0; channel < p_channelCount; channel++)
+		{
+			double difference = double(p_source[texel * 4 + channel]) - double(p_decoded[texel * 4 + channel]);
+
+			squaredError += difference * difference;
+		}
+	}
+
+	double meanSquaredError = squaredError / (double(p_width) * p_height * p_channelCount);
+
+	return meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : 99.0;
+}
+
+static bool CookTexture(const std::string& p_inputPath, const CookSettings& p_settings, CookStats& p_stats)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	MappedFile source;
+
+	if (!source.Open(p_inputPath.c_str()))
+	{
+		std::cout << "[Cooker] " << p_inputPath << " : can't open the file" << std::endl;
+		return false;
+	}
+
+	//Source bytes + everything that changes the output
+	std::string settingsKey = std::string(GetFormatName(p_settings.format)) + " v" COOKER_VERSION;
+
+	uint64_t hash = HashBytes(source.GetData(), source.GetSize());
+	hash = HashBytes(settingsKey.data(), settingsKey.size(), hash);
+
+	char hashText[17];
+	snprintf(hashText, sizeof(hashText), "%016llx", (unsigned long long)hash);
+
+	std::string outputPath = GetOutputPath(p_inputPath);
+
+	if (!p_settings.force)
+	{
+		TextureFile	existing;
+		std::string	existingHash;
+
+		if (existing.Open(outputPath.c_str()) && existing.FindKeyValue(SOURCE_HASH_KEY, existingHash) && existingHash == hashText)
+		{
+			std::cout << "[Cooker] " << outputPath << " is up to date" << std::endl;
+			p_stats.upToDate++;
+			return true;
+		}
+	}
+
+	int width, height, channels;
+	stbi_uc* pixels = stbi_load_from_memory(static_cast<const stbi_uc*>(source.GetData()), (int)source.GetSize(), &width, &height, &channels, STBI_rgb_alpha);
+
+	if (!pixels)
+	{
+		std::cout << "[Cooker] " << p_inputPath << " : " << stbi_failure_reason() << std::endl;
+		return false;
+	}
+
+	std::vector<uint8_t>	chain;
+	std::vector<ImageLevel> levels;
+
+	MipmapGenerator::GenerateRgba8(pixels, width, height, p_settings.srgb, chain, levels);
+
+	FormatInfo formatInfo;
+	TextureFile::GetFormatInfo(p_settings.format, formatInfo);
+
+	//Compressed levels, same 16 bytes alignment as the uncompressed chain
+	std::vector<ImageLevel> blockLevels(levels.size());
+	VkDeviceSize			blockDataSize = 0;
+
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		blockLevels[i].offset	= blockDataSize;
+		blockLevels[i].size		= TextureFile::GetLevelSize(formatInfo, levels[i].width, levels[i].height);
+		blockLevels[i].width	= levels[i].width;
+		blockLevels[i].height	= levels[i].height;
+
+		blockDataSize = (blockDataSize + blockLevels[i].size + 15) & ~VkDeviceSize(15);
+	}
+
+	std::vector<uint8_t> blocks(blockDataSize);
+
+	auto encodeStart = std::chrono::high_resolution_clock::now();
+
+	double megaPixels = 0.0;
+
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		BlockEncoder::Encode(p_settings.format, chain.data() + levels[i].offset, levels[i].width, levels[i].height, blocks.data() + blockLevels[i].offset, p_settings.threadCount);
+
+		megaPixels += double(levels[i].width) * levels[i].height / 1e6;
+	}
+
+	double encodeTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - encodeStart).count();
+
+	std::vector<uint8_t> decoded(size_t(width) * height * 4);
+	BlockDecoder::Decode(p_settings.format, blocks.data(), width, height, decoded.data());
+
+	bool	hasAlpha	= p_settings.format == VK_FORMAT_BC7_UNORM_BLOCK || p_settings.format == VK_FORMAT_BC7_SRGB_BLOCK;
+	double	psnr		= ComputePsnr(pixels, decoded.data(), width, height, hasAlpha ? 4 : 3);
+
+	stbi_image_free(pixels);
+
+	std::vector<std::pair<std::string, std::string>> keyValues =
+	{
+		{ "KTXwriter",		"HM TextureCooker v" COOKER_VERSION },
+		{ SOURCE_HASH_KEY,	hashText }
+	};
+
+	if (!TextureFile::Write(outputPath.c_str(), p_settings.format, blocks.data(), blockLevels, keyValues))
+	{
+		std::cout << "[Cooker] " << outputPath << " : can't write the file" << std::endl;
+		return false;
+	}
+
+	double totalTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	std::cout << "[Cooker] " << p_inputPath << " -> " << outputPath << " : " << width << "x" << height << ", " << levels.size() << " levels, " << GetFormatName(p_settings.format)
+			  << std::fixed << std::setprecision(2) << ", " << chain.size() / (1024.0 * 1024.0) << " MB -> " << blockDataSize / (1024.0 * 1024.0) << " MB, PSNR " << psnr << " dB"
+			  << std::setprecision(1) << ", encoded at " << megaPixels / std::max(encodeTime, 1e-9) << " MP/s"
+			  << std::setprecision(0) << " (" << totalTime * 1000.0 << " ms total)" << std::defaultfloat << std::endl;
+
+	p_stats.cooked++;
+	p_stats.megaPixels += megaPixels;
+	p_stats.encodeTime += encodeTime;
+
+	return true;
+}
+
+static void PrintUsage()
+{
+	std::cout << "Usage : TextureCooker [options] <image>...\n"
+				 "  --format bc7|bc1  block format (default bc7)\n"
+				 "  --linear          data texture, no sRGB encoding\n"
+				 "  --threads N       encoding threads (default : every core)\n"
+				 "  --force           cook even when the output is up to date\n"
+				 "Each <image> is written next to itself as a .ktx2" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	CookSettings				settings;
+	std::vector<std::string>	inputs;
+	bool						bc1 = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--format") && i + 1 < argc)
+		{
+			const char* format = argv[++i];
+
+			if (!strcmp(format, "bc1"))
+				bc1 = true;
+			else if (!strcmp(format, "bc7"))
+				bc1 = false;
+			else
+			{
+				std::cout << "[Cooker] unknown format " << format << ", bc7 or bc1" << std::endl;
+				return 1;
+			}
+		}
+		else if (!strcmp(argv[i], "--linear"))
+			settings.srgb = false;
+		else if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+			settings.threadCount = (uint32_t)std::max(atoi(argv[++i]), 0);
+		else if (!strcmp(argv[i], "--force"))
+			settings.force = true;
+		else if (argv[i][0] == '-')
+		{
+			PrintUsage();
+			return 1;
+		}
+		else
+			inputs.emplace_back(argv[i]);
+	}
+
+	if (inputs.empty())
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (bc1)
+		settings.format = settings.srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+	else
+		settings.format = settings.srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+
+	if (settings.threadCount == 0)
+		settings.threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	CookStats stats;
+
+	for (const std::string& input : inputs)
+	{
+		if (!CookTexture(input, settings, stats))
+			stats.failed++;
+	}
+
+	std::cout << "[Cooker] " << stats.cooked << " cooked, " << stats.upToDate << " up to date, " << stats.failed << " failed";
+
+	if (stats.cooked > 0)
+		std::cout << std::fixed << std::setprecision(1) << ", " << stats.megaPixels / std::max(stats.encodeTime, 1e-9) << " MP/s on " << settings.threadCount << " threads";
+
+	std::cout << std::endl;
+
+	return stats.failed > 0 ? 1 : 0;
+}